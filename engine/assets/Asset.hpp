@@ -27,6 +27,7 @@ namespace ouzel::assets
         struct Options final
         {
             bool mipmaps = true;
+            bool stream = false; // sounds are played from a memory mapped file instead of being loaded into memory
         };
 
         Asset(Type initType,
@@ -4,6 +4,7 @@
 #include "AssetError.hpp"
 #include "Bundle.hpp"
 #include "Cache.hpp"
+#include "VorbisLoader.hpp"
 #include "../formats/Json.hpp"
 
 namespace ouzel::assets
@@ -23,6 +24,13 @@ namespace ouzel::assets
                            const std::string& filename,
                            const Asset::Options& options)
     {
+        if (assetType == Asset::Type::sound && options.stream)
+        {
+            // formats that can not be streamed are loaded into memory
+            if (loadStreamedVorbis(*this, name, fileSystem.mapFile(filename)))
+                return;
+        }
+
         const auto data = fileSystem.readFile(filename);
 
         const auto& loaders = cache.getLoaders();
@@ -46,6 +54,7 @@ namespace ouzel::assets
 
             Asset::Options options;
             options.mipmaps = asset.hasMember("mipmaps") ? asset["mipmaps"].as<bool>() : true;
+            options.stream = asset.hasMember("stream") ? asset["stream"].as<bool>() : false;
             loadAsset(static_cast<Asset::Type>(asset["type"].as<std::uint32_t>()), name, file, options);
         }
     }
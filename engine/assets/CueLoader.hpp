@@ -86,6 +86,8 @@ namespace ouzel::assets
                     if (effectValue.hasMember("scale")) effectDefinition.scale = effectValue["scale"].as<float>();
                     if (effectValue.hasMember("shift")) effectDefinition.shift = effectValue["shift"].as<float>();
                     if (effectValue.hasMember("decay")) effectDefinition.decay = effectValue["decay"].as<float>();
+                    if (effectValue.hasMember("frequency")) effectDefinition.frequency = effectValue["frequency"].as<float>();
+                    if (effectValue.hasMember("resonance")) effectDefinition.resonance = effectValue["resonance"].as<float>();
 
                     sourceDefinition.effectDefinitions.push_back(effectDefinition);
                 }
@@ -4,8 +4,10 @@
 #define OUZEL_ASSETS_VORBISLOADER_HPP
 
 #include "Bundle.hpp"
+#include "../audio/PcmClip.hpp"
 #include "../audio/VorbisClip.hpp"
 #include "../core/Engine.hpp"
+#include "../storage/MappedFile.hpp"
 
 namespace ouzel::assets
 {
@@ -17,8 +19,22 @@ namespace ouzel::assets
     {
         try
         {
-            auto sound = std::make_unique<audio::VorbisClip>(engine->getAudio(), data);
-            bundle.setSound(name, std::move(sound));
+            auto& audio = engine->getAudio();
+
+            // short clips are decoded once here instead of on every playback
+            std::uint32_t channels;
+            std::uint32_t sampleRate;
+            std::vector<float> samples;
+            if (audio::decodeVorbis(data, audio.getPreDecodeDuration(), channels, sampleRate, samples))
+            {
+                auto sound = std::make_unique<audio::PcmClip>(audio, channels, sampleRate, samples);
+                bundle.setSound(name, std::move(sound));
+            }
+            else
+            {
+                auto sound = std::make_unique<audio::VorbisClip>(audio, data);
+                bundle.setSound(name, std::move(sound));
+            }
         }
         catch (const std::exception&)
         {
@@ -27,6 +43,23 @@ namespace ouzel::assets
 
         return true;
     }
+
+    inline bool loadStreamedVorbis(Bundle& bundle,
+                                   const std::string& name,
+                                   storage::MappedFile&& file)
+    {
+        const auto data = file.data();
+        if (file.getSize() < 4 ||
+            static_cast<char>(data[0]) != 'O' ||
+            static_cast<char>(data[1]) != 'g' ||
+            static_cast<char>(data[2]) != 'g' ||
+            static_cast<char>(data[3]) != 'S')
+            return false;
+
+        auto sound = std::make_unique<audio::VorbisClip>(engine->getAudio(), std::move(file));
+        bundle.setSound(name, std::move(sound));
+        return true;
+    }
 }
 
 #endif // OUZEL_ASSETS_VORBISLOADER_HPP
@@ -9,6 +9,7 @@
 #include "alsa/ALSAAudioDevice.hpp"
 #include "coreaudio/CAAudioDevice.hpp"
 #include "empty/EmptyAudioDevice.hpp"
+#include "offline/OfflineAudioDevice.hpp"
 #include "openal/OALAudioDevice.hpp"
 #include "opensl/OSLAudioDevice.hpp"
 #include "xaudio2/XA2AudioDevice.hpp"
@@ -25,6 +26,7 @@ namespace ouzel::audio
         if (availableDrivers.empty())
         {
             availableDrivers.insert(Driver::empty);
+            availableDrivers.insert(Driver::offline);
 
 #if OUZEL_COMPILE_OPENAL
             availableDrivers.insert(Driver::openAl);
@@ -72,6 +74,8 @@ namespace ouzel::audio
         }
         else if (driver == "empty")
             return Driver::empty;
+        else if (driver == "offline")
+            return Driver::offline;
         else if (driver == "openal")
             return Driver::openAl;
         else if (driver == "xaudio2")
@@ -99,6 +103,9 @@ namespace ouzel::audio
         {
             switch (driver)
             {
+                case Driver::offline:
+                    log(Log::Level::info) << "Using offline audio driver";
+                    return std::make_unique<offline::AudioDevice>(settings, dataGetter);
 #if OUZEL_COMPILE_OPENAL
                 case Driver::openAl:
                     log(Log::Level::info) << "Using OpenAL audio driver";
@@ -144,13 +151,30 @@ namespace ouzel::audio
                                            std::placeholders::_3,
                                            std::placeholders::_4),
                                  settings)},
-        mixer{device->getBufferSize(), device->getChannels()},
+        decoder{settings.decodeAheadFrames, device->getDriver() == Driver::offline},
+        mixer{
+            device->getBufferSize(),
+            device->getChannels(),
+            device->getSampleRate(),
+            settings.bufferCount,
+            settings.maxVoices,
+            device->getDriver() == Driver::offline
+        },
+        resampleQuality{settings.resampleQuality},
+        preDecodeDuration{settings.preDecodeDuration},
+        streamWindowSize{settings.streamWindowSize},
         masterMix{*this},
         rootNode{*this} // mixer.getRootObjectId()
     {
         addCommand(std::make_unique<mixer::SetMasterBusCommand>(masterMix.getBusId()));
     }
 
+    Audio::~Audio()
+    {
+        // the device thread reads from the mixer, which is destroyed before the device
+        device->stop();
+    }
+
     // TODO: get rid of this and push frames to audio device instead
     void Audio::start()
     {
@@ -187,26 +211,57 @@ namespace ouzel::audio
 
     void Audio::deleteObject(mixer::Mixer::ObjectId objectId)
     {
+        dataObjects.erase(objectId);
         addCommand(std::make_unique<mixer::DeleteObjectCommand>(objectId));
     }
 
     mixer::Mixer::ObjectId Audio::initBus()
     {
         const auto busId = mixer.getObjectId();
-        addCommand(std::make_unique<mixer::InitBusCommand>(busId));
+        addCommand(std::make_unique<mixer::InitBusCommand>(busId, std::make_unique<mixer::Bus>(mixer.getBufferSize())));
         return busId;
     }
 
     mixer::Mixer::ObjectId Audio::initStream(mixer::Mixer::ObjectId sourceId)
     {
+        const auto i = dataObjects.find(sourceId);
+        if (i == dataObjects.end())
+            throw Error{"Invalid audio data"};
+
+        // the data is immutable after its creation, so the stream can be created before it is passed to the mixer
+        auto& data = *i->second;
+        auto stream = data.createStream();
+
+        if (data.getSampleRate() != mixer.getSampleRate())
+            stream->setResampler(mixer::Resampler{data.getChannels(),
+                data.getSampleRate(),
+                mixer.getSampleRate(),
+                mixer.getBufferSize(),
+                getResampleFilter(data.getSampleRate())});
+
+        stream->reserve(mixer.getBufferSize(), mixer.getChannels());
+
         const auto streamId = mixer.getObjectId();
-        addCommand(std::make_unique<mixer::InitStreamCommand>(streamId, sourceId));
+        addCommand(std::make_unique<mixer::InitStreamCommand>(streamId, std::move(stream)));
         return streamId;
     }
 
+    std::shared_ptr<const mixer::Resampler::Filter> Audio::getResampleFilter(std::uint32_t sourceSampleRate)
+    {
+        // ratios that would need too large filter banks fall back to linear interpolation
+        if (resampleQuality == ResampleQuality::linear ||
+            mixer::Resampler::getPhases(sourceSampleRate, mixer.getSampleRate()) > mixer::Resampler::maxFilterPhases)
+            return nullptr;
+
+        auto& filter = resampleFilters[sourceSampleRate];
+        if (!filter) filter = std::make_shared<const mixer::Resampler::Filter>(sourceSampleRate, mixer.getSampleRate());
+        return filter;
+    }
+
     mixer::Mixer::ObjectId Audio::initData(std::unique_ptr<mixer::Data> data)
     {
         const auto dataId = mixer.getObjectId();
+        dataObjects[dataId] = data.get();
         addCommand(std::make_unique<mixer::InitDataCommand>(dataId, std::move(data)));
         return dataId;
     }
@@ -224,6 +279,16 @@ namespace ouzel::audio
         addCommand(std::make_unique<mixer::UpdateProcessorCommand>(processorId, updateFunction));
     }
 
+    void Audio::setProcessorParameter(mixer::Mixer::ObjectId processorId, std::uint32_t parameter, float value)
+    {
+        addCommand(std::make_unique<mixer::SetProcessorParameterCommand>(processorId, parameter, value));
+    }
+
+    void Audio::setProcessorPosition(mixer::Mixer::ObjectId processorId, const math::Vector<float, 3>& position)
+    {
+        addCommand(std::make_unique<mixer::SetProcessorPositionCommand>(processorId, position));
+    }
+
     void Audio::getSamples(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate, std::vector<float>& samples)
     {
         mixer.getSamples(frames, channels, sampleRate, samples);
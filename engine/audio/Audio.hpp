@@ -5,10 +5,13 @@
 
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <set>
+#include <unordered_map>
 #include <vector>
 #include "AudioDevice.hpp"
+#include "Decoder.hpp"
 #include "Driver.hpp"
 #include "Mix.hpp"
 #include "Node.hpp"
@@ -16,6 +19,7 @@
 #include "mixer/Commands.hpp"
 #include "mixer/Processor.hpp"
 #include "mixer/Mixer.hpp"
+#include "mixer/Resampler.hpp"
 #include "../math/Quaternion.hpp"
 #include "../math/Vector.hpp"
 
@@ -30,8 +34,15 @@ namespace ouzel::audio
     {
     public:
         Audio(Driver driver, const Settings& settings);
+        ~Audio();
+
+        Audio(const Audio&) = delete;
+        Audio& operator=(const Audio&) = delete;
+        Audio(Audio&&) = delete;
+        Audio& operator=(Audio&&) = delete;
 
         auto getDevice() const noexcept { return device.get(); }
+        Decoder& getDecoder() { return decoder; }
         mixer::Mixer& getMixer() { return mixer; }
         Mix& getMasterMix() { return masterMix; }
 
@@ -50,18 +61,31 @@ namespace ouzel::audio
         mixer::Mixer::ObjectId initProcessor(std::unique_ptr<mixer::Processor> processor);
         void updateProcessor(mixer::Mixer::ObjectId processorId,
                              const std::function<void(mixer::Processor*)>& updateFunction);
+        void setProcessorParameter(mixer::Mixer::ObjectId processorId, std::uint32_t parameter, float value);
+        void setProcessorPosition(mixer::Mixer::ObjectId processorId, const math::Vector<float, 3>& position);
 
         auto& getRootNode() { return rootNode; }
 
+        auto getPreDecodeDuration() const noexcept { return preDecodeDuration; }
+        auto getStreamWindowSize() const noexcept { return streamWindowSize; }
+
     private:
         void getSamples(std::uint32_t frames,
                         std::uint32_t channels,
                         std::uint32_t sampleRate,
                         std::vector<float>& samples);
 
+        std::shared_ptr<const mixer::Resampler::Filter> getResampleFilter(std::uint32_t sourceSampleRate);
+
         std::unique_ptr<AudioDevice> device;
+        Decoder decoder; // destroyed after the mixer, which owns the streams that decode on it
         mixer::Mixer mixer;
         mixer::CommandBuffer commandBuffer;
+        std::unordered_map<mixer::Mixer::ObjectId, mixer::Data*> dataObjects; // streams are created on the game thread
+        ResampleQuality resampleQuality;
+        float preDecodeDuration;
+        std::uint32_t streamWindowSize;
+        std::map<std::uint32_t, std::shared_ptr<const mixer::Resampler::Filter>> resampleFilters; // by the source sample rate
         Mix masterMix;
         Node rootNode;
     };
@@ -2,6 +2,7 @@
 
 #include "AudioDevice.hpp"
 #include "AudioError.hpp"
+#include "Dsp.hpp"
 
 namespace ouzel::audio
 {
@@ -20,6 +21,23 @@ namespace ouzel::audio
     }
 
     void AudioDevice::getData(std::uint32_t frames, std::vector<std::uint8_t>& result)
+    {
+        switch (sampleFormat)
+        {
+            case SampleFormat::signedInt16:
+                result.resize(frames * channels * sizeof(std::int16_t));
+                break;
+            case SampleFormat::float32:
+                result.resize(frames * channels * sizeof(float));
+                break;
+            default:
+                throw Error{"Invalid sample format"};
+        }
+
+        getData(frames, result.data());
+    }
+
+    void AudioDevice::getData(std::uint32_t frames, void* result)
     {
         dataGetter(frames, channels, sampleRate, buffer);
 
@@ -27,30 +45,18 @@ namespace ouzel::audio
         {
             case SampleFormat::signedInt16:
             {
-                result.resize(frames * channels * sizeof(std::int16_t));
-                auto resultPtr = reinterpret_cast<std::int16_t*>(result.data());
+                auto resultPtr = static_cast<std::int16_t*>(result);
 
                 for (std::uint32_t channel = 0; channel < channels; ++channel)
-                {
-                    const auto bufferChannel = &buffer[channel * frames];
-
-                    for (std::uint32_t frame = 0; frame < frames; ++frame)
-                        resultPtr[frame * channels + channel] = static_cast<std::int16_t>(bufferChannel[frame] * 32767.0F);
-                }
+                    dsp::convertToInt16(resultPtr + channel, channels, &buffer[channel * frames], frames);
                 break;
             }
             case SampleFormat::float32:
             {
-                result.resize(frames * channels * sizeof(float));
-                auto resultPtr = reinterpret_cast<float*>(result.data());
+                auto resultPtr = static_cast<float*>(result);
 
                 for (std::uint32_t channel = 0; channel < channels; ++channel)
-                {
-                    const auto bufferChannel = &buffer[channel * frames];
-
-                    for (std::uint32_t frame = 0; frame < frames; ++frame)
-                        resultPtr[frame * channels + channel] = bufferChannel[frame];
-                }
+                    dsp::interleave(resultPtr + channel, channels, &buffer[channel * frames], frames);
                 break;
             }
             default:
@@ -3,6 +3,8 @@
 #ifndef OUZEL_AUDIO_AUDIODEVICE_HPP
 #define OUZEL_AUDIO_AUDIODEVICE_HPP
 
+#include <atomic>
+#include <cstddef>
 #include <functional>
 #include <vector>
 #include "Driver.hpp"
@@ -36,6 +38,10 @@ namespace ouzel::audio
         auto getSampleRate() const noexcept { return sampleRate; }
         auto getChannels() const noexcept { return channels; }
 
+        // frames queued in the device ahead of the frame that is being played, measured by the backends that can
+        auto getLatency() const noexcept { return latency.load(std::memory_order_relaxed); }
+        auto getXrunCount() const noexcept { return xrunCount.load(std::memory_order_relaxed); }
+
         virtual void start() = 0;
         virtual void stop() = 0;
 
@@ -44,6 +50,10 @@ namespace ouzel::audio
 
     protected:
         void getData(std::uint32_t frames, std::vector<std::uint8_t>& result);
+        void getData(std::uint32_t frames, void* result); // writes interleaved samples of the sample format
+
+        std::atomic<std::uint32_t> latency{0};
+        std::atomic<std::size_t> xrunCount{0};
 
         std::uint16_t apiMajorVersion = 0;
         std::uint16_t apiMinorVersion = 0;
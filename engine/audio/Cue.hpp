@@ -39,6 +39,8 @@ namespace ouzel::audio
         float scale = 1.0F;
         float shift = 1.0f;
         float decay = 0.0F;
+        float frequency = 0.0F; // cutoff of the filters, zero keeps the default one
+        float resonance = 0.70710678F;
         std::pair<float, float> delayRandom{0.0F, 0.0F};
         std::pair<float, float> gainRandom{0.0F, 0.0F};
         std::pair<float, float> scaleRandom{0.0F, 0.0F};
@@ -0,0 +1,56 @@
+// Ouzel by Elviss Strazdins
+
+#include <algorithm>
+#include "Decoder.hpp"
+
+namespace ouzel::audio
+{
+    Decoder::Decoder(std::uint32_t initPrefetchFrames, bool initSynchronous):
+        prefetchFrames{initPrefetchFrames},
+        synchronous{initSynchronous}
+    {
+        // started after all the members have been initialized
+        if (!synchronous)
+            decoderThread = thread::Thread{&Decoder::decoderMain, this};
+    }
+
+    Decoder::~Decoder()
+    {
+        running = false;
+        semaphore.release();
+
+        if (decoderThread.isJoinable())
+            decoderThread.join();
+    }
+
+    void Decoder::addSource(Source& source)
+    {
+        {
+            std::scoped_lock lock{sourcesMutex};
+            sources.push_back(&source);
+        }
+
+        semaphore.release(); // start decoding ahead right away
+    }
+
+    void Decoder::removeSource(Source& source)
+    {
+        // waits for the source to finish decoding, so that it can be destroyed after this
+        std::scoped_lock lock{sourcesMutex};
+        sources.erase(std::remove(sources.begin(), sources.end(), &source), sources.end());
+    }
+
+    void Decoder::decoderMain()
+    {
+        while (running)
+        {
+            {
+                std::scoped_lock lock{sourcesMutex};
+                for (const auto source : sources)
+                    source->decode();
+            }
+
+            semaphore.acquire();
+        }
+    }
+}
@@ -0,0 +1,70 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_AUDIO_DECODER_HPP
+#define OUZEL_AUDIO_DECODER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "../thread/Semaphore.hpp"
+#include "../thread/Thread.hpp"
+
+namespace ouzel::audio
+{
+    // Decodes the compressed streams ahead of the mixer on its own thread,
+    // so that the decoding cost does not count against the mixer deadline
+    class Decoder final
+    {
+    public:
+        class Source
+        {
+        public:
+            Source() = default;
+            virtual ~Source() = default;
+
+            Source(const Source&) = delete;
+            Source& operator=(const Source&) = delete;
+            Source(Source&&) = delete;
+            Source& operator=(Source&&) = delete;
+
+            // called on the decoder thread, fills the buffer of the source
+            virtual void decode() = 0;
+        };
+
+        // a synchronous decoder has no thread, the sources decode when they are read
+        explicit Decoder(std::uint32_t initPrefetchFrames, bool initSynchronous = false);
+        ~Decoder();
+
+        Decoder(const Decoder&) = delete;
+        Decoder& operator=(const Decoder&) = delete;
+        Decoder(Decoder&&) = delete;
+        Decoder& operator=(Decoder&&) = delete;
+
+        auto getPrefetchFrames() const noexcept { return prefetchFrames; }
+        auto isSynchronous() const noexcept { return synchronous; }
+
+        void addSource(Source& source);
+        void removeSource(Source& source);
+
+        // called by the sources on the mixer thread after they have read from their buffers
+        void wake() { semaphore.release(); }
+
+        void addUnderrun() noexcept { underrunCount.fetch_add(1, std::memory_order_relaxed); }
+        auto getUnderrunCount() const noexcept { return underrunCount.load(std::memory_order_relaxed); }
+
+    private:
+        void decoderMain();
+
+        std::uint32_t prefetchFrames;
+        bool synchronous;
+        std::mutex sourcesMutex;
+        std::vector<Source*> sources;
+        std::atomic<std::size_t> underrunCount{0};
+        std::atomic<bool> running{true};
+        thread::Semaphore semaphore;
+        thread::Thread decoderThread;
+    };
+}
+
+#endif // OUZEL_AUDIO_DECODER_HPP
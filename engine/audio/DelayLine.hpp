@@ -0,0 +1,97 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_AUDIO_DELAYLINE_HPP
+#define OUZEL_AUDIO_DELAYLINE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace ouzel::audio
+{
+    // Circular buffer of the past samples of one channel, writing a sample and reading
+    // a delayed one cost the same regardless of the delay
+    class DelayLine final
+    {
+    public:
+        DelayLine() = default;
+
+        explicit DelayLine(float maxDelay)
+        {
+            reserve(maxDelay);
+        }
+
+        // the longest delay in samples that can be read
+        auto getMaxDelay() const noexcept
+        {
+            return buffer.empty() ? 0.0F : static_cast<float>(buffer.size() - 2);
+        }
+
+        // grows the buffer to a power of two if it can not hold the delay, keeping the written samples
+        void reserve(float maxDelay)
+        {
+            const auto size = static_cast<std::size_t>(maxDelay) + 2; // one more for the interpolation
+            if (size <= buffer.size()) return;
+
+            std::size_t capacity = 1;
+            while (capacity < size) capacity *= 2;
+
+            DelayLine longerLine;
+            longerLine.buffer.resize(capacity);
+            longerLine.mask = capacity - 1;
+            grow(longerLine);
+        }
+
+        // moves the written samples to the longer line and takes its buffer without allocating,
+        // so that a line allocated on the game thread can replace the one used by the mixer,
+        // the replaced buffer is left in the longer line
+        void grow(DelayLine& longerLine) noexcept
+        {
+            const auto capacity = longerLine.buffer.size();
+            if (capacity <= buffer.size()) return;
+
+            std::fill(longerLine.buffer.begin(), longerLine.buffer.end() - static_cast<std::ptrdiff_t>(buffer.size()), 0.0F);
+            for (std::size_t i = 0; i < buffer.size(); ++i)
+                longerLine.buffer[capacity - buffer.size() + i] = buffer[(position + i) & mask];
+
+            std::swap(buffer, longerLine.buffer);
+            std::swap(mask, longerLine.mask);
+            position = 0;
+            longerLine.position = 0;
+        }
+
+        void clear() noexcept
+        {
+            std::fill(buffer.begin(), buffer.end(), 0.0F);
+        }
+
+        void write(float sample) noexcept
+        {
+            buffer[position] = sample;
+            position = (position + 1) & mask;
+        }
+
+        // the sample written the given number of samples before the last written one
+        float read(std::size_t delay) const noexcept
+        {
+            return buffer[(position - 1 - delay) & mask];
+        }
+
+        // linearly interpolates between the two samples around the fractional delay
+        float read(float delay) const noexcept
+        {
+            const auto integerDelay = static_cast<std::size_t>(delay);
+            const auto fraction = delay - static_cast<float>(integerDelay);
+            const auto sample = read(integerDelay);
+            return sample + (read(integerDelay + 1) - sample) * fraction;
+        }
+
+    private:
+        std::vector<float> buffer;
+        std::size_t mask = 0;
+        std::size_t position = 0; // where the next sample is written
+    };
+}
+
+#endif // OUZEL_AUDIO_DELAYLINE_HPP
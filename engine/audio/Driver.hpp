@@ -8,6 +8,7 @@ namespace ouzel::audio
     enum class Driver
     {
         empty,
+        offline,
         openAl,
         xAudio2,
         openSl,
@@ -0,0 +1,148 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_AUDIO_DSP_HPP
+#define OUZEL_AUDIO_DSP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include "../math/Simd.hpp"
+
+namespace ouzel::audio::dsp
+{
+    inline namespace detail
+    {
+        // calls the kernel with SIMD lanes for the bulk of the samples and with scalar lanes for the rest
+        template <class Kernel>
+        void forEachLane(std::size_t count, Kernel kernel) noexcept
+        {
+            // the tail is counted separately, so that GCC can not assume that it wraps around
+            const auto simdCount = count - count % math::SimdLanes::width;
+            for (std::size_t i = 0; i < simdCount; i += math::SimdLanes::width)
+                kernel(math::SimdLanes{}, i);
+
+            const auto remaining = count - simdCount;
+            for (std::size_t i = 0; i < remaining; ++i)
+                kernel(math::ScalarLanes{}, simdCount + i);
+        }
+    }
+
+    // destination += source
+    inline void add(float* destination, const float* source, std::size_t count) noexcept
+    {
+        forEachLane(count, [destination, source](auto lanes, std::size_t i) noexcept {
+            using Lanes = decltype(lanes);
+            Lanes::store(destination + i, Lanes::add(Lanes::load(destination + i), Lanes::load(source + i)));
+        });
+    }
+
+    // destination += source * gain
+    inline void addScaled(float* destination, const float* source, float gain, std::size_t count) noexcept
+    {
+        forEachLane(count, [destination, source, gain](auto lanes, std::size_t i) noexcept {
+            using Lanes = decltype(lanes);
+            const auto scaled = Lanes::mul(Lanes::load(source + i), Lanes::set(gain));
+            Lanes::store(destination + i, Lanes::add(Lanes::load(destination + i), scaled));
+        });
+    }
+
+    // destination = source * gain
+    inline void scale(float* destination, const float* source, float gain, std::size_t count) noexcept
+    {
+        forEachLane(count, [destination, source, gain](auto lanes, std::size_t i) noexcept {
+            using Lanes = decltype(lanes);
+            Lanes::store(destination + i, Lanes::mul(Lanes::load(source + i), Lanes::set(gain)));
+        });
+    }
+
+    // destination = source * gain, where the gain changes linearly from startGain to endGain over the samples
+    inline void scaleRamp(float* destination, const float* source, float startGain, float endGain, std::size_t count) noexcept
+    {
+        static constexpr float laneOffsets[]{0.0F, 1.0F, 2.0F, 3.0F, 4.0F, 5.0F, 6.0F, 7.0F, 8.0F, 9.0F, 10.0F, 11.0F, 12.0F, 13.0F, 14.0F, 15.0F};
+        static_assert(math::SimdLanes::width <= std::size(laneOffsets));
+
+        const auto step = count ? (endGain - startGain) / static_cast<float>(count) : 0.0F;
+        forEachLane(count, [destination, source, startGain, step](auto lanes, std::size_t i) noexcept {
+            using Lanes = decltype(lanes);
+            const auto offsets = Lanes::mul(Lanes::load(laneOffsets), Lanes::set(step));
+            const auto gain = Lanes::add(Lanes::set(startGain + static_cast<float>(i + 1) * step), offsets);
+            Lanes::store(destination + i, Lanes::mul(Lanes::load(source + i), gain));
+        });
+    }
+
+    // destination = (a + b) * gain
+    inline void addPair(float* destination, const float* a, const float* b, float gain, std::size_t count) noexcept
+    {
+        forEachLane(count, [destination, a, b, gain](auto lanes, std::size_t i) noexcept {
+            using Lanes = decltype(lanes);
+            const auto sum = Lanes::add(Lanes::load(a + i), Lanes::load(b + i));
+            Lanes::store(destination + i, Lanes::mul(sum, Lanes::set(gain)));
+        });
+    }
+
+    // destination = clamp(source, min, max)
+    inline void clamp(float* destination, const float* source, float min, float max, std::size_t count) noexcept
+    {
+        forEachLane(count, [destination, source, min, max](auto lanes, std::size_t i) noexcept {
+            using Lanes = decltype(lanes);
+            const auto clamped = Lanes::min(Lanes::max(Lanes::load(source + i), Lanes::set(min)), Lanes::set(max));
+            Lanes::store(destination + i, clamped);
+        });
+    }
+
+    // sum of a * b
+    inline float dot(const float* a, const float* b, std::size_t count) noexcept
+    {
+        const auto simdCount = count - count % math::SimdLanes::width;
+        auto sums = math::SimdLanes::set(0.0F);
+        for (std::size_t i = 0; i < simdCount; i += math::SimdLanes::width)
+            sums = math::SimdLanes::add(sums, math::SimdLanes::mul(math::SimdLanes::load(a + i), math::SimdLanes::load(b + i)));
+
+        float lanes[math::SimdLanes::width];
+        math::SimdLanes::store(lanes, sums);
+
+        float result = 0.0F;
+        for (const auto lane : lanes) result += lane;
+
+        const auto remaining = count - simdCount;
+        for (std::size_t i = 0; i < remaining; ++i) result += a[simdCount + i] * b[simdCount + i];
+        return result;
+    }
+
+    // converts the source to clamped 16-bit integers written every stride elements of the destination
+    inline void convertToInt16(std::int16_t* destination, std::size_t stride,
+                               const float* source, std::size_t count) noexcept
+    {
+        forEachLane(count, [destination, stride, source](auto lanes, std::size_t i) noexcept {
+            using Lanes = decltype(lanes);
+
+            const auto clamped = Lanes::min(Lanes::max(Lanes::load(source + i), Lanes::set(-1.0F)), Lanes::set(1.0F));
+            float scaled[Lanes::width];
+            Lanes::store(scaled, Lanes::mul(clamped, Lanes::set(32767.0F)));
+
+            for (std::size_t lane = 0; lane < Lanes::width; ++lane)
+                destination[(i + lane) * stride] = static_cast<std::int16_t>(scaled[lane]);
+        });
+    }
+
+    // inverse distance clamped attenuation of a sound at the distance from the listener, the minimal distance
+    // is kept positive and the maximal one not below it, because both are set by the users of the panner
+    inline float getDistanceAttenuation(float distance, float minDistance, float maxDistance, float rolloffFactor) noexcept
+    {
+        constexpr float minMinDistance = 0.001F; // one millimeter
+        const auto safeMinDistance = std::max(minDistance, minMinDistance);
+        const auto clampedDistance = std::clamp(distance, safeMinDistance, std::max(maxDistance, safeMinDistance));
+        return safeMinDistance / (safeMinDistance + rolloffFactor * (clampedDistance - safeMinDistance));
+    }
+
+    // copies the source to every stride elements of the destination
+    inline void interleave(float* destination, std::size_t stride,
+                           const float* source, std::size_t count) noexcept
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            destination[i * stride] = source[i];
+    }
+}
+
+#endif // OUZEL_AUDIO_DSP_HPP
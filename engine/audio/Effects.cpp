@@ -1,67 +1,71 @@
 // Ouzel by Elviss Strazdins
 
 #include <algorithm>
+#include <array>
+#include <cassert>
 #include <cmath>
 #include "Effects.hpp"
 #include "Audio.hpp"
+#include "DelayLine.hpp"
+#include "Dsp.hpp"
+#include "PhaseVocoder.hpp"
 #include "../scene/Actor.hpp"
 #include "../math/Scalar.hpp"
-#include "smbPitchShift.hpp"
 
 namespace ouzel::audio
 {
     class DelayProcessor final: public mixer::Processor
     {
     public:
-        explicit DelayProcessor(float initDelay):
-            delay{initDelay}
+        DelayProcessor(std::uint32_t channels, std::uint32_t initSampleRate, float initDelay):
+            delay{initDelay},
+            sampleRate{initSampleRate},
+            delayLines(channels, DelayLine{initDelay * static_cast<float>(initSampleRate)})
         {
         }
 
-        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
+        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t,
                      std::vector<float>& samples) override
         {
-            const auto delayFrames = static_cast<std::uint32_t>(delay * sampleRate);
-            const auto bufferFrames = frames + delayFrames;
-
-            buffer.resize(bufferFrames * channels);
-
-            for (std::uint32_t channel = 0; channel < channels; ++channel)
+            for (std::uint32_t channel = 0; channel < channels && channel < delayLines.size(); ++channel)
             {
-                const auto bufferChannel = &buffer[channel * bufferFrames];
-                const auto outputChannel = &samples[channel * frames];
+                auto& delayLine = delayLines[channel];
+                const auto delayFrames = std::min(delay * static_cast<float>(sampleRate), delayLine.getMaxDelay());
 
-                for (std::uint32_t frame = 0; frame < frames; ++frame)
-                    bufferChannel[frame + delayFrames] += outputChannel[frame];
+                const auto outputChannel = &samples[channel * frames];
 
                 for (std::uint32_t frame = 0; frame < frames; ++frame)
-                    outputChannel[frame] = bufferChannel[frame];
-
-                // erase frames from beginning
-                for (std::uint32_t frame = 0; frame < bufferFrames - frames; ++frame)
-                    bufferChannel[frame] = bufferChannel[frame + frames];
-
-                for (std::uint32_t frame = bufferFrames - frames; frame < bufferFrames; ++frame)
-                    bufferChannel[frame] = 0.0F;
+                {
+                    delayLine.write(outputChannel[frame]);
+                    outputChannel[frame] = delayLine.read(delayFrames);
+                }
             }
         }
 
-        void setDelay(const float newDelay) noexcept
+        // the longer lines are allocated by the caller, the replaced ones are left in them
+        void setDelay(const float newDelay, std::vector<DelayLine>& longerLines) noexcept
         {
             delay = newDelay;
+
+            for (std::size_t channel = 0; channel < longerLines.size() && channel < delayLines.size(); ++channel)
+                delayLines[channel].grow(longerLines[channel]);
         }
 
     private:
         float delay = 0.0F;
-        std::vector<float> buffer;
+        std::uint32_t sampleRate;
+        std::vector<DelayLine> delayLines;
     };
 
     Delay::Delay(Audio& initAudio, float initDelay):
         Effect{
             initAudio,
-            initAudio.initProcessor(std::make_unique<DelayProcessor>(initDelay))
+            initAudio.initProcessor(std::make_unique<DelayProcessor>(initAudio.getMixer().getChannels(),
+                                                                     initAudio.getMixer().getSampleRate(),
+                                                                     initDelay))
         },
-        delay{initDelay}
+        delay{initDelay},
+        maxDelay{initDelay}
     {
     }
 
@@ -69,9 +73,18 @@ namespace ouzel::audio
     {
         delay = newDelay;
 
-        audio.updateProcessor(processorId, [newDelay](mixer::Object* node) {
+        // the lines are grown on the game thread and swapped in by the command, which frees the old ones
+        std::vector<DelayLine> longerLines;
+        if (newDelay > maxDelay)
+        {
+            const auto sampleRate = static_cast<float>(audio.getMixer().getSampleRate());
+            longerLines.assign(audio.getMixer().getChannels(), DelayLine{newDelay * sampleRate});
+            maxDelay = longerLines.front().getMaxDelay() / sampleRate;
+        }
+
+        audio.updateProcessor(processorId, [newDelay, longerLines](mixer::Object* node) mutable {
             const auto delayProcessor = static_cast<DelayProcessor*>(node);
-            delayProcessor->setDelay(newDelay);
+            delayProcessor->setDelay(newDelay, longerLines);
         });
     }
 
@@ -133,49 +146,263 @@ namespace ouzel::audio
         // TODO: pass to processor
     }
 
+    namespace
+    {
+        constexpr float speedOfSound = 343.0F; // in meters per second
+        constexpr float maxPropagationDelay = 1.0F; // in seconds, the Doppler effect of farther sources is not heard
+        constexpr std::uint32_t maxPannerChannels = 6;
+
+        struct Speaker final
+        {
+            std::uint32_t channel;
+            float azimuth; // in degrees clockwise from the front
+        };
+
+        // the speakers of the layouts that the bus converts to, ordered by the azimuth, the LFE is not panned
+        constexpr std::array<Speaker, 4> quadSpeakers{{{1, 45.0F}, {3, 135.0F}, {2, 225.0F}, {0, 315.0F}}};
+        constexpr std::array<Speaker, 5> surroundSpeakers{{{2, 0.0F}, {1, 30.0F}, {5, 110.0F}, {4, 250.0F}, {0, 330.0F}}};
+
+        // the weights of the channels in the panned mono signal, chosen so that the mono and stereo
+        // sources upmixed by the bus keep their level
+        constexpr std::array<std::array<float, maxPannerChannels>, maxPannerChannels + 1> downmixWeights{{
+            {},
+            {1.0F},
+            {0.5F, 0.5F},
+            {},
+            {0.5F, 0.5F, 0.5F, 0.5F},
+            {},
+            {0.5F, 0.5F, 1.0F, 0.0F, 0.5F, 0.5F}
+        }};
+
+        // rotates the vector by the inverse of the unit quaternion
+        math::Vector<float, 3> rotateInverse(const math::Vector<float, 3>& vector,
+                                             const math::Quaternion<float>& rotation) noexcept
+        {
+            const math::Vector<float, 3> axis{-rotation.v[0], -rotation.v[1], -rotation.v[2]};
+            const auto t = math::cross(axis, vector) * 2.0F;
+            return vector + t * rotation.v[3] + math::cross(axis, t);
+        }
+
+        // equal-power panning between the two speakers of the ring around the azimuth
+        template <std::size_t count>
+        void panRing(const std::array<Speaker, count>& speakers, float azimuth, float* gains) noexcept
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const auto& first = speakers[i];
+                const auto& second = speakers[(i + 1) % count];
+                const auto start = first.azimuth;
+                const auto end = (i + 1 == count) ? second.azimuth + 360.0F : second.azimuth;
+
+                auto angle = azimuth;
+                if (angle < start) angle += 360.0F;
+                if (angle >= start && angle <= end)
+                {
+                    const auto t = (angle - start) / (end - start) * math::pi<float> / 2.0F;
+                    gains[first.channel] = std::cos(t);
+                    gains[second.channel] = std::sin(t);
+                    return;
+                }
+            }
+        }
+    }
+
     class PannerProcessor final: public mixer::Processor
     {
     public:
-        PannerProcessor() noexcept
+        enum Parameter: std::uint32_t
+        {
+            rolloff,
+            minimumDistance,
+            maximumDistance
+        };
+
+        explicit PannerProcessor(std::uint32_t bufferSize):
+            monoBuffer(bufferSize)
         {
         }
 
-        void process(std::uint32_t, std::uint32_t, std::uint32_t,
-                     std::vector<float>&) override
+        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
+                     std::vector<float>& samples) override
         {
+            if (channels == 0 || channels > maxPannerChannels) return;
+
+            if (channels != gainChannels)
+            {
+                gainChannels = channels;
+                gainsValid = false;
+            }
+
+            // the mixer processes the buses in blocks of its buffer size, for which the buffer was allocated
+            assert(frames <= monoBuffer.size());
+
+            // the panned source is a point, so the channels are mixed to mono first
+            std::fill(monoBuffer.begin(), monoBuffer.begin() + frames, 0.0F);
+            for (std::uint32_t channel = 0; channel < channels; ++channel)
+                if (const auto weight = downmixWeights[channels][channel]; weight != 0.0F)
+                    dsp::addScaled(monoBuffer.data(), &samples[channel * frames], weight, frames);
+
+            const auto relativePosition = rotateInverse(position - listenerPosition, listenerRotation);
+            const auto distance = math::length(relativePosition);
+
+            if (dopplerFactor > 0.0F && delayLine.getMaxDelay() > 0.0F)
+                applyPropagationDelay(frames, sampleRate, distance);
+            else
+                previousDelay = -1.0F;
+
+            std::array<float, maxPannerChannels> targetGains{};
+            getPanningGains(channels, relativePosition, targetGains.data());
+
+            const auto attenuation = dsp::getDistanceAttenuation(distance, minDistance, maxDistance, rolloffFactor);
+            for (std::uint32_t channel = 0; channel < channels; ++channel)
+                targetGains[channel] *= attenuation;
+
+            if (!gainsValid)
+            {
+                gains = targetGains;
+                gainsValid = true;
+            }
+
+            // the gains are interpolated over the block, so that the moving sources do not produce zipper noise
+            for (std::uint32_t channel = 0; channel < channels; ++channel)
+                dsp::scaleRamp(&samples[channel * frames], monoBuffer.data(),
+                               gains[channel], targetGains[channel], frames);
+
+            gains = targetGains;
         }
 
-        void setPosition(const math::Vector<float, 3>& newPosition) noexcept
+        void setListener(const math::Vector<float, 3>& newListenerPosition,
+                         const math::Quaternion<float>& newListenerRotation) noexcept override
         {
-            position = newPosition;
+            listenerPosition = newListenerPosition;
+            listenerRotation = newListenerRotation;
+        }
+
+        float getAttenuation(const math::Vector<float, 3>& newListenerPosition) const noexcept override
+        {
+            return dsp::getDistanceAttenuation(math::distance(position, newListenerPosition),
+                                               minDistance, maxDistance, rolloffFactor);
         }
 
-        void setRolloffFactor(float newRolloffFactor)
+        void setPosition(const math::Vector<float, 3>& newPosition) noexcept override
         {
-            rolloffFactor = newRolloffFactor;
+            position = newPosition;
         }
 
-        void setMinDistance(float newMinDistance)
+        void setParameter(std::uint32_t parameter, float value) override
         {
-            minDistance = newMinDistance;
+            switch (parameter)
+            {
+                case Parameter::rolloff: rolloffFactor = value; break;
+                case Parameter::minimumDistance: minDistance = value; break;
+                case Parameter::maximumDistance: maxDistance = value; break;
+                default: break;
+            }
         }
 
-        void setMaxDistance(float newMaxDistance)
+        // the delay line is allocated by the caller when the propagation delay is enabled,
+        // the replaced one is left in it
+        void setDopplerFactor(float newDopplerFactor, DelayLine& newDelayLine) noexcept
         {
-            maxDistance = newMaxDistance;
+            dopplerFactor = newDopplerFactor;
+            delayLine.grow(newDelayLine);
         }
 
     private:
+        // delays the sound by the time it takes to reach the listener, the change of
+        // the delay over the block shifts the pitch of the moving sources
+        void applyPropagationDelay(std::uint32_t frames, std::uint32_t sampleRate, float distance) noexcept
+        {
+            const auto delay = std::min(std::min(distance * dopplerFactor / speedOfSound, maxPropagationDelay) *
+                                        static_cast<float>(sampleRate), delayLine.getMaxDelay());
+            if (previousDelay < 0.0F) previousDelay = delay;
+
+            const auto step = (delay - previousDelay) / static_cast<float>(frames);
+            for (std::uint32_t frame = 0; frame < frames; ++frame)
+            {
+                delayLine.write(monoBuffer[frame]);
+                monoBuffer[frame] = delayLine.read(previousDelay + step * static_cast<float>(frame + 1));
+            }
+
+            previousDelay = delay;
+        }
+
+        // the direction is projected on the horizontal plane of the listener, the sources closer than
+        // the minimal distance are spread over all the speakers
+        void getPanningGains(std::uint32_t channels, const math::Vector<float, 3>& relativePosition,
+                             float* result) const noexcept
+        {
+            if (channels == 1)
+            {
+                result[0] = 1.0F;
+                return;
+            }
+
+            const auto horizontalDistance = std::sqrt(relativePosition.v[0] * relativePosition.v[0] +
+                                                      relativePosition.v[2] * relativePosition.v[2]);
+            const auto azimuth = std::atan2(relativePosition.v[0], relativePosition.v[2]); // clockwise from the front
+
+            std::array<float, maxPannerChannels> directional{};
+            std::uint32_t speakerCount = 0;
+            switch (channels)
+            {
+                case 2:
+                {
+                    // the sources behind the listener are folded to the front
+                    const auto t = (std::sin(azimuth) + 1.0F) * math::pi<float> / 4.0F;
+                    directional[0] = std::cos(t);
+                    directional[1] = std::sin(t);
+                    speakerCount = 2;
+                    break;
+                }
+                case 4:
+                    panRing(quadSpeakers, math::radToDeg(azimuth < 0.0F ? azimuth + 2.0F * math::pi<float> : azimuth),
+                            directional.data());
+                    speakerCount = static_cast<std::uint32_t>(quadSpeakers.size());
+                    break;
+                case 6:
+                    panRing(surroundSpeakers, math::radToDeg(azimuth < 0.0F ? azimuth + 2.0F * math::pi<float> : azimuth),
+                            directional.data());
+                    speakerCount = static_cast<std::uint32_t>(surroundSpeakers.size());
+                    break;
+                default:
+                    std::fill(result, result + channels, 1.0F);
+                    return;
+            }
+
+            // blends the powers of the directional and the spread gains
+            const auto focus = minDistance > 0.0F ? std::min(horizontalDistance / minDistance, 1.0F) : 1.0F;
+            const auto spreadPower = 1.0F / static_cast<float>(speakerCount);
+            for (std::uint32_t channel = 0; channel < channels; ++channel)
+            {
+                const auto panned = channels != 6 || channel != 3; // the LFE
+                result[channel] = panned ?
+                    std::sqrt(focus * directional[channel] * directional[channel] + (1.0F - focus) * spreadPower) :
+                    0.0F;
+            }
+        }
+
         math::Vector<float, 3> position{};
         float rolloffFactor = 1.0F;
         float minDistance = 1.0F;
         float maxDistance = FLT_MAX;
+        float dopplerFactor = 0.0F;
+
+        math::Vector<float, 3> listenerPosition{};
+        math::Quaternion<float> listenerRotation = math::identityQuaternion<float>;
+
+        std::vector<float> monoBuffer;
+        DelayLine delayLine;
+        float previousDelay = -1.0F; // in frames, negative until the first block
+        std::uint32_t gainChannels = 0;
+        bool gainsValid = false;
+        std::array<float, maxPannerChannels> gains{};
     };
 
     Panner::Panner(Audio& initAudio):
         Effect{
             initAudio,
-            initAudio.initProcessor(std::make_unique<PannerProcessor>())
+            initAudio.initProcessor(std::make_unique<PannerProcessor>(initAudio.getMixer().getBufferSize()))
         }
     {
     }
@@ -184,45 +411,53 @@ namespace ouzel::audio
     {
         position = newPosition;
 
-        audio.updateProcessor(processorId, [newPosition](mixer::Object* node) {
-            const auto pannerProcessor = static_cast<PannerProcessor*>(node);
-            pannerProcessor->setPosition(newPosition);
-        });
+        audio.setProcessorPosition(processorId, newPosition);
     }
 
     void Panner::setRolloffFactor(float newRolloffFactor)
     {
         rolloffFactor = newRolloffFactor;
 
-        audio.updateProcessor(processorId, [newRolloffFactor](mixer::Object* node) {
-            const auto pannerProcessor = static_cast<PannerProcessor*>(node);
-            pannerProcessor->setRolloffFactor(newRolloffFactor);
-        });
+        audio.setProcessorParameter(processorId, PannerProcessor::Parameter::rolloff, newRolloffFactor);
     }
 
     void Panner::setMinDistance(float newMinDistance)
     {
         minDistance = newMinDistance;
 
-        audio.updateProcessor(processorId, [newMinDistance](mixer::Object* node) {
-            const auto pannerProcessor = static_cast<PannerProcessor*>(node);
-            pannerProcessor->setMinDistance(newMinDistance);
-        });
+        audio.setProcessorParameter(processorId, PannerProcessor::Parameter::minimumDistance, newMinDistance);
     }
 
     void Panner::setMaxDistance(float newMaxDistance)
     {
         maxDistance = newMaxDistance;
 
-        audio.updateProcessor(processorId, [newMaxDistance](mixer::Object* node) {
+        audio.setProcessorParameter(processorId, PannerProcessor::Parameter::maximumDistance, newMaxDistance);
+    }
+
+    void Panner::setDopplerFactor(float newDopplerFactor)
+    {
+        // the line for the longest propagation delay is allocated on the game thread when the delay is first enabled
+        DelayLine newDelayLine;
+        if (newDopplerFactor > 0.0F && !delayLineAllocated)
+        {
+            newDelayLine.reserve(maxPropagationDelay * static_cast<float>(audio.getMixer().getSampleRate()));
+            delayLineAllocated = true;
+        }
+
+        dopplerFactor = newDopplerFactor;
+
+        audio.updateProcessor(processorId, [newDopplerFactor, newDelayLine](mixer::Object* node) mutable {
             const auto pannerProcessor = static_cast<PannerProcessor*>(node);
-            pannerProcessor->setMaxDistance(newMaxDistance);
+            pannerProcessor->setDopplerFactor(newDopplerFactor, newDelayLine);
         });
     }
 
     void Panner::updateTransform()
     {
-        setPosition(actor->getWorldPosition());
+        // the transform of the actor is also updated when it rotates or scales, which does not move the sound
+        if (const auto worldPosition = actor->getWorldPosition(); worldPosition != position)
+            setPosition(worldPosition);
     }
 
     namespace
@@ -231,39 +466,48 @@ namespace ouzel::audio
         constexpr float maxPitch = 2.0F;
     }
 
-    class PitchScaleProcessor final: public mixer::Processor
+    // the pitch of PitchScale and PitchShift, which are the same effect under two names
+    class PitchProcessor final: public mixer::Processor
     {
     public:
-        explicit PitchScaleProcessor(float initScale):
-            scale{std::clamp(initScale, minPitch, maxPitch)}
+        enum Parameter: std::uint32_t
+        {
+            pitch
+        };
+
+        PitchProcessor(std::uint32_t channels, float initPitch):
+            pitchFactor{std::clamp(initPitch, minPitch, maxPitch)},
+            phaseVocoders(channels)
         {
         }
 
         void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
                      std::vector<float>& samples) override
         {
-            pitchShift.resize(channels);
-
-            for (std::uint32_t channel = 0; channel < channels; ++channel)
-                pitchShift[channel].process(scale, frames, sampleRate,
-                                            &samples[channel * frames],
-                                            &samples[channel * frames]);
+            for (std::uint32_t channel = 0; channel < channels && channel < phaseVocoders.size(); ++channel)
+                phaseVocoders[channel].process(pitchFactor, frames, sampleRate,
+                                               &samples[channel * frames],
+                                               &samples[channel * frames]);
         }
 
-        void setScale(const float newScale) noexcept
+        void setParameter(std::uint32_t parameter, float value) override
         {
-            scale = std::clamp(newScale, minPitch, maxPitch);
+            switch (parameter)
+            {
+                case Parameter::pitch: pitchFactor = std::clamp(value, minPitch, maxPitch); break;
+                default: break;
+            }
         }
 
     private:
-        float scale = 1.0f;
-        std::vector<smb::PitchShift<1024, 4>> pitchShift;
+        float pitchFactor = 1.0F;
+        std::vector<PhaseVocoder> phaseVocoders;
     };
 
     PitchScale::PitchScale(Audio& initAudio, float initScale):
         Effect{
             initAudio,
-            initAudio.initProcessor(std::make_unique<PitchScaleProcessor>(initScale))
+            initAudio.initProcessor(std::make_unique<PitchProcessor>(initAudio.getMixer().getChannels(), initScale))
         },
         scale{initScale}
     {
@@ -272,11 +516,7 @@ namespace ouzel::audio
     void PitchScale::setScale(float newScale)
     {
         scale = newScale;
-
-        audio.updateProcessor(processorId, [newScale](mixer::Object* node) {
-            const auto pitchScaleProcessor = static_cast<PitchScaleProcessor*>(node);
-            pitchScaleProcessor->setScale(newScale);
-        });
+        audio.setProcessorParameter(processorId, PitchProcessor::Parameter::pitch, newScale);
     }
 
     void PitchScale::setScaleRandom(const std::pair<float, float>& newScaleRandom)
@@ -285,33 +525,10 @@ namespace ouzel::audio
         // TODO: pass to processor
     }
 
-    class PitchShiftProcessor final: public mixer::Processor
-    {
-    public:
-        explicit PitchShiftProcessor(float initShift) noexcept:
-            shift{initShift}
-        {
-        }
-
-        void process(std::uint32_t, std::uint32_t, std::uint32_t,
-                     std::vector<float>&) override
-        {
-            // TODO: implement
-        }
-
-        void setShift(const float newShift) noexcept
-        {
-            shift = newShift;
-        }
-
-    private:
-        float shift = 1.0f;
-    };
-
     PitchShift::PitchShift(Audio& initAudio, float initShift):
         Effect{
             initAudio,
-            initAudio.initProcessor(std::make_unique<PitchShiftProcessor>(initShift))
+            initAudio.initProcessor(std::make_unique<PitchProcessor>(initAudio.getMixer().getChannels(), initShift))
         },
         shift{initShift}
     {
@@ -320,11 +537,7 @@ namespace ouzel::audio
     void PitchShift::setShift(float newShift)
     {
         shift = newShift;
-
-        audio.updateProcessor(processorId, [newShift](mixer::Object* node) {
-            const auto pitchShiftProcessor = static_cast<PitchShiftProcessor*>(node);
-            pitchShiftProcessor->setShift(newShift);
-        });
+        audio.setProcessorParameter(processorId, PitchProcessor::Parameter::pitch, newShift);
     }
 
     void PitchShift::setShiftRandom(const std::pair<float, float>& newShiftRandom)
@@ -333,94 +546,373 @@ namespace ouzel::audio
         // TODO: pass to processor
     }
 
+    namespace
+    {
+        // lengths of the delay lines relative to the longest one, spread so that the echoes do not coincide
+        constexpr std::array<float, 8> reverbLineRatios{
+            1116.0F / 1617.0F, 1188.0F / 1617.0F, 1277.0F / 1617.0F, 1356.0F / 1617.0F,
+            1422.0F / 1617.0F, 1491.0F / 1617.0F, 1557.0F / 1617.0F, 1.0F
+        };
+    }
+
+    // Feedback delay network of eight lines mixed through a Hadamard matrix, with a low-pass filter
+    // in every feedback path, the state of the lines is kept in arrays that are processed together
     class ReverbProcessor final: public mixer::Processor
     {
     public:
-        ReverbProcessor(float initDelay, float initDecay):
-            delay{initDelay}, decay{initDecay}
+        static constexpr std::size_t lineCount = reverbLineRatios.size();
+
+        ReverbProcessor(std::uint32_t initSampleRate, float initDelay, float initDecay):
+            delay{initDelay}, decay{initDecay},
+            sampleRate{initSampleRate},
+            preDelayLine{0.0F},
+            lines{createLines(initDelay * static_cast<float>(initSampleRate))}
         {
         }
 
-        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
+        // lines that can hold the longest line of the given length in frames
+        static std::array<DelayLine, lineCount> createLines(float longestLength)
+        {
+            std::array<DelayLine, lineCount> result;
+            for (std::size_t line = 0; line < lineCount; ++line)
+                result[line].reserve(std::max(reverbLineRatios[line] * longestLength, 1.0F));
+            return result;
+        }
+
+        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t,
                      std::vector<float>& samples) override
         {
-            const auto delayFrames = static_cast<std::uint32_t>(delay * sampleRate);
-            const auto bufferFrames = frames + delayFrames;
+            if (linesDirty) updateLines();
 
-            buffers.resize(channels);
+            const auto preDelayFrames = std::min(preDelay * static_cast<float>(sampleRate), preDelayLine.getMaxDelay());
 
-            for (std::uint32_t channel = 0; channel < channels; ++channel)
+            const auto inputScale = 1.0F / static_cast<float>(channels);
+            constexpr auto outputScale = 0.35355339F; // 1 / sqrt(lineCount)
+
+            for (std::uint32_t frame = 0; frame < frames; ++frame)
             {
-                auto& buffer = buffers[channel];
-                buffer.resize(bufferFrames);
+                float input = 0.0F;
+                for (std::uint32_t channel = 0; channel < channels; ++channel)
+                    input += samples[channel * frames + frame];
+
+                preDelayLine.write(input * inputScale);
+                const auto delayedInput = preDelayLine.read(preDelayFrames);
+
+                std::array<float, lineCount> lineOutputs;
+                for (std::size_t line = 0; line < lineCount; ++line)
+                    lineOutputs[line] = lines[line].read(lineLengths[line] - 1);
+
+                std::array<float, lineCount> feedback;
+                for (std::size_t line = 0; line < lineCount; ++line)
+                {
+                    filterStates[line] = lineOutputs[line] + (filterStates[line] - lineOutputs[line]) * damping;
+                    feedback[line] = filterStates[line] * lineGains[line];
+                }
+
+                hadamard(feedback);
+
+                for (std::size_t line = 0; line < lineCount; ++line)
+                    lines[line].write(feedback[line] * outputScale + delayedInput);
+
+                // every channel takes a differently signed sum of the lines, so that the channels are decorrelated
+                for (std::uint32_t channel = 0; channel < channels; ++channel)
+                {
+                    const auto signs = outputSigns[channel % outputSigns.size()];
+                    float output = 0.0F;
+                    for (std::size_t line = 0; line < lineCount; ++line)
+                        output += (signs & (1U << line)) ? -lineOutputs[line] : lineOutputs[line];
+
+                    auto& sample = samples[channel * frames + frame];
+                    sample = sample * dry + output * outputScale * wet;
+                }
+            }
+        }
 
-                const auto outputChannel = &samples[channel * frames];
+        // the longer lines are allocated by the caller, the replaced ones are left in them
+        void setDelay(float newDelay, std::array<DelayLine, lineCount>& longerLines) noexcept
+        {
+            delay = newDelay;
+            linesDirty = true;
 
-                for (std::uint32_t frame = 0; frame < frames; ++frame)
-                    buffer[frame] += outputChannel[frame];
+            for (std::size_t line = 0; line < lineCount; ++line)
+                lines[line].grow(longerLines[line]);
+        }
 
-                for (std::uint32_t frame = 0; frame < frames; ++frame)
-                    buffer[frame + delayFrames] += buffer[frame] * decay;
+        void setDecay(float newDecay) noexcept
+        {
+            decay = newDecay;
+            linesDirty = true;
+        }
 
-                for (std::uint32_t frame = 0; frame < frames; ++frame)
-                    outputChannel[frame] = buffer[frame];
+        // the longer line is allocated by the caller, the replaced one is left in it
+        void setPreDelay(float newPreDelay, DelayLine& longerLine) noexcept
+        {
+            preDelay = std::max(newPreDelay, 0.0F);
+            preDelayLine.grow(longerLine);
+        }
+
+        void setDamping(float newDamping) noexcept { damping = std::clamp(newDamping, 0.0F, 1.0F); }
+        void setWet(float newWet) noexcept { wet = newWet; }
+        void setDry(float newDry) noexcept { dry = newDry; }
+
+    private:
+        // signs of the line outputs for every channel, the rows 1 to 7 of the Hadamard matrix
+        static constexpr std::array<std::uint8_t, 7> outputSigns{0xAA, 0xCC, 0x99, 0xF0, 0xA5, 0xC3, 0x96};
+
+        // unnormalized fast Walsh-Hadamard transform, the matrix is orthogonal after the scaling by 1 / sqrt(8)
+        static void hadamard(std::array<float, lineCount>& values) noexcept
+        {
+            for (std::size_t step = 1; step < lineCount; step *= 2)
+                for (std::size_t i = 0; i < lineCount; i += step * 2)
+                    for (std::size_t j = i; j < i + step; ++j)
+                    {
+                        const auto a = values[j];
+                        const auto b = values[j + step];
+                        values[j] = a + b;
+                        values[j + step] = a - b;
+                    }
+        }
+
+        void updateLines() noexcept
+        {
+            const auto longestLength = std::max(delay * static_cast<float>(sampleRate), 1.0F);
 
-                // erase frames from beginning
-                buffer.erase(buffer.begin(), buffer.begin() + frames);
+            for (std::size_t line = 0; line < lineCount; ++line)
+            {
+                const auto length = std::min(std::max(reverbLineRatios[line] * longestLength, 1.0F),
+                                             lines[line].getMaxDelay());
+                lineLengths[line] = static_cast<std::size_t>(length);
+
+                // the decay is the gain of the longest line, so all the lines fade at the same rate
+                lineGains[line] = std::pow(std::clamp(decay, 0.0F, 0.999F), length / longestLength);
             }
+
+            linesDirty = false;
         }
 
-    private:
-        float delay = 0.1F;
-        float decay = 0.5F;
-        std::vector<std::vector<float>> buffers;
+        float delay = 0.1F; // length of the longest line in seconds
+        float decay = 0.5F; // gain of a pass through the longest line
+        float damping = 0.3F;
+        float preDelay = 0.0F;
+        float wet = 0.5F;
+        float dry = 1.0F;
+
+        std::uint32_t sampleRate;
+        bool linesDirty = true;
+        DelayLine preDelayLine;
+        std::array<DelayLine, lineCount> lines;
+        std::array<std::size_t, lineCount> lineLengths{};
+        std::array<float, lineCount> lineGains{};
+        std::array<float, lineCount> filterStates{};
     };
 
     Reverb::Reverb(Audio& initAudio, float initDelay, float initDecay):
         Effect{
             initAudio,
-            initAudio.initProcessor(std::make_unique<ReverbProcessor>(initDelay, initDecay))
+            initAudio.initProcessor(std::make_unique<ReverbProcessor>(initAudio.getMixer().getSampleRate(),
+                                                                      initDelay, initDecay))
         },
         delay{initDelay},
-        decay{initDecay}
+        decay{initDecay},
+        maxDelay{initDelay}
     {
     }
 
-    class LowPassProcessor final: public mixer::Processor
+    void Reverb::setDelay(float newDelay)
     {
-    public:
-        void process([[maybe_unused]] std::uint32_t frames,
-                     [[maybe_unused]] std::uint32_t channels,
-                     [[maybe_unused]] std::uint32_t sampleRate,
-                     [[maybe_unused]] std::vector<float>& samples) override
+        delay = newDelay;
+
+        // the lines are grown on the game thread and swapped in by the command, which frees the old ones
+        std::array<DelayLine, ReverbProcessor::lineCount> longerLines;
+        if (newDelay > maxDelay)
         {
+            const auto sampleRate = static_cast<float>(audio.getMixer().getSampleRate());
+            longerLines = ReverbProcessor::createLines(newDelay * sampleRate);
+            maxDelay = longerLines.back().getMaxDelay() / sampleRate;
         }
-    };
 
-    LowPass::LowPass(Audio& initAudio):
-        Effect{
-            initAudio,
-            initAudio.initProcessor(std::unique_ptr<LowPassProcessor>())
+        audio.updateProcessor(processorId, [newDelay, longerLines](mixer::Object* node) mutable {
+            const auto reverbProcessor = static_cast<ReverbProcessor*>(node);
+            reverbProcessor->setDelay(newDelay, longerLines);
+        });
+    }
+
+    void Reverb::setDecay(float newDecay)
+    {
+        decay = newDecay;
+
+        audio.updateProcessor(processorId, [newDecay](mixer::Object* node) {
+            const auto reverbProcessor = static_cast<ReverbProcessor*>(node);
+            reverbProcessor->setDecay(newDecay);
+        });
+    }
+
+    void Reverb::setDamping(float newDamping)
+    {
+        damping = newDamping;
+
+        audio.updateProcessor(processorId, [newDamping](mixer::Object* node) {
+            const auto reverbProcessor = static_cast<ReverbProcessor*>(node);
+            reverbProcessor->setDamping(newDamping);
+        });
+    }
+
+    void Reverb::setPreDelay(float newPreDelay)
+    {
+        preDelay = newPreDelay;
+
+        DelayLine longerLine;
+        if (newPreDelay > maxPreDelay)
+        {
+            const auto sampleRate = static_cast<float>(audio.getMixer().getSampleRate());
+            longerLine.reserve(newPreDelay * sampleRate);
+            maxPreDelay = longerLine.getMaxDelay() / sampleRate;
         }
+
+        audio.updateProcessor(processorId, [newPreDelay, longerLine](mixer::Object* node) mutable {
+            const auto reverbProcessor = static_cast<ReverbProcessor*>(node);
+            reverbProcessor->setPreDelay(newPreDelay, longerLine);
+        });
+    }
+
+    void Reverb::setWet(float newWet)
+    {
+        wet = newWet;
+
+        audio.updateProcessor(processorId, [newWet](mixer::Object* node) {
+            const auto reverbProcessor = static_cast<ReverbProcessor*>(node);
+            reverbProcessor->setWet(newWet);
+        });
+    }
+
+    void Reverb::setDry(float newDry)
     {
+        dry = newDry;
+
+        audio.updateProcessor(processorId, [newDry](mixer::Object* node) {
+            const auto reverbProcessor = static_cast<ReverbProcessor*>(node);
+            reverbProcessor->setDry(newDry);
+        });
     }
 
-    class HighPassProcessor final: public mixer::Processor
+    class FilterProcessor final: public mixer::Processor
     {
     public:
-        void process([[maybe_unused]] std::uint32_t frames,
-                     [[maybe_unused]] std::uint32_t channels,
-                     [[maybe_unused]] std::uint32_t sampleRate,
-                     [[maybe_unused]] std::vector<float>& samples) override
+        enum Parameter: std::uint32_t
         {
+            frequency,
+            resonance,
+            gain
+        };
+
+        FilterProcessor(std::uint32_t bufferSize, std::uint32_t channels,
+                        StateVariableFilter::Type initType, float initFrequency, float initResonance, float initGain):
+            filter{initType, initFrequency, initResonance, initGain}
+        {
+            filter.reserve(bufferSize, channels);
         }
+
+        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
+                     std::vector<float>& samples) override
+        {
+            filter.process(frames, channels, sampleRate, samples);
+        }
+
+        void setParameter(std::uint32_t parameter, float value) override
+        {
+            switch (parameter)
+            {
+                case Parameter::frequency: filter.setFrequency(value); break;
+                case Parameter::resonance: filter.setResonance(value); break;
+                case Parameter::gain: filter.setGain(value); break;
+                default: break;
+            }
+        }
+
+    private:
+        StateVariableFilter filter;
     };
 
-    HighPass::HighPass(Audio& initAudio):
+    Filter::Filter(Audio& initAudio, StateVariableFilter::Type initType,
+                   float initFrequency, float initResonance, float initGain):
         Effect{
             initAudio,
-            initAudio.initProcessor(std::unique_ptr<HighPassProcessor>())
-        }
+            initAudio.initProcessor(std::make_unique<FilterProcessor>(initAudio.getMixer().getBufferSize(),
+                                                                      initAudio.getMixer().getChannels(),
+                                                                      initType, initFrequency, initResonance, initGain))
+        },
+        type{initType},
+        frequency{initFrequency},
+        resonance{initResonance},
+        gain{initGain}
+    {
+    }
+
+    void Filter::setFrequency(float newFrequency)
+    {
+        frequency = newFrequency;
+        audio.setProcessorParameter(processorId, FilterProcessor::Parameter::frequency, newFrequency);
+    }
+
+    void Filter::setResonance(float newResonance)
+    {
+        resonance = newResonance;
+        audio.setProcessorParameter(processorId, FilterProcessor::Parameter::resonance, newResonance);
+    }
+
+    void Filter::setGain(float newGain)
+    {
+        gain = newGain;
+        audio.setProcessorParameter(processorId, FilterProcessor::Parameter::gain, newGain);
+    }
+
+    LowPass::LowPass(Audio& initAudio, float initFrequency, float initResonance):
+        Effect{
+            initAudio,
+            initAudio.initProcessor(std::make_unique<FilterProcessor>(initAudio.getMixer().getBufferSize(),
+                                                                      initAudio.getMixer().getChannels(),
+                                                                      StateVariableFilter::Type::lowPass,
+                                                                      initFrequency, initResonance, 0.0F))
+        },
+        frequency{initFrequency},
+        resonance{initResonance}
+    {
+    }
+
+    void LowPass::setFrequency(float newFrequency)
+    {
+        frequency = newFrequency;
+        audio.setProcessorParameter(processorId, FilterProcessor::Parameter::frequency, newFrequency);
+    }
+
+    void LowPass::setResonance(float newResonance)
+    {
+        resonance = newResonance;
+        audio.setProcessorParameter(processorId, FilterProcessor::Parameter::resonance, newResonance);
+    }
+
+    HighPass::HighPass(Audio& initAudio, float initFrequency, float initResonance):
+        Effect{
+            initAudio,
+            initAudio.initProcessor(std::make_unique<FilterProcessor>(initAudio.getMixer().getBufferSize(),
+                                                                      initAudio.getMixer().getChannels(),
+                                                                      StateVariableFilter::Type::highPass,
+                                                                      initFrequency, initResonance, 0.0F))
+        },
+        frequency{initFrequency},
+        resonance{initResonance}
+    {
+    }
+
+    void HighPass::setFrequency(float newFrequency)
+    {
+        frequency = newFrequency;
+        audio.setProcessorParameter(processorId, FilterProcessor::Parameter::frequency, newFrequency);
+    }
+
+    void HighPass::setResonance(float newResonance)
     {
+        resonance = newResonance;
+        audio.setProcessorParameter(processorId, FilterProcessor::Parameter::resonance, newResonance);
     }
 }
@@ -6,6 +6,7 @@
 #include <cfloat>
 #include <utility>
 #include "Effect.hpp"
+#include "StateVariableFilter.hpp"
 #include "../math/Vector.hpp"
 #include "../scene/Component.hpp"
 
@@ -29,6 +30,7 @@ namespace ouzel::audio
 
     private:
         float delay = 0.0F;
+        float maxDelay = 0.0F; // the longest delay that the lines of the processor can hold
         std::pair<float, float> delayRandom{0.0F, 0.0F};
     };
 
@@ -75,6 +77,11 @@ namespace ouzel::audio
         auto getMaxDistance() const noexcept { return maxDistance; }
         void setMaxDistance(float newMaxDistance);
 
+        // scales the propagation delay, whose changes shift the pitch of the moving sources,
+        // the delay is disabled by default and while the factor is zero
+        auto getDopplerFactor() const noexcept { return dopplerFactor; }
+        void setDopplerFactor(float newDopplerFactor);
+
     private:
         void updateTransform() override;
 
@@ -82,6 +89,8 @@ namespace ouzel::audio
         float rolloffFactor = 1.0F;
         float minDistance = 1.0F;
         float maxDistance = FLT_MAX;
+        float dopplerFactor = 0.0F;
+        bool delayLineAllocated = false; // by the first call to setDopplerFactor that enables the delay
     };
 
     class PitchScale final: public Effect
@@ -136,34 +145,110 @@ namespace ouzel::audio
         Reverb(Reverb&&) = delete;
         Reverb& operator=(Reverb&&) = delete;
 
+        // length of the longest delay line in seconds, which sets the size of the room
         auto getDelay() const noexcept { return delay; }
+        void setDelay(float newDelay);
+
+        // gain of the echoes after every pass through the longest delay line
         auto getDecay() const noexcept { return decay; }
+        void setDecay(float newDecay);
+
+        // how much the high frequencies are absorbed on every reflection, from 0 to 1
+        auto getDamping() const noexcept { return damping; }
+        void setDamping(float newDamping);
+
+        // delay of the first reflection in seconds
+        auto getPreDelay() const noexcept { return preDelay; }
+        void setPreDelay(float newPreDelay);
+
+        auto getWet() const noexcept { return wet; }
+        void setWet(float newWet);
+
+        auto getDry() const noexcept { return dry; }
+        void setDry(float newDry);
 
     private:
         float delay = 0.1F;
         float decay = 0.5F;
+        float damping = 0.3F;
+        float preDelay = 0.0F;
+        float wet = 0.5F;
+        float dry = 1.0F;
+        float maxDelay = 0.0F; // the longest delay and pre-delay that the lines of the processor can hold
+        float maxPreDelay = 0.0F;
+    };
+
+    // low-pass, high-pass, band-pass, shelf or peak filter
+    class Filter final: public Effect
+    {
+    public:
+        Filter(Audio& initAudio, StateVariableFilter::Type initType,
+               float initFrequency, float initResonance = 0.70710678F, float initGain = 0.0F);
+
+        Filter(const Filter&) = delete;
+        Filter& operator=(const Filter&) = delete;
+        Filter(Filter&&) = delete;
+        Filter& operator=(Filter&&) = delete;
+
+        auto getType() const noexcept { return type; }
+
+        auto getFrequency() const noexcept { return frequency; }
+        void setFrequency(float newFrequency);
+
+        auto getResonance() const noexcept { return resonance; }
+        void setResonance(float newResonance);
+
+        // gain of the shelf and peak filters in decibels
+        auto getGain() const noexcept { return gain; }
+        void setGain(float newGain);
+
+    private:
+        StateVariableFilter::Type type;
+        float frequency;
+        float resonance;
+        float gain;
     };
 
     class LowPass final: public Effect
     {
     public:
-        explicit LowPass(Audio& initAudio);
+        explicit LowPass(Audio& initAudio, float initFrequency = 20000.0F, float initResonance = 0.70710678F);
 
         LowPass(const LowPass&) = delete;
         LowPass& operator=(const LowPass&) = delete;
         LowPass(LowPass&&) = delete;
         LowPass& operator=(LowPass&&) = delete;
+
+        auto getFrequency() const noexcept { return frequency; }
+        void setFrequency(float newFrequency);
+
+        auto getResonance() const noexcept { return resonance; }
+        void setResonance(float newResonance);
+
+    private:
+        float frequency;
+        float resonance;
     };
 
     class HighPass final: public Effect
     {
     public:
-        explicit HighPass(Audio& initAudio);
+        explicit HighPass(Audio& initAudio, float initFrequency = 20.0F, float initResonance = 0.70710678F);
 
         HighPass(const HighPass&) = delete;
         HighPass& operator=(const HighPass&) = delete;
         HighPass(HighPass&&) = delete;
         HighPass& operator=(HighPass&&) = delete;
+
+        auto getFrequency() const noexcept { return frequency; }
+        void setFrequency(float newFrequency);
+
+        auto getResonance() const noexcept { return resonance; }
+        void setResonance(float newResonance);
+
+    private:
+        float frequency;
+        float resonance;
     };
 }
 
@@ -0,0 +1,156 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_AUDIO_FFT_HPP
+#define OUZEL_AUDIO_FFT_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Dsp.hpp"
+#include "../math/Constants.hpp"
+
+namespace ouzel::audio
+{
+    // In-place complex fast Fourier transform of a power of two size on separate real and imaginary arrays.
+    // The bit reversal and the twiddle factors are precomputed, the first two stages are done as one radix-4
+    // pass with trivial twiddles and the butterflies of the other stages are computed with SIMD lanes.
+    class Fft final
+    {
+    public:
+        explicit Fft(std::size_t initSize):
+            size{initSize},
+            reversed(initSize)
+        {
+            std::size_t bits = 0;
+            while ((std::size_t{1} << bits) < size) ++bits;
+
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                std::size_t j = 0;
+                for (std::size_t bit = 0; bit < bits; ++bit)
+                    if (i & (std::size_t{1} << bit)) j |= std::size_t{1} << (bits - 1 - bit);
+                reversed[i] = static_cast<std::uint32_t>(j);
+            }
+
+            // the twiddles of every stage from the third one are stored contiguously, so they can be loaded as lanes
+            for (std::size_t half = 4; half < size; half *= 2)
+                for (std::size_t j = 0; j < half; ++j)
+                {
+                    const auto angle = math::pi<double> * static_cast<double>(j) / static_cast<double>(half);
+                    twiddleReal.push_back(static_cast<float>(std::cos(angle)));
+                    twiddleImag.push_back(static_cast<float>(-std::sin(angle)));
+                }
+        }
+
+        auto getSize() const noexcept { return size; }
+
+        void forward(float* real, float* imag) const noexcept
+        {
+            transform<false>(real, imag);
+        }
+
+        // the result is not normalized, it is size times larger than the original signal
+        void inverse(float* real, float* imag) const noexcept
+        {
+            transform<true>(real, imag);
+        }
+
+    private:
+        template <bool inverse>
+        void transform(float* real, float* imag) const noexcept
+        {
+            for (std::size_t i = 0; i < size; ++i)
+                if (const std::size_t j = reversed[i]; i < j)
+                {
+                    std::swap(real[i], real[j]);
+                    std::swap(imag[i], imag[j]);
+                }
+
+            if (size < 2) return;
+
+            if (size == 2)
+            {
+                butterfly(real[0], imag[0], real[1], imag[1]);
+                return;
+            }
+
+            // the first two stages have the twiddles 1 and -i (i for the inverse transform)
+            for (std::size_t i = 0; i < size; i += 4)
+            {
+                auto r0 = real[i], i0 = imag[i];
+                auto r1 = real[i + 1], i1 = imag[i + 1];
+                auto r2 = real[i + 2], i2 = imag[i + 2];
+                auto r3 = real[i + 3], i3 = imag[i + 3];
+
+                butterfly(r0, i0, r1, i1);
+                butterfly(r2, i2, r3, i3);
+
+                const auto rotatedReal = inverse ? -i3 : i3;
+                const auto rotatedImag = inverse ? r3 : -r3;
+
+                real[i] = r0 + r2; imag[i] = i0 + i2;
+                real[i + 2] = r0 - r2; imag[i + 2] = i0 - i2;
+                real[i + 1] = r1 + rotatedReal; imag[i + 1] = i1 + rotatedImag;
+                real[i + 3] = r1 - rotatedReal; imag[i + 3] = i1 - rotatedImag;
+            }
+
+            std::size_t offset = 0;
+            for (std::size_t half = 4; half < size; offset += half, half *= 2)
+            {
+                const auto wr = twiddleReal.data() + offset;
+                const auto wi = twiddleImag.data() + offset;
+
+                for (std::size_t start = 0; start < size; start += half * 2)
+                {
+                    const auto ar = real + start;
+                    const auto ai = imag + start;
+                    const auto br = ar + half;
+                    const auto bi = ai + half;
+
+                    dsp::forEachLane(half, [ar, ai, br, bi, wr, wi](auto lanes, std::size_t j) noexcept {
+                        using Lanes = decltype(lanes);
+
+                        const auto xr = Lanes::load(br + j);
+                        const auto xi = Lanes::load(bi + j);
+                        const auto twr = Lanes::load(wr + j);
+                        const auto twi = Lanes::load(wi + j);
+
+                        // b * w, or b * conj(w) for the inverse transform
+                        const auto tr = inverse ?
+                            Lanes::add(Lanes::mul(xr, twr), Lanes::mul(xi, twi)) :
+                            Lanes::sub(Lanes::mul(xr, twr), Lanes::mul(xi, twi));
+                        const auto ti = inverse ?
+                            Lanes::sub(Lanes::mul(xi, twr), Lanes::mul(xr, twi)) :
+                            Lanes::add(Lanes::mul(xi, twr), Lanes::mul(xr, twi));
+
+                        const auto yr = Lanes::load(ar + j);
+                        const auto yi = Lanes::load(ai + j);
+                        Lanes::store(ar + j, Lanes::add(yr, tr));
+                        Lanes::store(ai + j, Lanes::add(yi, ti));
+                        Lanes::store(br + j, Lanes::sub(yr, tr));
+                        Lanes::store(bi + j, Lanes::sub(yi, ti));
+                    });
+                }
+            }
+        }
+
+        static void butterfly(float& ar, float& ai, float& br, float& bi) noexcept
+        {
+            const auto r = ar - br;
+            const auto i = ai - bi;
+            ar += br;
+            ai += bi;
+            br = r;
+            bi = i;
+        }
+
+        std::size_t size;
+        std::vector<std::uint32_t> reversed; // bit reversed index of every element
+        std::vector<float> twiddleReal;
+        std::vector<float> twiddleImag;
+    };
+}
+
+#endif // OUZEL_AUDIO_FFT_HPP
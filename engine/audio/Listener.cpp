@@ -26,8 +26,24 @@ namespace ouzel::audio
         if (mix) mix->addListener(this);
     }
 
+    void Listener::setPosition(const math::Vector<float, 3>& newPosition)
+    {
+        position = newPosition;
+
+        audio.addCommand(std::make_unique<mixer::SetListenerPositionCommand>(newPosition));
+    }
+
+    void Listener::setRotation(const math::Quaternion<float>& newRotation)
+    {
+        rotation = newRotation;
+
+        audio.addCommand(std::make_unique<mixer::SetListenerRotationCommand>(newRotation));
+    }
+
     void Listener::updateTransform()
     {
         transformDirty = true;
+        setPosition(actor->getWorldPosition());
+        setRotation(actor->getRotation());
     }
 }
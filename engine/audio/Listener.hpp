@@ -29,13 +29,15 @@ namespace ouzel::audio
         void setMix(Mix* newMix);
 
         auto& getPosition() const noexcept { return position; }
-        void setPosition(const math::Vector<float, 3>& newPosition) { position = newPosition; }
+        // the voices are attenuated and virtualized by their distance from the position
+        void setPosition(const math::Vector<float, 3>& newPosition);
 
         auto& getVelocity() const noexcept { return velocity; }
         void setVelocity(const math::Vector<float, 3>& newVelocity) { velocity = newVelocity; }
 
         auto& getRotation() const noexcept { return rotation; }
-        void setRotation(const math::Quaternion<float>& newRotation) { rotation = newRotation; }
+        // the panned voices are placed around the forward vector of the rotation
+        void setRotation(const math::Quaternion<float>& newRotation);
 
     private:
         void updateTransform() override;
@@ -21,6 +21,7 @@ namespace ouzel::audio
         }
 
         void generateSamples(std::uint32_t frames, std::vector<float>& samples) override;
+        void skipSamples(std::uint32_t frames) override;
 
     private:
         std::uint32_t position = 0;
@@ -89,6 +90,20 @@ namespace ouzel::audio
         }
     }
 
+    void PcmStream::skipSamples(std::uint32_t frames)
+    {
+        const auto& pcmData = static_cast<PcmData&>(data);
+        const auto sourceFrames = static_cast<std::uint32_t>(pcmData.getData().size() / pcmData.getChannels());
+
+        position += (frames > sourceFrames - position) ? sourceFrames - position : frames;
+
+        if ((sourceFrames - position) == 0)
+        {
+            playing = false; // TODO: fire event
+            reset();
+        }
+    }
+
     PcmClip::PcmClip(Audio& initAudio, std::uint32_t channels, std::uint32_t sampleRate,
                       const std::vector<float>& samples):
         Sound{
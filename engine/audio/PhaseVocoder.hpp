@@ -0,0 +1,213 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_AUDIO_PHASEVOCODER_HPP
+#define OUZEL_AUDIO_PHASEVOCODER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Dsp.hpp"
+#include "Fft.hpp"
+#include "../math/Constants.hpp"
+
+namespace ouzel::audio
+{
+    // Changes the pitch of one channel without changing its duration by moving the partials found in the
+    // short-time Fourier transform of overlapping frames, the output is delayed by one frame
+    class PhaseVocoder final
+    {
+    public:
+        explicit PhaseVocoder(std::size_t initFrameSize = 1024, std::size_t initOversampling = 4):
+            frameSize{initFrameSize},
+            oversampling{initOversampling},
+            stepSize{initFrameSize / initOversampling},
+            fft{initFrameSize},
+            window(initFrameSize),
+            inputFifo(initFrameSize),
+            outputFifo(initFrameSize),
+            outputAccumulator(initFrameSize * 2),
+            real(initFrameSize),
+            imag(initFrameSize),
+            lastPhase(initFrameSize / 2 + 1),
+            sumPhase(initFrameSize / 2 + 1),
+            analysisMagnitude(initFrameSize / 2 + 1),
+            analysisFrequency(initFrameSize / 2 + 1),
+            synthesisMagnitude(initFrameSize / 2 + 1),
+            synthesisFrequency(initFrameSize / 2 + 1),
+            synthesisPhase(initFrameSize / 2 + 1),
+            phaseOffset(initFrameSize / 2 + 1),
+            peakMagnitude(initFrameSize / 2 + 1),
+            synthesisPeak(initFrameSize / 2 + 1),
+            peaks(initFrameSize / 2 + 1),
+            position{initFrameSize - initFrameSize / initOversampling}
+        {
+            // Hann window
+            for (std::size_t i = 0; i < frameSize; ++i)
+                window[i] = 0.5F * (1.0F - std::cos(2.0F * math::pi<float> * static_cast<float>(i) /
+                                                    static_cast<float>(frameSize)));
+
+            // the window is applied twice and the frames overlap, which adds this gain to the output
+            float windowGain = 0.0F;
+            for (const auto value : window) windowGain += value * value;
+            windowGain /= static_cast<float>(stepSize);
+
+            outputScale = 2.0F / (static_cast<float>(halfSize() * oversampling) * windowGain);
+        }
+
+        // can process the samples in place
+        void process(float pitch, std::uint32_t frames, std::uint32_t sampleRate,
+                     const float* input, float* output)
+        {
+            const auto latency = frameSize - stepSize;
+
+            for (std::uint32_t frame = 0; frame < frames; ++frame)
+            {
+                inputFifo[position] = input[frame];
+                output[frame] = outputFifo[position - latency];
+
+                if (++position >= frameSize)
+                {
+                    position = latency;
+                    processFrame(pitch, sampleRate);
+                }
+            }
+        }
+
+    private:
+        std::size_t halfSize() const noexcept { return frameSize / 2; }
+
+        void processFrame(float pitch, std::uint32_t sampleRate)
+        {
+            const auto halfSize = this->halfSize();
+            const auto binFrequency = static_cast<float>(sampleRate) / static_cast<float>(frameSize);
+            const auto expectedPhase = 2.0F * math::pi<float> * static_cast<float>(stepSize) / static_cast<float>(frameSize);
+
+            for (std::size_t i = 0; i < frameSize; ++i)
+            {
+                real[i] = inputFifo[i] * window[i];
+                imag[i] = 0.0F;
+            }
+
+            fft.forward(real.data(), imag.data());
+
+            // analysis, finds the true frequency of every bin from the phase difference to the previous frame
+            for (std::size_t k = 0; k <= halfSize; ++k)
+            {
+                const auto phase = std::atan2(imag[k], real[k]);
+                auto delta = phase - lastPhase[k] - static_cast<float>(k) * expectedPhase;
+                lastPhase[k] = phase;
+
+                delta -= 2.0F * math::pi<float> * std::round(delta / (2.0F * math::pi<float>));
+
+                const auto deviation = static_cast<float>(oversampling) * delta / (2.0F * math::pi<float>);
+                analysisMagnitude[k] = 2.0F * std::sqrt(real[k] * real[k] + imag[k] * imag[k]);
+                analysisFrequency[k] = (static_cast<float>(k) + deviation) * binFrequency;
+            }
+
+            // moves the region of bins around every peak by the same number of bins, so that the shape and the phase
+            // differences of the partial's main lobe are kept and its bins add up coherently
+            std::size_t peakCount = 0;
+            for (std::size_t k = 0; k <= halfSize; ++k)
+                if ((k == 0 || analysisMagnitude[k] > analysisMagnitude[k - 1]) &&
+                    (k == halfSize || analysisMagnitude[k] >= analysisMagnitude[k + 1]))
+                    peaks[peakCount++] = k;
+
+            std::fill(synthesisMagnitude.begin(), synthesisMagnitude.end(), 0.0F);
+            std::fill(synthesisFrequency.begin(), synthesisFrequency.end(), 0.0F);
+            std::fill(peakMagnitude.begin(), peakMagnitude.end(), 0.0F);
+            for (std::size_t i = 0; i < peakCount; ++i)
+            {
+                const auto peak = peaks[i];
+                const auto first = (i == 0) ? 0 : (peaks[i - 1] + peak) / 2 + 1;
+                const auto last = (i == peakCount - 1) ? halfSize : (peak + peaks[i + 1]) / 2;
+
+                // the offset moves the true frequency of the partial, which is between the bins, to its shifted frequency
+                const auto offset = static_cast<std::ptrdiff_t>(std::lround(analysisFrequency[peak] * (pitch - 1.0F) /
+                                                                            binFrequency));
+                const auto shiftedPeak = static_cast<std::ptrdiff_t>(peak) + offset;
+                if (shiftedPeak < 0 || shiftedPeak > static_cast<std::ptrdiff_t>(halfSize)) continue;
+
+                for (std::size_t k = first; k <= last; ++k)
+                {
+                    const auto shiftedBin = static_cast<std::ptrdiff_t>(k) + offset;
+                    if (shiftedBin < 0 || shiftedBin > static_cast<std::ptrdiff_t>(halfSize)) continue;
+
+                    // the regions overlap when the pitch is lowered, the bin is kept by the stronger partial
+                    const auto index = static_cast<std::size_t>(shiftedBin);
+                    if (peakMagnitude[index] > analysisMagnitude[peak]) continue;
+                    peakMagnitude[index] = analysisMagnitude[peak];
+                    synthesisMagnitude[index] = analysisMagnitude[k];
+                    synthesisFrequency[index] = analysisFrequency[peak] * pitch;
+                    synthesisPeak[index] = static_cast<std::size_t>(shiftedPeak);
+                    phaseOffset[index] = lastPhase[k] - lastPhase[peak];
+                }
+            }
+
+            // synthesis, accumulates the phase of every bin from its frequency
+            for (std::size_t k = 0; k <= halfSize; ++k)
+            {
+                const auto deviation = synthesisFrequency[k] / binFrequency - static_cast<float>(k);
+                sumPhase[k] += 2.0F * math::pi<float> * deviation / static_cast<float>(oversampling) +
+                    static_cast<float>(k) * expectedPhase;
+                sumPhase[k] = std::remainder(sumPhase[k], 2.0F * math::pi<float>);
+            }
+
+            for (std::size_t k = 0; k <= halfSize; ++k)
+                synthesisPhase[k] = sumPhase[synthesisPeak[k]] + phaseOffset[k];
+
+            dsp::forEachLane(halfSize + 1, [this](auto lanes, std::size_t k) noexcept {
+                using Lanes = decltype(lanes);
+
+                typename Lanes::Type sine;
+                typename Lanes::Type cosine;
+                Lanes::sinCos(Lanes::load(synthesisPhase.data() + k), sine, cosine);
+
+                const auto magnitude = Lanes::load(synthesisMagnitude.data() + k);
+                Lanes::store(real.data() + k, Lanes::mul(magnitude, cosine));
+                Lanes::store(imag.data() + k, Lanes::mul(magnitude, sine));
+            });
+
+            // the negative frequencies are left empty, so the real part of the result is half of the signal
+            for (std::size_t k = halfSize + 1; k < frameSize; ++k)
+                real[k] = imag[k] = 0.0F;
+
+            fft.inverse(real.data(), imag.data());
+
+            for (std::size_t i = 0; i < frameSize; ++i)
+                outputAccumulator[i] += window[i] * real[i] * outputScale;
+
+            std::copy(outputAccumulator.begin(), outputAccumulator.begin() + stepSize, outputFifo.begin());
+            std::copy(outputAccumulator.begin() + stepSize, outputAccumulator.begin() + stepSize + frameSize,
+                      outputAccumulator.begin());
+            std::copy(inputFifo.begin() + stepSize, inputFifo.end(), inputFifo.begin());
+        }
+
+        std::size_t frameSize;
+        std::size_t oversampling;
+        std::size_t stepSize;
+        Fft fft;
+        std::vector<float> window;
+        std::vector<float> inputFifo;
+        std::vector<float> outputFifo;
+        std::vector<float> outputAccumulator;
+        std::vector<float> real;
+        std::vector<float> imag;
+        std::vector<float> lastPhase;
+        std::vector<float> sumPhase;
+        std::vector<float> analysisMagnitude;
+        std::vector<float> analysisFrequency;
+        std::vector<float> synthesisMagnitude;
+        std::vector<float> synthesisFrequency;
+        std::vector<float> synthesisPhase;
+        std::vector<float> phaseOffset;
+        std::vector<float> peakMagnitude;
+        std::vector<std::size_t> synthesisPeak;
+        std::vector<std::size_t> peaks;
+        std::size_t position;
+        float outputScale = 1.0F;
+    };
+}
+
+#endif // OUZEL_AUDIO_PHASEVOCODER_HPP
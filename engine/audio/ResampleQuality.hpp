@@ -0,0 +1,15 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_AUDIO_RESAMPLEQUALITY_HPP
+#define OUZEL_AUDIO_RESAMPLEQUALITY_HPP
+
+namespace ouzel::audio
+{
+    enum class ResampleQuality
+    {
+        linear,
+        sinc
+    };
+}
+
+#endif // OUZEL_AUDIO_RESAMPLEQUALITY_HPP
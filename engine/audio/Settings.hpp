@@ -4,6 +4,8 @@
 #define OUZEL_AUDIO_SETTINGS_HPP
 
 #include <cstdint>
+#include <string>
+#include "ResampleQuality.hpp"
 #include "SampleFormat.hpp"
 
 namespace ouzel::audio
@@ -12,9 +14,15 @@ namespace ouzel::audio
     {
         bool debugAudio = false;
         std::uint32_t bufferSize = 512;
+        std::uint32_t bufferCount = 3; // buffers mixed ahead of the device, more add latency and headroom
         std::uint32_t sampleRate = 44100;
         std::uint32_t channels = 0;
         SampleFormat sampleFormat = SampleFormat::float32;
+        ResampleQuality resampleQuality = ResampleQuality::sinc;
+        std::uint32_t decodeAheadFrames = 16384; // frames decoded ahead of the mixer for every compressed stream
+        float preDecodeDuration = 0.0F; // compressed clips up to this many seconds long are decoded when loaded
+        std::uint32_t streamWindowSize = 262144; // bytes of a streamed file kept resident around the decoding position
+        std::uint32_t maxVoices = 64; // streams rendered at once, the least audible ones above it become virtual
         std::string audioDevice;
     };
 }
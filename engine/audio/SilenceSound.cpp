@@ -20,6 +20,7 @@ namespace ouzel::audio
         }
 
         void generateSamples(std::uint32_t frames, std::vector<float>& samples) override;
+        void skipSamples(std::uint32_t frames) override;
 
     private:
         std::uint32_t position = 0;
@@ -52,30 +53,21 @@ namespace ouzel::audio
 
     void SilenceStream::generateSamples(std::uint32_t frames, std::vector<float>& samples)
     {
-        auto& silenceData = static_cast<SilenceData&>(data);
-
         samples.resize(frames);
         std::fill(samples.begin(), samples.end(), 0.0F); // TODO: fill only the needed samples
 
-        const auto length = static_cast<SilenceData&>(silenceData).getLength();
+        skipSamples(frames);
+    }
+
+    void SilenceStream::skipSamples(std::uint32_t frames)
+    {
+        const auto length = static_cast<SilenceData&>(data).getLength();
 
         if (length > 0.0F)
         {
             const auto frameCount = static_cast<std::uint32_t>(length * data.getSampleRate());
 
-            if (auto neededSize = frames; neededSize > 0)
-            {
-                if (frameCount - position < neededSize)
-                {
-                    neededSize -= frameCount - position;
-                    position = frameCount;
-                }
-                else
-                {
-                    position += neededSize;
-                    neededSize = 0;
-                }
-            }
+            position += (frames > frameCount - position) ? frameCount - position : frames;
 
             if ((frameCount - position) == 0)
             {
@@ -84,9 +76,7 @@ namespace ouzel::audio
             }
         }
         else
-        {
             position += frames;
-        }
     }
 
     SilenceSound::SilenceSound(Audio& initAudio, float initLength):
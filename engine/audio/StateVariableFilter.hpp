@@ -0,0 +1,244 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_AUDIO_STATEVARIABLEFILTER_HPP
+#define OUZEL_AUDIO_STATEVARIABLEFILTER_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../math/Constants.hpp"
+
+namespace ouzel::audio
+{
+    // Trapezoidal state variable filter, which stays stable while its coefficients change, so the
+    // coefficients are ramped over a block instead of jumping when the parameters are changed
+    class StateVariableFilter final
+    {
+    public:
+        enum class Type
+        {
+            lowPass,
+            highPass,
+            bandPass,
+            lowShelf,
+            highShelf,
+            peak
+        };
+
+        StateVariableFilter() = default;
+
+        StateVariableFilter(Type initType, float initFrequency, float initResonance, float initGain) noexcept:
+            type{initType}, frequency{initFrequency}, resonance{initResonance}, gain{initGain}
+        {
+        }
+
+        auto getType() const noexcept { return type; }
+        void setType(Type newType) noexcept { type = newType; dirty = true; }
+
+        auto getFrequency() const noexcept { return frequency; }
+        void setFrequency(float newFrequency) noexcept { frequency = newFrequency; dirty = true; }
+
+        auto getResonance() const noexcept { return resonance; }
+        void setResonance(float newResonance) noexcept { resonance = newResonance; dirty = true; }
+
+        // gain of the shelf and peak filters in decibels
+        auto getGain() const noexcept { return gain; }
+        void setGain(float newGain) noexcept { gain = newGain; dirty = true; }
+
+        // called before the filter is processed on the mixer thread, so that processing does not allocate,
+        // the coefficients are ramped over at most maxFrames frames
+        void reserve(std::uint32_t maxFrames, std::uint32_t channels)
+        {
+            ramp.resize(maxFrames);
+            states.resize(channels);
+        }
+
+        void reset() noexcept
+        {
+            std::fill(states.begin(), states.end(), State{});
+        }
+
+        // filters every channel of the planar samples, the state of each channel stays in registers for the whole block,
+        // the filter must have been reserved for the channels
+        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
+                     std::vector<float>& samples) noexcept
+        {
+            assert(channels <= states.size());
+            channels = std::min(channels, static_cast<std::uint32_t>(states.size()));
+
+            if (sampleRate != coefficientSampleRate || dirty)
+            {
+                const auto first = coefficientSampleRate == 0; // the first block starts at the target
+                target = getCoefficients(sampleRate);
+                coefficientSampleRate = sampleRate;
+                dirty = false;
+
+                if (first)
+                    current = target;
+                else
+                    rampCoefficients(frames);
+            }
+
+            if (ramping)
+            {
+                for (std::uint32_t channel = 0; channel < channels; ++channel)
+                {
+                    auto state = states[channel];
+                    float* data = samples.data() + channel * frames;
+                    for (std::uint32_t frame = 0; frame < rampFrames; ++frame)
+                        data[frame] = tick(ramp[frame], state, data[frame]);
+                    for (std::uint32_t frame = rampFrames; frame < frames; ++frame)
+                        data[frame] = tick(target, state, data[frame]);
+                    states[channel] = flushDenormals(state);
+                }
+
+                current = target;
+                ramping = false;
+            }
+            else
+            {
+                const auto coefficients = current;
+                for (std::uint32_t channel = 0; channel < channels; ++channel)
+                {
+                    auto state = states[channel];
+                    float* data = samples.data() + channel * frames;
+                    for (std::uint32_t frame = 0; frame < frames; ++frame)
+                        data[frame] = tick(coefficients, state, data[frame]);
+                    states[channel] = flushDenormals(state);
+                }
+            }
+        }
+
+    private:
+        struct Coefficients final
+        {
+            float g = 0.0F; // warped cutoff frequency
+            float k = 2.0F; // damping
+            float a1 = 1.0F;
+            float a2 = 0.0F;
+            float a3 = 0.0F;
+            float m0 = 1.0F; // mix of the input
+            float m1 = 0.0F; // mix of the band-pass
+            float m2 = 0.0F; // mix of the low-pass
+        };
+
+        struct State final
+        {
+            float ic1eq = 0.0F;
+            float ic2eq = 0.0F;
+        };
+
+        static float tick(const Coefficients& c, State& state, float input) noexcept
+        {
+            const auto v3 = input - state.ic2eq;
+            const auto v1 = c.a1 * state.ic1eq + c.a2 * v3;
+            const auto v2 = state.ic2eq + c.a2 * state.ic1eq + c.a3 * v3;
+            state.ic1eq = 2.0F * v1 - state.ic1eq;
+            state.ic2eq = 2.0F * v2 - state.ic2eq;
+            return c.m0 * input + c.m1 * v1 + c.m2 * v2;
+        }
+
+        static State flushDenormals(State state) noexcept
+        {
+            constexpr float threshold = 1e-20F;
+            if (std::fabs(state.ic1eq) < threshold) state.ic1eq = 0.0F;
+            if (std::fabs(state.ic2eq) < threshold) state.ic2eq = 0.0F;
+            return state;
+        }
+
+        Coefficients getCoefficients(std::uint32_t sampleRate) const noexcept
+        {
+            const auto nyquist = static_cast<float>(sampleRate) / 2.0F;
+            const auto clampedFrequency = std::clamp(frequency, 10.0F, nyquist * 0.99F);
+            const auto q = std::max(resonance, 0.01F);
+            const auto a = std::pow(10.0F, gain / 40.0F); // square root of the linear gain
+
+            auto g = std::tan(math::pi<float> * clampedFrequency / static_cast<float>(sampleRate));
+            auto k = 1.0F / q;
+
+            Coefficients c;
+            switch (type)
+            {
+                case Type::lowPass:
+                    c.m0 = 0.0F; c.m1 = 0.0F; c.m2 = 1.0F;
+                    break;
+                case Type::highPass:
+                    c.m0 = 1.0F; c.m1 = -k; c.m2 = -1.0F;
+                    break;
+                case Type::bandPass:
+                    c.m0 = 0.0F; c.m1 = k; c.m2 = 0.0F; // unity gain at the center frequency
+                    break;
+                case Type::lowShelf:
+                    g /= std::sqrt(a);
+                    c.m0 = 1.0F; c.m1 = k * (a - 1.0F); c.m2 = a * a - 1.0F;
+                    break;
+                case Type::highShelf:
+                    g *= std::sqrt(a);
+                    c.m0 = a * a; c.m1 = k * (1.0F - a) * a; c.m2 = 1.0F - a * a;
+                    break;
+                case Type::peak:
+                    k = 1.0F / (q * a);
+                    c.m0 = 1.0F; c.m1 = k * (a * a - 1.0F); c.m2 = 0.0F;
+                    break;
+            }
+
+            c.g = g;
+            c.k = k;
+            updateFeedback(c);
+            return c;
+        }
+
+        static void updateFeedback(Coefficients& c) noexcept
+        {
+            c.a1 = 1.0F / (1.0F + c.g * (c.g + c.k));
+            c.a2 = c.g * c.a1;
+            c.a3 = c.g * c.a2;
+        }
+
+        // interpolates the frequency, damping and mix from the current to the target ones over the block,
+        // or over the reserved frames if the block is longer, the feedback coefficients are derived from them, so every intermediate filter is a stable one
+        void rampCoefficients(std::uint32_t frames) noexcept
+        {
+            rampFrames = std::min(frames, static_cast<std::uint32_t>(ramp.size()));
+            if (rampFrames == 0)
+            {
+                current = target;
+                return;
+            }
+
+            const auto step = 1.0F / static_cast<float>(rampFrames);
+            for (std::uint32_t frame = 0; frame < rampFrames; ++frame)
+            {
+                const auto t = static_cast<float>(frame + 1) * step;
+                auto& c = ramp[frame];
+                c.g = current.g + (target.g - current.g) * t;
+                c.k = current.k + (target.k - current.k) * t;
+                c.m0 = current.m0 + (target.m0 - current.m0) * t;
+                c.m1 = current.m1 + (target.m1 - current.m1) * t;
+                c.m2 = current.m2 + (target.m2 - current.m2) * t;
+                updateFeedback(c);
+            }
+
+            ramping = true;
+        }
+
+        Type type = Type::lowPass;
+        float frequency = 1000.0F;
+        float resonance = 0.70710678F;
+        float gain = 0.0F;
+
+        bool dirty = true;
+        bool ramping = false;
+        std::uint32_t rampFrames = 0;
+        std::uint32_t coefficientSampleRate = 0;
+        Coefficients current;
+        Coefficients target;
+        std::vector<Coefficients> ramp;
+        std::vector<State> states; // for every channel
+    };
+}
+
+#endif // OUZEL_AUDIO_STATEVARIABLEFILTER_HPP
@@ -111,10 +111,14 @@ namespace ouzel::audio
                     effects.push_back(std::make_unique<Reverb>(initAudio, effectDefinition.delay, effectDefinition.decay));
                     break;
                 case EffectDefinition::Type::lowPass:
-                    effects.push_back(std::make_unique<LowPass>(initAudio));
+                    effects.push_back(std::make_unique<LowPass>(initAudio,
+                        effectDefinition.frequency > 0.0F ? effectDefinition.frequency : 20000.0F,
+                        effectDefinition.resonance));
                     break;
                 case EffectDefinition::Type::highPass:
-                    effects.push_back(std::make_unique<HighPass>(initAudio));
+                    effects.push_back(std::make_unique<HighPass>(initAudio,
+                        effectDefinition.frequency > 0.0F ? effectDefinition.frequency : 20.0F,
+                        effectDefinition.resonance));
                     break;
             }
         }
@@ -139,6 +143,27 @@ namespace ouzel::audio
             audio.deleteObject(streamId);
     }
 
+    void Voice::setPosition(const math::Vector<float, 3>& newPosition)
+    {
+        position = newPosition;
+
+        audio.addCommand(std::make_unique<mixer::SetStreamPositionCommand>(streamId, newPosition));
+    }
+
+    void Voice::setGain(float newGain)
+    {
+        gain = newGain;
+
+        audio.addCommand(std::make_unique<mixer::SetStreamGainCommand>(streamId, newGain));
+    }
+
+    void Voice::setPriority(std::int32_t newPriority)
+    {
+        priority = newPriority;
+
+        audio.addCommand(std::make_unique<mixer::SetStreamPriorityCommand>(streamId, newPriority));
+    }
+
     void Voice::play()
     {
         audio.addCommand(std::make_unique<mixer::PlayStreamCommand>(streamId));
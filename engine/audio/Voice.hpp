@@ -3,6 +3,7 @@
 #ifndef OUZEL_AUDIO_VOICE_HPP
 #define OUZEL_AUDIO_VOICE_HPP
 
+#include <cstdint>
 #include <memory>
 #include "Cue.hpp"
 #include "Node.hpp"
@@ -41,11 +42,18 @@ namespace ouzel::audio
         auto& getSound() const noexcept { return sound; }
 
         auto& getPosition() const noexcept { return position; }
-        void setPosition(const math::Vector<float, 3>& newPosition) { position = newPosition; }
+        void setPosition(const math::Vector<float, 3>& newPosition);
 
         auto& getVelocity() const noexcept { return velocity; }
         void setVelocity(const math::Vector<float, 3>& newVelocity) { velocity = newVelocity; }
 
+        auto getGain() const noexcept { return gain; }
+        void setGain(float newGain);
+
+        // voices with higher priority are rendered before the louder ones when there are too many voices
+        auto getPriority() const noexcept { return priority; }
+        void setPriority(std::int32_t newPriority);
+
         void play();
         void pause();
         void stop();
@@ -56,11 +64,13 @@ namespace ouzel::audio
 
     private:
         Audio& audio;
-        std::size_t streamId;
+        std::size_t streamId = 0;
 
         const Sound* sound = nullptr;
         math::Vector<float, 3> position{};
         math::Vector<float, 3> velocity{};
+        float gain = 1.0F;
+        std::int32_t priority = 0;
         bool playing = false;
 
         Mix* output = nullptr;
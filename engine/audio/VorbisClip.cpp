@@ -1,9 +1,13 @@
 // Ouzel by Elviss Strazdins
 
+#include <algorithm>
+#include <atomic>
 #include "VorbisClip.hpp"
 #include "Audio.hpp"
 #include "AudioError.hpp"
+#include "Decoder.hpp"
 #include "mixer/Data.hpp"
+#include "mixer/FrameBuffer.hpp"
 #include "mixer/Stream.hpp"
 #include "../utils/Utils.hpp"
 
@@ -43,132 +47,373 @@
 
 namespace ouzel::audio
 {
+    namespace
+    {
+        constexpr std::uint32_t decodeFrames = 1024; // frames decoded at once
+
+        bool isSupportedChannelCount(int channels) noexcept
+        {
+            return channels == 1 || channels == 2 || channels == 4 || channels == 6;
+        }
+
+        // points the channels of stb_vorbis to the planar samples, the 5.1 order of Vorbis is L, C, R, SL, SR, LFE
+        void getChannelData(std::uint32_t channels, float* samples, std::size_t stride, float* channelData[6]) noexcept
+        {
+            if (channels == 6)
+            {
+                channelData[0] = samples + 0 * stride;
+                channelData[1] = samples + 2 * stride;
+                channelData[2] = samples + 1 * stride;
+                channelData[3] = samples + 4 * stride;
+                channelData[4] = samples + 5 * stride;
+                channelData[5] = samples + 3 * stride;
+            }
+            else
+                for (std::uint32_t channel = 0; channel < channels; ++channel)
+                    channelData[channel] = samples + channel * stride;
+        }
+    }
+
     class VorbisData;
 
-    class VorbisStream final: public mixer::Stream
+    class VorbisStream final: public mixer::Stream, public Decoder::Source
     {
     public:
         explicit VorbisStream(VorbisData& vorbisData);
 
         ~VorbisStream() override
         {
+            decoder.removeSource(*this);
+
             if (vorbisStream)
                 stb_vorbis_close(vorbisStream);
         }
 
         void reset() override
         {
-            stb_vorbis_seek_start(vorbisStream);
+            playedFrames = 0;
+            seekPending = false;
+            seek(0);
         }
 
         void generateSamples(std::uint32_t frames, std::vector<float>& samples) override;
+        void skipSamples(std::uint32_t frames) override;
+
+        void decode() override;
 
     private:
-        stb_vorbis* vorbisStream = nullptr;
+        // called on the mixer thread, the decoder thread seeks to the frame before it decodes again
+        void seek(std::size_t frame)
+        {
+            seekFrame.store(frame, std::memory_order_relaxed);
+            seekRequest.store(seekRequest.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            discarding = true;
+            decoder.wake();
+        }
+
+        void updateWindow();
+
+        static constexpr std::size_t noEnd = ~std::size_t{0};
+
+        Decoder& decoder;
+        stb_vorbis* vorbisStream = nullptr; // used only by the decoder thread after the construction
+        std::vector<float> decodeBuffer;
+        mixer::FrameBuffer buffer;
+        std::size_t releasedOffset = 0; // the pages of a mapped file before it have been released
+
+        std::atomic<std::uint32_t> seekRequest{0};
+        std::atomic<std::uint32_t> seekAck{0};
+        std::atomic<std::size_t> seekFrame{0};
+        std::atomic<std::size_t> discardPosition{0}; // the frames before it were decoded before the seek
+        std::atomic<std::size_t> endPosition{noEnd}; // position of the last decoded frame of the stream
+        bool discarding = false;
+        std::size_t playedFrames = 0; // playback position in the stream, used to seek after the stream was virtual
+        bool seekPending = false;
     };
 
     class VorbisData final: public mixer::Data
     {
     public:
-        explicit VorbisData(const std::vector<std::byte>& initData):
-            data{initData}
+        VorbisData(Decoder& initDecoder, const std::vector<std::byte>& initData):
+            decoder{initDecoder},
+            data{initData},
+            bytes{data.data()},
+            size{data.size()}
+        {
+            readInfo();
+        }
+
+        VorbisData(Decoder& initDecoder, storage::MappedFile&& initFile, std::size_t initWindowSize):
+            decoder{initDecoder},
+            file{std::move(initFile)},
+            bytes{file.data()},
+            size{file.getSize()},
+            windowSize{initWindowSize}
         {
-            stb_vorbis* vorbisStream = stb_vorbis_open_memory(reinterpret_cast<const unsigned char*>(data.data()),
-                                                              static_cast<int>(data.size()),
+            readInfo();
+        }
+
+        auto& getDecoder() const noexcept { return decoder; }
+        auto getBytes() const noexcept { return bytes; }
+        auto getSize() const noexcept { return size; }
+        auto getFrames() const noexcept { return frames; }
+
+        auto isMapped() const noexcept { return file.getSize() != 0; }
+        auto& getFile() const noexcept { return file; }
+        auto getWindowSize() const noexcept { return windowSize; }
+
+        std::unique_ptr<mixer::Stream> createStream() override
+        {
+            return std::make_unique<VorbisStream>(*this);
+        }
+
+    private:
+        void readInfo()
+        {
+            stb_vorbis* vorbisStream = stb_vorbis_open_memory(reinterpret_cast<const unsigned char*>(bytes),
+                                                              static_cast<int>(size),
                                                               nullptr, nullptr);
 
             if (!vorbisStream)
                 throw Error{"Failed to load Vorbis stream"};
 
             stb_vorbis_info info = stb_vorbis_get_info(vorbisStream);
-
-            channels = static_cast<std::uint32_t>(info.channels);
-            sampleRate = info.sample_rate;
-
+            frames = stb_vorbis_stream_length_in_samples(vorbisStream);
             stb_vorbis_close(vorbisStream);
-        }
 
-        auto& getData() const noexcept { return data; }
+            if (!isSupportedChannelCount(info.channels))
+                throw Error{"Unsupported channel count"};
 
-        std::unique_ptr<mixer::Stream> createStream() override
-        {
-            return std::make_unique<VorbisStream>(*this);
+            channels = static_cast<std::uint32_t>(info.channels);
+            sampleRate = info.sample_rate;
         }
 
-    private:
+        Decoder& decoder;
         std::vector<std::byte> data;
+        storage::MappedFile file;
+        const std::byte* bytes = nullptr;
+        std::size_t size = 0;
+        std::size_t frames = 0; // length of the stream, 0 if it could not be determined
+        std::size_t windowSize = 0; // bytes of the mapped file kept resident after the decoding position
     };
 
     VorbisStream::VorbisStream(VorbisData& vorbisData):
-        Stream{vorbisData}
+        Stream{vorbisData},
+        decoder{vorbisData.getDecoder()},
+        decodeBuffer(decodeFrames * vorbisData.getChannels()),
+        buffer{vorbisData.getDecoder().getPrefetchFrames(), vorbisData.getChannels()}
     {
-        vorbisStream = stb_vorbis_open_memory(reinterpret_cast<const unsigned char*>(vorbisData.getData().data()),
-                                              static_cast<int>(vorbisData.getData().size()),
+        vorbisStream = stb_vorbis_open_memory(reinterpret_cast<const unsigned char*>(vorbisData.getBytes()),
+                                              static_cast<int>(vorbisData.getSize()),
                                               nullptr, nullptr);
+
+        if (!vorbisStream)
+            throw Error{"Failed to open Vorbis stream"};
+
+        decoder.addSource(*this);
     }
 
     void VorbisStream::generateSamples(std::uint32_t frames, std::vector<float>& samples)
     {
-        std::uint32_t neededSize = frames * data.getChannels();
-        samples.resize(neededSize);
+        const std::uint32_t channels = data.getChannels();
+        samples.resize(frames * channels);
+
+        std::size_t readFrames = 0;
+
+        if (seekPending)
+        {
+            seek(playedFrames);
+            seekPending = false;
+        }
 
-        int resultFrames = 0;
+        // the offline mixer reads faster than real time, so the stream is decoded on the mixer thread
+        if (decoder.isSynchronous() && (discarding || buffer.getReadableFrames() < frames))
+            decode();
 
-        if (neededSize > 0)
+        if (discarding && seekAck.load(std::memory_order_acquire) == seekRequest.load(std::memory_order_relaxed))
         {
-            if (vorbisStream->eof)
-                reset();
+            // drop the frames that were decoded before the seek
+            buffer.skip(discardPosition.load(std::memory_order_relaxed) - buffer.getReadPosition());
+            discarding = false;
+        }
 
-            std::vector<float*> channelData(data.getChannels());
+        if (!discarding)
+        {
+            readFrames = std::min(static_cast<std::size_t>(frames), buffer.getReadableFrames());
+            buffer.read(samples, readFrames, frames);
+            playedFrames += readFrames;
 
-            switch (data.getChannels())
+            if (readFrames < frames)
             {
-                case 1:
-                    channelData[0] = &samples[0];
-                    break;
-                case 2:
-                    channelData[0] = &samples[0 * frames];
-                    channelData[1] = &samples[1 * frames];
-                    break;
-                case 4:
-                    channelData[0] = &samples[0 * frames];
-                    channelData[1] = &samples[1 * frames];
-                    channelData[2] = &samples[2 * frames];
-                    channelData[3] = &samples[3 * frames];
-                    break;
-                case 6:
-                    channelData[0] = &samples[0 * frames];
-                    channelData[1] = &samples[2 * frames];
-                    channelData[2] = &samples[1 * frames];
-                    channelData[3] = &samples[4 * frames];
-                    channelData[4] = &samples[5 * frames];
-                    channelData[5] = &samples[3 * frames];
-                    break;
-                default:
-                    throw Error{"Unsupported channel count"};
+                if (buffer.getReadPosition() == endPosition.load(std::memory_order_acquire))
+                {
+                    playing = false; // TODO: fire event
+                    reset();
+                }
+                else
+                    decoder.addUnderrun();
             }
-
-            resultFrames = stb_vorbis_get_samples_float(vorbisStream,
-                                                        static_cast<int>(data.getChannels()),
-                                                        channelData.data(),
-                                                        static_cast<int>(frames));
         }
 
-        if (vorbisStream->eof)
+        for (std::uint32_t channel = 0; channel < channels; ++channel)
+            std::fill(samples.begin() + channel * frames + static_cast<std::ptrdiff_t>(readFrames),
+                      samples.begin() + (channel + 1) * frames, 0.0F);
+
+        if (buffer.getReadableFrames() < buffer.getCapacity() / 2)
+            decoder.wake();
+    }
+
+    void VorbisStream::skipSamples(std::uint32_t frames)
+    {
+        playedFrames += frames;
+
+        if (const auto totalFrames = static_cast<const VorbisData&>(data).getFrames();
+            totalFrames != 0 && playedFrames >= totalFrames)
         {
             playing = false; // TODO: fire event
             reset();
         }
+        else if (!discarding && !seekPending && frames <= buffer.getReadableFrames())
+        {
+            // the frames are already decoded, so the decoder keeps its position
+            buffer.skip(frames);
+
+            if (buffer.getReadableFrames() < buffer.getCapacity() / 2)
+                decoder.wake();
+        }
+        else
+            seekPending = true; // seek once when the stream is rendered again instead of decoding the skipped frames
+    }
+
+    void VorbisStream::decode()
+    {
+        if (const auto request = seekRequest.load(std::memory_order_acquire);
+            request != seekAck.load(std::memory_order_relaxed))
+        {
+            if (const auto frame = seekFrame.load(std::memory_order_relaxed); frame == 0)
+                stb_vorbis_seek_start(vorbisStream);
+            else
+                stb_vorbis_seek(vorbisStream, static_cast<unsigned int>(frame));
+
+            releasedOffset = 0;
+            endPosition.store(noEnd, std::memory_order_relaxed);
+            discardPosition.store(buffer.getWritePosition(), std::memory_order_relaxed);
+            seekAck.store(request, std::memory_order_release);
+        }
+
+        if (endPosition.load(std::memory_order_relaxed) != noEnd)
+            return; // decoded to the end, waiting for a seek
+
+        float* channelData[6];
+        getChannelData(data.getChannels(), decodeBuffer.data(), decodeFrames, channelData);
+
+        while (const auto writableFrames = std::min(buffer.getWritableFrames(), static_cast<std::size_t>(decodeFrames)))
+        {
+            const auto resultFrames = stb_vorbis_get_samples_float(vorbisStream,
+                                                                   static_cast<int>(data.getChannels()),
+                                                                   channelData,
+                                                                   static_cast<int>(writableFrames));
+
+            buffer.write(decodeBuffer, static_cast<std::size_t>(resultFrames), decodeFrames);
+
+            if (static_cast<std::size_t>(resultFrames) < writableFrames)
+            {
+                endPosition.store(buffer.getWritePosition(), std::memory_order_release);
+                break;
+            }
+        }
+
+        updateWindow();
+    }
+
+    void VorbisStream::updateWindow()
+    {
+        const auto& vorbisData = static_cast<const VorbisData&>(data);
+        if (!vorbisData.isMapped()) return;
+
+        // only the pages around the decoding position of the mapped file stay resident
+        const auto& file = vorbisData.getFile();
+        const auto windowSize = vorbisData.getWindowSize();
+        const auto offset = static_cast<std::size_t>(stb_vorbis_get_file_offset(vorbisStream));
+
+        file.prefetch(offset, windowSize);
+
+        if (offset > releasedOffset + windowSize)
+        {
+            file.release(releasedOffset, offset - windowSize - releasedOffset);
+            releasedOffset = offset - windowSize;
+        }
+    }
+
+    bool decodeVorbis(const std::vector<std::byte>& data, float maxDuration,
+                      std::uint32_t& channels, std::uint32_t& sampleRate, std::vector<float>& samples)
+    {
+        if (maxDuration <= 0.0F) return false;
+
+        stb_vorbis* vorbisStream = stb_vorbis_open_memory(reinterpret_cast<const unsigned char*>(data.data()),
+                                                          static_cast<int>(data.size()),
+                                                          nullptr, nullptr);
+
+        if (!vorbisStream)
+            throw Error{"Failed to load Vorbis stream"};
+
+        const stb_vorbis_info info = stb_vorbis_get_info(vorbisStream);
+        const auto frames = stb_vorbis_stream_length_in_samples(vorbisStream);
+
+        if (!isSupportedChannelCount(info.channels))
+        {
+            stb_vorbis_close(vorbisStream);
+            throw Error{"Unsupported channel count"};
+        }
+
+        // the length is zero if it is unknown, such streams are not pre-decoded
+        if (frames == 0 || static_cast<float>(frames) > maxDuration * static_cast<float>(info.sample_rate))
+        {
+            stb_vorbis_close(vorbisStream);
+            return false;
+        }
 
-        for (std::uint32_t channel = 0; channel < data.getChannels(); ++channel)
-            for (auto frame = static_cast<std::uint32_t>(resultFrames); frame < frames; ++frame)
-                samples[channel * frames + frame] = 0.0F;
+        channels = static_cast<std::uint32_t>(info.channels);
+        sampleRate = info.sample_rate;
+        samples.resize(static_cast<std::size_t>(frames) * channels);
+
+        float* channelData[6];
+        getChannelData(channels, samples.data(), frames, channelData);
+
+        const auto decodedFrames = static_cast<std::size_t>(std::max(
+            stb_vorbis_get_samples_float(vorbisStream, info.channels, channelData, static_cast<int>(frames)), 0));
+        stb_vorbis_close(vorbisStream);
+
+        if (decodedFrames == 0) return false;
+
+        // the planar channels are moved together if the stream ended before its reported length
+        if (decodedFrames < frames)
+        {
+            for (std::uint32_t channel = 1; channel < channels; ++channel)
+                std::copy(samples.begin() + static_cast<std::ptrdiff_t>(channel * frames),
+                          samples.begin() + static_cast<std::ptrdiff_t>(channel * frames + decodedFrames),
+                          samples.begin() + static_cast<std::ptrdiff_t>(channel * decodedFrames));
+            samples.resize(decodedFrames * channels);
+        }
+
+        return true;
     }
 
     VorbisClip::VorbisClip(Audio& initAudio, const std::vector<std::byte>& initData):
         Sound{
             initAudio,
-            initAudio.initData(std::unique_ptr<mixer::Data>(data = new VorbisData(initData))),
+            initAudio.initData(std::unique_ptr<mixer::Data>(data = new VorbisData(initAudio.getDecoder(), initData))),
+            Sound::Format::vorbis
+        }
+    {
+    }
+
+    VorbisClip::VorbisClip(Audio& initAudio, storage::MappedFile&& initFile):
+        Sound{
+            initAudio,
+            initAudio.initData(std::unique_ptr<mixer::Data>(data = new VorbisData(initAudio.getDecoder(),
+                                                                                   std::move(initFile),
+                                                                                   initAudio.getStreamWindowSize()))),
             Sound::Format::vorbis
         }
     {
@@ -6,16 +6,24 @@
 #include <cstdint>
 #include <vector>
 #include "Sound.hpp"
+#include "../storage/MappedFile.hpp"
 
 namespace ouzel::audio
 {
     class VorbisData;
 
+    // decodes the whole Vorbis stream into planar samples if its length is known and not longer than maxDuration seconds
+    bool decodeVorbis(const std::vector<std::byte>& data, float maxDuration,
+                      std::uint32_t& channels, std::uint32_t& sampleRate, std::vector<float>& samples);
+
     class VorbisClip final: public Sound
     {
     public:
         VorbisClip(Audio& initAudio, const std::vector<std::byte>& initData);
 
+        // the file is decoded while it is played, so only a window of it is resident in memory
+        VorbisClip(Audio& initAudio, storage::MappedFile&& initFile);
+
     private:
         VorbisData* data;
     };
@@ -4,6 +4,7 @@
 
 #if OUZEL_COMPILE_ALSA
 
+#include <algorithm>
 #include <system_error>
 #include "ALSAAudioDevice.hpp"
 #include "ALSAErrorCategory.hpp"
@@ -12,6 +13,11 @@
 
 namespace ouzel::audio::alsa
 {
+    namespace
+    {
+        constexpr int waitTimeout = 100; // in milliseconds, the audio thread checks whether it should stop after it
+    }
+
     AudioDevice::AudioDevice(const Settings& settings,
                              const std::function<void(std::uint32_t frames,
                                                       std::uint32_t channels,
@@ -32,7 +38,14 @@ namespace ouzel::audio::alsa
         if (const auto result = snd_pcm_hw_params_any(playbackHandle, hwParams); result < 0)
             throw std::system_error{result, errorCategory, "Failed to initialize hardware parameters"};
 
-        if (const auto result = snd_pcm_hw_params_set_access(playbackHandle, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED); result != 0)
+        if (snd_pcm_hw_params_test_access(playbackHandle, hwParams, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0)
+        {
+            if (const auto result = snd_pcm_hw_params_set_access(playbackHandle, hwParams, SND_PCM_ACCESS_MMAP_INTERLEAVED); result != 0)
+                throw std::system_error{result, errorCategory, "Failed to set access type"};
+
+            mappedAccess = true;
+        }
+        else if (const auto result = snd_pcm_hw_params_set_access(playbackHandle, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED); result != 0)
             throw std::system_error{result, errorCategory, "Failed to set access type"};
 
         if (snd_pcm_hw_params_test_format(playbackHandle, hwParams, SND_PCM_FORMAT_FLOAT_LE) == 0)
@@ -77,16 +90,21 @@ namespace ouzel::audio::alsa
         if (const auto result = snd_pcm_hw_params(playbackHandle, hwParams); result != 0)
             throw std::system_error{result, errorCategory, "Failed to set hardware parameters"};
 
+        if (const auto result = snd_pcm_hw_params_get_buffer_size(hwParams, &deviceBufferSize); result != 0)
+            throw std::system_error{result, errorCategory, "Failed to get buffer size"};
+
         snd_pcm_sw_params_t* swParams = nullptr;
         snd_pcm_sw_params_alloca(&swParams);
 
         if (const auto result = snd_pcm_sw_params_current(playbackHandle, swParams); result != 0)
             throw std::system_error{result, errorCategory, "Failed to initialize software parameters"};
 
-        if (const auto result = snd_pcm_sw_params_set_avail_min(playbackHandle, swParams, 4096); result != 0)
+        // the audio thread is woken up once a period is free
+        if (const auto result = snd_pcm_sw_params_set_avail_min(playbackHandle, swParams, periodSize); result != 0)
             throw std::system_error{result, errorCategory, "Failed to set minimum available count"};
 
-        if (const auto result = snd_pcm_sw_params_set_start_threshold(playbackHandle, swParams, 0); result != 0)
+        // the playback starts after the buffer has been filled
+        if (const auto result = snd_pcm_sw_params_set_start_threshold(playbackHandle, swParams, deviceBufferSize - deviceBufferSize % periodSize); result != 0)
             throw std::system_error{result, errorCategory, "Failed to set start threshold"};
 
         if (const auto result = snd_pcm_sw_params(playbackHandle, swParams); result != 0)
@@ -94,6 +112,12 @@ namespace ouzel::audio::alsa
 
         if (const auto result = snd_pcm_prepare(playbackHandle); result != 0)
             throw std::system_error{result, errorCategory, "Failed to prepare audio interface"};
+
+        if (!mappedAccess)
+        {
+            const auto sampleSize = (sampleFormat == SampleFormat::float32) ? sizeof(float) : sizeof(std::int16_t);
+            data.resize(periodSize * channels * sampleSize);
+        }
     }
 
     AudioDevice::~AudioDevice()
@@ -122,47 +146,37 @@ namespace ouzel::audio::alsa
         {
             try
             {
-                snd_pcm_sframes_t frames;
+                const auto frames = snd_pcm_avail_update(playbackHandle);
 
-                if ((frames = snd_pcm_avail_update(playbackHandle)) < 0)
+                if (frames < 0)
                 {
-                    if (frames == -EPIPE)
-                    {
-                        log(Log::Level::warning) << "Buffer underrun occurred";
-
-                        if (const auto result = snd_pcm_prepare(playbackHandle); result != 0)
-                            throw std::system_error{result, errorCategory, "Failed to prepare audio interface"};
-
-                        continue;
-                    }
-                    else
-                        throw std::system_error{frames, errorCategory, "Failed to get available frames"};
+                    recover(static_cast<int>(frames));
+                    continue;
                 }
 
-                if (static_cast<snd_pcm_uframes_t>(frames) > periods * periodSize)
+                if (static_cast<snd_pcm_uframes_t>(frames) > deviceBufferSize)
                 {
-                    log(Log::Level::warning) << "Buffer size exceeded, error: " << frames;
-                    snd_pcm_reset(playbackHandle);
+                    // some plugins report an underrun only through the available frame count
+                    recover(-EPIPE);
                     continue;
                 }
 
                 if (static_cast<snd_pcm_uframes_t>(frames) < periodSize)
+                {
+                    // sleeps until a period is free instead of polling the available frame count
+                    if (const auto result = snd_pcm_wait(playbackHandle, waitTimeout); result < 0)
+                        recover(result);
+
                     continue;
+                }
 
-                getData(frames, data);
+                if (mappedAccess)
+                    writeMapped();
+                else
+                    writeInterleaved();
 
-                if (const auto result = snd_pcm_writei(playbackHandle, data.data(), frames); result != 0)
-                {
-                    if (result == -EPIPE)
-                    {
-                        log(Log::Level::warning) << "Buffer underrun occurred";
-
-                        if (const auto prepareResult = snd_pcm_prepare(playbackHandle); prepareResult != 0)
-                            throw std::system_error{prepareResult, errorCategory, "Failed to prepare audio interface"};
-                    }
-                    else
-                        throw std::system_error{result, errorCategory, "Failed to write data"};
-                }
+                if (snd_pcm_sframes_t delay; snd_pcm_delay(playbackHandle, &delay) == 0)
+                    latency.store(static_cast<std::uint32_t>(std::max(delay, snd_pcm_sframes_t{0})), std::memory_order_relaxed);
             }
             catch (const std::exception& e)
             {
@@ -170,5 +184,95 @@ namespace ouzel::audio::alsa
             }
         }
     }
+
+    void AudioDevice::writeMapped()
+    {
+        for (snd_pcm_uframes_t writtenFrames = 0; writtenFrames < periodSize;)
+        {
+            const snd_pcm_channel_area_t* areas;
+            snd_pcm_uframes_t offset;
+            snd_pcm_uframes_t frames = periodSize - writtenFrames;
+
+            // the returned area can be shorter than requested when it reaches the end of the buffer
+            if (const auto result = snd_pcm_mmap_begin(playbackHandle, &areas, &offset, &frames); result < 0)
+            {
+                recover(result);
+                return;
+            }
+
+            // the channels are interleaved, so the area of the first channel starts at the frame
+            const auto destination = static_cast<std::uint8_t*>(areas[0].addr) +
+                (areas[0].first + offset * areas[0].step) / 8;
+            getData(static_cast<std::uint32_t>(frames), destination);
+
+            const auto result = snd_pcm_mmap_commit(playbackHandle, offset, frames);
+            if (result < 0)
+            {
+                recover(static_cast<int>(result));
+                return;
+            }
+
+            if (static_cast<snd_pcm_uframes_t>(result) != frames)
+            {
+                recover(-EPIPE);
+                return;
+            }
+
+            writtenFrames += frames;
+        }
+
+        // only snd_pcm_writei applies the start threshold, so the devices that are written
+        // through the mapped buffer, like the plain hw ones, are started once the buffer is full
+        if (snd_pcm_state(playbackHandle) == SND_PCM_STATE_PREPARED)
+        {
+            const auto availableFrames = snd_pcm_avail_update(playbackHandle);
+            if (availableFrames < 0)
+                recover(static_cast<int>(availableFrames));
+            else if (static_cast<snd_pcm_uframes_t>(availableFrames) < periodSize)
+                if (const auto result = snd_pcm_start(playbackHandle); result < 0)
+                    recover(result);
+        }
+    }
+
+    void AudioDevice::writeInterleaved()
+    {
+        getData(static_cast<std::uint32_t>(periodSize), data.data());
+
+        const auto frameSize = data.size() / periodSize;
+
+        for (snd_pcm_uframes_t writtenFrames = 0; writtenFrames < periodSize && running;)
+        {
+            const auto result = snd_pcm_writei(playbackHandle,
+                                               data.data() + writtenFrames * frameSize,
+                                               periodSize - writtenFrames);
+
+            if (result == -EAGAIN)
+            {
+                snd_pcm_wait(playbackHandle, waitTimeout);
+                continue;
+            }
+
+            if (result < 0)
+            {
+                recover(static_cast<int>(result));
+                return;
+            }
+
+            writtenFrames += static_cast<snd_pcm_uframes_t>(result);
+        }
+    }
+
+    void AudioDevice::recover(int error)
+    {
+        if (error == -EPIPE || error == -ESTRPIPE)
+        {
+            xrunCount.fetch_add(1, std::memory_order_relaxed);
+            log(Log::Level::warning) << "Buffer underrun occurred";
+        }
+
+        // prepares the device after an underrun and resumes it after a suspend
+        if (const auto result = snd_pcm_recover(playbackHandle, error, 1); result != 0)
+            throw std::system_error{result, errorCategory, "Failed to recover audio interface"};
+    }
 }
 #endif
@@ -31,13 +31,18 @@ namespace ouzel::audio::alsa
 
     private:
         void run();
+        void writeMapped();
+        void writeInterleaved();
+        void recover(int error);
 
         snd_pcm_t* playbackHandle = nullptr;
+        bool mappedAccess = false; // the samples are written directly to the buffer of the device
 
         unsigned int periods = 4U;
         snd_pcm_uframes_t periodSize = 1024U;
+        snd_pcm_uframes_t deviceBufferSize = 4096U;
 
-        std::vector<std::uint8_t> data;
+        std::vector<std::uint8_t> data; // used only if the device does not support mapped access
 
         std::atomic_bool running{false};
         thread::Thread audioThread;
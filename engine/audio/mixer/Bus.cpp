@@ -1,26 +1,57 @@
 // Ouzel by Elviss Strazdins
 
 #include <algorithm>
+#include <chrono>
 #include "Bus.hpp"
 #include "Data.hpp"
 #include "Processor.hpp"
 #include "Stream.hpp"
-#include "../../math/Scalar.hpp"
+#include "../Dsp.hpp"
 
 namespace ouzel::audio::mixer
 {
+    namespace
+    {
+        constexpr std::uint32_t maxChannels = 6; // the most channels that convert supports
+
+        // connections beyond these counts still work, but allocate on the audio thread
+        constexpr std::size_t reservedInputBuses = 8;
+        constexpr std::size_t reservedInputStreams = 64;
+        constexpr std::size_t reservedProcessors = 8;
+    }
+
+    Bus::Bus(std::uint32_t maxFrames)
+    {
+        mixBuffer.reserve(maxFrames * maxChannels);
+
+        inputBuses.reserve(reservedInputBuses);
+        inputStreams.reserve(reservedInputStreams);
+        processors.reserve(reservedProcessors);
+    }
+
     Bus::~Bus()
     {
+        Bus::detach();
+    }
+
+    void Bus::detach()
+    {
+        Object::detach();
+
         if (output) output->removeInput(this);
+        output = nullptr;
 
         for (auto inputBus : inputBuses)
             inputBus->output = nullptr;
+        inputBuses.clear();
 
         for (auto stream : inputStreams)
             stream->output = nullptr;
+        inputStreams.clear();
 
         for (auto processor : processors)
             processor->bus = nullptr;
+        processors.clear();
     }
 
     void Bus::setOutput(Bus* newOutput)
@@ -30,48 +61,6 @@ namespace ouzel::audio::mixer
         if (output) output->addInput(this);
     }
 
-    static void resample(std::uint32_t channels, std::uint32_t sourceFrames, const std::vector<float>& sourceSamples,
-                         std::uint32_t frames, std::vector<float>& samples)
-    {
-        if (sourceFrames != frames)
-        {
-            const auto sourceIncrement = static_cast<float>(sourceFrames - 1) / static_cast<float>(frames - 1);
-            auto sourcePosition = 0.0F;
-
-            samples.resize(frames * channels);
-
-            for (std::uint32_t frame = 0; frame < frames - 1; ++frame)
-            {
-                const auto sourceCurrentFrame = static_cast<std::uint32_t>(sourcePosition);
-                const auto fraction = sourcePosition - sourceCurrentFrame;
-
-                const std::uint32_t sourceNextFrame = sourceCurrentFrame + 1;
-
-                for (std::uint32_t channel = 0; channel < channels; ++channel)
-                {
-                    const auto sourceChannel = &sourceSamples[channel * sourceFrames];
-                    const auto outputChannel = &samples[channel * frames];
-
-                    outputChannel[frame] = math::lerp(sourceChannel[sourceCurrentFrame],
-                                                      sourceChannel[sourceNextFrame],
-                                                      fraction);
-                }
-
-                sourcePosition += sourceIncrement;
-            }
-
-            // fill the last frame of the destination with the last frame of the source
-            for (std::uint32_t channel = 0; channel < channels; ++channel)
-            {
-                const auto sourceChannel = &sourceSamples[channel * sourceFrames];
-                const auto outputChannel = &samples[channel * frames];
-                outputChannel[frames - 1] = sourceChannel[sourceFrames - 1];
-            }
-        }
-        else
-            samples = sourceSamples;
-    }
-
     static void convert(std::uint32_t frames, std::uint32_t sourceChannels, const std::vector<float>& sourceSamples,
                         std::uint32_t channels, std::vector<float>& samples)
     {
@@ -79,6 +68,19 @@ namespace ouzel::audio::mixer
 
         if (sourceChannels != channels)
         {
+            const auto source = [&sourceSamples, frames](std::uint32_t channel) noexcept {
+                return &sourceSamples[channel * frames];
+            };
+            const auto output = [&samples, frames](std::uint32_t channel) noexcept {
+                return &samples[channel * frames];
+            };
+            const auto copy = [&source, &output, frames](std::uint32_t channel, std::uint32_t sourceChannel) noexcept {
+                std::copy(source(sourceChannel), source(sourceChannel) + frames, output(channel));
+            };
+            const auto clear = [&output, frames](std::uint32_t channel) noexcept {
+                std::fill(output(channel), output(channel) + frames, 0.0F);
+            };
+
             switch (sourceChannels)
             {
                 case 1:
@@ -86,31 +88,22 @@ namespace ouzel::audio::mixer
                     switch (channels)
                     {
                         case 2: // upmix 1 to 2
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[0 * frames + frame] = sourceSamples[frame]; // L = M
-                                samples[1 * frames + frame] = sourceSamples[frame]; // R = M
-                            }
+                            copy(0, 0); // L = M
+                            copy(1, 0); // R = M
                             break;
                         case 4: // upmix 1 to 4
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[0 * frames + frame] = sourceSamples[frame]; // L = M
-                                samples[1 * frames + frame] = sourceSamples[frame]; // R = M
-                                samples[2 * frames + frame] = 0.0F; // SL = 0
-                                samples[3 * frames + frame] = 0.0F; // SR = 0
-                            }
+                            copy(0, 0); // L = M
+                            copy(1, 0); // R = M
+                            clear(2); // SL = 0
+                            clear(3); // SR = 0
                             break;
                         case 6: // upmix 1 to 6
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[0 * frames + frame] = 0.0F; // L = 0
-                                samples[1 * frames + frame] = 0.0F; // R = 0
-                                samples[2 * frames + frame] = sourceSamples[frame]; // C = M
-                                samples[3 * frames + frame] = 0.0F; // LFE = 0
-                                samples[4 * frames + frame] = 0.0F; // SL = 0
-                                samples[5 * frames + frame] = 0.0F; // SR = 0
-                            }
+                            clear(0); // L = 0
+                            clear(1); // R = 0
+                            copy(2, 0); // C = M
+                            clear(3); // LFE = 0
+                            clear(4); // SL = 0
+                            clear(5); // SR = 0
                             break;
                     }
                     break;
@@ -120,29 +113,21 @@ namespace ouzel::audio::mixer
                     switch (channels)
                     {
                         case 1: // downmix 2 to 1
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                                samples[frame] = (sourceSamples[0 * frames + frame] +
-                                                  sourceSamples[1 * frames + frame]) * 0.5F; // M = (L + R) * 0.5
+                            dsp::addPair(output(0), source(0), source(1), 0.5F, frames); // M = (L + R) * 0.5
                             break;
                         case 4: // upmix 2 to 4
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[0 * frames + frame] = sourceSamples[0 * frames + frame]; // L = L
-                                samples[1 * frames + frame] = sourceSamples[1 * frames + frame]; // R = R
-                                samples[2 * frames + frame] = 0.0F; // SL = 0
-                                samples[3 * frames + frame] = 0.0F; // SR = 0
-                            }
+                            copy(0, 0); // L = L
+                            copy(1, 1); // R = R
+                            clear(2); // SL = 0
+                            clear(3); // SR = 0
                             break;
                         case 6: // upmix 2 to 6
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[0 * frames + frame] = sourceSamples[0 * frames + frame]; // L = L
-                                samples[1 * frames + frame] = sourceSamples[1 * frames + frame]; // R = R
-                                samples[2 * frames + frame] = 0.0F; // C = 0
-                                samples[3 * frames + frame] = 0.0F; // LFE = 0
-                                samples[4 * frames + frame] = 0.0F; // SL = 0
-                                samples[5 * frames + frame] = 0.0F; // SR = 0
-                            }
+                            copy(0, 0); // L = L
+                            copy(1, 1); // R = R
+                            clear(2); // C = 0
+                            clear(3); // LFE = 0
+                            clear(4); // SL = 0
+                            clear(5); // SR = 0
                             break;
                     }
                     break;
@@ -152,31 +137,21 @@ namespace ouzel::audio::mixer
                     switch (channels)
                     {
                         case 1: // downmix 4 to 1
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                                samples[frame] = (sourceSamples[0 * frames + frame] +
-                                                  sourceSamples[1 * frames + frame] +
-                                                  sourceSamples[2 * frames + frame] +
-                                                  sourceSamples[3 * frames + frame]) * 0.25F; // M = (L + R + SL + SR) * 0.25
+                            dsp::addPair(output(0), source(0), source(1), 0.25F, frames); // M = (L + R + SL + SR) * 0.25
+                            dsp::addScaled(output(0), source(2), 0.25F, frames);
+                            dsp::addScaled(output(0), source(3), 0.25F, frames);
                             break;
                         case 2: // downmix 4 to 2
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[0 * frames + frame] = (sourceSamples[0 * frames + frame] +
-                                                               sourceSamples[2 * frames + frame]) * 0.5F; // L = (L + SL) * 0.5
-                                samples[1 * frames + frame] = (sourceSamples[1 * frames + frame] +
-                                                               sourceSamples[3 * frames + frame]) * 0.5F; // R = (R + RL) * 0.5
-                            }
+                            dsp::addPair(output(0), source(0), source(2), 0.5F, frames); // L = (L + SL) * 0.5
+                            dsp::addPair(output(1), source(1), source(3), 0.5F, frames); // R = (R + SR) * 0.5
                             break;
                         case 6: // upmix 4 to 6
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[0 * frames + frame] = sourceSamples[0 * frames + frame]; // L = L
-                                samples[1 * frames + frame] = sourceSamples[1 * frames + frame]; // R = R
-                                samples[2 * frames + frame] = 0.0F; // C = 0
-                                samples[3 * frames + frame] = 0.0F; // LFE = 0
-                                samples[4 * frames + frame] = sourceSamples[2 * frames + frame]; // SL = SL
-                                samples[5 * frames + frame] = sourceSamples[3 * frames + frame]; // SR = SR
-                            }
+                            copy(0, 0); // L = L
+                            copy(1, 1); // R = R
+                            clear(2); // C = 0
+                            clear(3); // LFE = 0
+                            copy(4, 2); // SL = SL
+                            copy(5, 3); // SR = SR
                             break;
                     }
                     break;
@@ -186,34 +161,26 @@ namespace ouzel::audio::mixer
                     switch (channels)
                     {
                         case 1: // downmix 6 to 1
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                                samples[frame] = ((sourceSamples[0 * frames + frame] +
-                                                   sourceSamples[1 * frames + frame]) * 0.7071F +
-                                                  sourceSamples[2 * frames + frame] +
-                                                  (sourceSamples[4 * frames + frame] +
-                                                   sourceSamples[5 * frames + frame]) * 0.5F); // M = (L + R) * 0.7071 + C + (SL + SR) * 0.5
+                            dsp::addPair(output(0), source(0), source(1), 0.7071F, frames); // M = (L + R) * 0.7071 + C + (SL + SR) * 0.5
+                            dsp::add(output(0), source(2), frames);
+                            dsp::addScaled(output(0), source(4), 0.5F, frames);
+                            dsp::addScaled(output(0), source(5), 0.5F, frames);
                             break;
                         case 2: // downmix 6 to 2
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[frame * channels + 0] = (sourceSamples[0 * frames + frame] +
-                                                                 (sourceSamples[2 * frames + frame] +
-                                                                  sourceSamples[4 * frames + frame]) * 0.7071F); // L = L + (C + SL) * 0.7071
-                                samples[frame * channels + 1] = (sourceSamples[1 * frames + frame] +
-                                                                 (sourceSamples[2 * frames + frame] +
-                                                                  sourceSamples[5 * frames + frame]) * 0.7071F); // R = R + (C + SR) * 0.7071
-                            }
+                            copy(0, 0); // L = L + (C + SL) * 0.7071
+                            dsp::addScaled(output(0), source(2), 0.7071F, frames);
+                            dsp::addScaled(output(0), source(4), 0.7071F, frames);
+                            copy(1, 1); // R = R + (C + SR) * 0.7071
+                            dsp::addScaled(output(1), source(2), 0.7071F, frames);
+                            dsp::addScaled(output(1), source(5), 0.7071F, frames);
                             break;
                         case 4: // downmix 6 to 4
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[frame * channels + 0] = (sourceSamples[0 * frames + frame] +
-                                                                 sourceSamples[2 * frames + frame] * 0.7071F); // L = L + C * 0.7071
-                                samples[frame * channels + 1] = (sourceSamples[1 * frames + frame] +
-                                                                 sourceSamples[2 * frames + frame] * 0.7071F); // R = R + C * 0.7071
-                                samples[frame * channels + 2] = sourceSamples[4 * frames + frame]; // SL = SL
-                                samples[frame * channels + 3] = sourceSamples[5 * frames + frame]; // SR = SR
-                            }
+                            copy(0, 0); // L = L + C * 0.7071
+                            dsp::addScaled(output(0), source(2), 0.7071F, frames);
+                            copy(1, 1); // R = R + C * 0.7071
+                            dsp::addScaled(output(1), source(2), 0.7071F, frames);
+                            copy(2, 4); // SL = SL
+                            copy(3, 5); // SR = SR
                             break;
                     }
                     break;
@@ -224,51 +191,97 @@ namespace ouzel::audio::mixer
             samples = sourceSamples;
     }
 
-    void Bus::generateSamples(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
-                              const math::Vector<float, 3>& listenerPosition, const math::Quaternion<float>& listenerRotation,
-                              std::vector<float>& samples)
+    void Bus::renderStream(Stream& stream, std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate)
     {
-        samples.resize(frames * channels);
-        std::fill(samples.begin(), samples.end(), 0.0F);
+        // the stream that has just become virtual is rendered once more to fade it out
+        stream.rendered = stream.isPlaying() && (!stream.isVirtual() || stream.fade == Stream::Fade::out);
 
-        for (auto bus : inputBuses)
+        const std::uint32_t sourceSampleRate = stream.getData().getSampleRate();
+        const std::uint32_t sourceChannels = stream.getData().getChannels();
+
+        if (!stream.rendered)
         {
-            bus->generateSamples(frames, channels, sampleRate,
-                                 listenerPosition, listenerRotation, buffer);
+            if (stream.isPlaying())
+            {
+                // virtual streams keep their position, the resampler starts from silence when they become real again
+                const auto sourceFrames = static_cast<std::uint32_t>((static_cast<std::uint64_t>(frames) * sourceSampleRate + sampleRate / 2) / sampleRate);
+                stream.skipSamples(sourceFrames);
+                stream.resampler.reset();
+            }
+            stream.fade = Stream::Fade::none;
+            return;
+        }
 
-            for (std::size_t s = 0; s < samples.size(); ++s)
-                samples[s] += buffer[s];
+        // the samples are produced directly in the output if no conversion is needed
+        auto& convertBuffer = (sourceChannels != channels) ? stream.mixBuffer : stream.outputBuffer;
+
+        if (sourceSampleRate != sampleRate)
+        {
+            const auto sourceFrames = stream.resampler.getSourceFrames(frames);
+            stream.generateSamples(sourceFrames, stream.resampleBuffer);
+            stream.resampler.process(sourceFrames, stream.resampleBuffer, frames, convertBuffer);
         }
+        else
+            stream.generateSamples(frames, convertBuffer);
 
-        for (auto stream : inputStreams)
+        if (sourceChannels != channels)
+            convert(frames, sourceChannels, stream.mixBuffer, channels, stream.outputBuffer);
+
+        if (stream.fade != Stream::Fade::none)
         {
-            if (stream->isPlaying())
+            // the changes between real and virtual are faded, so that they do not click
+            const auto startGain = (stream.fade == Stream::Fade::in) ? 0.0F : stream.gain;
+            const auto endGain = (stream.fade == Stream::Fade::in) ? stream.gain : 0.0F;
+            for (std::uint32_t channel = 0; channel < channels; ++channel)
             {
-                const std::uint32_t sourceSampleRate = stream->getData().getSampleRate();
-                const std::uint32_t sourceChannels = stream->getData().getChannels();
+                const auto output = stream.outputBuffer.data() + channel * frames;
+                dsp::scaleRamp(output, output, startGain, endGain, frames);
+            }
+            stream.fade = Stream::Fade::none;
+        }
+        else if (stream.gain != 1.0F)
+            dsp::scale(stream.outputBuffer.data(), stream.outputBuffer.data(), stream.gain, stream.outputBuffer.size());
+    }
+
+    void Bus::mix(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate, bool profile)
+    {
+        mixBuffer.resize(frames * channels);
+        std::fill(mixBuffer.begin(), mixBuffer.end(), 0.0F);
 
-                if (sourceSampleRate != sampleRate)
+        // the input buses and streams have been rendered before this bus
+        for (auto bus : inputBuses)
+            dsp::add(mixBuffer.data(), bus->mixBuffer.data(), mixBuffer.size());
+
+        for (auto stream : inputStreams)
+            if (stream->rendered)
+                dsp::add(mixBuffer.data(), stream->outputBuffer.data(), mixBuffer.size());
+
+        for (auto processor : processors)
+            if (processor->isEnabled())
+            {
+                if (profile)
                 {
-                    std::uint32_t sourceFrames = (frames * sourceSampleRate + sampleRate - 1) / sampleRate; // round up
-                    stream->generateSamples(sourceFrames, resampleBuffer);
-                    resample(sourceChannels, sourceFrames, resampleBuffer, frames, mixBuffer);
+                    const auto start = std::chrono::steady_clock::now();
+                    processor->process(frames, channels, sampleRate, mixBuffer);
+                    processor->addProcessingTime(std::chrono::steady_clock::now() - start);
                 }
                 else
-                    stream->generateSamples(frames, mixBuffer);
-
-                if (sourceChannels != channels)
-                    convert(frames, sourceChannels, mixBuffer, channels, buffer);
-                else
-                    buffer = mixBuffer;
-
-                for (std::size_t s = 0; s < samples.size(); ++s)
-                    samples[s] += buffer[s];
+                    processor->process(frames, channels, sampleRate, mixBuffer);
             }
-        }
+    }
+
+    void Bus::updateListener(const math::Vector<float, 3>& listenerPosition,
+                             const math::Quaternion<float>& listenerRotation) noexcept
+    {
+        audibility = output ? output->audibility : 1.0F;
 
         for (auto processor : processors)
+        {
+            processor->setListener(listenerPosition, listenerRotation);
+
             if (processor->isEnabled())
-                processor->process(frames, channels, sampleRate, samples);
+                audibility *= processor->getAttenuation(listenerPosition);
+        }
     }
 
     void Bus::addProcessor(Processor* processor)
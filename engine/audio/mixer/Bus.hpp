@@ -3,8 +3,11 @@
 #ifndef OUZEL_AUDIO_MIXER_BUS_HPP
 #define OUZEL_AUDIO_MIXER_BUS_HPP
 
+#include <cstdint>
 #include <vector>
 #include "Object.hpp"
+#include "../../math/Quaternion.hpp"
+#include "../../math/Vector.hpp"
 
 namespace ouzel::audio::mixer
 {
@@ -16,7 +19,7 @@ namespace ouzel::audio::mixer
         friend Processor;
         friend Stream;
     public:
-        Bus() noexcept {}
+        explicit Bus(std::uint32_t maxFrames);
         ~Bus() override;
         Bus(const Bus&) = delete;
         Bus& operator=(const Bus&) = delete;
@@ -24,11 +27,27 @@ namespace ouzel::audio::mixer
         Bus(Bus&&) = delete;
         Bus& operator=(Bus&&) = delete;
 
+        void detach() override;
+
         void setOutput(Bus* newOutput);
 
-        void generateSamples(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
-                             const math::Vector<float, 3>& listenerPosition, const math::Quaternion<float>& listenerRotation,
-                             std::vector<float>& samples);
+        auto& getMixBuffer() const noexcept { return mixBuffer; }
+        auto& getInputBuses() const noexcept { return inputBuses; }
+        auto& getInputStreams() const noexcept { return inputStreams; }
+
+        // the product of the attenuations of the processors of this bus and the buses after it
+        auto getAudibility() const noexcept { return audibility; }
+
+        // passes the listener to the processors and updates the audibility, called once per block
+        void updateListener(const math::Vector<float, 3>& listenerPosition,
+                            const math::Quaternion<float>& listenerRotation) noexcept;
+
+        // renders a playing stream into its output buffer, converted to the format of the bus
+        static void renderStream(Stream& stream, std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate);
+
+        // sums the outputs of the inputs, which must have been rendered already, and runs the processors,
+        // the processing time of the processors is measured if profile is true
+        void mix(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate, bool profile);
 
         void addProcessor(Processor* processor);
         void removeProcessor(Processor* processor);
@@ -44,9 +63,8 @@ namespace ouzel::audio::mixer
         std::vector<Stream*> inputStreams;
         std::vector<Processor*> processors;
 
-        std::vector<float> resampleBuffer;
-        std::vector<float> mixBuffer;
-        std::vector<float> buffer;
+        std::vector<float> mixBuffer; // reserved in the constructor, so that mixing does not allocate
+        float audibility = 1.0F;
     };
 }
 
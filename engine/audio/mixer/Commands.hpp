@@ -6,11 +6,17 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "Bus.hpp"
+#include "Object.hpp"
 #include "Processor.hpp"
 #include "Source.hpp"
 #include "Stream.hpp"
 #include "Data.hpp"
+#include "../../math/Quaternion.hpp"
+#include "../../math/Vector.hpp"
 
 namespace ouzel::audio::mixer
 {
@@ -36,9 +42,17 @@ namespace ouzel::audio::mixer
             playStream,
             stopStream,
             setStreamOutput,
+            setStreamGain,
+            setStreamPriority,
+            setStreamPosition,
+            setListenerPosition,
+            setListenerRotation,
             initData,
             initProcessor,
-            updateProcessor
+            updateProcessor,
+            setProcessorParameter,
+            setProcessorPosition,
+            resizeObjects
         };
 
         explicit constexpr Command(Type initType) noexcept: type{initType} {}
@@ -47,34 +61,37 @@ namespace ouzel::audio::mixer
         const Type type;
     };
 
+    // objects are created by the commands on the game thread, so the audio thread does not allocate
     class InitObjectCommand final: public Command
     {
     public:
-        explicit constexpr InitObjectCommand(ObjectId initObjectId) noexcept:
+        explicit InitObjectCommand(ObjectId initObjectId):
             Command{Command::Type::initObject},
-            objectId{initObjectId}
+            objectId{initObjectId},
+            object{std::make_unique<Object>()}
         {}
 
         InitObjectCommand(ObjectId initObjectId,
-                          std::unique_ptr<Source> initSource) noexcept:
+                          std::unique_ptr<Source> initSource):
             Command{Command::Type::initObject},
             objectId{initObjectId},
-            source{std::move(initSource)}
+            object{std::make_unique<Object>(std::move(initSource))}
         {}
 
         const ObjectId objectId;
-        std::unique_ptr<Source> source;
+        std::unique_ptr<Object> object;
     };
 
     class DeleteObjectCommand final: public Command
     {
     public:
-        explicit constexpr DeleteObjectCommand(ObjectId initObjectId) noexcept:
+        explicit DeleteObjectCommand(ObjectId initObjectId) noexcept:
             Command{Command::Type::deleteObject},
             objectId{initObjectId}
         {}
 
         const ObjectId objectId;
+        std::unique_ptr<Object> object; // set by the mixer and destroyed with the command on the game thread
     };
 
     class AddChildCommand final: public Command
@@ -133,12 +150,15 @@ namespace ouzel::audio::mixer
     class InitBusCommand final: public Command
     {
     public:
-        explicit constexpr InitBusCommand(ObjectId initBusId) noexcept:
+        InitBusCommand(ObjectId initBusId,
+                       std::unique_ptr<Bus> initBus) noexcept:
             Command{Command::Type::initBus},
-            busId{initBusId}
+            busId{initBusId},
+            bus{std::move(initBus)}
         {}
 
         const ObjectId busId;
+        std::unique_ptr<Bus> bus;
     };
 
     class SetBusOutputCommand final: public Command
@@ -197,15 +217,15 @@ namespace ouzel::audio::mixer
     class InitStreamCommand final: public Command
     {
     public:
-        constexpr InitStreamCommand(ObjectId initStreamId,
-                                    ObjectId initDataId) noexcept:
+        InitStreamCommand(ObjectId initStreamId,
+                          std::unique_ptr<Stream> initStream) noexcept:
             Command{Command::Type::initStream},
             streamId{initStreamId},
-            dataId{initDataId}
+            stream{std::move(initStream)}
         {}
 
         const ObjectId streamId;
-        const ObjectId dataId;
+        std::unique_ptr<Stream> stream;
     };
 
     class PlayStreamCommand final: public Command
@@ -247,6 +267,70 @@ namespace ouzel::audio::mixer
         const ObjectId busId;
     };
 
+    class SetStreamGainCommand final: public Command
+    {
+    public:
+        constexpr SetStreamGainCommand(ObjectId initStreamId,
+                                       float initGain) noexcept:
+            Command{Command::Type::setStreamGain},
+            streamId{initStreamId},
+            gain{initGain}
+        {}
+
+        const ObjectId streamId;
+        const float gain;
+    };
+
+    class SetStreamPriorityCommand final: public Command
+    {
+    public:
+        constexpr SetStreamPriorityCommand(ObjectId initStreamId,
+                                           std::int32_t initPriority) noexcept:
+            Command{Command::Type::setStreamPriority},
+            streamId{initStreamId},
+            priority{initPriority}
+        {}
+
+        const ObjectId streamId;
+        const std::int32_t priority;
+    };
+
+    class SetStreamPositionCommand final: public Command
+    {
+    public:
+        SetStreamPositionCommand(ObjectId initStreamId,
+                                 const math::Vector<float, 3>& initPosition) noexcept:
+            Command{Command::Type::setStreamPosition},
+            streamId{initStreamId},
+            position{initPosition}
+        {}
+
+        const ObjectId streamId;
+        const math::Vector<float, 3> position;
+    };
+
+    class SetListenerPositionCommand final: public Command
+    {
+    public:
+        explicit SetListenerPositionCommand(const math::Vector<float, 3>& initPosition) noexcept:
+            Command{Command::Type::setListenerPosition},
+            position{initPosition}
+        {}
+
+        const math::Vector<float, 3> position;
+    };
+
+    class SetListenerRotationCommand final: public Command
+    {
+    public:
+        explicit SetListenerRotationCommand(const math::Quaternion<float>& initRotation) noexcept:
+            Command{Command::Type::setListenerRotation},
+            rotation{initRotation}
+        {}
+
+        const math::Quaternion<float> rotation;
+    };
+
     class InitDataCommand final: public Command
     {
     public:
@@ -289,6 +373,61 @@ namespace ouzel::audio::mixer
         const std::function<void(Processor*)> updateFunction;
     };
 
+    // sets a numeric parameter of the processor without allocating an update function
+    class SetProcessorParameterCommand final: public Command
+    {
+    public:
+        SetProcessorParameterCommand(ObjectId initProcessorId,
+                                     std::uint32_t initParameter,
+                                     float initValue) noexcept:
+            Command{Command::Type::setProcessorParameter},
+            processorId{initProcessorId},
+            parameter{initParameter},
+            value{initValue}
+        {}
+
+        const ObjectId processorId;
+        const std::uint32_t parameter;
+        const float value;
+    };
+
+    // moves a positional processor, sent by the emitters whenever their actor moves
+    class SetProcessorPositionCommand final: public Command
+    {
+    public:
+        SetProcessorPositionCommand(ObjectId initProcessorId,
+                                    const math::Vector<float, 3>& initPosition) noexcept:
+            Command{Command::Type::setProcessorPosition},
+            processorId{initProcessorId},
+            position{initPosition}
+        {}
+
+        const ObjectId processorId;
+        const math::Vector<float, 3> position;
+    };
+
+    // grows the object table of the mixer, the old table is returned in the command
+    // the graph can not hold more objects than the table, so it is preallocated together with it
+    class ResizeObjectsCommand final: public Command
+    {
+    public:
+        explicit ResizeObjectsCommand(std::size_t size):
+            Command{Command::Type::resizeObjects},
+            objects(size)
+        {
+            graphStreams.reserve(size);
+            graphBuses.reserve(size);
+            graphLevelEnds.reserve(size);
+            voices.reserve(size);
+        }
+
+        std::vector<std::unique_ptr<Object>> objects;
+        std::vector<Stream*> graphStreams;
+        std::vector<std::pair<std::size_t, Bus*>> graphBuses;
+        std::vector<std::size_t> graphLevelEnds;
+        std::vector<std::pair<float, Stream*>> voices;
+    };
+
     class CommandBuffer final
     {
     public:
@@ -304,24 +443,18 @@ namespace ouzel::audio::mixer
 
         void pushCommand(std::unique_ptr<Command> command)
         {
-            commands.push(std::move(command));
-        }
-
-        std::unique_ptr<Command> popCommand()
-        {
-            auto result = std::move(commands.front());
-            commands.pop();
-            return result;
+            commands.push_back(std::move(command));
         }
 
-        auto& getCommands() const
+        // the commands are not removed by the mixer, so that they are destroyed on the game thread
+        auto& getCommands() const noexcept
         {
             return commands;
         }
 
     private:
         std::string name;
-        std::queue<std::unique_ptr<Command>> commands;
+        std::vector<std::unique_ptr<Command>> commands;
     };
 }
 
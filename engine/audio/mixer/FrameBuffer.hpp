@@ -0,0 +1,92 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_AUDIO_MIXER_FRAMEBUFFER_HPP
+#define OUZEL_AUDIO_MIXER_FRAMEBUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ouzel::audio::mixer
+{
+    // Wait-free ring of interleaved frames for one writer and one reader thread,
+    // the positions count all the frames that have passed through the ring
+    class FrameBuffer final
+    {
+    public:
+        FrameBuffer(std::size_t size, std::uint32_t initChannels):
+            maxFrames{size},
+            channels{initChannels},
+            buffer(size * channels)
+        {
+        }
+
+        FrameBuffer(const FrameBuffer&) = delete;
+        FrameBuffer& operator=(const FrameBuffer&) = delete;
+        FrameBuffer(FrameBuffer&&) = delete;
+        FrameBuffer& operator=(FrameBuffer&&) = delete;
+
+        auto getCapacity() const noexcept { return maxFrames; }
+
+        // must be called only by the reader
+        std::size_t getReadableFrames() const noexcept
+        {
+            return writePosition.load(std::memory_order_acquire) - readPosition.load(std::memory_order_relaxed);
+        }
+
+        // must be called only by the writer
+        std::size_t getWritableFrames() const noexcept
+        {
+            return maxFrames - (writePosition.load(std::memory_order_relaxed) - readPosition.load(std::memory_order_acquire));
+        }
+
+        std::size_t getReadPosition() const noexcept { return readPosition.load(std::memory_order_acquire); }
+        std::size_t getWritePosition() const noexcept { return writePosition.load(std::memory_order_acquire); }
+
+        // writes the frames from planar samples with the given distance between the channels, must be called only by the writer
+        void write(const std::vector<float>& samples, std::size_t frames, std::size_t stride) noexcept
+        {
+            const auto position = writePosition.load(std::memory_order_relaxed);
+
+            for (std::size_t frame = 0; frame < frames; ++frame)
+            {
+                const auto offset = ((position + frame) % maxFrames) * channels;
+                for (std::uint32_t channel = 0; channel < channels; ++channel)
+                    buffer[offset + channel] = samples[channel * stride + frame];
+            }
+
+            writePosition.store(position + frames, std::memory_order_release);
+        }
+
+        // reads the frames into planar samples with the given distance between the channels, must be called only by the reader
+        void read(std::vector<float>& samples, std::size_t frames, std::size_t stride) noexcept
+        {
+            const auto position = readPosition.load(std::memory_order_relaxed);
+
+            for (std::size_t frame = 0; frame < frames; ++frame)
+            {
+                const auto offset = ((position + frame) % maxFrames) * channels;
+                for (std::uint32_t channel = 0; channel < channels; ++channel)
+                    samples[channel * stride + frame] = buffer[offset + channel];
+            }
+
+            readPosition.store(position + frames, std::memory_order_release);
+        }
+
+        // drops the frames without reading them, must be called only by the reader
+        void skip(std::size_t frames) noexcept
+        {
+            readPosition.fetch_add(frames, std::memory_order_release);
+        }
+
+    private:
+        std::size_t maxFrames;
+        std::uint32_t channels;
+        std::vector<float> buffer;
+        alignas(64) std::atomic<std::size_t> readPosition{0};
+        alignas(64) std::atomic<std::size_t> writePosition{0};
+    };
+}
+
+#endif // OUZEL_AUDIO_MIXER_FRAMEBUFFER_HPP
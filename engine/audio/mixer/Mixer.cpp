@@ -6,246 +6,472 @@
 #include "Data.hpp"
 #include "MixerError.hpp"
 #include "Stream.hpp"
-#include "../../math/Scalar.hpp"
+#include "../Dsp.hpp"
 
 namespace ouzel::audio::mixer
 {
+    namespace
+    {
+        constexpr std::size_t maxRenderThreads = 3;
+
+        std::size_t getRenderThreadCount() noexcept
+        {
+            return std::min(static_cast<std::size_t>(std::max(std::thread::hardware_concurrency(), 2U) - 1), maxRenderThreads);
+        }
+    }
+
     Mixer::Mixer(std::uint32_t initBufferSize,
-                 std::uint32_t initChannels):
+                 std::uint32_t initChannels,
+                 std::uint32_t initSampleRate,
+                 std::uint32_t initBufferCount,
+                 std::uint32_t initMaxVoices,
+                 bool initOffline):
         bufferSize{initBufferSize},
         channels{initChannels},
-        mixerThread{&Mixer::mixerMain, this},
-        buffer{initBufferSize * 3, initChannels}
+        sampleRate{initSampleRate},
+        offline{initOffline},
+        renderPool{getRenderThreadCount()},
+        voiceManager{initMaxVoices},
+        buffer{static_cast<std::size_t>(initBufferSize) * std::max(initBufferCount, 2U), initChannels},
+        renderBuffer(static_cast<std::size_t>(initBufferSize) * initChannels)
     {
-        //mixerThread.setPriority(20.0F, true);
-
         rootObjectId = getObjectId();
-        objects.resize(rootObjectId);
+        objectCapacity = rootObjectId;
+        objects.resize(objectCapacity);
         auto object = std::make_unique<RootObject>();
         rootObject = object.get();
         objects[rootObjectId - 1] = std::move(object);
+
+        // started after all the members have been initialized
+        if (!offline)
+            mixerThread = thread::Thread{&Mixer::mixerMain, this};
+        //mixerThread.setPriority(20.0F, true);
     }
 
     Mixer::~Mixer()
     {
+        running = false;
+        renderSemaphore.release();
+
         if (mixerThread.isJoinable())
             mixerThread.join();
     }
 
+    void Mixer::submitCommandBuffer(CommandBuffer&& commandBuffer)
+    {
+        retireCommandBuffers();
+
+        if (lastObjectId > objectCapacity)
+        {
+            objectCapacity = std::max(lastObjectId, objectCapacity * 2);
+
+            auto resizeCommandBuffer = std::make_unique<CommandBuffer>();
+            resizeCommandBuffer->pushCommand(std::make_unique<ResizeObjectsCommand>(objectCapacity));
+            pendingCommandBuffers.push(std::move(resizeCommandBuffer));
+        }
+
+        if (!commandBuffer.isEmpty())
+            pendingCommandBuffers.push(std::make_unique<CommandBuffer>(std::move(commandBuffer)));
+
+        // the retired queue has the same capacity, so the audio thread can always return the buffers
+        while (!pendingCommandBuffers.empty() &&
+               commandBuffersInFlight < commandQueue.getCapacity() &&
+               commandQueue.push(std::move(pendingCommandBuffers.front())))
+        {
+            pendingCommandBuffers.pop();
+            ++commandBuffersInFlight;
+        }
+
+        renderSemaphore.release();
+    }
+
+    void Mixer::retireCommandBuffers()
+    {
+        std::unique_ptr<CommandBuffer> commandBuffer;
+        while (retiredCommandQueue.pop(commandBuffer))
+        {
+            commandBuffer.reset();
+            --commandBuffersInFlight;
+        }
+    }
+
+    // executed on the mixer thread, must not lock or allocate
     void Mixer::process()
     {
-        CommandBuffer commandBuffer;
-        std::unique_ptr<Command> command;
+        std::unique_ptr<CommandBuffer> commandBuffer;
 
-        for (;;)
+        while (commandQueue.pop(commandBuffer))
         {
-            std::unique_lock lock{commandQueueMutex};
-            if (commandQueue.empty()) break;
-            commandBuffer = std::move(commandQueue.front());
-            commandQueue.pop();
-            lock.unlock();
+            for (const auto& command : commandBuffer->getCommands())
+                executeCommand(*command);
 
-            while (!commandBuffer.isEmpty())
+            retiredCommandQueue.push(std::move(commandBuffer));
+        }
+    }
+
+    void Mixer::executeCommand(Command& command)
+    {
+        switch (command.type)
+        {
+            case Command::Type::initObject:
+            {
+                const auto initObjectCommand = static_cast<InitObjectCommand*>(&command);
+                objects[initObjectCommand->objectId - 1] = std::move(initObjectCommand->object);
+                break;
+            }
+            case Command::Type::deleteObject:
             {
-                command = commandBuffer.popCommand();
+                const auto deleteObjectCommand = static_cast<DeleteObjectCommand*>(&command);
+                auto& object = objects[deleteObjectCommand->objectId - 1];
 
-                switch (command->type)
+                if (object)
                 {
-                    case Command::Type::initObject:
-                    {
-                        const auto initObjectCommand = static_cast<InitObjectCommand*>(command.get());
-                        objects[initObjectCommand->objectId - 1] = std::make_unique<Object>(std::move(initObjectCommand->source));
-                        break;
-                    }
-                    case Command::Type::deleteObject:
-                    {
-                        const auto deleteObjectCommand = static_cast<const DeleteObjectCommand*>(command.get());
-                        objects[deleteObjectCommand->objectId - 1].reset();
-                        break;
-                    }
-                    case Command::Type::addChild:
-                    {
-                        const auto addChildCommand = static_cast<const AddChildCommand*>(command.get());
-                        const auto object = objects[addChildCommand->objectId - 1].get();
-                        const auto child = objects[addChildCommand->objectId - 1].get();
-                        object->addChild(*child);
-                        break;
-                    }
-                    case Command::Type::removeChild:
-                    {
-                        const auto removeChildCommand = static_cast<const RemoveChildCommand*>(command.get());
-                        const auto object = objects[removeChildCommand->objectId - 1].get();
-                        const auto child = objects[removeChildCommand->objectId - 1].get();
-                        object->removeChild(*child);
-                        break;
-                    }
-                    case Command::Type::play:
-                    {
-                        const auto playCommand = static_cast<const PlayCommand*>(command.get());
-                        const auto object = objects[playCommand->objectId - 1].get();
-                        object->play();
-                        break;
-                    }
-                    case Command::Type::stop:
-                    {
-                        const auto stopCommand = static_cast<const StopCommand*>(command.get());
-                        const auto object = objects[stopCommand->objectId - 1].get();
-                        object->stop(stopCommand->reset);
-                        break;
-                    }
-                    case Command::Type::initBus:
-                    {
-                        const auto initBusCommand = static_cast<const InitBusCommand*>(command.get());
-
-                        if (initBusCommand->busId > objects.size())
-                            objects.resize(initBusCommand->busId);
-
-                        objects[initBusCommand->busId - 1] = std::make_unique<Bus>();
-                        break;
-                    }
-                    case Command::Type::setBusOutput:
-                    {
-                        const auto setBusOutputCommand = static_cast<const SetBusOutputCommand*>(command.get());
-
-                        const auto bus = static_cast<Bus*>(objects[setBusOutputCommand->busId - 1].get());
-                        bus->setOutput(setBusOutputCommand->outputBusId ? static_cast<Bus*>(objects[setBusOutputCommand->outputBusId - 1].get()) : nullptr);
-                        break;
-                    }
-                    case Command::Type::addProcessor:
-                    {
-                        const auto addProcessorCommand = static_cast<const AddProcessorCommand*>(command.get());
-
-                        const auto bus = static_cast<Bus*>(objects[addProcessorCommand->busId - 1].get());
-                        const auto processor = static_cast<Processor*>(objects[addProcessorCommand->processorId - 1].get());
-                        bus->addProcessor(processor);
-                        break;
-                    }
-                    case Command::Type::removeProcessor:
-                    {
-                        const auto removeProcessorCommand = static_cast<const RemoveProcessorCommand*>(command.get());
-
-                        const auto bus = static_cast<Bus*>(objects[removeProcessorCommand->busId - 1].get());
-                        const auto processor = static_cast<Processor*>(objects[removeProcessorCommand->processorId - 1].get());
-                        bus->removeProcessor(processor);
-                        break;
-                    }
-                    case Command::Type::setMasterBus:
-                    {
-                        const auto setMasterBusCommand = static_cast<const SetMasterBusCommand*>(command.get());
-
-                        masterBus = setMasterBusCommand->busId ? static_cast<Bus*>(objects[setMasterBusCommand->busId - 1].get()) : nullptr;
-                        break;
-                    }
-                    case Command::Type::initStream:
-                    {
-                        const auto initStreamCommand = static_cast<const InitStreamCommand*>(command.get());
-
-                        if (initStreamCommand->streamId > objects.size())
-                            objects.resize(initStreamCommand->streamId);
-
-                        const auto data = static_cast<Data*>(objects[initStreamCommand->dataId - 1].get());
-                        objects[initStreamCommand->streamId - 1] = data->createStream();
-                        break;
-                    }
-                    case Command::Type::playStream:
-                    {
-                        const auto playStreamCommand = static_cast<const PlayStreamCommand*>(command.get());
-
-                        const auto stream = static_cast<Stream*>(objects[playStreamCommand->streamId - 1].get());
-                        stream->play();
-                        break;
-                    }
-                    case Command::Type::stopStream:
-                    {
-                        const auto stopStreamCommand = static_cast<const StopStreamCommand*>(command.get());
-
-                        const auto stream = static_cast<Stream*>(objects[stopStreamCommand->streamId - 1].get());
-                        stream->stop(stopStreamCommand->reset);
-                        break;
-                    }
-                    case Command::Type::setStreamOutput:
-                    {
-                        const auto setStreamOutputCommand = static_cast<const SetStreamOutputCommand*>(command.get());
-
-                        const auto stream = static_cast<Stream*>(objects[setStreamOutputCommand->streamId - 1].get());
-                        stream->setOutput(setStreamOutputCommand->busId ? static_cast<Bus*>(objects[setStreamOutputCommand->busId - 1].get()) : nullptr);
-                        break;
-                    }
-                    case Command::Type::initData:
-                    {
-                        const auto initDataCommand = static_cast<InitDataCommand*>(command.get());
-
-                        if (initDataCommand->dataId > objects.size())
-                            objects.resize(initDataCommand->dataId);
-
-                        objects[initDataCommand->dataId - 1] = std::move(initDataCommand->data);
-                        break;
-                    }
-                    case Command::Type::initProcessor:
-                    {
-                        const auto initProcessorCommand = static_cast<InitProcessorCommand*>(command.get());
-
-                        if (initProcessorCommand->processorId > objects.size())
-                            objects.resize(initProcessorCommand->processorId);
-
-                        objects[initProcessorCommand->processorId - 1] = std::move(initProcessorCommand->processor);
-                        break;
-                    }
-                    case Command::Type::updateProcessor:
-                    {
-                        const auto updateProcessorCommand = static_cast<const UpdateProcessorCommand*>(command.get());
-
-                        const auto processor = static_cast<Processor*>(objects[updateProcessorCommand->processorId - 1].get());
-                        updateProcessorCommand->updateFunction(processor);
-                        break;
-                    }
-                    default:
-                        throw Error{"Invalid command"};
+                    if (object.get() == masterBus) masterBus = nullptr;
+                    object->detach();
                 }
+
+                // the object is destroyed together with the command on the game thread
+                deleteObjectCommand->object = std::move(object);
+                graphDirty = true;
+                break;
             }
+            case Command::Type::addChild:
+            {
+                const auto addChildCommand = static_cast<const AddChildCommand*>(&command);
+                const auto object = objects[addChildCommand->objectId - 1].get();
+                const auto child = objects[addChildCommand->objectId - 1].get();
+                object->addChild(*child);
+                break;
+            }
+            case Command::Type::removeChild:
+            {
+                const auto removeChildCommand = static_cast<const RemoveChildCommand*>(&command);
+                const auto object = objects[removeChildCommand->objectId - 1].get();
+                const auto child = objects[removeChildCommand->objectId - 1].get();
+                object->removeChild(*child);
+                break;
+            }
+            case Command::Type::play:
+            {
+                const auto playCommand = static_cast<const PlayCommand*>(&command);
+                const auto object = objects[playCommand->objectId - 1].get();
+                object->play();
+                break;
+            }
+            case Command::Type::stop:
+            {
+                const auto stopCommand = static_cast<const StopCommand*>(&command);
+                const auto object = objects[stopCommand->objectId - 1].get();
+                object->stop(stopCommand->reset);
+                break;
+            }
+            case Command::Type::initBus:
+            {
+                const auto initBusCommand = static_cast<InitBusCommand*>(&command);
+                objects[initBusCommand->busId - 1] = std::move(initBusCommand->bus);
+                break;
+            }
+            case Command::Type::setBusOutput:
+            {
+                const auto setBusOutputCommand = static_cast<const SetBusOutputCommand*>(&command);
+
+                const auto bus = static_cast<Bus*>(objects[setBusOutputCommand->busId - 1].get());
+                bus->setOutput(setBusOutputCommand->outputBusId ? static_cast<Bus*>(objects[setBusOutputCommand->outputBusId - 1].get()) : nullptr);
+                graphDirty = true;
+                break;
+            }
+            case Command::Type::addProcessor:
+            {
+                const auto addProcessorCommand = static_cast<const AddProcessorCommand*>(&command);
+
+                const auto bus = static_cast<Bus*>(objects[addProcessorCommand->busId - 1].get());
+                const auto processor = static_cast<Processor*>(objects[addProcessorCommand->processorId - 1].get());
+                bus->addProcessor(processor);
+                break;
+            }
+            case Command::Type::removeProcessor:
+            {
+                const auto removeProcessorCommand = static_cast<const RemoveProcessorCommand*>(&command);
+
+                const auto bus = static_cast<Bus*>(objects[removeProcessorCommand->busId - 1].get());
+                const auto processor = static_cast<Processor*>(objects[removeProcessorCommand->processorId - 1].get());
+                bus->removeProcessor(processor);
+                break;
+            }
+            case Command::Type::setMasterBus:
+            {
+                const auto setMasterBusCommand = static_cast<const SetMasterBusCommand*>(&command);
+
+                masterBus = setMasterBusCommand->busId ? static_cast<Bus*>(objects[setMasterBusCommand->busId - 1].get()) : nullptr;
+                graphDirty = true;
+                break;
+            }
+            case Command::Type::initStream:
+            {
+                const auto initStreamCommand = static_cast<InitStreamCommand*>(&command);
+                objects[initStreamCommand->streamId - 1] = std::move(initStreamCommand->stream);
+                break;
+            }
+            case Command::Type::playStream:
+            {
+                const auto playStreamCommand = static_cast<const PlayStreamCommand*>(&command);
+
+                const auto stream = static_cast<Stream*>(objects[playStreamCommand->streamId - 1].get());
+                stream->play();
+                break;
+            }
+            case Command::Type::stopStream:
+            {
+                const auto stopStreamCommand = static_cast<const StopStreamCommand*>(&command);
+
+                const auto stream = static_cast<Stream*>(objects[stopStreamCommand->streamId - 1].get());
+                stream->stop(stopStreamCommand->reset);
+                break;
+            }
+            case Command::Type::setStreamOutput:
+            {
+                const auto setStreamOutputCommand = static_cast<const SetStreamOutputCommand*>(&command);
+
+                const auto stream = static_cast<Stream*>(objects[setStreamOutputCommand->streamId - 1].get());
+                stream->setOutput(setStreamOutputCommand->busId ? static_cast<Bus*>(objects[setStreamOutputCommand->busId - 1].get()) : nullptr);
+                graphDirty = true;
+                break;
+            }
+            case Command::Type::setStreamGain:
+            {
+                const auto setStreamGainCommand = static_cast<const SetStreamGainCommand*>(&command);
+
+                const auto stream = static_cast<Stream*>(objects[setStreamGainCommand->streamId - 1].get());
+                stream->setGain(setStreamGainCommand->gain);
+                break;
+            }
+            case Command::Type::setStreamPriority:
+            {
+                const auto setStreamPriorityCommand = static_cast<const SetStreamPriorityCommand*>(&command);
+
+                const auto stream = static_cast<Stream*>(objects[setStreamPriorityCommand->streamId - 1].get());
+                stream->setPriority(setStreamPriorityCommand->priority);
+                break;
+            }
+            case Command::Type::setStreamPosition:
+            {
+                const auto setStreamPositionCommand = static_cast<const SetStreamPositionCommand*>(&command);
+
+                const auto stream = static_cast<Stream*>(objects[setStreamPositionCommand->streamId - 1].get());
+                stream->setPosition(setStreamPositionCommand->position);
+                break;
+            }
+            case Command::Type::setListenerPosition:
+            {
+                const auto setListenerPositionCommand = static_cast<const SetListenerPositionCommand*>(&command);
+                listenerPosition = setListenerPositionCommand->position;
+                break;
+            }
+            case Command::Type::setListenerRotation:
+            {
+                const auto setListenerRotationCommand = static_cast<const SetListenerRotationCommand*>(&command);
+                listenerRotation = setListenerRotationCommand->rotation;
+                break;
+            }
+            case Command::Type::initData:
+            {
+                const auto initDataCommand = static_cast<InitDataCommand*>(&command);
+                objects[initDataCommand->dataId - 1] = std::move(initDataCommand->data);
+                break;
+            }
+            case Command::Type::initProcessor:
+            {
+                const auto initProcessorCommand = static_cast<InitProcessorCommand*>(&command);
+                objects[initProcessorCommand->processorId - 1] = std::move(initProcessorCommand->processor);
+                break;
+            }
+            case Command::Type::updateProcessor:
+            {
+                const auto updateProcessorCommand = static_cast<const UpdateProcessorCommand*>(&command);
+
+                const auto processor = static_cast<Processor*>(objects[updateProcessorCommand->processorId - 1].get());
+                updateProcessorCommand->updateFunction(processor);
+                break;
+            }
+            case Command::Type::setProcessorParameter:
+            {
+                const auto setProcessorParameterCommand = static_cast<const SetProcessorParameterCommand*>(&command);
+
+                const auto processor = static_cast<Processor*>(objects[setProcessorParameterCommand->processorId - 1].get());
+                processor->setParameter(setProcessorParameterCommand->parameter, setProcessorParameterCommand->value);
+                break;
+            }
+            case Command::Type::setProcessorPosition:
+            {
+                const auto setProcessorPositionCommand = static_cast<const SetProcessorPositionCommand*>(&command);
+
+                const auto processor = static_cast<Processor*>(objects[setProcessorPositionCommand->processorId - 1].get());
+                processor->setPosition(setProcessorPositionCommand->position);
+                break;
+            }
+            case Command::Type::resizeObjects:
+            {
+                const auto resizeObjectsCommand = static_cast<ResizeObjectsCommand*>(&command);
+
+                // the new table is preallocated by the command, only the pointers are moved
+                std::move(objects.begin(), objects.end(), resizeObjectsCommand->objects.begin());
+                objects.swap(resizeObjectsCommand->objects);
+
+                // the old graph is destroyed with the command and rebuilt in the new buffers before the next render
+                graphStreams.swap(resizeObjectsCommand->graphStreams);
+                graphBuses.swap(resizeObjectsCommand->graphBuses);
+                graphLevelEnds.swap(resizeObjectsCommand->graphLevelEnds);
+                voiceManager.swapBuffer(resizeObjectsCommand->voices);
+                graphDirty = true;
+                break;
+            }
+            default:
+                throw Error{"Invalid command"};
         }
     }
 
-    void Mixer::getSamples(std::uint32_t frames, std::uint32_t channelCount, std::uint32_t sampleRate, std::vector<float>& samples)
+    void Mixer::getSamples(std::uint32_t frames, std::uint32_t, std::uint32_t, std::vector<float>& samples)
     {
-        process();
+        samples.resize(frames * channels);
 
-        samples.resize(frames * channelCount);
+        if (offline)
+        {
+            process();
 
-        if (masterBus)
+            while (buffer.getReadableFrames() < frames && buffer.getWritableFrames() >= bufferSize)
+                render();
+        }
+
+        const auto readFrames = std::min(static_cast<std::size_t>(frames), buffer.getReadableFrames());
+        buffer.read(samples, readFrames, frames);
+
+        if (readFrames < frames)
         {
-            math::Vector<float, 3> listenerPosition{};
-            math::Quaternion<float> listenerRotation{};
+            // the mixer thread did not keep up, the rest is filled with silence
+            for (std::uint32_t channel = 0; channel < channels; ++channel)
+                std::fill(samples.begin() + channel * frames + static_cast<std::ptrdiff_t>(readFrames),
+                          samples.begin() + (channel + 1) * frames, 0.0F);
 
-            masterBus->generateSamples(frames, channelCount, sampleRate,
-                                       listenerPosition, listenerRotation, samples);
+            starved.store(true, std::memory_order_relaxed);
         }
 
-        for (auto& sample : samples)
-            sample = std::clamp(sample, -1.0F, 1.0F);
+        renderSemaphore.release();
     }
 
-    void Mixer::mixerMain()
+    void Mixer::render()
     {
-        for (;;)
+        if (graphDirty)
+        {
+            buildGraph();
+            graphDirty = false;
+        }
+
+        if (masterBus)
         {
-            break; // TODO: remove
+            // the outputs of the buses are on the higher levels, so their audibility is updated first
+            for (auto i = graphBuses.rbegin(); i != graphBuses.rend(); ++i)
+                i->second->updateListener(listenerPosition, listenerRotation);
 
-            /*process();
+            voiceManager.update(graphStreams, listenerPosition);
 
-            std::unique_lock lock{bufferMutex};
-            bufferCondition.wait(lock);
+            auto renderStream = [this](std::size_t index) {
+                auto& stream = *graphStreams[index];
 
-            if (masterBus)
+                if (offline)
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    Bus::renderStream(stream, bufferSize, channels, sampleRate);
+                    stream.addProcessingTime(std::chrono::steady_clock::now() - start);
+                }
+                else
+                    Bus::renderStream(stream, bufferSize, channels, sampleRate);
+            };
+            renderPool.run(graphStreams.size(), renderStream);
+
+            std::size_t levelBegin = 0;
+            for (const auto levelEnd : graphLevelEnds)
             {
-                //Vector<float, 3> listenerPosition{};
-                //Quaternion<float> listenerRotation{};
+                auto mixBus = [this, levelBegin](std::size_t index) {
+                    graphBuses[levelBegin + index].second->mix(bufferSize, channels, sampleRate, offline);
+                };
+                renderPool.run(levelEnd - levelBegin, mixBus);
+                levelBegin = levelEnd;
+            }
+
+            const auto& mixBuffer = masterBus->getMixBuffer();
+            dsp::clamp(renderBuffer.data(), mixBuffer.data(), -1.0F, 1.0F, renderBuffer.size());
+        }
+        else
+            std::fill(renderBuffer.begin(), renderBuffer.end(), 0.0F);
+
+        buffer.write(renderBuffer, bufferSize, bufferSize);
+    }
+
+    // collects the buses and the streams that reach the master bus, executed only when the routing changes,
+    // the buffers have been preallocated for the whole object table by the ResizeObjectsCommand
+    void Mixer::buildGraph()
+    {
+        graphStreams.clear();
+        graphBuses.clear();
+        graphLevelEnds.clear();
+
+        if (!masterBus) return;
+
+        addToGraph(*masterBus);
+
+        // the order of the buses on a level does not matter, and unlike stable_sort, sort does not allocate
+        std::sort(graphBuses.begin(), graphBuses.end(), [](const auto& a, const auto& b) noexcept {
+            return a.first < b.first;
+        });
+
+        for (std::size_t i = 0; i < graphBuses.size(); ++i)
+            if (i + 1 == graphBuses.size() || graphBuses[i + 1].first != graphBuses[i].first)
+                graphLevelEnds.push_back(i + 1);
+    }
+
+    // returns the level of the bus, which is one more than the highest level of its inputs
+    std::size_t Mixer::addToGraph(Bus& bus)
+    {
+        std::size_t level = 0;
+        for (const auto inputBus : bus.getInputBuses())
+            level = std::max(level, addToGraph(*inputBus) + 1);
+
+        graphBuses.emplace_back(level, &bus);
+        graphStreams.insert(graphStreams.end(), bus.getInputStreams().begin(), bus.getInputStreams().end());
+
+        return level;
+    }
+
+    std::vector<std::pair<Mixer::ObjectId, std::chrono::steady_clock::duration>> Mixer::getProcessingTimes() const
+    {
+        std::vector<std::pair<ObjectId, std::chrono::steady_clock::duration>> result;
+
+        for (std::size_t i = 0; i < objects.size(); ++i)
+            if (objects[i] && objects[i]->getProcessingTime() != std::chrono::steady_clock::duration::zero())
+                result.emplace_back(i + 1, objects[i]->getProcessingTime());
+
+        return result;
+    }
+
+    void Mixer::resetProcessingTimes() noexcept
+    {
+        for (const auto& object : objects)
+            if (object) object->resetProcessingTime();
+    }
+
+    void Mixer::mixerMain()
+    {
+        while (running)
+        {
+            process();
+
+            while (buffer.getWritableFrames() >= bufferSize)
+                render();
 
-                //masterBus->getData(frames, channels, sampleRate, listenerPosition, listenerRotation, samples);
-            }*/
+            if (starved.exchange(false, std::memory_order_relaxed))
+                sendEvent(Event{Event::Type::starvation});
 
-            //for (auto& f : samples)
-            //    f = std::clamp(f, -1.0F, 1.0F);
+            renderSemaphore.acquire();
         }
     }
 
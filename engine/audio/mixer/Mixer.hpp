@@ -3,7 +3,8 @@
 #ifndef OUZEL_AUDIO_MIXER_MIXER_HPP
 #define OUZEL_AUDIO_MIXER_MIXER_HPP
 
-#include <condition_variable>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <mutex>
@@ -12,8 +13,14 @@
 #include <thread>
 #include <vector>
 #include "Commands.hpp"
+#include "FrameBuffer.hpp"
 #include "Object.hpp"
 #include "Processor.hpp"
+#include "RenderPool.hpp"
+#include "VoiceManager.hpp"
+#include "../Dsp.hpp"
+#include "../../thread/Semaphore.hpp"
+#include "../../thread/SpscQueue.hpp"
 #include "../../thread/Thread.hpp"
 
 namespace ouzel::audio::mixer
@@ -29,10 +36,7 @@ namespace ouzel::audio::mixer
             for (auto child : children)
             {
                 child->getSamples(frames, channels, sampleRate, buffer);
-
-                for (std::uint32_t channel = 0; channel < channels; ++channel)
-                    for (std::uint32_t frame = 0; frame < frames; ++frame)
-                        samples[channel * frames + frame] += buffer[channel * frames + frame];
+                dsp::add(samples.data(), buffer.data(), samples.size());
             }
         }
 
@@ -62,7 +66,11 @@ namespace ouzel::audio::mixer
         };
 
         Mixer(std::uint32_t initBufferSize,
-              std::uint32_t initChannels);
+              std::uint32_t initChannels,
+              std::uint32_t initSampleRate,
+              std::uint32_t initBufferCount,
+              std::uint32_t initMaxVoices,
+              bool initOffline = false);
 
         ~Mixer();
 
@@ -72,7 +80,14 @@ namespace ouzel::audio::mixer
         Mixer(Mixer&&) = delete;
         Mixer& operator=(Mixer&&) = delete;
 
+        auto getBufferSize() const noexcept { return bufferSize; }
+        auto getChannels() const noexcept { return channels; }
+        auto getSampleRate() const noexcept { return sampleRate; }
+
         void process();
+
+        // called by the audio device, only copies the samples that the mixer thread rendered ahead,
+        // the offline mixer has no thread and renders the samples on the calling thread
         void getSamples(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate, std::vector<float>& samples);
 
         using ObjectId = std::size_t;
@@ -93,11 +108,7 @@ namespace ouzel::audio::mixer
             deletedObjectIds.insert(objectId);
         }
 
-        void submitCommandBuffer(CommandBuffer&& commandBuffer)
-        {
-            std::scoped_lock lock{commandQueueMutex};
-            commandQueue.push(std::move(commandBuffer));
-        }
+        void submitCommandBuffer(CommandBuffer&& commandBuffer);
 
         auto getRootObjectId() const noexcept
         {
@@ -106,19 +117,34 @@ namespace ouzel::audio::mixer
 
         std::queue<Event> getEvents();
 
+        auto isOffline() const noexcept { return offline; }
+
+        // time spent rendering every stream, bus and processor, measured only by the offline mixer,
+        // must not be called while the samples are being rendered
+        std::vector<std::pair<ObjectId, std::chrono::steady_clock::duration>> getProcessingTimes() const;
+        void resetProcessingTimes() noexcept;
+
     protected:
         void sendEvent(const Event& event);
 
     private:
         void mixerMain();
+        void render();
+        void buildGraph();
+        std::size_t addToGraph(Bus& bus);
+        void retireCommandBuffers();
+        void executeCommand(Command& command);
 
         std::uint32_t bufferSize;
         std::uint32_t channels;
+        std::uint32_t sampleRate;
+        bool offline;
         std::queue<Event> eventQueue;
         std::mutex eventQueueMutex;
 
         ObjectId lastObjectId = 0;
         std::set<ObjectId> deletedObjectIds;
+        std::size_t objectCapacity = 0; // size of the object table after the submitted commands
 
         std::vector<std::unique_ptr<Object>> objects;
         std::size_t rootObjectId = 0;
@@ -126,35 +152,31 @@ namespace ouzel::audio::mixer
 
         Bus* masterBus = nullptr;
 
-        class Buffer final
-        {
-        public:
-            Buffer(std::size_t size, std::uint32_t initChannels):
-                maxFrames{size},
-                channels{initChannels},
-                buffer(size * channels)
-            {
-            }
-
-            bool canRead() const noexcept { return frames > 0; }
-            bool canWrite() const noexcept { return frames < maxFrames; }
-
-        private:
-            std::size_t frames = 0;
-            std::size_t maxFrames;
-            std::uint32_t channels;
-            std::size_t readPosition = 0;
-            std::size_t writePosition = 0;
-            std::vector<float> buffer;
-        };
-
+        // the buses ordered by their level, buses on the same level do not depend on each other
+        RenderPool renderPool;
+        bool graphDirty = true;
+        std::vector<Stream*> graphStreams;
+        std::vector<std::pair<std::size_t, Bus*>> graphBuses;
+        std::vector<std::size_t> graphLevelEnds;
+
+        VoiceManager voiceManager;
+        math::Vector<float, 3> listenerPosition{};
+        math::Quaternion<float> listenerRotation = math::identityQuaternion<float>;
+
+        FrameBuffer buffer; // written by the mixer thread and read by the audio device
+        std::vector<float> renderBuffer;
+        std::atomic<bool> running{true};
+        std::atomic<bool> starved{false};
+        thread::Semaphore renderSemaphore; // released when there is space in the buffer or new commands
         thread::Thread mixerThread;
-        std::mutex bufferMutex;
-        std::condition_variable bufferCondition;
-        Buffer buffer;
 
-        std::queue<CommandBuffer> commandQueue;
-        std::mutex commandQueueMutex;
+        // command buffers are passed to the audio thread through a wait-free ring and returned
+        // through another one, so that the commands and the deleted objects are freed on the game thread
+        static constexpr std::size_t commandQueueCapacity = 64;
+        thread::SpscQueue<std::unique_ptr<CommandBuffer>> commandQueue{commandQueueCapacity};
+        thread::SpscQueue<std::unique_ptr<CommandBuffer>> retiredCommandQueue{commandQueueCapacity};
+        std::queue<std::unique_ptr<CommandBuffer>> pendingCommandBuffers; // not yet fitting in the ring
+        std::size_t commandBuffersInFlight = 0;
     };
 }
 
@@ -3,6 +3,8 @@
 #ifndef OUZEL_AUDIO_MIXER_OBJECT_HPP
 #define OUZEL_AUDIO_MIXER_OBJECT_HPP
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <vector>
@@ -53,11 +55,24 @@ namespace ouzel::audio::mixer
             if (child.parent == this)
                 if (const auto i = std::find(children.begin(), children.end(), &child); i != children.end())
                 {
-                    child.parent = this;
+                    child.parent = nullptr;
                     children.erase(i);
                 }
         }
 
+        // unlinks the object from the graph on the audio thread, so that it
+        // can be destroyed on another thread without touching the other objects
+        virtual void detach()
+        {
+            if (parent)
+                parent->removeChild(*this);
+
+            for (auto child : children)
+                child->parent = nullptr;
+
+            children.clear();
+        }
+
         void play()
         {
             if (source)
@@ -80,10 +95,18 @@ namespace ouzel::audio::mixer
                 source->getSamples(frames, channels, sampleRate, samples);
         }
 
+        // time spent rendering the object, measured only by the offline mixer
+        auto getProcessingTime() const noexcept { return processingTime; }
+        void addProcessingTime(std::chrono::steady_clock::duration time) noexcept { processingTime += time; }
+        void resetProcessingTime() noexcept { processingTime = {}; }
+
     protected:
         Object* parent = nullptr;
         std::vector<Object*> children;
         std::unique_ptr<Source> source;
+
+    private:
+        std::chrono::steady_clock::duration processingTime{};
     };
 }
 
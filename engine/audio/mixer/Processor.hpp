@@ -5,6 +5,8 @@
 
 #include "Object.hpp"
 #include "Bus.hpp"
+#include "../../math/Quaternion.hpp"
+#include "../../math/Vector.hpp"
 
 namespace ouzel::audio::mixer
 {
@@ -18,6 +20,13 @@ namespace ouzel::audio::mixer
             if (bus) bus->removeProcessor(this);
         }
 
+        void detach() override
+        {
+            Object::detach();
+
+            if (bus) bus->removeProcessor(this);
+        }
+
         Processor(const Processor&) = delete;
         Processor& operator=(const Processor&) = delete;
 
@@ -27,6 +36,18 @@ namespace ouzel::audio::mixer
         virtual void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
                              std::vector<float>& samples) = 0;
 
+        // numeric parameters are set by the SetProcessorParameterCommand, the ids are defined by the processor
+        virtual void setParameter(std::uint32_t, float) {}
+
+        // the position of the processors that emit sound in the world space, set by the SetProcessorPositionCommand
+        virtual void setPosition(const math::Vector<float, 3>&) noexcept {}
+
+        // the listener in the world space, set before every block is mixed
+        virtual void setListener(const math::Vector<float, 3>&, const math::Quaternion<float>&) noexcept {}
+
+        // gain of the processor for a sound heard at the listener position, used to find the inaudible voices
+        virtual float getAttenuation(const math::Vector<float, 3>&) const noexcept { return 1.0F; }
+
         auto isEnabled() const noexcept { return enabled; }
         void setEnabled(bool newEnabled) { enabled = newEnabled; }
 
@@ -0,0 +1,110 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_AUDIO_MIXER_RENDERPOOL_HPP
+#define OUZEL_AUDIO_MIXER_RENDERPOOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "../../thread/Semaphore.hpp"
+#include "../../thread/Thread.hpp"
+
+namespace ouzel::audio::mixer
+{
+    // Threads that help the mixer thread to render, the tasks are claimed
+    // with an atomic counter, so running them neither locks nor allocates
+    class RenderPool final
+    {
+    public:
+        explicit RenderPool(std::size_t threadCount)
+        {
+            threads.reserve(threadCount);
+            for (std::size_t i = 0; i < threadCount; ++i)
+                threads.emplace_back(&RenderPool::main, this);
+        }
+
+        ~RenderPool()
+        {
+            running = false;
+            semaphore.release(static_cast<std::ptrdiff_t>(threads.size()));
+
+            for (auto& thread : threads)
+                if (thread.isJoinable()) thread.join();
+        }
+
+        RenderPool(const RenderPool&) = delete;
+        RenderPool& operator=(const RenderPool&) = delete;
+        RenderPool(RenderPool&&) = delete;
+        RenderPool& operator=(RenderPool&&) = delete;
+
+        [[nodiscard]] auto getThreadCount() const noexcept { return threads.size(); }
+
+        // calls the function for every index in [0, count) and returns after all the calls finished,
+        // the calling thread takes part in the work
+        template <class Function>
+        void run(std::size_t count, Function& function)
+        {
+            const auto helperCount = std::min(threads.size(), count > 0 ? count - 1 : 0);
+
+            if (helperCount == 0)
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                    function(i);
+                return;
+            }
+
+            task = [](void* context, std::size_t index) {
+                (*static_cast<Function*>(context))(index);
+            };
+            taskContext = &function;
+            taskCount = count;
+            nextTask.store(0, std::memory_order_relaxed);
+            activeHelpers.store(helperCount, std::memory_order_relaxed);
+
+            semaphore.release(static_cast<std::ptrdiff_t>(helperCount));
+
+            work();
+
+            // the helpers must leave before the task is replaced by the next run
+            while (activeHelpers.load(std::memory_order_acquire) != 0)
+                std::this_thread::yield();
+        }
+
+    private:
+        void main()
+        {
+            for (;;)
+            {
+                semaphore.acquire();
+                if (!running) return;
+
+                work();
+                activeHelpers.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        void work()
+        {
+            for (;;)
+            {
+                const auto index = nextTask.fetch_add(1, std::memory_order_relaxed);
+                if (index >= taskCount) break;
+                task(taskContext, index);
+            }
+        }
+
+        void (*task)(void*, std::size_t) = nullptr;
+        void* taskContext = nullptr;
+        std::size_t taskCount = 0;
+        alignas(64) std::atomic<std::size_t> nextTask{0};
+        alignas(64) std::atomic<std::size_t> activeHelpers{0};
+        std::atomic<bool> running{true};
+        thread::Semaphore semaphore;
+        std::vector<thread::Thread> threads;
+    };
+}
+
+#endif // OUZEL_AUDIO_MIXER_RENDERPOOL_HPP
@@ -0,0 +1,147 @@
+// Ouzel by Elviss Strazdins
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "Resampler.hpp"
+#include "../Dsp.hpp"
+#include "../../math/Constants.hpp"
+
+namespace ouzel::audio::mixer
+{
+    Resampler::Filter::Filter(std::uint32_t sourceSampleRate, std::uint32_t sampleRate):
+        phases{Resampler::getPhases(sourceSampleRate, sampleRate)},
+        coefficients(static_cast<std::size_t>(phases) * filterTaps)
+    {
+        // the cutoff is lowered below the output Nyquist frequency when downsampling
+        const auto ratio = std::min(1.0, static_cast<double>(sampleRate) / static_cast<double>(sourceSampleRate));
+        const auto cutoff = 0.45 * ratio; // in cycles per source frame
+        constexpr auto halfTaps = static_cast<double>(filterTaps / 2);
+
+        for (std::uint32_t phase = 0; phase < phases; ++phase)
+        {
+            const auto phaseCoefficients = &coefficients[phase * filterTaps];
+            double doubleCoefficients[filterTaps];
+            double sum = 0.0;
+
+            for (std::uint32_t tap = 0; tap < filterTaps; ++tap)
+            {
+                // distance from the output frame to the source frame
+                const auto x = static_cast<double>(tap) - (halfTaps - 1.0) -
+                    static_cast<double>(phase) / static_cast<double>(phases);
+
+                const auto t = 2.0 * math::pi<double> * cutoff * x;
+                const auto sinc = (x == 0.0) ? 1.0 : std::sin(t) / t;
+                const auto window = 0.42 + 0.5 * std::cos(math::pi<double> * x / halfTaps) +
+                    0.08 * std::cos(2.0 * math::pi<double> * x / halfTaps); // Blackman
+
+                doubleCoefficients[tap] = 2.0 * cutoff * sinc * window;
+                sum += doubleCoefficients[tap];
+            }
+
+            // unity gain at DC for every phase, normalized in double precision and rounded once
+            for (std::uint32_t tap = 0; tap < filterTaps; ++tap)
+                phaseCoefficients[tap] = static_cast<float>(doubleCoefficients[tap] / sum);
+        }
+    }
+
+    std::uint32_t Resampler::getPhases(std::uint32_t sourceSampleRate, std::uint32_t sampleRate) noexcept
+    {
+        return sampleRate / std::gcd(sourceSampleRate, sampleRate);
+    }
+
+    Resampler::Resampler(std::uint32_t initChannels,
+                         std::uint32_t sourceSampleRate,
+                         std::uint32_t sampleRate,
+                         std::uint32_t maxFrames,
+                         std::shared_ptr<const Filter> initFilter):
+        channels{initChannels},
+        phases{getPhases(sourceSampleRate, sampleRate)},
+        step{sourceSampleRate / std::gcd(sourceSampleRate, sampleRate)},
+        taps{initFilter ? filterTaps : 2},
+        filter{std::move(initFilter)}
+    {
+        capacity = (static_cast<std::size_t>(maxFrames) * step + phases - 1) / phases + 2 * taps;
+        history.resize(capacity * channels);
+        reset();
+    }
+
+    std::uint32_t Resampler::getSourceFrames(std::uint32_t frames) const noexcept
+    {
+        if (frames == 0) return 0;
+
+        // the window of the last frame must be available and all the consumed frames must have been read
+        const auto lastFrame = (phase + static_cast<std::size_t>(frames - 1) * step) / phases;
+        const auto consumed = (phase + static_cast<std::size_t>(frames) * step) / phases;
+        const auto needed = std::max(lastFrame + taps, consumed);
+
+        return needed > historyFrames ? static_cast<std::uint32_t>(needed - historyFrames) : 0;
+    }
+
+    void Resampler::process(std::uint32_t sourceFrames, const std::vector<float>& sourceSamples,
+                            std::uint32_t frames, std::vector<float>& samples)
+    {
+        samples.resize(frames * channels);
+
+        std::size_t position = 0;
+        std::uint32_t endPhase = phase;
+
+        for (std::uint32_t channel = 0; channel < channels; ++channel)
+        {
+            const auto input = &history[channel * capacity];
+            const auto output = &samples[channel * frames];
+
+            std::copy(sourceSamples.begin() + channel * sourceFrames,
+                      sourceSamples.begin() + (channel + 1) * sourceFrames,
+                      input + historyFrames);
+
+            position = 0;
+            endPhase = phase;
+
+            if (filter)
+                for (std::uint32_t frame = 0; frame < frames; ++frame)
+                {
+                    output[frame] = dsp::dot(input + position, filter->getCoefficients(endPhase), filterTaps);
+
+                    endPhase += step;
+                    position += endPhase / phases;
+                    endPhase %= phases;
+                }
+            else
+            {
+                const auto phaseScale = 1.0F / static_cast<float>(phases);
+
+                for (std::uint32_t frame = 0; frame < frames; ++frame)
+                {
+                    const auto fraction = static_cast<float>(endPhase) * phaseScale;
+                    output[frame] = input[position] + (input[position + 1] - input[position]) * fraction;
+
+                    endPhase += step;
+                    position += endPhase / phases;
+                    endPhase %= phases;
+                }
+            }
+        }
+
+        // keep the frames that the next buffer still needs
+        const auto availableFrames = historyFrames + sourceFrames;
+        const auto remainingFrames = availableFrames - std::min(position, availableFrames);
+
+        for (std::uint32_t channel = 0; channel < channels; ++channel)
+        {
+            const auto input = &history[channel * capacity];
+            std::copy(input + availableFrames - remainingFrames, input + availableFrames, input);
+        }
+
+        historyFrames = remainingFrames;
+        phase = endPhase;
+    }
+
+    void Resampler::reset() noexcept
+    {
+        // the filter is centered on the output frame, so the first frames are preceded by silence
+        historyFrames = taps / 2 - 1;
+        phase = 0;
+        std::fill(history.begin(), history.end(), 0.0F);
+    }
+}
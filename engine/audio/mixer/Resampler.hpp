@@ -0,0 +1,72 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_AUDIO_MIXER_RESAMPLER_HPP
+#define OUZEL_AUDIO_MIXER_RESAMPLER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ouzel::audio::mixer
+{
+    // Streaming sample rate converter, the position and the unconsumed source frames
+    // are kept between the calls, so consecutive buffers join without discontinuities
+    class Resampler final
+    {
+    public:
+        static constexpr std::uint32_t filterTaps = 16;
+        static constexpr std::uint32_t maxFilterPhases = 1024;
+
+        // Polyphase windowed-sinc filter bank for one conversion ratio,
+        // computed once and shared by all the streams that use the ratio
+        class Filter final
+        {
+        public:
+            Filter(std::uint32_t sourceSampleRate, std::uint32_t sampleRate);
+
+            auto getPhases() const noexcept { return phases; }
+            auto getCoefficients(std::uint32_t phase) const noexcept { return &coefficients[phase * filterTaps]; }
+
+        private:
+            std::uint32_t phases = 0;
+            std::vector<float> coefficients;
+        };
+
+        // the number of filter phases that the ratio needs, the filter is used only up to maxFilterPhases
+        static std::uint32_t getPhases(std::uint32_t sourceSampleRate, std::uint32_t sampleRate) noexcept;
+
+        Resampler() = default;
+
+        // uses linear interpolation if the filter is null
+        Resampler(std::uint32_t initChannels,
+                  std::uint32_t sourceSampleRate,
+                  std::uint32_t sampleRate,
+                  std::uint32_t maxFrames,
+                  std::shared_ptr<const Filter> initFilter);
+
+        // the number of source frames that must be passed to process to produce the frames
+        std::uint32_t getSourceFrames(std::uint32_t frames) const noexcept;
+
+        // the most source frames that getSourceFrames returns for the maximum frames
+        auto getMaxSourceFrames() const noexcept { return capacity; }
+
+        // source and the result are planar, must not allocate after the first call
+        void process(std::uint32_t sourceFrames, const std::vector<float>& sourceSamples,
+                     std::uint32_t frames, std::vector<float>& samples);
+
+        void reset() noexcept;
+
+    private:
+        std::uint32_t channels = 0;
+        std::uint32_t phases = 1; // output frames per step source frames
+        std::uint32_t step = 1;
+        std::uint32_t taps = 2;
+        std::uint32_t phase = 0;
+        std::size_t historyFrames = 0;
+        std::size_t capacity = 0; // frames per channel in the history
+        std::vector<float> history; // planar, the frames that have not been consumed yet
+        std::shared_ptr<const Filter> filter;
+    };
+}
+
+#endif // OUZEL_AUDIO_MIXER_RESAMPLER_HPP
@@ -3,9 +3,14 @@
 #ifndef OUZEL_AUDIO_MIXER_STREAM_HPP
 #define OUZEL_AUDIO_MIXER_STREAM_HPP
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include "Object.hpp"
 #include "Bus.hpp"
 #include "Data.hpp"
+#include "Resampler.hpp"
+#include "../../math/Vector.hpp"
 
 namespace ouzel::audio::mixer
 {
@@ -26,6 +31,14 @@ namespace ouzel::audio::mixer
             if (output) output->removeInput(this);
         }
 
+        void detach() override
+        {
+            Object::detach();
+
+            if (output) output->removeInput(this);
+            output = nullptr;
+        }
+
         Stream(const Stream&) = delete;
         Stream& operator=(const Object&) = delete;
 
@@ -34,6 +47,19 @@ namespace ouzel::audio::mixer
 
         auto& getData() const noexcept { return data; }
 
+        // must be set before the stream is passed to the mixer if the data has a different sample rate
+        void setResampler(Resampler&& newResampler) { resampler = std::move(newResampler); }
+
+        // called on the game thread after the resampler is set, so that rendering the stream does not allocate
+        void reserve(std::uint32_t maxFrames, std::uint32_t channels)
+        {
+            const std::size_t sourceChannels = data.getChannels();
+            resampleBuffer.reserve(resampler.getMaxSourceFrames() * sourceChannels);
+            mixBuffer.reserve(maxFrames * sourceChannels);
+            outputBuffer.reserve(maxFrames * std::max(sourceChannels, static_cast<std::size_t>(channels)));
+        }
+
+        auto getOutput() const noexcept { return output; }
         void setOutput(Bus* newOutput)
         {
             if (output) output->removeInput(this);
@@ -47,17 +73,78 @@ namespace ouzel::audio::mixer
         void stop(bool shouldReset)
         {
             playing = false;
-            if (shouldReset) reset();
+            if (shouldReset)
+            {
+                resampler.reset();
+                reset();
+            }
         }
 
         virtual void reset() = 0;
 
         virtual void generateSamples(std::uint32_t frames, std::vector<float>& samples) = 0;
 
+        // advances the playback position without producing the samples, called instead of generateSamples for virtual streams
+        virtual void skipSamples(std::uint32_t frames) = 0;
+
+        auto getGain() const noexcept { return gain; }
+        void setGain(float newGain) noexcept { gain = newGain; }
+
+        auto getPriority() const noexcept { return priority; }
+        void setPriority(std::int32_t newPriority) noexcept { priority = newPriority; }
+
+        auto isPositional() const noexcept { return positional; }
+        auto& getPosition() const noexcept { return position; }
+        void setPosition(const math::Vector<float, 3>& newPosition) noexcept
+        {
+            position = newPosition;
+            positional = true;
+        }
+
+        // virtual streams are not rendered, set by the voice manager on every buffer,
+        // the stream is faded in or out over the buffer after the change
+        auto isVirtual() const noexcept { return virtualized; }
+        void setVirtual(bool newVirtual) noexcept
+        {
+            if (newVirtual == virtualized) return;
+
+            virtualized = newVirtual;
+            fade = newVirtual ? Fade::out : Fade::in;
+            heldBuffers = 0;
+        }
+
+        // the number of buffers since the stream last became real or virtual, counted by the voice manager
+        auto getHeldBuffers() const noexcept { return heldBuffers; }
+        void holdBuffer() noexcept { if (heldBuffers != std::numeric_limits<std::uint32_t>::max()) ++heldBuffers; }
+
     protected:
         Data& data;
         Bus* output = nullptr;
         bool playing = false;
+
+    private:
+        // written by Bus::renderStream, so that the streams can be rendered in parallel
+        std::vector<float> resampleBuffer;
+        std::vector<float> mixBuffer;
+        std::vector<float> outputBuffer;
+        Resampler resampler;
+        bool rendered = false;
+
+        float gain = 1.0F;
+        std::int32_t priority = 0;
+        math::Vector<float, 3> position{};
+        bool positional = false;
+        bool virtualized = false;
+
+        enum class Fade: std::uint8_t
+        {
+            none,
+            in,
+            out
+        };
+
+        Fade fade = Fade::none;
+        std::uint32_t heldBuffers = std::numeric_limits<std::uint32_t>::max(); // the state has never changed
     };
 }
 
@@ -0,0 +1,67 @@
+// Ouzel by Elviss Strazdins
+
+#include <algorithm>
+#include <cfloat>
+#include "VoiceManager.hpp"
+#include "Bus.hpp"
+#include "Stream.hpp"
+#include "../Dsp.hpp"
+
+namespace ouzel::audio::mixer
+{
+    namespace
+    {
+        // attenuation of the positional streams that are not panned by a processor
+        constexpr float minDistance = 1.0F;
+        constexpr float rolloffFactor = 1.0F;
+
+        // the real streams are ranked as if they were louder and every stream keeps its state for a few buffers
+        // after a change, so that the streams around the voice limit do not flip between real and virtual
+        constexpr float realStreamMargin = 2.0F; // +6 dB
+        constexpr std::uint32_t minHoldBuffers = 8;
+    }
+
+    void VoiceManager::update(const std::vector<Stream*>& streams, const math::Vector<float, 3>& listenerPosition)
+    {
+        voices.clear();
+
+        for (const auto stream : streams)
+        {
+            if (!stream->isPlaying()) continue;
+
+            stream->holdBuffer();
+
+            auto audibility = stream->getGain() * stream->getOutput()->getAudibility();
+
+            if (stream->isPositional())
+                audibility *= dsp::getDistanceAttenuation(math::distance(stream->getPosition(), listenerPosition),
+                                                          minDistance, FLT_MAX, rolloffFactor);
+
+            if (audibility < minAudibility)
+                stream->setVirtual(true);
+            else if (stream->getHeldBuffers() < minHoldBuffers)
+                voices.emplace_back(stream->isVirtual() ? 0.0F : FLT_MAX, stream);
+            else
+                voices.emplace_back(stream->isVirtual() ? audibility : audibility * realStreamMargin, stream);
+        }
+
+        if (voices.size() > maxVoices)
+        {
+            // only the streams that are kept have to be found, their order does not matter
+            std::nth_element(voices.begin(), voices.begin() + maxVoices, voices.end(),
+                             [](const auto& a, const auto& b) noexcept {
+                                 const auto priorityA = a.second->getPriority();
+                                 const auto priorityB = b.second->getPriority();
+                                 return priorityA != priorityB ? priorityA > priorityB : a.first > b.first;
+                             });
+
+            for (auto i = voices.begin() + maxVoices; i != voices.end(); ++i)
+                i->second->setVirtual(true);
+
+            voices.resize(maxVoices);
+        }
+
+        for (const auto& voice : voices)
+            voice.second->setVirtual(false);
+    }
+}
@@ -0,0 +1,41 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_AUDIO_MIXER_VOICEMANAGER_HPP
+#define OUZEL_AUDIO_MIXER_VOICEMANAGER_HPP
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "../../math/Vector.hpp"
+
+namespace ouzel::audio::mixer
+{
+    class Stream;
+
+    // Limits the number of the streams that are rendered, the playing streams with
+    // the lowest priority and audibility become virtual and only advance their position
+    class VoiceManager final
+    {
+    public:
+        static constexpr float minAudibility = 0.001F; // -60 dB, quieter streams are not rendered
+
+        explicit VoiceManager(std::uint32_t initMaxVoices) noexcept:
+            maxVoices{initMaxVoices}
+        {
+        }
+
+        auto getMaxVoices() const noexcept { return maxVoices; }
+
+        // the buffer is preallocated on the game thread for all the streams, so that the update does not allocate
+        void swapBuffer(std::vector<std::pair<float, Stream*>>& buffer) noexcept { voices.swap(buffer); }
+
+        // called on the mixer thread before every buffer is rendered
+        void update(const std::vector<Stream*>& streams, const math::Vector<float, 3>& listenerPosition);
+
+    private:
+        std::uint32_t maxVoices;
+        std::vector<std::pair<float, Stream*>> voices; // the ranking score and the stream
+    };
+}
+
+#endif // OUZEL_AUDIO_MIXER_VOICEMANAGER_HPP
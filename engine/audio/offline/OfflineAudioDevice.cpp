@@ -0,0 +1,103 @@
+// Ouzel by Elviss Strazdins
+
+#include <algorithm>
+#include <limits>
+#include "OfflineAudioDevice.hpp"
+#include "../AudioError.hpp"
+#include "../../utils/Utils.hpp"
+
+namespace ouzel::audio::offline
+{
+    namespace
+    {
+        constexpr std::uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+        constexpr std::uint32_t headerSize = 44;
+    }
+
+    AudioDevice::AudioDevice(const Settings& settings,
+                             const std::function<void(std::uint32_t frames,
+                                                      std::uint32_t channels,
+                                                      std::uint32_t sampleRate,
+                                                      std::vector<float>& samples)>& initDataGetter):
+        audio::AudioDevice{Driver::offline, settings, initDataGetter},
+        data(static_cast<std::size_t>(bufferSize) * channels * sizeof(float))
+    {
+        sampleFormat = SampleFormat::float32;
+
+        if (!settings.audioDevice.empty())
+        {
+            file.open(settings.audioDevice, std::ios::binary | std::ios::trunc);
+            if (!file)
+                throw Error{"Failed to open " + settings.audioDevice};
+
+            writeHeader(); // the sizes are written again when the rendering stops
+        }
+    }
+
+    AudioDevice::~AudioDevice()
+    {
+        if (file.is_open()) writeHeader();
+    }
+
+    void AudioDevice::stop()
+    {
+        if (file.is_open())
+        {
+            writeHeader();
+            file.flush();
+        }
+    }
+
+    void AudioDevice::render(std::uint64_t frames)
+    {
+        for (std::uint64_t i = 0; i < frames; i += bufferSize)
+            renderBlock();
+    }
+
+    void AudioDevice::renderBlock()
+    {
+        const auto start = std::chrono::steady_clock::now();
+        getData(bufferSize, data.data());
+        const auto time = std::chrono::steady_clock::now() - start;
+
+        renderedFrames += bufferSize;
+        renderTime += time;
+
+        const auto microseconds = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(time).count());
+        std::size_t bucket = 0;
+        while (bucket + 1 < histogramBuckets && (microseconds >> (bucket + 1)) != 0) ++bucket;
+        ++blockTimeHistogram[bucket];
+
+        if (file.is_open())
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        else
+        {
+            const auto blockSamples = reinterpret_cast<const float*>(data.data());
+            samples.insert(samples.end(), blockSamples, blockSamples + data.size() / sizeof(float));
+        }
+    }
+
+    void AudioDevice::writeHeader()
+    {
+        const auto blockAlign = channels * static_cast<std::uint32_t>(sizeof(float));
+        const auto dataSize = static_cast<std::uint32_t>(std::min(renderedFrames * blockAlign,
+                                                                  static_cast<std::uint64_t>(std::numeric_limits<std::uint32_t>::max() - headerSize)));
+
+        std::uint8_t header[headerSize] = {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E', 'f', 'm', 't', ' '};
+        encodeLittleEndian<std::uint32_t>(header + 4, headerSize - 8 + dataSize);
+        encodeLittleEndian<std::uint32_t>(header + 16, 16); // format chunk size
+        encodeLittleEndian<std::uint16_t>(header + 20, WAVE_FORMAT_IEEE_FLOAT);
+        encodeLittleEndian<std::uint16_t>(header + 22, static_cast<std::uint16_t>(channels));
+        encodeLittleEndian<std::uint32_t>(header + 24, sampleRate);
+        encodeLittleEndian<std::uint32_t>(header + 28, sampleRate * blockAlign);
+        encodeLittleEndian<std::uint16_t>(header + 32, static_cast<std::uint16_t>(blockAlign));
+        encodeLittleEndian<std::uint16_t>(header + 34, 32); // bits per sample
+        header[36] = 'd'; header[37] = 'a'; header[38] = 't'; header[39] = 'a';
+        encodeLittleEndian<std::uint32_t>(header + 40, dataSize);
+
+        const auto position = file.tellp();
+        file.seekp(0, std::ios::beg);
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        if (position > 0) file.seekp(position);
+    }
+}
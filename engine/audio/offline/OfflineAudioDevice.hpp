@@ -0,0 +1,60 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_AUDIO_OFFLINEAUDIODEVICE_HPP
+#define OUZEL_AUDIO_OFFLINEAUDIODEVICE_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+#include "../AudioDevice.hpp"
+
+namespace ouzel::audio::offline
+{
+    // Renders the samples as fast as the mixer produces them instead of at the playback rate,
+    // into the WAV file named by the audio device setting or into memory if there is none,
+    // the samples are rendered only by render, so the device does not run on its own after it is started
+    class AudioDevice final: public audio::AudioDevice
+    {
+    public:
+        static constexpr std::size_t histogramBuckets = 24;
+
+        AudioDevice(const Settings& settings,
+                    const std::function<void(std::uint32_t frames,
+                                             std::uint32_t channels,
+                                             std::uint32_t sampleRate,
+                                             std::vector<float>& samples)>& initDataGetter);
+        ~AudioDevice() override;
+
+        void start() final {}
+        void stop() final;
+
+        // renders at least the given number of frames on the calling thread
+        void render(std::uint64_t frames);
+
+        // the interleaved samples rendered into memory, they are kept until they are cleared
+        auto& getSamples() const noexcept { return samples; }
+        void clearSamples() noexcept { samples.clear(); }
+
+        auto getRenderedFrames() const noexcept { return renderedFrames; }
+        auto getRenderTime() const noexcept { return renderTime; }
+
+        // bucket i counts the blocks that took [2^i, 2^(i+1)) microseconds to render, the first one also the faster blocks
+        auto& getBlockTimeHistogram() const noexcept { return blockTimeHistogram; }
+
+    private:
+        void renderBlock();
+        void writeHeader();
+
+        std::ofstream file;
+        std::vector<std::uint8_t> data;
+        std::vector<float> samples;
+
+        std::uint64_t renderedFrames = 0;
+        std::chrono::steady_clock::duration renderTime{};
+        std::array<std::size_t, histogramBuckets> blockTimeHistogram{};
+    };
+}
+
+#endif // OUZEL_AUDIO_OFFLINEAUDIODEVICE_HPP
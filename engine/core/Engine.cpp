@@ -147,6 +147,29 @@ namespace ouzel::core
             const auto& debugAudioValue = userEngineSection.getValue("debugAudio", defaultEngineSection.getValue("debugAudio"));
             if (!debugAudioValue.empty()) settings.audioSettings.debugAudio = (debugAudioValue == "true" || debugAudioValue == "1" || debugAudioValue == "yes");
 
+            const auto& resampleQualityValue = userEngineSection.getValue("resampleQuality", defaultEngineSection.getValue("resampleQuality"));
+            if (!resampleQualityValue.empty())
+            {
+                if (resampleQualityValue == "linear")
+                    settings.audioSettings.resampleQuality = audio::ResampleQuality::linear;
+                else if (resampleQualityValue == "sinc")
+                    settings.audioSettings.resampleQuality = audio::ResampleQuality::sinc;
+                else
+                    throw std::runtime_error{"Invalid resample quality specified"};
+            }
+
+            const auto& decodeAheadFramesValue = userEngineSection.getValue("decodeAheadFrames", defaultEngineSection.getValue("decodeAheadFrames"));
+            if (!decodeAheadFramesValue.empty()) settings.audioSettings.decodeAheadFrames = static_cast<std::uint32_t>(std::stoul(decodeAheadFramesValue));
+
+            const auto& preDecodeDurationValue = userEngineSection.getValue("preDecodeDuration", defaultEngineSection.getValue("preDecodeDuration"));
+            if (!preDecodeDurationValue.empty()) settings.audioSettings.preDecodeDuration = std::stof(preDecodeDurationValue);
+
+            const auto& streamWindowSizeValue = userEngineSection.getValue("streamWindowSize", defaultEngineSection.getValue("streamWindowSize"));
+            if (!streamWindowSizeValue.empty()) settings.audioSettings.streamWindowSize = static_cast<std::uint32_t>(std::stoul(streamWindowSizeValue));
+
+            const auto& maxVoicesValue = userEngineSection.getValue("maxVoices", defaultEngineSection.getValue("maxVoices"));
+            if (!maxVoicesValue.empty()) settings.audioSettings.maxVoices = static_cast<std::uint32_t>(std::stoul(maxVoicesValue));
+
             settings.audioSettings.audioDevice = userEngineSection.getValue("audioDevice", defaultEngineSection.getValue("audioDevice"));
 
             return settings;
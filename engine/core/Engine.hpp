@@ -86,6 +86,9 @@ namespace ouzel::core
         [[nodiscard]] auto& getNetwork() noexcept { return network; }
         [[nodiscard]] auto& getNetwork() const noexcept { return network; }
 
+        [[nodiscard]] auto& getWorkerPool() noexcept { return workerPool; }
+        [[nodiscard]] auto& getWorkerPool() const noexcept { return workerPool; }
+
         void start();
         void pause();
         void resume();
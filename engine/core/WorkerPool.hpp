@@ -3,13 +3,17 @@
 #ifndef OUZEL_CORE_WORKERPOOL_HPP
 #define OUZEL_CORE_WORKERPOOL_HPP
 
+#include <atomic>
 #include <condition_variable>
 #include <functional>
+#include <initializer_list>
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <stdexcept>
 #include <vector>
 #include "../thread/Thread.hpp"
+#include "../thread/WorkStealingQueue.hpp"
 #include "../utils/Log.hpp"
 
 namespace ouzel::core
@@ -22,23 +26,76 @@ namespace ouzel::core
 
         void add(std::function<void()> task)
         {
-            taskQueue.push(std::move(task));
+            tasks.push_back(std::move(task));
         }
 
-        std::size_t getTaskCount() const noexcept { return taskQueue.size(); }
+        std::size_t getTaskCount() const noexcept { return tasks.size(); }
 
     private:
-        std::queue<std::function<void()>> taskQueue;
+        std::vector<std::function<void()>> tasks;
+    };
+
+    // Tasks with dependencies, a task is started when all of its dependencies have finished
+    class TaskGraph final
+    {
+        friend class WorkerPool;
+    public:
+        using Node = std::size_t;
+
+        TaskGraph() = default;
+
+        Node add(std::function<void()> task)
+        {
+            nodes.push_back(NodeData{std::move(task), {}, 0});
+            return nodes.size() - 1;
+        }
+
+        Node add(std::function<void()> task, std::initializer_list<Node> dependencies)
+        {
+            const auto node = add(std::move(task));
+            for (const auto dependency : dependencies)
+                precede(dependency, node);
+            return node;
+        }
+
+        // makes the second node depend on the first one
+        void precede(Node first, Node second)
+        {
+            if (first >= nodes.size() || second >= nodes.size())
+                throw std::out_of_range{"Invalid task graph node"};
+
+            nodes[first].successors.push_back(second);
+            ++nodes[second].dependencyCount;
+        }
+
+        std::size_t getTaskCount() const noexcept { return nodes.size(); }
+
+    private:
+        struct NodeData final
+        {
+            std::function<void()> task;
+            std::vector<Node> successors;
+            std::size_t dependencyCount = 0;
+        };
+
+        std::vector<NodeData> nodes;
     };
 
     class Future final
     {
         friend class Promise;
     public:
-        void wait()
+        [[nodiscard]] bool isReady() const noexcept
         {
+            return sharedState->count.load(std::memory_order_acquire) == 0;
+        }
+
+        void wait() const
+        {
+            if (isReady()) return;
+
             std::unique_lock lock{sharedState->mutex};
-            sharedState->condition.wait(lock, [this]() noexcept { return sharedState->count == 0; });
+            sharedState->condition.wait(lock, [this]() noexcept { return isReady(); });
         }
 
     private:
@@ -49,7 +106,8 @@ namespace ouzel::core
             {
             }
 
-            std::size_t count = 0;
+            std::atomic<std::size_t> count{0};
+            // used only to put waiters to sleep, finishing a task does not lock it
             std::mutex mutex;
             std::condition_variable condition;
         };
@@ -65,8 +123,13 @@ namespace ouzel::core
     class Promise final
     {
     public:
-        Promise(const TaskGroup& taskGroup) noexcept:
-            sharedState{std::make_shared<Future::State>(taskGroup.getTaskCount())}
+        explicit Promise(std::size_t taskCount):
+            sharedState{std::make_shared<Future::State>(taskCount)}
+        {
+        }
+
+        Promise(const TaskGroup& taskGroup):
+            Promise{taskGroup.getTaskCount()}
         {
         }
 
@@ -77,10 +140,11 @@ namespace ouzel::core
 
         void decrement()
         {
-            std::unique_lock lock{sharedState->mutex};
-
-            if (sharedState->count == 0 || --sharedState->count == 0)
+            if (sharedState->count.fetch_sub(1, std::memory_order_acq_rel) == 1)
             {
+                // lock and unlock the mutex so that the notification can't slip
+                // between the waiter's predicate check and its wait
+                std::unique_lock lock{sharedState->mutex};
                 lock.unlock();
                 sharedState->condition.notify_all();
             }
@@ -93,69 +157,337 @@ namespace ouzel::core
     class WorkerPool final
     {
     public:
-        WorkerPool()
+        WorkerPool():
+            WorkerPool{getDefaultWorkerCount()}
         {
-            const std::size_t cpuCount = std::thread::hardware_concurrency();
-            const std::size_t count = (cpuCount > 1) ? cpuCount - 1 : 1;
+        }
+
+        explicit WorkerPool(std::size_t count)
+        {
+            if (count == 0)
+                throw std::invalid_argument{"Worker pool needs at least one worker"};
 
             for (std::size_t i = 0; i < count; ++i)
-                workers.emplace_back(&WorkerPool::work, this);
+                queues.push_back(std::make_unique<thread::WorkStealingQueue<Task*>>());
+
+            for (std::size_t i = 0; i < count; ++i)
+                workers.emplace_back(&WorkerPool::work, this, i);
         }
 
         ~WorkerPool()
         {
+            std::unique_lock lock{idleMutex};
             running = false;
-            taskQueueCondition.notify_all();
+            lock.unlock();
+            idleCondition.notify_all();
+
+            workers.clear(); // join the threads
+
+            for (const auto& queue : queues)
+                while (const auto task = queue->pop())
+                    delete *task;
+
+            while (!injectedTasks.empty())
+            {
+                delete injectedTasks.front();
+                injectedTasks.pop();
+            }
         }
 
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+        WorkerPool(WorkerPool&&) = delete;
+        WorkerPool& operator=(WorkerPool&&) = delete;
+
+        [[nodiscard]] std::size_t getWorkerCount() const noexcept { return queues.size(); }
+
         Future run(TaskGroup&& taskGroup)
         {
             Promise promise{taskGroup};
             Future future = promise.getFuture();
 
-            std::unique_lock lock{taskQueueMutex};
+            std::vector<Task*> tasks;
+            tasks.reserve(taskGroup.tasks.size());
+            for (auto& function : taskGroup.tasks)
+                tasks.push_back(new Task{promise, std::move(function)});
+            taskGroup.tasks.clear();
+
+            submit(tasks);
+
+            return future;
+        }
+
+        Future run(TaskGraph&& taskGraph)
+        {
+            checkAcyclic(taskGraph);
+
+            Promise promise{taskGraph.getTaskCount()};
+            Future future = promise.getFuture();
 
-            while (!taskGroup.taskQueue.empty())
+            auto state = std::make_shared<GraphState>();
+            state->promise = promise;
+            state->nodes = std::move(taskGraph.nodes);
+            state->remainingDependencies = std::make_unique<std::atomic<std::size_t>[]>(state->nodes.size());
+
+            std::vector<Task*> tasks;
+            for (TaskGraph::Node node = 0; node < state->nodes.size(); ++node)
             {
-                taskQueue.push(std::pair(std::move(promise),
-                                         std::move(taskGroup.taskQueue.front())));
-                taskGroup.taskQueue.pop();
+                state->remainingDependencies[node].store(state->nodes[node].dependencyCount, std::memory_order_relaxed);
+                if (state->nodes[node].dependencyCount == 0)
+                    tasks.push_back(createGraphTask(state, node));
             }
 
-            lock.unlock();
-
-            taskQueueCondition.notify_all();
+            submit(tasks);
 
             return future;
         }
 
+        // splits the range into chunks of grainSize elements and calls
+        // function(first, last) for each chunk, the calling thread takes part in the work
+        template <class Function>
+        void parallelFor(std::size_t first, std::size_t last, std::size_t grainSize, Function function)
+        {
+            if (first >= last) return;
+            if (grainSize == 0) grainSize = 1;
+
+            if (last - first <= grainSize)
+            {
+                function(first, last);
+                return;
+            }
+
+            TaskGroup taskGroup;
+            for (auto chunkFirst = first + grainSize; chunkFirst < last; chunkFirst += grainSize)
+            {
+                const auto chunkLast = (last - chunkFirst > grainSize) ? chunkFirst + grainSize : last;
+                taskGroup.add([&function, chunkFirst, chunkLast]() { function(chunkFirst, chunkLast); });
+            }
+
+            const auto future = run(std::move(taskGroup));
+
+            try
+            {
+                function(first, first + grainSize);
+            }
+            catch (...)
+            {
+                // the queued chunks reference the function, so they have to finish before it goes out of scope
+                wait(future);
+                throw;
+            }
+
+            wait(future);
+        }
+
+        // executes queued tasks on the calling thread until the future is ready
+        void wait(const Future& future)
+        {
+            const auto& context = getWorkerContext();
+            const auto index = (context.pool == this) ? context.index : queues.size();
+
+            while (!future.isReady())
+            {
+                if (const auto task = findTask(index))
+                    execute(task);
+                else if (pendingTaskCount.load(std::memory_order_seq_cst) == 0)
+                {
+                    // all the remaining tasks are already running on other threads
+                    future.wait();
+                    break;
+                }
+                else
+                    std::this_thread::yield();
+            }
+        }
+
     private:
-        void work()
+        struct Task final
         {
-            log(Log::Level::info) << "Worker started";
+            Promise promise;
+            std::function<void()> function;
+        };
 
-            for (;;)
+        struct GraphState final
+        {
+            Promise promise{0};
+            std::vector<TaskGraph::NodeData> nodes;
+            std::unique_ptr<std::atomic<std::size_t>[]> remainingDependencies;
+        };
+
+        struct WorkerContext final
+        {
+            WorkerPool* pool = nullptr;
+            std::size_t index = 0;
+        };
+
+        static std::size_t getDefaultWorkerCount() noexcept
+        {
+            const std::size_t cpuCount = std::thread::hardware_concurrency();
+            return (cpuCount > 1) ? cpuCount - 1 : 1;
+        }
+
+        static WorkerContext& getWorkerContext() noexcept
+        {
+            static thread_local WorkerContext context;
+            return context;
+        }
+
+        static void checkAcyclic(const TaskGraph& taskGraph)
+        {
+            std::vector<std::size_t> dependencyCounts;
+            std::vector<TaskGraph::Node> readyNodes;
+            for (TaskGraph::Node node = 0; node < taskGraph.nodes.size(); ++node)
+            {
+                dependencyCounts.push_back(taskGraph.nodes[node].dependencyCount);
+                if (taskGraph.nodes[node].dependencyCount == 0)
+                    readyNodes.push_back(node);
+            }
+
+            std::size_t visitedCount = 0;
+            while (!readyNodes.empty())
             {
-                std::unique_lock lock{taskQueueMutex};
-                taskQueueCondition.wait(lock, [this]() noexcept { return !running || !taskQueue.empty(); });
-                if (!running) break;
-                auto task = std::move(taskQueue.front());
-                taskQueue.pop();
+                const auto node = readyNodes.back();
+                readyNodes.pop_back();
+                ++visitedCount;
+
+                for (const auto successor : taskGraph.nodes[node].successors)
+                    if (--dependencyCounts[successor] == 0)
+                        readyNodes.push_back(successor);
+            }
+
+            if (visitedCount != taskGraph.nodes.size())
+                throw std::runtime_error{"Task graph contains a cycle"};
+        }
+
+        Task* createGraphTask(const std::shared_ptr<GraphState>& state, TaskGraph::Node node)
+        {
+            return new Task{state->promise, [this, state, node]() {
+                state->nodes[node].task();
+
+                for (const auto successor : state->nodes[node].successors)
+                    if (state->remainingDependencies[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        submit({createGraphTask(state, successor)});
+            }};
+        }
+
+        void submit(const std::vector<Task*>& tasks)
+        {
+            if (tasks.empty()) return;
+
+            pendingTaskCount.fetch_add(tasks.size(), std::memory_order_seq_cst);
+
+            if (const auto& context = getWorkerContext(); context.pool == this)
+            {
+                // nested submission from one of our workers goes to its own queue
+                auto& queue = *queues[context.index];
+                for (const auto task : tasks)
+                    queue.push(task);
+            }
+            else
+            {
+                std::lock_guard lock{injectedTasksMutex};
+                for (const auto task : tasks)
+                    injectedTasks.push(task);
+                injectedTaskCount.store(injectedTasks.size(), std::memory_order_release);
+            }
+
+            if (sleepingWorkerCount.load(std::memory_order_seq_cst) > 0)
+            {
+                std::unique_lock lock{idleMutex};
                 lock.unlock();
+                if (tasks.size() > 1)
+                    idleCondition.notify_all();
+                else
+                    idleCondition.notify_one();
+            }
+        }
+
+        // index is the worker's own queue or queues.size() for threads outside of the pool
+        Task* findTask(std::size_t index)
+        {
+            if (index < queues.size())
+                if (const auto task = queues[index]->pop())
+                    return *task;
+
+            if (injectedTaskCount.load(std::memory_order_acquire) > 0)
+            {
+                std::lock_guard lock{injectedTasksMutex};
+                if (!injectedTasks.empty())
+                {
+                    const auto task = injectedTasks.front();
+                    injectedTasks.pop();
+                    injectedTaskCount.store(injectedTasks.size(), std::memory_order_release);
+                    return task;
+                }
+            }
 
-                task.second();
+            for (std::size_t i = 1; i <= queues.size(); ++i)
+                if (const auto victim = (index + i) % (queues.size() + 1); victim < queues.size())
+                    if (const auto task = queues[victim]->steal())
+                        return *task;
 
-                task.first.decrement();
+            return nullptr;
+        }
+
+        void execute(Task* task)
+        {
+            pendingTaskCount.fetch_sub(1, std::memory_order_relaxed);
+
+            std::unique_ptr<Task> taskPtr{task};
+            taskPtr->function();
+            taskPtr->promise.decrement();
+        }
+
+        void work(std::size_t index)
+        {
+            log(Log::Level::info) << "Worker started";
+
+            auto& context = getWorkerContext();
+            context.pool = this;
+            context.index = index;
+
+            constexpr std::size_t spinCount = 64;
+
+            while (running.load(std::memory_order_relaxed))
+            {
+                Task* task = nullptr;
+                for (std::size_t spin = 0; !task && spin < spinCount; ++spin)
+                    if (!(task = findTask(index)))
+                        std::this_thread::yield();
+
+                if (task)
+                {
+                    execute(task);
+                    continue;
+                }
+
+                sleepingWorkerCount.fetch_add(1, std::memory_order_seq_cst);
+                std::unique_lock lock{idleMutex};
+                idleCondition.wait(lock, [this]() noexcept {
+                    return !running || pendingTaskCount.load(std::memory_order_seq_cst) > 0;
+                });
+                lock.unlock();
+                sleepingWorkerCount.fetch_sub(1, std::memory_order_relaxed);
             }
 
+            context.pool = nullptr;
+
             log(Log::Level::info) << "Worker finished";
         }
 
+        std::atomic_bool running{true};
+        std::vector<std::unique_ptr<thread::WorkStealingQueue<Task*>>> queues;
+
+        std::queue<Task*> injectedTasks;
+        std::atomic<std::size_t> injectedTaskCount{0};
+        std::mutex injectedTasksMutex;
+
+        std::atomic<std::size_t> pendingTaskCount{0};
+        std::atomic<std::size_t> sleepingWorkerCount{0};
+        std::mutex idleMutex;
+        std::condition_variable idleCondition;
+
         std::vector<thread::Thread> workers;
-        bool running = true;
-        std::queue<std::pair<Promise, std::function<void()>>> taskQueue;
-        std::mutex taskQueueMutex;
-        std::condition_variable taskQueueCondition;
     };
 }
 
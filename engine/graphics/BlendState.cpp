@@ -29,12 +29,12 @@ namespace ouzel::graphics
         colorMask{initColorMask},
         enableBlending{initEnableBlending}
     {
-        initGraphics.addCommand(std::make_unique<InitBlendStateCommand>(resource,
-                                                                        initEnableBlending,
-                                                                        initColorBlendSource, initColorBlendDest,
-                                                                        initColorOperation,
-                                                                        initAlphaBlendSource, initAlphaBlendDest,
-                                                                        initAlphaOperation,
-                                                                        initColorMask));
+        initGraphics.addCommand<InitBlendStateCommand>(resource,
+                                                       initEnableBlending,
+                                                       initColorBlendSource, initColorBlendDest,
+                                                       initColorOperation,
+                                                       initAlphaBlendSource, initAlphaBlendDest,
+                                                       initAlphaOperation,
+                                                       initColorMask);
     }
 }
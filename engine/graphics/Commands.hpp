@@ -3,9 +3,18 @@
 #ifndef OUZEL_GRAPHICS_COMMANDS_HPP
 #define OUZEL_GRAPHICS_COMMANDS_HPP
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <new>
 #include <set>
 #include <string>
-#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include "BlendFactor.hpp"
 #include "BlendOperation.hpp"
 #include "BufferType.hpp"
@@ -23,12 +32,84 @@
 #include "TextureType.hpp"
 #include "Vertex.hpp"
 #include "../math/Color.hpp"
+#include "../math/Matrix.hpp"
 #include "../math/Rect.hpp"
+#include "../math/Vector.hpp"
 
 namespace ouzel::graphics
 {
     using ResourceId = std::size_t;
 
+    // view of an array that is stored in the command buffer's memory
+    template <class T>
+    class CommandArray final
+    {
+    public:
+        constexpr CommandArray() noexcept = default;
+        constexpr CommandArray(const T* initData, std::size_t initSize) noexcept:
+            elements{initData}, elementCount{initSize}
+        {
+        }
+
+        [[nodiscard]] constexpr auto data() const noexcept { return elements; }
+        [[nodiscard]] constexpr auto size() const noexcept { return elementCount; }
+        [[nodiscard]] constexpr auto empty() const noexcept { return elementCount == 0; }
+
+        [[nodiscard]] constexpr auto begin() const noexcept { return elements; }
+        [[nodiscard]] constexpr auto end() const noexcept { return elements + elementCount; }
+
+        [[nodiscard]] constexpr auto& operator[](std::size_t index) const noexcept { return elements[index]; }
+
+    private:
+        const T* elements = nullptr;
+        std::size_t elementCount = 0;
+    };
+
+    // non-owning view of a typed constant block that is copied into the command buffer
+    class ShaderConstant final
+    {
+    public:
+        template <std::size_t n>
+        constexpr ShaderConstant(const float (&initData)[n]) noexcept:
+            elements{initData}, elementCount{n}
+        {
+        }
+
+        template <std::size_t n>
+        constexpr ShaderConstant(const std::array<float, n>& initData) noexcept:
+            elements{initData.data()}, elementCount{n}
+        {
+        }
+
+        template <std::size_t dims>
+        constexpr ShaderConstant(const math::Vector<float, dims>& vector) noexcept:
+            elements{vector.v}, elementCount{dims}
+        {
+        }
+
+        template <std::size_t rows, std::size_t cols>
+        constexpr ShaderConstant(const math::Matrix<float, rows, cols>& matrix) noexcept:
+            elements{matrix.m.v}, elementCount{rows * cols}
+        {
+        }
+
+        [[nodiscard]] constexpr auto data() const noexcept { return elements; }
+        [[nodiscard]] constexpr auto size() const noexcept { return elementCount; }
+
+    private:
+        const float* elements;
+        std::size_t elementCount;
+    };
+
+    // range of floats in the command buffer's shader constant storage
+    struct ShaderConstantRange final
+    {
+        std::uint32_t offset = 0;
+        std::uint32_t size = 0;
+    };
+
+    // Commands are placed into the command buffer's memory and are never deleted
+    // through a base pointer, so Command has no virtual destructor
     class Command
     {
     public:
@@ -73,8 +154,6 @@ namespace ouzel::graphics
         {
         }
 
-        virtual ~Command() = default;
-
         const Type type;
     };
 
@@ -420,16 +499,16 @@ namespace ouzel::graphics
     class SetShaderConstantsCommand final: public Command
     {
     public:
-        SetShaderConstantsCommand(std::vector<std::vector<float>> initFragmentShaderConstants,
-                                  std::vector<std::vector<float>> initVertexShaderConstants) noexcept(false):
+        constexpr SetShaderConstantsCommand(ShaderConstantRange initFragmentShaderConstants,
+                                            ShaderConstantRange initVertexShaderConstants) noexcept:
             Command{Type::setShaderConstants},
             fragmentShaderConstants{initFragmentShaderConstants},
             vertexShaderConstants{initVertexShaderConstants}
         {
         }
 
-        const std::vector<std::vector<float>> fragmentShaderConstants;
-        const std::vector<std::vector<float>> vertexShaderConstants;
+        const ShaderConstantRange fragmentShaderConstants;
+        const ShaderConstantRange vertexShaderConstants;
     };
 
     class InitTextureCommand final: public Command
@@ -525,13 +604,13 @@ namespace ouzel::graphics
     class SetTexturesCommand final: public Command
     {
     public:
-        explicit SetTexturesCommand(const std::vector<ResourceId>& initTextures) noexcept(false):
+        explicit constexpr SetTexturesCommand(CommandArray<ResourceId> initTextures) noexcept:
             Command{Type::setTextures},
             textures{initTextures}
         {
         }
 
-        const std::vector<ResourceId> textures;
+        const CommandArray<ResourceId> textures;
     };
 
     class InitRenderPassCommand final: public Command
@@ -564,39 +643,212 @@ namespace ouzel::graphics
         const std::set<ResourceId> renderTargets;
     };
 
+    // Linear allocator for commands and their data. The memory is kept when the buffer
+    // is cleared, so that it can be reused for the next frame without heap allocations.
     class CommandBuffer final
     {
+        struct Entry final
+        {
+            Entry* next;
+            Command* command;
+            void (*destroy)(Command*);
+        };
+
     public:
+        class ConstIterator final
+        {
+        public:
+            explicit ConstIterator(const Entry* initEntry) noexcept: entry{initEntry} {}
+
+            [[nodiscard]] const Command* operator*() const noexcept { return entry->command; }
+
+            ConstIterator& operator++() noexcept
+            {
+                entry = entry->next;
+                return *this;
+            }
+
+            [[nodiscard]] bool operator==(const ConstIterator& other) const noexcept { return entry == other.entry; }
+            [[nodiscard]] bool operator!=(const ConstIterator& other) const noexcept { return entry != other.entry; }
+
+        private:
+            const Entry* entry;
+        };
+
         CommandBuffer() = default;
         explicit CommandBuffer(const std::string& initName) noexcept(false):
             name{initName}
         {
         }
 
+        ~CommandBuffer()
+        {
+            destroyCommands();
+        }
+
+        CommandBuffer(const CommandBuffer&) = delete;
+        CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+        CommandBuffer(CommandBuffer&& other) noexcept:
+            name{std::move(other.name)},
+            blocks{std::move(other.blocks)},
+            blockIndex{std::exchange(other.blockIndex, 0)},
+            blockOffset{std::exchange(other.blockOffset, 0)},
+            firstEntry{std::exchange(other.firstEntry, nullptr)},
+            lastEntry{std::exchange(other.lastEntry, nullptr)},
+            commandCount{std::exchange(other.commandCount, 0)},
+            shaderConstants{std::move(other.shaderConstants)}
+        {
+            other.blocks.clear();
+            other.shaderConstants.clear();
+        }
+
+        CommandBuffer& operator=(CommandBuffer&& other) noexcept
+        {
+            if (&other == this) return *this;
+
+            destroyCommands();
+            name = std::move(other.name);
+            blocks = std::move(other.blocks);
+            other.blocks.clear();
+            blockIndex = std::exchange(other.blockIndex, 0);
+            blockOffset = std::exchange(other.blockOffset, 0);
+            firstEntry = std::exchange(other.firstEntry, nullptr);
+            lastEntry = std::exchange(other.lastEntry, nullptr);
+            commandCount = std::exchange(other.commandCount, 0);
+            shaderConstants = std::move(other.shaderConstants);
+            other.shaderConstants.clear();
+
+            return *this;
+        }
+
         auto& getName() const noexcept { return name; }
 
-        auto isEmpty() const noexcept { return commands.empty(); }
+        auto isEmpty() const noexcept { return firstEntry == nullptr; }
+        auto getCommandCount() const noexcept { return commandCount; }
 
-        void pushCommand(std::unique_ptr<Command> command)
+        template <class T, class... Args>
+        void pushCommand(Args&&... args)
         {
-            commands.push(std::move(command));
+            static_assert(std::is_base_of_v<Command, T>);
+            static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+            // the entry and the command are allocated as one record
+            constexpr auto commandOffset = (sizeof(Entry) + alignof(T) - 1) & ~(alignof(T) - 1);
+            const auto memory = static_cast<std::byte*>(allocate(commandOffset + sizeof(T),
+                                                                 std::max(alignof(Entry), alignof(T))));
+
+            const auto command = new(memory + commandOffset) T(std::forward<Args>(args)...);
+            const auto entry = new(memory) Entry{nullptr, command, nullptr};
+
+            if constexpr (!std::is_trivially_destructible_v<T>)
+                entry->destroy = [](Command* c) noexcept { static_cast<T*>(c)->~T(); };
+
+            if (lastEntry) lastEntry->next = entry;
+            else firstEntry = entry;
+            lastEntry = entry;
+            ++commandCount;
         }
 
-        std::unique_ptr<Command> popCommand()
+        // copies the data into the command buffer, the result is valid until the buffer is cleared
+        template <class T>
+        CommandArray<T> pushData(const T* data, std::size_t count)
         {
-            auto result = std::move(commands.front());
-            commands.pop();
-            return result;
+            static_assert(std::is_trivially_copyable_v<T>);
+            static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+            if (count == 0) return CommandArray<T>{};
+
+            const auto memory = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+            std::copy(data, data + count, memory);
+            return CommandArray<T>{memory, count};
         }
 
-        auto& getCommands() const
+        // appends the constant blocks to the shader constant storage of this frame,
+        // commands refer to it by offset, so the storage can grow without invalidating them
+        ShaderConstantRange pushShaderConstants(std::initializer_list<ShaderConstant> constants)
         {
-            return commands;
+            const auto offset = shaderConstants.size();
+            for (const auto& constant : constants)
+                shaderConstants.insert(shaderConstants.end(), constant.data(), constant.data() + constant.size());
+
+            return ShaderConstantRange{
+                static_cast<std::uint32_t>(offset),
+                static_cast<std::uint32_t>(shaderConstants.size() - offset)
+            };
         }
 
+        [[nodiscard]] const float* getShaderConstants(const ShaderConstantRange& range) const noexcept
+        {
+            return shaderConstants.data() + range.offset;
+        }
+
+        // destroys the commands but keeps the memory
+        void clear() noexcept
+        {
+            destroyCommands();
+            shaderConstants.clear();
+            blockIndex = 0;
+            blockOffset = 0;
+            firstEntry = nullptr;
+            lastEntry = nullptr;
+            commandCount = 0;
+        }
+
+        ConstIterator begin() const noexcept { return ConstIterator{firstEntry}; }
+        ConstIterator end() const noexcept { return ConstIterator{nullptr}; }
+
     private:
+        static constexpr std::size_t blockSize = 64 * 1024;
+
+        struct Block final
+        {
+            explicit Block(std::size_t initSize):
+                data{new std::byte[initSize]},
+                size{initSize}
+            {
+            }
+
+            std::unique_ptr<std::byte[]> data;
+            std::size_t size;
+        };
+
+        void* allocate(std::size_t size, std::size_t alignment)
+        {
+            for (;;)
+            {
+                if (blockIndex < blocks.size())
+                {
+                    auto& block = blocks[blockIndex];
+                    const auto offset = (blockOffset + alignment - 1) & ~(alignment - 1);
+                    if (offset + size <= block.size)
+                    {
+                        blockOffset = offset + size;
+                        return block.data.get() + offset;
+                    }
+
+                    ++blockIndex;
+                    blockOffset = 0;
+                }
+                else
+                    blocks.emplace_back(std::max(size, blockSize));
+            }
+        }
+
+        void destroyCommands() noexcept
+        {
+            for (auto entry = firstEntry; entry; entry = entry->next)
+                if (entry->destroy) entry->destroy(entry->command);
+        }
+
         std::string name;
-        std::queue<std::unique_ptr<Command>> commands;
+        std::vector<Block> blocks;
+        std::size_t blockIndex = 0;
+        std::size_t blockOffset = 0;
+        Entry* firstEntry = nullptr;
+        Entry* lastEntry = nullptr;
+        std::size_t commandCount = 0;
+        std::vector<float> shaderConstants;
     };
 }
 
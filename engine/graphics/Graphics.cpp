@@ -4,6 +4,7 @@
 #  include <TargetConditionals.h>
 #endif
 #include <stdexcept>
+#include <utility>
 #include "../core/Setup.h"
 #include "Graphics.hpp"
 #include "GraphicsError.hpp"
@@ -163,7 +164,16 @@ namespace ouzel::graphics
     {
         size = newSize;
 
-        addCommand(std::make_unique<ResizeCommand>(newSize));
+        addCommand<ResizeCommand>(newSize);
+        invalidateState();
+    }
+
+    void Graphics::invalidateState() noexcept
+    {
+        currentViewport.reset();
+        currentDepthStencilState.reset();
+        currentPipelineState.reset();
+        currentTextures.reset();
     }
 
     void Graphics::saveScreenshot(const std::string& filename)
@@ -173,7 +183,8 @@ namespace ouzel::graphics
 
     void Graphics::setRenderTarget(std::size_t renderTarget)
     {
-        addCommand(std::make_unique<SetRenderTargetCommand>(renderTarget));
+        addCommand<SetRenderTargetCommand>(renderTarget);
+        invalidateState();
     }
 
     void Graphics::clearRenderTarget(bool clearColorBuffer,
@@ -183,29 +194,46 @@ namespace ouzel::graphics
                                      float clearDepth,
                                      std::uint32_t clearStencil)
     {
-        addCommand(std::make_unique<ClearRenderTargetCommand>(clearColorBuffer,
-                                                              clearDepthBuffer,
-                                                              clearStencilBuffer,
-                                                              clearColor,
-                                                              clearDepth,
-                                                              clearStencil));
+        addCommand<ClearRenderTargetCommand>(clearColorBuffer,
+                                             clearDepthBuffer,
+                                             clearStencilBuffer,
+                                             clearColor,
+                                             clearDepth,
+                                             clearStencil);
+        invalidateState();
     }
 
     void Graphics::setScissorTest(bool enabled, const math::Rect<float>& rectangle)
     {
-        addCommand(std::make_unique<SetScissorTestCommand>(enabled, rectangle));
+        addCommand<SetScissorTestCommand>(enabled, rectangle);
+        invalidateState(); // Metal starts a new render command encoder
     }
 
     void Graphics::setViewport(const math::Rect<float>& viewport)
     {
-        addCommand(std::make_unique<SetViewportCommand>(viewport));
+        if (currentViewport == viewport)
+        {
+            ++droppedCommandCount;
+            return;
+        }
+
+        addCommand<SetViewportCommand>(viewport);
+        currentViewport = viewport;
     }
 
     void Graphics::setDepthStencilState(std::size_t depthStencilState,
                                         std::uint32_t stencilReferenceValue)
     {
-        addCommand(std::make_unique<SetDepthStencilStateCommand>(depthStencilState,
-                                                                 stencilReferenceValue));
+        const DepthStencilStateDesc state{depthStencilState, stencilReferenceValue};
+        if (currentDepthStencilState == state)
+        {
+            ++droppedCommandCount;
+            return;
+        }
+
+        addCommand<SetDepthStencilStateCommand>(depthStencilState,
+                                                stencilReferenceValue);
+        currentDepthStencilState = state;
     }
 
     void Graphics::setPipelineState(std::size_t blendState,
@@ -213,10 +241,18 @@ namespace ouzel::graphics
                                     CullMode cullMode,
                                     FillMode fillMode)
     {
-        addCommand(std::make_unique<SetPipelineStateCommand>(blendState,
-                                                             shader,
-                                                             cullMode,
-                                                             fillMode));
+        const PipelineStateDesc state{blendState, shader, cullMode, fillMode};
+        if (currentPipelineState == state)
+        {
+            ++droppedCommandCount;
+            return;
+        }
+
+        addCommand<SetPipelineStateCommand>(blendState,
+                                            shader,
+                                            cullMode,
+                                            fillMode);
+        currentPipelineState = state;
     }
 
     void Graphics::draw(std::size_t indexBuffer,
@@ -229,31 +265,47 @@ namespace ouzel::graphics
         if (!indexBuffer || !vertexBuffer)
             throw Error{"Invalid mesh buffer passed to render queue"};
 
-        addCommand(std::make_unique<DrawCommand>(indexBuffer,
-                                                 indexCount,
-                                                 indexSize,
-                                                 vertexBuffer,
-                                                 drawMode,
-                                                 startIndex));
+        addCommand<DrawCommand>(indexBuffer,
+                                indexCount,
+                                indexSize,
+                                vertexBuffer,
+                                drawMode,
+                                startIndex);
+        ++drawCallCount;
     }
 
-    void Graphics::setShaderConstants(const std::vector<std::vector<float>>& fragmentShaderConstants,
-                                      const std::vector<std::vector<float>>& vertexShaderConstants)
+    void Graphics::setShaderConstants(std::initializer_list<ShaderConstant> fragmentShaderConstants,
+                                      std::initializer_list<ShaderConstant> vertexShaderConstants)
     {
-        addCommand(std::make_unique<SetShaderConstantsCommand>(fragmentShaderConstants,
-                                                               vertexShaderConstants));
+        const auto fragmentConstants = commandBuffer.pushShaderConstants(fragmentShaderConstants);
+        const auto vertexConstants = commandBuffer.pushShaderConstants(vertexShaderConstants);
+        addCommand<SetShaderConstantsCommand>(fragmentConstants, vertexConstants);
     }
 
     void Graphics::setTextures(const std::vector<std::size_t>& textures)
     {
-        addCommand(std::make_unique<SetTexturesCommand>(textures));
+        if (currentTextures == textures)
+        {
+            ++droppedCommandCount;
+            return;
+        }
+
+        addCommand<SetTexturesCommand>(commandBuffer.pushData(textures.data(), textures.size()));
+        currentTextures = textures;
     }
 
     void Graphics::present()
     {
-        addCommand(std::make_unique<PresentCommand>());
+        addCommand<PresentCommand>();
+        invalidateState();
+
+        device->drawCallCount = std::exchange(drawCallCount, 0);
+        device->batchCount = std::exchange(batchCount, 0);
+        device->commandCount = static_cast<std::uint32_t>(commandBuffer.getCommandCount());
+        device->droppedCommandCount = std::exchange(droppedCommandCount, 0);
+
         device->submitCommandBuffer(std::move(commandBuffer));
-        commandBuffer = CommandBuffer();
+        commandBuffer = device->getFreeCommandBuffer();
     }
 
     bool Graphics::getRefillQueue(bool waitForNextFrame) const
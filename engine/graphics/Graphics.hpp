@@ -4,9 +4,12 @@
 #define OUZEL_GRAPHICS_GRAPHICS_HPP
 
 #include <cstdint>
+#include <initializer_list>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include "Commands.hpp"
 #include "Driver.hpp"
@@ -66,13 +69,27 @@ namespace ouzel::graphics
                   std::size_t vertexBuffer,
                   DrawMode drawMode,
                   std::uint32_t startIndex);
-        void setShaderConstants(const std::vector<std::vector<float>>& fragmentShaderConstants,
-                                const std::vector<std::vector<float>>& vertexShaderConstants);
+        void setShaderConstants(std::initializer_list<ShaderConstant> fragmentShaderConstants,
+                                std::initializer_list<ShaderConstant> vertexShaderConstants);
         void setTextures(const std::vector<std::size_t>& textures);
 
-        void addCommand(std::unique_ptr<Command> command)
+        // marks the last draw call as a batch of merged sprites
+        void countBatch() noexcept { ++batchCount; }
+
+        template <class T, class... Args>
+        void addCommand(Args&&... args)
         {
-            commandBuffer.pushCommand(std::move(command));
+            // resource ids are reused, so a bound id may refer to a new object after initialization
+            if constexpr (std::is_same_v<T, InitBlendStateCommand> ||
+                          std::is_same_v<T, InitShaderCommand>)
+                currentPipelineState.reset();
+            else if constexpr (std::is_same_v<T, InitDepthStencilStateCommand>)
+                currentDepthStencilState.reset();
+            else if constexpr (std::is_same_v<T, InitTextureCommand> ||
+                               std::is_same_v<T, SetTextureParametersCommand>)
+                currentTextures.reset();
+
+            commandBuffer.pushCommand<T>(std::forward<Args>(args)...);
         }
         void present();
 
@@ -98,11 +115,51 @@ namespace ouzel::graphics
         void changeScreen(const std::uintptr_t screenId);
         void setSize(const math::Size<std::uint32_t, 2>& newSize);
 
+        // forgets the tracked state, e.g. when the backend may start a new render pass
+        void invalidateState() noexcept;
+
         SamplerFilter textureFilter = SamplerFilter::point;
         std::uint32_t maxAnisotropy = 1;
 
         math::Size<std::uint32_t, 2> size;
         CommandBuffer commandBuffer;
+        std::uint32_t drawCallCount = 0;
+        std::uint32_t batchCount = 0;
+
+        // state that was last sent to the render device, used to drop redundant commands
+        struct PipelineStateDesc final
+        {
+            [[nodiscard]] bool operator==(const PipelineStateDesc& other) const noexcept
+            {
+                return blendState == other.blendState &&
+                    shader == other.shader &&
+                    cullMode == other.cullMode &&
+                    fillMode == other.fillMode;
+            }
+
+            std::size_t blendState;
+            std::size_t shader;
+            CullMode cullMode;
+            FillMode fillMode;
+        };
+
+        struct DepthStencilStateDesc final
+        {
+            [[nodiscard]] bool operator==(const DepthStencilStateDesc& other) const noexcept
+            {
+                return depthStencilState == other.depthStencilState &&
+                    stencilReferenceValue == other.stencilReferenceValue;
+            }
+
+            std::size_t depthStencilState;
+            std::uint32_t stencilReferenceValue;
+        };
+
+        std::optional<math::Rect<float>> currentViewport;
+        std::optional<DepthStencilStateDesc> currentDepthStencilState;
+        std::optional<PipelineStateDesc> currentPipelineState;
+        std::optional<std::vector<std::size_t>> currentTextures;
+        std::uint32_t droppedCommandCount = 0;
 
         std::unique_ptr<RenderDevice> device;
     };
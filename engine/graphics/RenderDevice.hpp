@@ -10,6 +10,7 @@
 #include <mutex>
 #include <queue>
 #include <set>
+#include <vector>
 #include "Commands.hpp"
 #include "Driver.hpp"
 #include "SamplerFilter.hpp"
@@ -108,7 +109,21 @@ namespace ouzel::graphics
             commandQueueCondition.notify_all();
         }
 
+        // returns a processed command buffer that still holds its memory
+        CommandBuffer getFreeCommandBuffer()
+        {
+            std::scoped_lock lock{freeCommandBuffersMutex};
+            if (freeCommandBuffers.empty()) return CommandBuffer{};
+
+            auto result = std::move(freeCommandBuffers.back());
+            freeCommandBuffers.pop_back();
+            return result;
+        }
+
         auto getDrawCallCount() const noexcept { return drawCallCount; }
+        auto getBatchCount() const noexcept { return batchCount; }
+        auto getCommandCount() const noexcept { return commandCount; }
+        auto getDroppedCommandCount() const noexcept { return droppedCommandCount; } // redundant state changes
 
         auto getAPIMajorVersion() const noexcept { return apiVersion.v[0]; }
         auto getAPIMinorVersion() const noexcept { return apiVersion.v[1]; }
@@ -178,6 +193,14 @@ namespace ouzel::graphics
     protected:
         void executeAll();
 
+        void recycleCommandBuffer(CommandBuffer&& commandBuffer)
+        {
+            commandBuffer.clear();
+
+            std::scoped_lock lock{freeCommandBuffersMutex};
+            freeCommandBuffers.push_back(std::move(commandBuffer));
+        }
+
         virtual void changeScreen(const std::uintptr_t) {}
         virtual void generateScreenshot(const std::string& filename);
         void saveScreenshot(const std::string& filename,
@@ -212,11 +235,17 @@ namespace ouzel::graphics
         math::Matrix<float, 4> renderTargetProjectionTransform = math::identityMatrix<float, 4>;
 
         std::uint32_t drawCallCount = 0;
+        std::uint32_t batchCount = 0;
+        std::uint32_t commandCount = 0;
+        std::uint32_t droppedCommandCount = 0;
 
         std::queue<CommandBuffer> commandQueue;
         std::mutex commandQueueMutex;
         std::condition_variable commandQueueCondition;
 
+        std::vector<CommandBuffer> freeCommandBuffers;
+        std::mutex freeCommandBuffersMutex;
+
         std::queue<std::function<void()>> executeQueue;
         std::mutex executeMutex;
 
@@ -16,8 +16,8 @@ namespace ouzel::graphics
         for (const auto& renderTarget : renderTargets)
             renderTargetIds.insert(renderTarget ? renderTarget->getResource() : 0);
 
-        graphics->addCommand(std::make_unique<InitRenderPassCommand>(resource,
-                                                                     renderTargetIds));
+        graphics->addCommand<InitRenderPassCommand>(resource,
+                                                    renderTargetIds);
     }
 
     void RenderPass::setRenderTargets(const std::vector<RenderTarget*>& newRenderTargets)
@@ -30,7 +30,7 @@ namespace ouzel::graphics
             renderTargetIds.insert(renderTarget ? renderTarget->getResource() : 0);
 
         if (resource)
-            graphics->addCommand(std::make_unique<SetRenderPassParametersCommand>(resource,
-                                                                                  renderTargetIds));
+            graphics->addCommand<SetRenderPassParametersCommand>(resource,
+                                                                 renderTargetIds);
     }
 }
@@ -678,14 +678,14 @@ namespace ouzel::graphics
 
         const auto levels = calculateSizes(size, mipmaps, pixelFormat);
 
-        initGraphics.addCommand(std::make_unique<InitTextureCommand>(resource,
-                                                                     levels,
-                                                                     TextureType::twoDimensional,
-                                                                     flags,
-                                                                     sampleCount,
-                                                                     pixelFormat,
-                                                                     filter,
-                                                                     maxAnisotropy));
+        initGraphics.addCommand<InitTextureCommand>(resource,
+                                                    levels,
+                                                    TextureType::twoDimensional,
+                                                    flags,
+                                                    sampleCount,
+                                                    pixelFormat,
+                                                    filter,
+                                                    maxAnisotropy);
     }
 
     Texture::Texture(Graphics& initGraphics,
@@ -713,14 +713,14 @@ namespace ouzel::graphics
 
         std::vector<std::pair<math::Size<std::uint32_t, 2>, std::vector<std::uint8_t>>> levels = calculateSizes(size, initData, mipmaps, pixelFormat);
 
-        initGraphics.addCommand(std::make_unique<InitTextureCommand>(resource,
-                                                                     levels,
-                                                                     TextureType::twoDimensional,
-                                                                     flags,
-                                                                     sampleCount,
-                                                                     pixelFormat,
-                                                                     filter,
-                                                                     maxAnisotropy));
+        initGraphics.addCommand<InitTextureCommand>(resource,
+                                                    levels,
+                                                    TextureType::twoDimensional,
+                                                    flags,
+                                                    sampleCount,
+                                                    pixelFormat,
+                                                    filter,
+                                                    maxAnisotropy);
     }
 
     Texture::Texture(Graphics& initGraphics,
@@ -750,14 +750,14 @@ namespace ouzel::graphics
             levels.resize(1);
         }
 
-        initGraphics.addCommand(std::make_unique<InitTextureCommand>(resource,
-                                                                     levels,
-                                                                     TextureType::twoDimensional,
-                                                                     flags,
-                                                                     sampleCount,
-                                                                     pixelFormat,
-                                                                     filter,
-                                                                     maxAnisotropy));
+        initGraphics.addCommand<InitTextureCommand>(resource,
+                                                    levels,
+                                                    TextureType::twoDimensional,
+                                                    flags,
+                                                    sampleCount,
+                                                    pixelFormat,
+                                                    filter,
+                                                    maxAnisotropy);
     }
 
     void Texture::setData(const std::vector<std::uint8_t>& newData, CubeFace face)
@@ -769,9 +769,9 @@ namespace ouzel::graphics
         const auto levels = calculateSizes(size, newData, mipmaps, pixelFormat);
 
         if (resource)
-            graphics->addCommand(std::make_unique<SetTextureDataCommand>(resource,
-                                                                         levels,
-                                                                         face));
+            graphics->addCommand<SetTextureDataCommand>(resource,
+                                                        levels,
+                                                        face);
     }
 
     void Texture::setFilter(SamplerFilter newFilter)
@@ -779,13 +779,13 @@ namespace ouzel::graphics
         filter = newFilter;
 
         if (resource)
-            graphics->addCommand(std::make_unique<SetTextureParametersCommand>(resource,
-                                                                               filter,
-                                                                               addressX,
-                                                                               addressY,
-                                                                               addressZ,
-                                                                               borderColor,
-                                                                               maxAnisotropy));
+            graphics->addCommand<SetTextureParametersCommand>(resource,
+                                                              filter,
+                                                              addressX,
+                                                              addressY,
+                                                              addressZ,
+                                                              borderColor,
+                                                              maxAnisotropy);
     }
 
     void Texture::setAddressX(SamplerAddressMode newAddressX)
@@ -793,13 +793,13 @@ namespace ouzel::graphics
         addressX = newAddressX;
 
         if (resource)
-            graphics->addCommand(std::make_unique<SetTextureParametersCommand>(resource,
-                                                                               filter,
-                                                                               addressX,
-                                                                               addressY,
-                                                                               addressZ,
-                                                                               borderColor,
-                                                                               maxAnisotropy));
+            graphics->addCommand<SetTextureParametersCommand>(resource,
+                                                              filter,
+                                                              addressX,
+                                                              addressY,
+                                                              addressZ,
+                                                              borderColor,
+                                                              maxAnisotropy);
     }
 
     void Texture::setAddressY(SamplerAddressMode newAddressY)
@@ -807,13 +807,13 @@ namespace ouzel::graphics
         addressY = newAddressY;
 
         if (resource)
-            graphics->addCommand(std::make_unique<SetTextureParametersCommand>(resource,
-                                                                               filter,
-                                                                               addressX,
-                                                                               addressY,
-                                                                               addressZ,
-                                                                               borderColor,
-                                                                               maxAnisotropy));
+            graphics->addCommand<SetTextureParametersCommand>(resource,
+                                                              filter,
+                                                              addressX,
+                                                              addressY,
+                                                              addressZ,
+                                                              borderColor,
+                                                              maxAnisotropy);
     }
 
     void Texture::setAddressZ(SamplerAddressMode newAddressZ)
@@ -821,13 +821,13 @@ namespace ouzel::graphics
         addressZ = newAddressZ;
 
         if (resource)
-            graphics->addCommand(std::make_unique<SetTextureParametersCommand>(resource,
-                                                                               filter,
-                                                                               addressX,
-                                                                               addressY,
-                                                                               addressZ,
-                                                                               borderColor,
-                                                                               maxAnisotropy));
+            graphics->addCommand<SetTextureParametersCommand>(resource,
+                                                              filter,
+                                                              addressX,
+                                                              addressY,
+                                                              addressZ,
+                                                              borderColor,
+                                                              maxAnisotropy);
     }
 
     void Texture::setBorderColor(math::Color newBorderColor)
@@ -835,13 +835,13 @@ namespace ouzel::graphics
         borderColor = newBorderColor;
 
         if (resource)
-            graphics->addCommand(std::make_unique<SetTextureParametersCommand>(resource,
-                                                                               filter,
-                                                                               addressX,
-                                                                               addressY,
-                                                                               addressZ,
-                                                                               borderColor,
-                                                                               maxAnisotropy));
+            graphics->addCommand<SetTextureParametersCommand>(resource,
+                                                              filter,
+                                                              addressX,
+                                                              addressY,
+                                                              addressZ,
+                                                              borderColor,
+                                                              maxAnisotropy);
     }
 
     void Texture::setMaxAnisotropy(std::uint32_t newMaxAnisotropy)
@@ -849,12 +849,12 @@ namespace ouzel::graphics
         maxAnisotropy = newMaxAnisotropy;
 
         if (resource)
-            graphics->addCommand(std::make_unique<SetTextureParametersCommand>(resource,
-                                                                               filter,
-                                                                               addressX,
-                                                                               addressY,
-                                                                               addressZ,
-                                                                               borderColor,
-                                                                               maxAnisotropy));
+            graphics->addCommand<SetTextureParametersCommand>(resource,
+                                                              filter,
+                                                              addressX,
+                                                              addressY,
+                                                              addressZ,
+                                                              borderColor,
+                                                              maxAnisotropy);
     }
 }
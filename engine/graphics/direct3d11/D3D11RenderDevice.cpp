@@ -285,7 +285,7 @@ namespace ouzel::graphics::d3d11
     {
         running = false;
         CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
+        commandBuffer.pushCommand<PresentCommand>();
         submitCommandBuffer(std::move(commandBuffer));
 
         if (renderThread.isJoinable()) renderThread.join();
@@ -304,8 +304,6 @@ namespace ouzel::graphics::d3d11
         graphics::RenderDevice::process();
         executeAll();
 
-        std::vector<float> shaderData;
-
         std::size_t fillModeIndex = 0U;
         std::size_t scissorEnableIndex = 0U;
         std::size_t cullModeIndex = 0U;
@@ -316,7 +314,6 @@ namespace ouzel::graphics::d3d11
         std::vector<ID3D11SamplerState*> currentSamplerStates;
 
         CommandBuffer commandBuffer;
-        std::unique_ptr<Command> command;
 
         for (;;)
         {
@@ -326,15 +323,13 @@ namespace ouzel::graphics::d3d11
             commandQueue.pop();
             lock.unlock();
 
-            while (!commandBuffer.isEmpty())
+            for (const auto command : commandBuffer)
             {
-                command = commandBuffer.popCommand();
-
                 switch (command->type)
                 {
                     case Command::Type::resize:
                     {
-                        const auto resizeCommand = static_cast<const ResizeCommand*>(command.get());
+                        const auto resizeCommand = static_cast<const ResizeCommand*>(command);
                         resizeBackBuffer(static_cast<UINT>(resizeCommand->size.v[0]),
                                          static_cast<UINT>(resizeCommand->size.v[1]));
                         break;
@@ -351,14 +346,14 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::deleteResource:
                     {
-                        const auto deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command.get());
+                        const auto deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command);
                         resources[deleteResourceCommand->resource - 1].reset();
                         break;
                     }
 
                     case Command::Type::initRenderTarget:
                     {
-                        const auto initRenderTargetCommand = static_cast<const InitRenderTargetCommand*>(command.get());
+                        const auto initRenderTargetCommand = static_cast<const InitRenderTargetCommand*>(command);
 
                         std::set<Texture*> colorTextures;
                         for (const auto colorTextureId : initRenderTargetCommand->colorTextures)
@@ -376,7 +371,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setRenderTarget:
                     {
-                        const auto setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command.get());
+                        const auto setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command);
 
                         if (currentRenderTarget)
                             currentRenderTarget->resolve();
@@ -400,7 +395,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::clearRenderTarget:
                     {
-                        const auto clearCommand = static_cast<const ClearRenderTargetCommand*>(command.get());
+                        const auto clearCommand = static_cast<const ClearRenderTargetCommand*>(command);
 
                         const std::array<FLOAT, 4> frameBufferClearColor{
                             clearCommand->clearColor.normR(),
@@ -439,7 +434,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setScissorTest:
                     {
-                        const auto setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command.get());
+                        const auto setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command);
 
                         if (setScissorTestCommand->enabled)
                         {
@@ -461,7 +456,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setViewport:
                     {
-                        const auto setViewportCommand = static_cast<const SetViewportCommand*>(command.get());
+                        const auto setViewportCommand = static_cast<const SetViewportCommand*>(command);
 
                         D3D11_VIEWPORT viewport;
                         viewport.MinDepth = 0.0F;
@@ -477,7 +472,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::initDepthStencilState:
                     {
-                        const auto initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command.get());
+                        const auto initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command);
                         auto depthStencilState = std::make_unique<DepthStencilState>(*this,
                                                                                      initDepthStencilStateCommand->depthTest,
                                                                                      initDepthStencilStateCommand->depthWrite,
@@ -502,7 +497,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setDepthStencilState:
                     {
-                        const auto setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command.get());
+                        const auto setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command);
 
                         if (setDepthStencilStateCommand->depthStencilState)
                         {
@@ -519,7 +514,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setPipelineState:
                     {
-                        const auto setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command.get());
+                        const auto setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command);
 
                         const auto blendState = getResource<BlendState>(setPipelineStateCommand->blendState);
                         const auto shader = getResource<Shader>(setPipelineStateCommand->shader);
@@ -569,7 +564,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::draw:
                     {
-                        const auto drawCommand = static_cast<const DrawCommand*>(command.get());
+                        const auto drawCommand = static_cast<const DrawCommand*>(command);
 
                         // draw mesh buffer
                         const auto indexBuffer = getResource<Buffer>(drawCommand->indexBuffer);
@@ -599,7 +594,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::initBlendState:
                     {
-                        const auto initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command.get());
+                        const auto initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command);
 
                         auto blendState = std::make_unique<BlendState>(*this,
                                                                        initBlendStateCommand->enableBlending,
@@ -619,7 +614,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::initBuffer:
                     {
-                        const auto initBufferCommand = static_cast<const InitBufferCommand*>(command.get());
+                        const auto initBufferCommand = static_cast<const InitBufferCommand*>(command);
 
                         auto buffer = std::make_unique<Buffer>(*this,
                                                                initBufferCommand->bufferType,
@@ -635,7 +630,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setBufferData:
                     {
-                        const auto setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command.get());
+                        const auto setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command);
 
                         const auto buffer = getResource<Buffer>(setBufferDataCommand->buffer);
                         buffer->setData(setBufferDataCommand->data);
@@ -644,7 +639,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::initShader:
                     {
-                        const auto initShaderCommand = static_cast<const InitShaderCommand*>(command.get());
+                        const auto initShaderCommand = static_cast<const InitShaderCommand*>(command);
 
                         auto shader = std::make_unique<Shader>(*this,
                                                                initShaderCommand->fragmentShader,
@@ -663,59 +658,49 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setShaderConstants:
                     {
-                        const auto setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command.get());
+                        const auto setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command);
 
                         if (!currentShader)
                             throw std::runtime_error{"No shader set"};
 
                         // pixel shader constants
                         const auto& fragmentShaderConstantLocations = currentShader->getFragmentShaderConstantLocations();
+                        const auto& fragmentShaderConstants = setShaderConstantsCommand->fragmentShaderConstants;
 
-                        if (setShaderConstantsCommand->fragmentShaderConstants.size() > fragmentShaderConstantLocations.size())
-                            throw std::runtime_error{"Invalid pixel shader constant size"};
-
-                        shaderData.clear();
-
-                        for (std::size_t i = 0; i < setShaderConstantsCommand->fragmentShaderConstants.size(); ++i)
+                        std::uint32_t fragmentShaderConstantSize = 0;
+                        for (const auto& fragmentShaderConstantLocation : fragmentShaderConstantLocations)
                         {
-                            const auto& fragmentShaderConstantLocation = fragmentShaderConstantLocations[i];
-                            const auto& fragmentShaderConstant = setShaderConstantsCommand->fragmentShaderConstants[i];
-
-                            if (sizeof(float) * fragmentShaderConstant.size() != fragmentShaderConstantLocation.size)
-                                throw std::runtime_error{"Invalid pixel shader constant size"};
-
-                            shaderData.insert(shaderData.end(), fragmentShaderConstant.begin(), fragmentShaderConstant.end());
+                            if (fragmentShaderConstantSize >= sizeof(float) * fragmentShaderConstants.size) break;
+                            fragmentShaderConstantSize += fragmentShaderConstantLocation.size;
                         }
 
+                        if (fragmentShaderConstantSize != sizeof(float) * fragmentShaderConstants.size)
+                            throw std::runtime_error{"Invalid pixel shader constant size"};
+
                         uploadBuffer(currentShader->getFragmentShaderConstantBuffer().get(),
-                                     shaderData.data(),
-                                     static_cast<std::uint32_t>(sizeof(float) * shaderData.size()));
+                                     commandBuffer.getShaderConstants(fragmentShaderConstants),
+                                     fragmentShaderConstantSize);
 
                         ID3D11Buffer* fragmentShaderConstantBuffers[1] = {currentShader->getFragmentShaderConstantBuffer().get()};
                         context->PSSetConstantBuffers(0, 1, fragmentShaderConstantBuffers);
 
                         // vertex shader constants
                         const auto& vertexShaderConstantLocations = currentShader->getVertexShaderConstantLocations();
+                        const auto& vertexShaderConstants = setShaderConstantsCommand->vertexShaderConstants;
 
-                        if (setShaderConstantsCommand->vertexShaderConstants.size() > vertexShaderConstantLocations.size())
-                            throw std::runtime_error{"Invalid vertex shader constant size"};
-
-                        shaderData.clear();
-
-                        for (std::size_t i = 0; i < setShaderConstantsCommand->vertexShaderConstants.size(); ++i)
+                        std::uint32_t vertexShaderConstantSize = 0;
+                        for (const auto& vertexShaderConstantLocation : vertexShaderConstantLocations)
                         {
-                            const auto& vertexShaderConstantLocation = vertexShaderConstantLocations[i];
-                            const auto& vertexShaderConstant = setShaderConstantsCommand->vertexShaderConstants[i];
-
-                            if (sizeof(float) * vertexShaderConstant.size() != vertexShaderConstantLocation.size)
-                                throw std::runtime_error{"Invalid vertex shader constant size"};
-
-                            shaderData.insert(shaderData.end(), vertexShaderConstant.begin(), vertexShaderConstant.end());
+                            if (vertexShaderConstantSize >= sizeof(float) * vertexShaderConstants.size) break;
+                            vertexShaderConstantSize += vertexShaderConstantLocation.size;
                         }
 
+                        if (vertexShaderConstantSize != sizeof(float) * vertexShaderConstants.size)
+                            throw std::runtime_error{"Invalid vertex shader constant size"};
+
                         uploadBuffer(currentShader->getVertexShaderConstantBuffer().get(),
-                                     shaderData.data(),
-                                     static_cast<std::uint32_t>(sizeof(float) * shaderData.size()));
+                                     commandBuffer.getShaderConstants(vertexShaderConstants),
+                                     vertexShaderConstantSize);
 
                         ID3D11Buffer* vertexShaderConstantBuffers[1] = {currentShader->getVertexShaderConstantBuffer().get()};
                         context->VSSetConstantBuffers(0, 1, vertexShaderConstantBuffers);
@@ -725,7 +710,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::initTexture:
                     {
-                        const auto initTextureCommand = static_cast<const InitTextureCommand*>(command.get());
+                        const auto initTextureCommand = static_cast<const InitTextureCommand*>(command);
 
                         auto texture = std::make_unique<Texture>(*this,
                                                                  initTextureCommand->levels,
@@ -744,7 +729,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setTextureData:
                     {
-                        const auto setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command.get());
+                        const auto setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command);
 
                         const auto texture = getResource<Texture>(setTextureDataCommand->texture);
                         texture->setData(setTextureDataCommand->levels);
@@ -754,7 +739,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setTextureParameters:
                     {
-                        const auto setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command.get());
+                        const auto setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command);
 
                         const auto texture = getResource<Texture>(setTextureParametersCommand->texture);
                         texture->setFilter(setTextureParametersCommand->filter);
@@ -768,7 +753,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setTextures:
                     {
-                        const auto setTexturesCommand = static_cast<const SetTexturesCommand*>(command.get());
+                        const auto setTexturesCommand = static_cast<const SetTexturesCommand*>(command);
 
                         currentResourceViews.clear();
                         currentSamplerStates.clear();
@@ -795,8 +780,14 @@ namespace ouzel::graphics::d3d11
                         throw std::runtime_error{"Invalid command"};
                 }
 
-                if (command->type == Command::Type::present) return;
+                if (command->type == Command::Type::present)
+                {
+                    recycleCommandBuffer(std::move(commandBuffer));
+                    return;
+                }
             }
+
+            recycleCommandBuffer(std::move(commandBuffer));
         }
     }
 
@@ -249,7 +249,6 @@ namespace ouzel::graphics::metal
         MTLRenderPassDescriptorPtr currentRenderPassDescriptor = nil;
         id<MTLRenderCommandEncoder> currentRenderCommandEncoder = nil;
         PipelineStateDesc currentPipelineStateDesc;
-        std::vector<float> shaderData;
 
         if (++shaderConstantBufferIndex >= bufferCount) shaderConstantBufferIndex = 0;
         auto& shaderConstantBuffer = shaderConstantBuffers[shaderConstantBufferIndex];
@@ -259,7 +258,6 @@ namespace ouzel::graphics::metal
         const Shader* currentShader = nullptr;
 
         CommandBuffer commandBuffer;
-        std::unique_ptr<Command> command;
 
         for (;;)
         {
@@ -269,15 +267,13 @@ namespace ouzel::graphics::metal
             commandQueue.pop();
             lock.unlock();
 
-            while (!commandBuffer.isEmpty())
+            for (const auto command : commandBuffer)
             {
-                command = commandBuffer.popCommand();
-
                 switch (command->type)
                 {
                     case Command::Type::resize:
                     {
-                        const auto resizeCommand = static_cast<const ResizeCommand*>(command.get());
+                        const auto resizeCommand = static_cast<const ResizeCommand*>(command);
                         const CGSize drawableSize = CGSizeMake(resizeCommand->size.v[0],
                                                                resizeCommand->size.v[1]);
                         metalLayer.drawableSize = drawableSize;
@@ -299,14 +295,14 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::deleteResource:
                     {
-                        const auto deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command.get());
+                        const auto deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command);
                         resources[deleteResourceCommand->resource - 1].reset();
                         break;
                     }
 
                     case Command::Type::initRenderTarget:
                     {
-                        const auto initRenderTargetCommand = static_cast<const InitRenderTargetCommand*>(command.get());
+                        const auto initRenderTargetCommand = static_cast<const InitRenderTargetCommand*>(command);
 
                         std::set<Texture*> colorTextures;
                         for (const auto colorTextureId : initRenderTargetCommand->colorTextures)
@@ -324,7 +320,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setRenderTarget:
                     {
-                        const auto setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command.get());
+                        const auto setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command);
 
                         MTLRenderPassDescriptorPtr newRenderPassDescriptor;
 
@@ -370,7 +366,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::clearRenderTarget:
                     {
-                        const auto clearCommand = static_cast<const ClearRenderTargetCommand*>(command.get());
+                        const auto clearCommand = static_cast<const ClearRenderTargetCommand*>(command);
 
                         if (currentRenderCommandEncoder)
                             [currentRenderCommandEncoder endEncoding];
@@ -406,7 +402,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setScissorTest:
                     {
-                        const auto setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command.get());
+                        const auto setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command);
 
                         // create a new render command encoder to set up a new scissor rect
                         if (currentRenderCommandEncoder)
@@ -428,7 +424,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setViewport:
                     {
-                        const auto setViewportCommand = static_cast<const SetViewportCommand*>(command.get());
+                        const auto setViewportCommand = static_cast<const SetViewportCommand*>(command);
 
                         if (!currentRenderCommandEncoder)
                             throw Error{"Metal render command encoder not initialized"};
@@ -448,7 +444,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::initDepthStencilState:
                     {
-                        const auto initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command.get());
+                        const auto initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command);
                         auto depthStencilState = std::make_unique<DepthStencilState>(*this,
                                                                                      initDepthStencilStateCommand->depthTest,
                                                                                      initDepthStencilStateCommand->depthWrite,
@@ -474,7 +470,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setDepthStencilState:
                     {
-                        const auto setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command.get());
+                        const auto setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command);
 
                         if (!currentRenderCommandEncoder)
                             throw Error{"Metal render command encoder not initialized"};
@@ -495,7 +491,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setPipelineState:
                     {
-                        const auto setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command.get());
+                        const auto setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command);
 
                         if (!currentRenderCommandEncoder)
                             throw Error{"Metal render command encoder not initialized"};
@@ -518,7 +514,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::draw:
                     {
-                        const auto drawCommand = static_cast<const DrawCommand*>(command.get());
+                        const auto drawCommand = static_cast<const DrawCommand*>(command);
 
                         if (!currentRenderCommandEncoder)
                             throw Error{"Metal render command encoder not initialized"};
@@ -550,7 +546,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::initBlendState:
                     {
-                        const auto initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command.get());
+                        const auto initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command);
 
                         auto blendState = std::make_unique<BlendState>(*this,
                                                                        initBlendStateCommand->enableBlending,
@@ -570,7 +566,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::initBuffer:
                     {
-                        const auto initBufferCommand = static_cast<const InitBufferCommand*>(command.get());
+                        const auto initBufferCommand = static_cast<const InitBufferCommand*>(command);
 
                         auto buffer = std::make_unique<Buffer>(*this,
                                                                 initBufferCommand->bufferType,
@@ -586,7 +582,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setBufferData:
                     {
-                        const auto setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command.get());
+                        const auto setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command);
 
                         const auto buffer = getResource<Buffer>(setBufferDataCommand->buffer);
                         buffer->setData(setBufferDataCommand->data);
@@ -595,7 +591,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::initShader:
                     {
-                        const auto initShaderCommand = static_cast<const InitShaderCommand*>(command.get());
+                        const auto initShaderCommand = static_cast<const InitShaderCommand*>(command);
 
                         auto shader = std::make_unique<Shader>(*this,
                                                                initShaderCommand->fragmentShader,
@@ -614,7 +610,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setShaderConstants:
                     {
-                        const auto setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command.get());
+                        const auto setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command);
 
                         if (!currentRenderCommandEncoder)
                             throw Error{"Metal render command encoder not initialized"};
@@ -624,27 +620,22 @@ namespace ouzel::graphics::metal
 
                         // pixel shader constants
                         const auto& fragmentShaderConstantLocations = currentShader->getFragmentShaderConstantLocations();
+                        const auto& fragmentShaderConstants = setShaderConstantsCommand->fragmentShaderConstants;
 
-                        if (setShaderConstantsCommand->fragmentShaderConstants.size() > fragmentShaderConstantLocations.size())
-                            throw Error{"Invalid pixel shader constant size"};
-
-                        shaderData.clear();
-
-                        for (std::size_t i = 0; i < setShaderConstantsCommand->fragmentShaderConstants.size(); ++i)
+                        std::uint32_t fragmentShaderConstantSize = 0;
+                        for (const auto& fragmentShaderConstantLocation : fragmentShaderConstantLocations)
                         {
-                            const auto& fragmentShaderConstantLocation = fragmentShaderConstantLocations[i];
-                            const auto& fragmentShaderConstant = setShaderConstantsCommand->fragmentShaderConstants[i];
-
-                            if (sizeof(float) * fragmentShaderConstant.size() != fragmentShaderConstantLocation.size)
-                                throw Error{"Invalid pixel shader constant size"};
-
-                            shaderData.insert(shaderData.end(), fragmentShaderConstant.begin(), fragmentShaderConstant.end());
+                            if (fragmentShaderConstantSize >= sizeof(float) * fragmentShaderConstants.size) break;
+                            fragmentShaderConstantSize += fragmentShaderConstantLocation.size;
                         }
 
+                        if (fragmentShaderConstantSize != sizeof(float) * fragmentShaderConstants.size)
+                            throw Error{"Invalid pixel shader constant size"};
+
                         shaderConstantBuffer.offset = ((shaderConstantBuffer.offset + currentShader->getFragmentShaderAlignment() - 1) /
                                                        currentShader->getFragmentShaderAlignment()) * currentShader->getFragmentShaderAlignment(); // round up to nearest aligned pointer
 
-                        if (shaderConstantBuffer.offset + getVectorSize(shaderData) > bufferSize)
+                        if (shaderConstantBuffer.offset + fragmentShaderConstantSize > bufferSize)
                         {
                             ++shaderConstantBuffer.index;
                             shaderConstantBuffer.offset = 0;
@@ -664,37 +655,32 @@ namespace ouzel::graphics::metal
                         MTLBufferPtr currentBuffer = shaderConstantBuffer.buffers[shaderConstantBuffer.index].get();
 
                         std::memcpy(static_cast<char*>([currentBuffer contents]) + shaderConstantBuffer.offset,
-                                    shaderData.data(), shaderData.size() * sizeof(float));
+                                    commandBuffer.getShaderConstants(fragmentShaderConstants), fragmentShaderConstantSize);
 
                         [currentRenderCommandEncoder setFragmentBuffer:currentBuffer
                                                                 offset:shaderConstantBuffer.offset
                                                                atIndex:1];
 
-                        shaderConstantBuffer.offset += static_cast<std::uint32_t>(getVectorSize(shaderData));
+                        shaderConstantBuffer.offset += fragmentShaderConstantSize;
 
                         // vertex shader constants
                         const auto& vertexShaderConstantLocations = currentShader->getVertexShaderConstantLocations();
+                        const auto& vertexShaderConstants = setShaderConstantsCommand->vertexShaderConstants;
 
-                        if (setShaderConstantsCommand->vertexShaderConstants.size() > vertexShaderConstantLocations.size())
-                            throw Error{"Invalid vertex shader constant size"};
-
-                        shaderData.clear();
-
-                        for (std::size_t i = 0; i < setShaderConstantsCommand->vertexShaderConstants.size(); ++i)
+                        std::uint32_t vertexShaderConstantSize = 0;
+                        for (const auto& vertexShaderConstantLocation : vertexShaderConstantLocations)
                         {
-                            const auto& vertexShaderConstantLocation = vertexShaderConstantLocations[i];
-                            const auto& vertexShaderConstant = setShaderConstantsCommand->vertexShaderConstants[i];
-
-                            if (sizeof(float) * vertexShaderConstant.size() != vertexShaderConstantLocation.size)
-                                throw Error{"Invalid vertex shader constant size"};
-
-                            shaderData.insert(shaderData.end(), vertexShaderConstant.begin(), vertexShaderConstant.end());
+                            if (vertexShaderConstantSize >= sizeof(float) * vertexShaderConstants.size) break;
+                            vertexShaderConstantSize += vertexShaderConstantLocation.size;
                         }
 
+                        if (vertexShaderConstantSize != sizeof(float) * vertexShaderConstants.size)
+                            throw Error{"Invalid vertex shader constant size"};
+
                         shaderConstantBuffer.offset = ((shaderConstantBuffer.offset + currentShader->getVertexShaderAlignment() - 1) /
                                                        currentShader->getVertexShaderAlignment()) * currentShader->getVertexShaderAlignment(); // round up to nearest aligned pointer
 
-                        if (shaderConstantBuffer.offset + getVectorSize(shaderData) > bufferSize)
+                        if (shaderConstantBuffer.offset + vertexShaderConstantSize > bufferSize)
                         {
                             ++shaderConstantBuffer.index;
                             shaderConstantBuffer.offset = 0;
@@ -714,20 +700,20 @@ namespace ouzel::graphics::metal
                         currentBuffer = shaderConstantBuffer.buffers[shaderConstantBuffer.index].get();
 
                         std::memcpy(static_cast<char*>([currentBuffer contents]) + shaderConstantBuffer.offset,
-                                    shaderData.data(), shaderData.size() * sizeof(float));
+                                    commandBuffer.getShaderConstants(vertexShaderConstants), vertexShaderConstantSize);
 
                         [currentRenderCommandEncoder setVertexBuffer:currentBuffer
                                                               offset:shaderConstantBuffer.offset
                                                              atIndex:1];
 
-                        shaderConstantBuffer.offset += static_cast<std::uint32_t>(getVectorSize(shaderData));
+                        shaderConstantBuffer.offset += vertexShaderConstantSize;
 
                         break;
                     }
 
                     case Command::Type::initTexture:
                     {
-                        const auto initTextureCommand = static_cast<const InitTextureCommand*>(command.get());
+                        const auto initTextureCommand = static_cast<const InitTextureCommand*>(command);
 
                         auto texture = std::make_unique<Texture>(*this,
                                                                  initTextureCommand->levels,
@@ -746,7 +732,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setTextureData:
                     {
-                        const auto setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command.get());
+                        const auto setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command);
 
                         const auto texture = getResource<Texture>(setTextureDataCommand->texture);
                         texture->setData(setTextureDataCommand->levels);
@@ -756,7 +742,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setTextureParameters:
                     {
-                        const auto setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command.get());
+                        const auto setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command);
 
                         const auto texture = getResource<Texture>(setTextureParametersCommand->texture);
                         texture->setFilter(setTextureParametersCommand->filter);
@@ -770,7 +756,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setTextures:
                     {
-                        const auto setTexturesCommand = static_cast<const SetTexturesCommand*>(command.get());
+                        const auto setTexturesCommand = static_cast<const SetTexturesCommand*>(command);
 
                         if (!currentRenderCommandEncoder)
                             throw Error{"Metal render command encoder not initialized"};
@@ -795,8 +781,14 @@ namespace ouzel::graphics::metal
                     default: throw Error{"Invalid command"};
                 }
 
-                if (command->type == Command::Type::present) return;
+                if (command->type == Command::Type::present)
+                {
+                    recycleCommandBuffer(std::move(commandBuffer));
+                    return;
+                }
             }
+
+            recycleCommandBuffer(std::move(commandBuffer));
         }
     }
 
@@ -40,7 +40,7 @@ namespace ouzel::graphics::metal::ios
         running = false;
         runLoop.stop();
         CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
+        commandBuffer.pushCommand<PresentCommand>();
         submitCommandBuffer(std::move(commandBuffer));
     }
 
@@ -69,7 +69,7 @@ namespace ouzel::graphics::metal::macos
     {
         running = false;
         CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
+        commandBuffer.pushCommand<PresentCommand>();
         submitCommandBuffer(std::move(commandBuffer));
     }
 
@@ -104,7 +104,7 @@ namespace ouzel::graphics::metal::macos
     {
         engine->executeOnMainThread([this, screenId]() {
             CommandBuffer commandBuffer;
-            commandBuffer.pushCommand(std::make_unique<PresentCommand>());
+            commandBuffer.pushCommand<PresentCommand>();
             submitCommandBuffer(std::move(commandBuffer));
 
             const auto displayId = static_cast<CGDirectDisplayID>(screenId);
@@ -36,7 +36,7 @@ namespace ouzel::graphics::metal::tvos
         running = false;
         runLoop.stop();
         CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
+        commandBuffer.pushCommand<PresentCommand>();
         submitCommandBuffer(std::move(commandBuffer));
     }
 
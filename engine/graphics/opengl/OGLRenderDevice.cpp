@@ -725,7 +725,6 @@ namespace ouzel::graphics::opengl
         const Shader* currentShader = nullptr;
 
         CommandBuffer commandBuffer;
-        std::unique_ptr<Command> command;
 
         for (;;)
         {
@@ -735,15 +734,13 @@ namespace ouzel::graphics::opengl
             commandQueue.pop();
             lock.unlock();
 
-            while (!commandBuffer.isEmpty())
+            for (const auto command : commandBuffer)
             {
-                command = commandBuffer.popCommand();
-
                 switch (command->type)
                 {
                     case Command::Type::resize:
                     {
-                        const auto resizeCommand = static_cast<const ResizeCommand*>(command.get());
+                        const auto resizeCommand = static_cast<const ResizeCommand*>(command);
                         frameBufferWidth = static_cast<GLsizei>(resizeCommand->size.v[0]);
                         frameBufferHeight = static_cast<GLsizei>(resizeCommand->size.v[1]);
                         resizeFrameBuffer();
@@ -758,14 +755,14 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::deleteResource:
                     {
-                        const auto deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command.get());
+                        const auto deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command);
                         resources[deleteResourceCommand->resource - 1].reset();
                         break;
                     }
 
                     case Command::Type::initRenderTarget:
                     {
-                        const auto initRenderTargetCommand = static_cast<const InitRenderTargetCommand*>(command.get());
+                        const auto initRenderTargetCommand = static_cast<const InitRenderTargetCommand*>(command);
 
                         std::set<Texture*> colorTextures;
                         for (const auto colorTextureId : initRenderTargetCommand->colorTextures)
@@ -783,7 +780,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setRenderTarget:
                     {
-                        const auto setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command.get());
+                        const auto setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command);
 
                         if (setRenderTargetCommand->renderTarget)
                         {
@@ -804,7 +801,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::clearRenderTarget:
                     {
-                        const auto clearCommand = static_cast<const ClearRenderTargetCommand*>(command.get());
+                        const auto clearCommand = static_cast<const ClearRenderTargetCommand*>(command);
 
                         const GLbitfield clearMask = (clearCommand->clearColorBuffer ? GL_COLOR_BUFFER_BIT : 0) |
                             (clearCommand->clearDepthBuffer ? GL_DEPTH_BUFFER_BIT : 0 |
@@ -858,7 +855,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setScissorTest:
                     {
-                        const auto setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command.get());
+                        const auto setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command);
 
                         setScissorTest(setScissorTestCommand->enabled,
                                        static_cast<GLint>(setScissorTestCommand->rectangle.position.v[0]),
@@ -871,7 +868,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setViewport:
                     {
-                        const auto setViewportCommand = static_cast<const SetViewportCommand*>(command.get());
+                        const auto setViewportCommand = static_cast<const SetViewportCommand*>(command);
 
                         setViewport(static_cast<GLint>(setViewportCommand->viewport.position.v[0]),
                                     static_cast<GLint>(setViewportCommand->viewport.position.v[1]),
@@ -883,7 +880,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::initDepthStencilState:
                     {
-                        const auto initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command.get());
+                        const auto initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command);
                         auto depthStencilState = std::make_unique<DepthStencilState>(*this,
                                                                                      initDepthStencilStateCommand->depthTest,
                                                                                      initDepthStencilStateCommand->depthWrite,
@@ -908,7 +905,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setDepthStencilState:
                     {
-                        const auto setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command.get());
+                        const auto setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command);
 
                         if (setDepthStencilStateCommand->depthStencilState)
                         {
@@ -953,7 +950,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setPipelineState:
                     {
-                        const auto setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command.get());
+                        const auto setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command);
 
                         const auto blendState = getResource<BlendState>(setPipelineStateCommand->blendState);
                         const auto shader = getResource<Shader>(setPipelineStateCommand->shader);
@@ -1003,7 +1000,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::draw:
                     {
-                        const auto drawCommand = static_cast<const DrawCommand*>(command.get());
+                        const auto drawCommand = static_cast<const DrawCommand*>(command);
 
                         // mesh buffer
                         const auto indexBuffer = getResource<Buffer>(drawCommand->indexBuffer);
@@ -1058,7 +1055,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::initBlendState:
                     {
-                        const auto initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command.get());
+                        const auto initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command);
 
                         auto blendState = std::make_unique<BlendState>(*this,
                                                                        initBlendStateCommand->enableBlending,
@@ -1078,7 +1075,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::initBuffer:
                     {
-                        const auto initBufferCommand = static_cast<const InitBufferCommand*>(command.get());
+                        const auto initBufferCommand = static_cast<const InitBufferCommand*>(command);
 
                         auto buffer = std::make_unique<Buffer>(*this,
                                                                initBufferCommand->bufferType,
@@ -1094,7 +1091,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setBufferData:
                     {
-                        const auto setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command.get());
+                        const auto setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command);
 
                         const auto buffer = getResource<Buffer>(setBufferDataCommand->buffer);
                         buffer->setData(setBufferDataCommand->data);
@@ -1103,7 +1100,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::initShader:
                     {
-                        const auto initShaderCommand = static_cast<const InitShaderCommand*>(command.get());
+                        const auto initShaderCommand = static_cast<const InitShaderCommand*>(command);
 
                         auto shader = std::make_unique<Shader>(*this,
                                                                initShaderCommand->fragmentShader,
@@ -1122,49 +1119,65 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setShaderConstants:
                     {
-                        const auto setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command.get());
+                        const auto setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command);
 
                         if (!currentShader)
                             throw Error{"No shader set"};
 
                         // pixel shader constants
                         const auto& fragmentShaderConstantLocations = currentShader->getFragmentShaderConstantLocations();
+                        const auto& fragmentShaderConstants = setShaderConstantsCommand->fragmentShaderConstants;
+                        const auto fragmentShaderConstantData = commandBuffer.getShaderConstants(fragmentShaderConstants);
 
-                        if (setShaderConstantsCommand->fragmentShaderConstants.size() > fragmentShaderConstantLocations.size())
-                            throw Error{"Invalid pixel shader constant size"};
-
-                        for (std::size_t i = 0; i < setShaderConstantsCommand->fragmentShaderConstants.size(); ++i)
+                        std::uint32_t fragmentShaderConstantOffset = 0;
+                        for (const auto& fragmentShaderConstantLocation : fragmentShaderConstantLocations)
                         {
-                            const auto& fragmentShaderConstantLocation = fragmentShaderConstantLocations[i];
-                            const auto& fragmentShaderConstant = setShaderConstantsCommand->fragmentShaderConstants[i];
+                            if (fragmentShaderConstantOffset >= fragmentShaderConstants.size) break;
+
+                            const auto size = getDataTypeSize(fragmentShaderConstantLocation.dataType) / sizeof(float);
+                            if (fragmentShaderConstantOffset + size > fragmentShaderConstants.size)
+                                throw Error{"Invalid pixel shader constant size"};
 
                             setUniform(fragmentShaderConstantLocation.location,
                                        fragmentShaderConstantLocation.dataType,
-                                       fragmentShaderConstant.data());
+                                       fragmentShaderConstantData + fragmentShaderConstantOffset);
+
+                            fragmentShaderConstantOffset += static_cast<std::uint32_t>(size);
                         }
 
+                        if (fragmentShaderConstantOffset != fragmentShaderConstants.size)
+                            throw Error{"Invalid pixel shader constant size"};
+
                         // vertex shader constants
                         const auto& vertexShaderConstantLocations = currentShader->getVertexShaderConstantLocations();
+                        const auto& vertexShaderConstants = setShaderConstantsCommand->vertexShaderConstants;
+                        const auto vertexShaderConstantData = commandBuffer.getShaderConstants(vertexShaderConstants);
 
-                        if (setShaderConstantsCommand->vertexShaderConstants.size() > vertexShaderConstantLocations.size())
-                            throw Error{"Invalid vertex shader constant size"};
-
-                        for (std::size_t i = 0; i < setShaderConstantsCommand->vertexShaderConstants.size(); ++i)
+                        std::uint32_t vertexShaderConstantOffset = 0;
+                        for (const auto& vertexShaderConstantLocation : vertexShaderConstantLocations)
                         {
-                            const auto& vertexShaderConstantLocation = vertexShaderConstantLocations[i];
-                            const auto& vertexShaderConstant = setShaderConstantsCommand->vertexShaderConstants[i];
+                            if (vertexShaderConstantOffset >= vertexShaderConstants.size) break;
+
+                            const auto size = getDataTypeSize(vertexShaderConstantLocation.dataType) / sizeof(float);
+                            if (vertexShaderConstantOffset + size > vertexShaderConstants.size)
+                                throw Error{"Invalid vertex shader constant size"};
 
                             setUniform(vertexShaderConstantLocation.location,
                                        vertexShaderConstantLocation.dataType,
-                                       vertexShaderConstant.data());
+                                       vertexShaderConstantData + vertexShaderConstantOffset);
+
+                            vertexShaderConstantOffset += static_cast<std::uint32_t>(size);
                         }
 
+                        if (vertexShaderConstantOffset != vertexShaderConstants.size)
+                            throw Error{"Invalid vertex shader constant size"};
+
                         break;
                     }
 
                     case Command::Type::initTexture:
                     {
-                        const auto initTextureCommand = static_cast<const InitTextureCommand*>(command.get());
+                        const auto initTextureCommand = static_cast<const InitTextureCommand*>(command);
 
                         auto texture = std::make_unique<Texture>(*this,
                                                                  initTextureCommand->levels,
@@ -1183,7 +1196,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setTextureData:
                     {
-                        const auto setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command.get());
+                        const auto setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command);
 
                         const auto texture = getResource<Texture>(setTextureDataCommand->texture);
                         texture->setData(setTextureDataCommand->levels);
@@ -1193,7 +1206,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setTextureParameters:
                     {
-                        const auto setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command.get());
+                        const auto setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command);
 
                         const auto texture = getResource<Texture>(setTextureParametersCommand->texture);
                         texture->setFilter(setTextureParametersCommand->filter);
@@ -1206,7 +1219,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setTextures:
                     {
-                        const auto setTexturesCommand = static_cast<const SetTexturesCommand*>(command.get());
+                        const auto setTexturesCommand = static_cast<const SetTexturesCommand*>(command);
 
                         for (std::size_t layer = 0; layer < setTexturesCommand->textures.size(); ++layer)
                             if (auto texture = getResource<Texture>(setTexturesCommand->textures[layer]))
@@ -1221,8 +1234,14 @@ namespace ouzel::graphics::opengl
                         throw Error{"Invalid command"};
                 }
 
-                if (command->type == Command::Type::present) return;
+                if (command->type == Command::Type::present)
+                {
+                    recycleCommandBuffer(std::move(commandBuffer));
+                    return;
+                }
             }
+
+            recycleCommandBuffer(std::move(commandBuffer));
         }
     }
 
@@ -179,7 +179,7 @@ namespace ouzel::graphics::opengl::android
     {
         running = false;
         CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
+        commandBuffer.pushCommand<PresentCommand>();
         submitCommandBuffer(std::move(commandBuffer));
 
         if (renderThread.isJoinable()) renderThread.join();
@@ -209,7 +209,7 @@ namespace ouzel::graphics::opengl::android
     {
         running = false;
         CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
+        commandBuffer.pushCommand<PresentCommand>();
         submitCommandBuffer(std::move(commandBuffer));
 
         if (renderThread.isJoinable()) renderThread.join();
@@ -337,7 +337,7 @@ namespace ouzel::graphics::opengl::android
     {
         running = false;
         CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
+        commandBuffer.pushCommand<PresentCommand>();
         submitCommandBuffer(std::move(commandBuffer));
 
         if (renderThread.isJoinable()) renderThread.join();
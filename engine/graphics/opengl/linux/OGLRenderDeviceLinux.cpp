@@ -167,7 +167,7 @@ namespace ouzel::graphics::opengl::linux
     {
         running = false;
         CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
+        commandBuffer.pushCommand<PresentCommand>();
         submitCommandBuffer(std::move(commandBuffer));
 
         if (renderThread.isJoinable()) renderThread.join();
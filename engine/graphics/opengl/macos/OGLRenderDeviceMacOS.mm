@@ -121,7 +121,7 @@ namespace ouzel::graphics::opengl::macos
     {
         running = false;
         CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
+        commandBuffer.pushCommand<PresentCommand>();
         submitCommandBuffer(std::move(commandBuffer));
 
         if (context)
@@ -310,7 +310,7 @@ namespace ouzel::graphics::opengl::windows
     {
         running = false;
         CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
+        commandBuffer.pushCommand<PresentCommand>();
         submitCommandBuffer(std::move(commandBuffer));
 
         if (renderThread.isJoinable()) renderThread.join();
@@ -0,0 +1,216 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_MATH_SIMD_HPP
+#define OUZEL_MATH_SIMD_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || _M_IX86_FP >= 2
+#  include <xmmintrin.h>
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#endif
+
+namespace ouzel::math
+{
+    // Lane abstractions for the kernels that process structure-of-arrays data,
+    // a kernel is written once as a template and instantiated with SimdLanes
+    // for the bulk of the data and with ScalarLanes for the remainder
+    struct ScalarLanes final
+    {
+        using Type = float;
+        using Mask = bool;
+        static constexpr std::size_t width = 1;
+
+        static Type load(const float* data) noexcept { return *data; }
+        static void store(float* data, Type value) noexcept { *data = value; }
+        static Type set(float value) noexcept { return value; }
+
+        static Type add(Type a, Type b) noexcept { return a + b; }
+        static Type sub(Type a, Type b) noexcept { return a - b; }
+        static Type mul(Type a, Type b) noexcept { return a * b; }
+        static Type div(Type a, Type b) noexcept { return a / b; }
+        static Type min(Type a, Type b) noexcept { return std::min(a, b); }
+        static Type max(Type a, Type b) noexcept { return std::max(a, b); }
+        static Type abs(Type a) noexcept { return std::fabs(a); }
+        static Type reciprocalSqrt(Type a) noexcept { return 1.0F / std::sqrt(a); }
+
+        static Mask equal(Type a, Type b) noexcept { return a == b; }
+        static Mask greater(Type a, Type b) noexcept { return a > b; }
+        static Mask either(Mask a, Mask b) noexcept { return a || b; }
+        static Type select(Mask mask, Type a, Type b) noexcept { return mask ? a : b; }
+
+        static void sinCos(Type angle, Type& sine, Type& cosine) noexcept
+        {
+            sine = std::sin(angle);
+            cosine = std::cos(angle);
+        }
+
+        static float reduceMin(Type a) noexcept { return a; }
+        static float reduceMax(Type a) noexcept { return a; }
+    };
+
+    // sine and cosine with the Cephes minimax polynomials, the angle is
+    // reduced to [-pi/4, pi/4] using the octant that it belongs to
+    template <class Lanes>
+    void approximateSinCos(typename Lanes::Type angle,
+                           typename Lanes::Type& sine,
+                           typename Lanes::Type& cosine) noexcept
+    {
+        const auto x = Lanes::abs(angle);
+
+        // octant rounded up to an even number
+        auto octant = Lanes::truncate(Lanes::mul(x, Lanes::set(1.27323954473516F))); // 4 / pi
+        octant = Lanes::add(octant, Lanes::sub(octant, Lanes::mul(Lanes::set(2.0F), Lanes::truncate(Lanes::mul(octant, Lanes::set(0.5F))))));
+        const auto quadrant = Lanes::sub(octant, Lanes::mul(Lanes::set(8.0F), Lanes::truncate(Lanes::mul(octant, Lanes::set(0.125F)))));
+
+        // extended precision subtraction of octant * pi / 4
+        auto r = Lanes::sub(x, Lanes::mul(octant, Lanes::set(0.78515625F)));
+        r = Lanes::sub(r, Lanes::mul(octant, Lanes::set(2.4187564849853515625e-4F)));
+        r = Lanes::sub(r, Lanes::mul(octant, Lanes::set(3.77489497744594108e-8F)));
+        const auto z = Lanes::mul(r, r);
+
+        auto polynomialCos = Lanes::add(Lanes::mul(Lanes::set(2.443315711809948e-5F), z), Lanes::set(-1.388731625493765e-3F));
+        polynomialCos = Lanes::add(Lanes::mul(polynomialCos, z), Lanes::set(4.166664568298827e-2F));
+        polynomialCos = Lanes::mul(Lanes::mul(polynomialCos, z), z);
+        polynomialCos = Lanes::add(Lanes::sub(polynomialCos, Lanes::mul(Lanes::set(0.5F), z)), Lanes::set(1.0F));
+
+        auto polynomialSin = Lanes::add(Lanes::mul(Lanes::set(-1.9515295891e-4F), z), Lanes::set(8.3321608736e-3F));
+        polynomialSin = Lanes::add(Lanes::mul(polynomialSin, z), Lanes::set(-1.6666654611e-1F));
+        polynomialSin = Lanes::add(Lanes::mul(Lanes::mul(polynomialSin, z), r), r);
+
+        const auto two = Lanes::set(2.0F);
+        const auto four = Lanes::set(4.0F);
+        const auto six = Lanes::set(6.0F);
+        const auto swap = Lanes::either(Lanes::equal(quadrant, two), Lanes::equal(quadrant, six));
+        const auto negateSin = Lanes::greater(quadrant, Lanes::set(3.0F));
+        const auto negateCos = Lanes::either(Lanes::equal(quadrant, two), Lanes::equal(quadrant, four));
+        const auto negativeAngle = Lanes::greater(Lanes::set(0.0F), angle);
+
+        auto s = Lanes::select(swap, polynomialCos, polynomialSin);
+        auto c = Lanes::select(swap, polynomialSin, polynomialCos);
+        s = Lanes::select(negateSin, Lanes::sub(Lanes::set(0.0F), s), s);
+        s = Lanes::select(negativeAngle, Lanes::sub(Lanes::set(0.0F), s), s);
+        c = Lanes::select(negateCos, Lanes::sub(Lanes::set(0.0F), c), c);
+
+        sine = s;
+        cosine = c;
+    }
+
+#if defined(__SSE2__) || defined(_M_X64) || _M_IX86_FP >= 2
+    struct SseLanes final
+    {
+        using Type = __m128;
+        using Mask = __m128;
+        static constexpr std::size_t width = 4;
+
+        static Type load(const float* data) noexcept { return _mm_loadu_ps(data); }
+        static void store(float* data, Type value) noexcept { _mm_storeu_ps(data, value); }
+        static Type set(float value) noexcept { return _mm_set1_ps(value); }
+
+        static Type add(Type a, Type b) noexcept { return _mm_add_ps(a, b); }
+        static Type sub(Type a, Type b) noexcept { return _mm_sub_ps(a, b); }
+        static Type mul(Type a, Type b) noexcept { return _mm_mul_ps(a, b); }
+        static Type div(Type a, Type b) noexcept { return _mm_div_ps(a, b); }
+        static Type min(Type a, Type b) noexcept { return _mm_min_ps(a, b); }
+        static Type max(Type a, Type b) noexcept { return _mm_max_ps(a, b); }
+        static Type abs(Type a) noexcept { return _mm_andnot_ps(_mm_set1_ps(-0.0F), a); }
+        static Type truncate(Type a) noexcept { return _mm_cvtepi32_ps(_mm_cvttps_epi32(a)); }
+        static Type reciprocalSqrt(Type a) noexcept { return _mm_div_ps(_mm_set1_ps(1.0F), _mm_sqrt_ps(a)); }
+
+        static Mask equal(Type a, Type b) noexcept { return _mm_cmpeq_ps(a, b); }
+        static Mask greater(Type a, Type b) noexcept { return _mm_cmpgt_ps(a, b); }
+        static Mask either(Mask a, Mask b) noexcept { return _mm_or_ps(a, b); }
+        static Type select(Mask mask, Type a, Type b) noexcept
+        {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+
+        static void sinCos(Type angle, Type& sine, Type& cosine) noexcept
+        {
+            approximateSinCos<SseLanes>(angle, sine, cosine);
+        }
+
+        static float reduceMin(Type a) noexcept
+        {
+            const auto t = _mm_min_ps(a, _mm_movehl_ps(a, a));
+            return _mm_cvtss_f32(_mm_min_ss(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))));
+        }
+
+        static float reduceMax(Type a) noexcept
+        {
+            const auto t = _mm_max_ps(a, _mm_movehl_ps(a, a));
+            return _mm_cvtss_f32(_mm_max_ss(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))));
+        }
+    };
+
+    using SimdLanes = SseLanes;
+#elif defined(__ARM_NEON__)
+    struct NeonLanes final
+    {
+        using Type = float32x4_t;
+        using Mask = uint32x4_t;
+        static constexpr std::size_t width = 4;
+
+        static Type load(const float* data) noexcept { return vld1q_f32(data); }
+        static void store(float* data, Type value) noexcept { vst1q_f32(data, value); }
+        static Type set(float value) noexcept { return vdupq_n_f32(value); }
+
+        static Type add(Type a, Type b) noexcept { return vaddq_f32(a, b); }
+        static Type sub(Type a, Type b) noexcept { return vsubq_f32(a, b); }
+        static Type mul(Type a, Type b) noexcept { return vmulq_f32(a, b); }
+        static Type div(Type a, Type b) noexcept
+        {
+            // reciprocal estimate refined with two Newton-Raphson steps
+            auto reciprocal = vrecpeq_f32(b);
+            reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+            reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+            return vmulq_f32(a, reciprocal);
+        }
+        static Type min(Type a, Type b) noexcept { return vminq_f32(a, b); }
+        static Type max(Type a, Type b) noexcept { return vmaxq_f32(a, b); }
+        static Type abs(Type a) noexcept { return vabsq_f32(a); }
+        static Type truncate(Type a) noexcept { return vcvtq_f32_s32(vcvtq_s32_f32(a)); }
+        static Type reciprocalSqrt(Type a) noexcept
+        {
+            auto estimate = vrsqrteq_f32(a);
+            estimate = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, estimate), estimate), estimate);
+            estimate = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, estimate), estimate), estimate);
+            return estimate;
+        }
+
+        static Mask equal(Type a, Type b) noexcept { return vceqq_f32(a, b); }
+        static Mask greater(Type a, Type b) noexcept { return vcgtq_f32(a, b); }
+        static Mask either(Mask a, Mask b) noexcept { return vorrq_u32(a, b); }
+        static Type select(Mask mask, Type a, Type b) noexcept { return vbslq_f32(mask, a, b); }
+
+        static void sinCos(Type angle, Type& sine, Type& cosine) noexcept
+        {
+            approximateSinCos<NeonLanes>(angle, sine, cosine);
+        }
+
+        static float reduceMin(Type a) noexcept
+        {
+            auto t = vpmin_f32(vget_low_f32(a), vget_high_f32(a));
+            t = vpmin_f32(t, t);
+            return vget_lane_f32(t, 0);
+        }
+
+        static float reduceMax(Type a) noexcept
+        {
+            auto t = vpmax_f32(vget_low_f32(a), vget_high_f32(a));
+            t = vpmax_f32(t, t);
+            return vget_lane_f32(t, 0);
+        }
+    };
+
+    using SimdLanes = NeonLanes;
+#else
+    using SimdLanes = ScalarLanes;
+#endif
+}
+
+#endif // OUZEL_MATH_SIMD_HPP
@@ -112,6 +112,7 @@ namespace ouzel::scene
         {
             if (entered) actor->leave();
             actor->parent = nullptr;
+            actor->setLayer(nullptr);
         }
 
         children.clear();
@@ -237,36 +238,33 @@ namespace ouzel::scene
             component->setActor(nullptr);
     }
 
-    void Actor::visit(std::vector<Actor*>& drawQueue,
-                      const math::Matrix<float, 4>& newParentTransform,
+    void Actor::visit(const math::Matrix<float, 4>& newParentTransform,
                       bool parentTransformDirty,
-                      Camera* camera,
                       Order parentOrder,
                       bool parentHidden)
     {
+        assert(layer);
+
         worldOrder = parentOrder + order;
         worldHidden = parentHidden || hidden;
+        traversalIndex = layer->traversalCount++;
 
         if (parentTransformDirty) updateTransform(newParentTransform);
-        if (transformDirty) calculateTransform();
 
-        if (!worldHidden)
-        {
-            const auto boundingBox = getBoundingBox();
+        // components do not report the changes of their bounds, so they are compared here
+        const auto boundingBox = getBoundingBox();
+        if (transformDirty ||
+            spatialBoundingBox.min != boundingBox.min ||
+            spatialBoundingBox.max != boundingBox.max)
+            layer->updateSpatialProxy(*this, boundingBox);
 
-            if (cullDisabled || (!isEmpty(boundingBox) && camera->checkVisibility(getTransform(), boundingBox)))
-            {
-                const auto upperBound = std::upper_bound(drawQueue.begin(), drawQueue.end(), this,
-                                                         [](const auto a, const auto b) noexcept {
-                                                             return a->worldOrder > b->worldOrder;
-                                                         });
+        if (transformDirty) calculateTransform();
 
-                drawQueue.insert(upperBound, this);
-            }
-        }
+        if (!worldHidden && cullDisabled)
+            layer->unculledActors.push_back(this);
 
         for (const auto actor : children)
-            actor->visit(drawQueue, transform, updateChildrenTransform, camera, worldOrder, worldHidden);
+            actor->visit(transform, updateChildrenTransform, worldOrder, worldHidden);
 
         updateChildrenTransform = false;
     }
@@ -402,6 +400,7 @@ namespace ouzel::scene
     void Actor::updateLocalTransform()
     {
         localTransformDirty = transformDirty = inverseTransformDirty = true;
+        if (layer) layer->invalidateSpatialProxy(*this);
         for (const auto component : components)
             component->updateTransform();
     }
@@ -534,6 +533,12 @@ namespace ouzel::scene
 
     void Actor::setLayer(Layer* newLayer)
     {
+        if (layer != newLayer)
+        {
+            if (layer) layer->removeActor(*this);
+            if (newLayer) newLayer->invalidateSpatialProxy(*this);
+        }
+
         ActorContainer::setLayer(newLayer);
 
         for (const auto component : components)
@@ -3,8 +3,11 @@
 #ifndef OUZEL_SCENE_ACTOR_HPP
 #define OUZEL_SCENE_ACTOR_HPP
 
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <vector>
+#include "DynamicAabbTree.hpp"
 #include "../math/Box.hpp"
 #include "../math/Color.hpp"
 #include "../math/Matrix.hpp"
@@ -69,10 +72,8 @@ namespace ouzel::scene
         Actor() = default;
         ~Actor() override;
 
-        virtual void visit(std::vector<Actor*>& drawQueue,
-                           const math::Matrix<float, 4>& newParentTransform,
+        virtual void visit(const math::Matrix<float, 4>& newParentTransform,
                            bool parentTransformDirty,
-                           Camera* camera,
                            Order parentOrder,
                            bool parentHidden);
         virtual void draw(Camera* camera, bool wireframe);
@@ -196,6 +197,15 @@ namespace ouzel::scene
 
         std::vector<Component*> components;
         std::vector<std::unique_ptr<Component>> ownedComponents;
+
+    private:
+        static constexpr std::size_t invalidIndex = std::numeric_limits<std::size_t>::max();
+
+        // state of the actor in the spatial index of its layer
+        std::size_t spatialProxy = DynamicAabbTree<Actor*>::nullProxy;
+        std::size_t spatialDirtyIndex = invalidIndex; // position in the dirty list of the layer
+        math::Box<float, 3> spatialBoundingBox; // local bounding box of the last update
+        std::uint32_t traversalIndex = 0; // position in the last scene graph traversal
     };
 }
 
@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <algorithm>
+#include <limits>
 #include "Camera.hpp"
 #include "Actor.hpp"
 #include "Layer.hpp"
@@ -284,6 +285,31 @@ namespace ouzel::scene
         }
     }
 
+    math::Box<float, 3> Camera::getVisibleBox() const
+    {
+        math::Box<float, 3> result;
+
+        // the perspective projection maps the depth to [-1, 1] like the frustum planes do
+        const auto& inverse = getInverseViewProjection();
+        for (const auto x : {-1.0F, 1.0F})
+            for (const auto y : {-1.0F, 1.0F})
+                for (const auto z : {-1.0F, 1.0F})
+                {
+                    math::Vector<float, 3> corner{x, y, z};
+                    transformPoint(inverse, corner);
+                    insertPoint(result, corner);
+                }
+
+        // the orthographic visibility check ignores the depth
+        if (projectionMode == ProjectionMode::orthographic)
+        {
+            result.min.v[2] = std::numeric_limits<float>::lowest();
+            result.max.v[2] = std::numeric_limits<float>::max();
+        }
+
+        return result;
+    }
+
     void Camera::setViewport(const math::Rect<float>& newViewport)
     {
         viewport = newViewport;
@@ -88,6 +88,8 @@ namespace ouzel::scene
         [[nodiscard]] math::Vector<float, 2> convertWorldToNormalized(const math::Vector<float, 3>& worldPosition) const noexcept;
 
         [[nodiscard]] bool checkVisibility(const math::Matrix<float, 4>& boxTransform, const math::Box<float, 3>& box) const;
+        // world space bounding box of the view volume, unbounded along the z axis for the orthographic projection
+        [[nodiscard]] math::Box<float, 3> getVisibleBox() const;
 
         [[nodiscard]] auto& getViewport() const noexcept { return viewport; }
         void setViewport(const math::Rect<float>& newViewport);
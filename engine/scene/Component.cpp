@@ -2,6 +2,7 @@
 
 #include "Component.hpp"
 #include "Actor.hpp"
+#include "Layer.hpp"
 
 namespace ouzel::scene
 {
@@ -15,6 +16,8 @@ namespace ouzel::scene
                          const math::Matrix<float, 4>&,
                          bool)
     {
+        // sprites batched before this component must be drawn first
+        if (layer) layer->getSpriteBatch().flush();
     }
 
     bool Component::pointOn(const math::Vector<float, 2>& position) const noexcept
@@ -0,0 +1,47 @@
+// Ouzel by Elviss Strazdins
+
+#include <array>
+#include <cstddef>
+#include "DrawList.hpp"
+
+namespace ouzel::scene
+{
+    void DrawList::sort()
+    {
+        constexpr std::size_t radixBits = 8;
+        constexpr std::size_t bucketCount = 1U << radixBits;
+        constexpr std::size_t passCount = sizeof(Key) * 8 / radixBits;
+
+        if (entries.size() < 2) return;
+
+        // histograms of all the digits are gathered in a single pass
+        std::array<std::array<std::size_t, bucketCount>, passCount> counts{};
+        for (const auto& entry : entries)
+            for (std::size_t pass = 0; pass < passCount; ++pass)
+                ++counts[pass][(entry.key >> (pass * radixBits)) & (bucketCount - 1)];
+
+        buffer.resize(entries.size());
+
+        for (std::size_t pass = 0; pass < passCount; ++pass)
+        {
+            auto& count = counts[pass];
+
+            // skip the digits that are the same for all the keys (e.g. a common order)
+            const auto digit = (entries.front().key >> (pass * radixBits)) & (bucketCount - 1);
+            if (count[digit] == entries.size()) continue;
+
+            std::size_t offset = 0;
+            for (auto& c : count)
+            {
+                const auto size = c;
+                c = offset;
+                offset += size;
+            }
+
+            for (const auto& entry : entries)
+                buffer[count[(entry.key >> (pass * radixBits)) & (bucketCount - 1)]++] = entry;
+
+            entries.swap(buffer);
+        }
+    }
+}
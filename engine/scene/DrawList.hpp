@@ -0,0 +1,55 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_SCENE_DRAWLIST_HPP
+#define OUZEL_SCENE_DRAWLIST_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace ouzel::scene
+{
+    class Actor;
+
+    // Collects the visible actors with 64-bit sort keys and radix-sorts them,
+    // the storage is kept between frames
+    class DrawList final
+    {
+    public:
+        using Key = std::uint64_t;
+
+        struct Entry final
+        {
+            Key key;
+            Actor* actor;
+        };
+
+        // actors with a higher order are drawn first, actors with the same order
+        // are drawn in the ascending order of their sequence
+        [[nodiscard]] static constexpr Key makeKey(std::int32_t order, std::uint32_t sequence) noexcept
+        {
+            const auto biasedOrder = static_cast<std::uint32_t>(order) ^ 0x80000000U;
+            return (static_cast<Key>(~biasedOrder) << 32) | sequence;
+        }
+
+        void clear() noexcept { entries.clear(); }
+
+        void add(Actor& actor, std::int32_t order, std::uint32_t sequence)
+        {
+            entries.push_back(Entry{makeKey(order, sequence), &actor});
+        }
+
+        void sort();
+
+        [[nodiscard]] auto isEmpty() const noexcept { return entries.empty(); }
+        [[nodiscard]] auto getSize() const noexcept { return entries.size(); }
+
+        [[nodiscard]] auto begin() const noexcept { return entries.begin(); }
+        [[nodiscard]] auto end() const noexcept { return entries.end(); }
+
+    private:
+        std::vector<Entry> entries;
+        std::vector<Entry> buffer;
+    };
+}
+
+#endif // OUZEL_SCENE_DRAWLIST_HPP
@@ -0,0 +1,328 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_SCENE_DYNAMICAABBTREE_HPP
+#define OUZEL_SCENE_DYNAMICAABBTREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "../math/Box.hpp"
+
+namespace ouzel::scene
+{
+    // Bounding volume hierarchy of fattened boxes that is updated incrementally,
+    // a proxy is reinserted only when its box leaves the fattened box
+    template <class Type>
+    class DynamicAabbTree final
+    {
+    public:
+        using Box = math::Box<float, 3>;
+        static constexpr std::size_t nullProxy = std::numeric_limits<std::size_t>::max();
+
+        explicit DynamicAabbTree(float initMargin = 0.1F) noexcept:
+            margin{initMargin}
+        {
+        }
+
+        [[nodiscard]] auto isEmpty() const noexcept { return root == nullProxy; }
+        [[nodiscard]] auto getHeight() const noexcept { return root == nullProxy ? 0 : nodes[root].height; }
+
+        [[nodiscard]] const Type& getData(std::size_t proxy) const noexcept { return nodes[proxy].data; }
+        [[nodiscard]] const Box& getFatBox(std::size_t proxy) const noexcept { return nodes[proxy].box; }
+
+        std::size_t insert(const Box& box, const Type& data)
+        {
+            const auto proxy = allocateNode();
+            nodes[proxy].box = fatten(box);
+            nodes[proxy].data = data;
+            nodes[proxy].height = 0;
+            insertLeaf(proxy);
+            return proxy;
+        }
+
+        void remove(std::size_t proxy)
+        {
+            removeLeaf(proxy);
+            freeNode(proxy);
+        }
+
+        // returns true if the proxy had to be reinserted
+        bool move(std::size_t proxy, const Box& box)
+        {
+            const auto& fatBox = nodes[proxy].box;
+            if (contains(fatBox, box)) return false;
+
+            removeLeaf(proxy);
+            nodes[proxy].box = fatten(box);
+            insertLeaf(proxy);
+            return true;
+        }
+
+        void clear() noexcept
+        {
+            nodes.clear();
+            root = nullProxy;
+            freeList = nullProxy;
+        }
+
+        // calls the function with the data of every proxy whose fattened box intersects the box
+        template <class Function>
+        void query(const Box& box, Function function) const
+        {
+            if (root == nullProxy) return;
+
+            stack.clear();
+            stack.push_back(root);
+
+            while (!stack.empty())
+            {
+                const auto& node = nodes[stack.back()];
+                stack.pop_back();
+
+                if (!intersects(node.box, box)) continue;
+
+                if (node.isLeaf())
+                    function(node.data);
+                else
+                {
+                    stack.push_back(node.left);
+                    stack.push_back(node.right);
+                }
+            }
+        }
+
+    private:
+        struct Node final
+        {
+            [[nodiscard]] bool isLeaf() const noexcept { return left == nullProxy; }
+
+            Box box;
+            Type data{};
+            std::size_t parent = nullProxy; // next free node for the nodes in the free list
+            std::size_t left = nullProxy;
+            std::size_t right = nullProxy;
+            std::int32_t height = -1; // -1 for free nodes
+        };
+
+        static bool contains(const Box& outer, const Box& inner) noexcept
+        {
+            for (std::size_t i = 0; i < 3; ++i)
+                if (inner.min.v[i] < outer.min.v[i] || inner.max.v[i] > outer.max.v[i])
+                    return false;
+            return true;
+        }
+
+        // sum of the extents, it does not degenerate for flat (2D) boxes
+        static float getCost(const Box& box) noexcept
+        {
+            return (box.max.v[0] - box.min.v[0]) +
+                (box.max.v[1] - box.min.v[1]) +
+                (box.max.v[2] - box.min.v[2]);
+        }
+
+        Box fatten(const Box& box) const noexcept
+        {
+            Box result = box;
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                const auto extension = (box.max.v[i] - box.min.v[i]) * margin;
+                result.min.v[i] -= extension;
+                result.max.v[i] += extension;
+            }
+            return result;
+        }
+
+        std::size_t allocateNode()
+        {
+            if (freeList == nullProxy)
+            {
+                nodes.emplace_back();
+                return nodes.size() - 1;
+            }
+
+            const auto index = freeList;
+            freeList = nodes[index].parent;
+            nodes[index] = Node{};
+            return index;
+        }
+
+        void freeNode(std::size_t index) noexcept
+        {
+            nodes[index].parent = freeList;
+            nodes[index].left = nullProxy;
+            nodes[index].right = nullProxy;
+            nodes[index].height = -1;
+            nodes[index].data = Type{};
+            freeList = index;
+        }
+
+        void insertLeaf(std::size_t leaf)
+        {
+            if (root == nullProxy)
+            {
+                root = leaf;
+                nodes[root].parent = nullProxy;
+                return;
+            }
+
+            // find the best sibling by the cost of the new parent and the enlargement of the ancestors
+            const auto leafBox = nodes[leaf].box;
+            auto index = root;
+            while (!nodes[index].isLeaf())
+            {
+                const auto& node = nodes[index];
+                const auto area = getCost(node.box);
+                const auto combinedArea = getCost(math::merged(node.box, leafBox));
+
+                const auto cost = 2.0F * combinedArea;
+                const auto inheritanceCost = 2.0F * (combinedArea - area);
+
+                const auto getChildCost = [this, &leafBox, inheritanceCost](std::size_t child) noexcept {
+                    const auto mergedCost = getCost(math::merged(leafBox, nodes[child].box));
+                    return nodes[child].isLeaf() ?
+                        mergedCost + inheritanceCost :
+                        mergedCost - getCost(nodes[child].box) + inheritanceCost;
+                };
+
+                const auto leftCost = getChildCost(node.left);
+                const auto rightCost = getChildCost(node.right);
+
+                if (cost < leftCost && cost < rightCost) break;
+
+                index = leftCost < rightCost ? node.left : node.right;
+            }
+
+            const auto sibling = index;
+            const auto oldParent = nodes[sibling].parent;
+            const auto newParent = allocateNode();
+            nodes[newParent].parent = oldParent;
+            nodes[newParent].box = math::merged(leafBox, nodes[sibling].box);
+            nodes[newParent].height = nodes[sibling].height + 1;
+            nodes[newParent].left = sibling;
+            nodes[newParent].right = leaf;
+            nodes[sibling].parent = newParent;
+            nodes[leaf].parent = newParent;
+
+            if (oldParent != nullProxy)
+            {
+                if (nodes[oldParent].left == sibling)
+                    nodes[oldParent].left = newParent;
+                else
+                    nodes[oldParent].right = newParent;
+            }
+            else
+                root = newParent;
+
+            refit(nodes[leaf].parent);
+        }
+
+        void removeLeaf(std::size_t leaf) noexcept
+        {
+            if (leaf == root)
+            {
+                root = nullProxy;
+                return;
+            }
+
+            const auto parent = nodes[leaf].parent;
+            const auto grandParent = nodes[parent].parent;
+            const auto sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+            if (grandParent != nullProxy)
+            {
+                if (nodes[grandParent].left == parent)
+                    nodes[grandParent].left = sibling;
+                else
+                    nodes[grandParent].right = sibling;
+                nodes[sibling].parent = grandParent;
+                freeNode(parent);
+
+                refit(grandParent);
+            }
+            else
+            {
+                root = sibling;
+                nodes[sibling].parent = nullProxy;
+                freeNode(parent);
+            }
+        }
+
+        // rebalances and updates the boxes and the heights up to the root
+        void refit(std::size_t index) noexcept
+        {
+            while (index != nullProxy)
+            {
+                index = balance(index);
+
+                auto& node = nodes[index];
+                node.height = 1 + std::max(nodes[node.left].height, nodes[node.right].height);
+                node.box = math::merged(nodes[node.left].box, nodes[node.right].box);
+
+                index = node.parent;
+            }
+        }
+
+        // performs a left or right rotation if the node is imbalanced, returns the new subtree root
+        std::size_t balance(std::size_t a) noexcept
+        {
+            if (nodes[a].isLeaf() || nodes[a].height < 2) return a;
+
+            const auto b = nodes[a].left;
+            const auto c = nodes[a].right;
+            const auto difference = nodes[c].height - nodes[b].height;
+
+            if (difference > 1) return rotate(a, c, b, false);
+            if (difference < -1) return rotate(a, b, c, true);
+            return a;
+        }
+
+        // moves the higher child up and puts the node under it
+        std::size_t rotate(std::size_t a, std::size_t up, std::size_t other, bool upIsLeft) noexcept
+        {
+            const auto f = nodes[up].left;
+            const auto g = nodes[up].right;
+
+            nodes[up].left = a;
+            nodes[up].parent = nodes[a].parent;
+            nodes[a].parent = up;
+
+            if (const auto parent = nodes[up].parent; parent != nullProxy)
+            {
+                if (nodes[parent].left == a)
+                    nodes[parent].left = up;
+                else
+                    nodes[parent].right = up;
+            }
+            else
+                root = up;
+
+            // the higher grandchild stays under the rotated node, the lower one replaces it under a
+            const auto keep = nodes[f].height > nodes[g].height ? f : g;
+            const auto give = keep == f ? g : f;
+
+            nodes[up].right = keep;
+            if (upIsLeft)
+                nodes[a].left = give;
+            else
+                nodes[a].right = give;
+            nodes[give].parent = a;
+
+            nodes[a].box = math::merged(nodes[other].box, nodes[give].box);
+            nodes[up].box = math::merged(nodes[a].box, nodes[keep].box);
+            nodes[a].height = 1 + std::max(nodes[other].height, nodes[give].height);
+            nodes[up].height = 1 + std::max(nodes[a].height, nodes[keep].height);
+
+            return up;
+        }
+
+        float margin;
+        std::vector<Node> nodes;
+        std::size_t root = nullProxy;
+        std::size_t freeList = nullProxy;
+        mutable std::vector<std::size_t> stack;
+    };
+}
+
+#endif // OUZEL_SCENE_DYNAMICAABBTREE_HPP
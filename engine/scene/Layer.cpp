@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <algorithm>
+#include <limits>
 #include "Layer.hpp"
 #include "Scene.hpp"
 #include "Component.hpp"
@@ -11,6 +12,36 @@
 
 namespace ouzel::scene
 {
+    namespace
+    {
+        math::Box<float, 3> transformBox(const math::Matrix<float, 4>& transform,
+                                         const math::Box<float, 3>& box) noexcept
+        {
+            math::Box<float, 3> result;
+
+            for (const auto x : {box.min.v[0], box.max.v[0]})
+                for (const auto y : {box.min.v[1], box.max.v[1]})
+                    for (const auto z : {box.min.v[2], box.max.v[2]})
+                    {
+                        math::Vector<float, 3> corner{x, y, z};
+                        transformPoint(transform, corner);
+                        insertPoint(result, corner);
+                    }
+
+            return result;
+        }
+
+        // picking is two-dimensional, so the query box spans all depths
+        math::Box<float, 3> getPickBox(const math::Vector<float, 2>& min,
+                                       const math::Vector<float, 2>& max) noexcept
+        {
+            return math::Box<float, 3>{
+                math::Vector<float, 3>{min.v[0], min.v[1], std::numeric_limits<float>::lowest()},
+                math::Vector<float, 3>{max.v[0], max.v[1], std::numeric_limits<float>::max()}
+            };
+        }
+    }
+
     Layer::Layer()
     {
         layer = this;
@@ -19,24 +50,46 @@ namespace ouzel::scene
     Layer::~Layer()
     {
         if (scene) scene->removeLayer(*this);
+
+        // the actors have to leave the spatial index before it is destroyed
+        removeAllChildren();
     }
 
     void Layer::draw()
     {
+        spriteBatch.begin();
+
+        // propagates the transforms and updates the spatial index once for all cameras
+        traversalCount = 0;
+        unculledActors.clear();
+
+        for (const auto actor : children)
+            actor->visit(math::identityMatrix<float, 4>, false, 0, false);
+
         for (const auto camera : cameras)
         {
-            std::vector<Actor*> drawQueue;
+            drawList.clear();
+
+            for (const auto actor : unculledActors)
+                drawList.add(*actor, actor->worldOrder, actor->traversalIndex);
 
-            for (const auto actor : children)
-                actor->visit(drawQueue, math::identityMatrix<float, 4>, false, camera, 0, false);
+            spatialIndex.query(camera->getVisibleBox(), [this, camera](Actor* actor) {
+                if (!actor->worldHidden && !actor->cullDisabled &&
+                    camera->checkVisibility(actor->getTransform(), actor->spatialBoundingBox))
+                    drawList.add(*actor, actor->worldOrder, actor->traversalIndex);
+            });
+
+            drawList.sort();
 
             engine->getGraphics().setRenderTarget(camera->getRenderTarget() ? camera->getRenderTarget()->getResource() : 0);
             engine->getGraphics().setViewport(camera->getRenderViewport());
             engine->getGraphics().setDepthStencilState(camera->getDepthStencilState() ? camera->getDepthStencilState()->getResource() : 0,
                                                         camera->getStencilReferenceValue());
 
-            for (const auto actor : drawQueue)
-                actor->draw(camera, camera->getWireframe());
+            for (const auto& entry : drawList)
+                entry.actor->draw(camera, camera->getWireframe());
+
+            spriteBatch.flush();
         }
     }
 
@@ -78,7 +131,7 @@ namespace ouzel::scene
             if (renderTargets || !camera->getRenderTarget())
             {
                 const auto worldPosition = math::Vector<float, 2>{camera->convertNormalizedToWorld(position)};
-                const auto actors = findActors(worldPosition);
+                const auto actors = queryActors(worldPosition);
                 if (!actors.empty()) return actors.front();
             }
         }
@@ -97,7 +150,7 @@ namespace ouzel::scene
             if (renderTargets || !camera->getRenderTarget())
             {
                 const auto worldPosition = math::Vector<float, 2>{camera->convertNormalizedToWorld(position)};
-                const auto actors = findActors(worldPosition);
+                const auto actors = queryActors(worldPosition);
                 result.insert(result.end(), actors.begin(), actors.end());
             }
         }
@@ -121,7 +174,7 @@ namespace ouzel::scene
                 for (const auto& edge : edges)
                     worldEdges.emplace_back(camera->convertNormalizedToWorld(edge));
 
-                const auto actors = findActors(worldEdges);
+                const auto actors = queryActors(worldEdges);
                 result.insert(result.end(), actors.begin(), actors.end());
             }
         }
@@ -151,4 +204,138 @@ namespace ouzel::scene
     {
         if (scene) scene->removeLayer(*this);
     }
+
+    void Layer::invalidateSpatialProxy(Actor& actor) const
+    {
+        if (actor.spatialDirtyIndex != Actor::invalidIndex) return;
+
+        actor.spatialDirtyIndex = dirtyActors.size();
+        dirtyActors.push_back(&actor);
+    }
+
+    void Layer::updateSpatialProxy(Actor& actor, const math::Box<float, 3>& boundingBox) const
+    {
+        eraseDirtyActor(actor);
+        actor.spatialBoundingBox = boundingBox;
+
+        if (isEmpty(boundingBox))
+        {
+            if (actor.spatialProxy != DynamicAabbTree<Actor*>::nullProxy)
+            {
+                spatialIndex.remove(actor.spatialProxy);
+                actor.spatialProxy = DynamicAabbTree<Actor*>::nullProxy;
+            }
+            return;
+        }
+
+        const auto worldBoundingBox = transformBox(actor.getTransform(), boundingBox);
+
+        if (actor.spatialProxy == DynamicAabbTree<Actor*>::nullProxy)
+            actor.spatialProxy = spatialIndex.insert(worldBoundingBox, &actor);
+        else
+            spatialIndex.move(actor.spatialProxy, worldBoundingBox);
+    }
+
+    void Layer::removeActor(Actor& actor)
+    {
+        if (scene) scene->removePointerActor(actor);
+
+        eraseDirtyActor(actor);
+        actor.spatialBoundingBox = math::Box<float, 3>{};
+
+        if (actor.spatialProxy != DynamicAabbTree<Actor*>::nullProxy)
+        {
+            spatialIndex.remove(actor.spatialProxy);
+            actor.spatialProxy = DynamicAabbTree<Actor*>::nullProxy;
+        }
+    }
+
+    void Layer::eraseDirtyActor(Actor& actor) const noexcept
+    {
+        if (actor.spatialDirtyIndex == Actor::invalidIndex) return;
+
+        const auto last = dirtyActors.back();
+        dirtyActors[actor.spatialDirtyIndex] = last;
+        last->spatialDirtyIndex = actor.spatialDirtyIndex;
+        dirtyActors.pop_back();
+        actor.spatialDirtyIndex = Actor::invalidIndex;
+    }
+
+    void Layer::updateSpatialIndex() const
+    {
+        while (!dirtyActors.empty())
+        {
+            const auto actor = dirtyActors.back();
+            updateSpatialProxy(*actor, actor->getBoundingBox());
+        }
+    }
+
+    std::vector<std::pair<Actor*, math::Vector<float, 3>>> Layer::queryActors(const math::Vector<float, 2>& position) const
+    {
+        updateSpatialIndex();
+
+        std::vector<Actor*> actors;
+        spatialIndex.query(getPickBox(position, position), [this, &position, &actors](Actor* actor) {
+            if (actor->isPickable() && !isHidden(*actor) && actor->pointOn(position))
+                actors.push_back(actor);
+        });
+
+        std::sort(actors.begin(), actors.end(), isAbove);
+
+        std::vector<std::pair<Actor*, math::Vector<float, 3>>> result;
+        result.reserve(actors.size());
+
+        for (const auto actor : actors)
+            result.emplace_back(actor, actor->convertWorldToLocal(math::Vector<float, 3>{position}));
+
+        return result;
+    }
+
+    std::vector<Actor*> Layer::queryActors(const std::vector<math::Vector<float, 2>>& edges) const
+    {
+        if (edges.empty()) return {};
+
+        updateSpatialIndex();
+
+        auto min = edges.front();
+        auto max = edges.front();
+        for (const auto& edge : edges)
+            for (std::size_t i = 0; i < 2; ++i)
+            {
+                min.v[i] = std::min(min.v[i], edge.v[i]);
+                max.v[i] = std::max(max.v[i], edge.v[i]);
+            }
+
+        std::vector<Actor*> result;
+        spatialIndex.query(getPickBox(min, max), [this, &edges, &result](Actor* actor) {
+            if (actor->isPickable() && !isHidden(*actor) && actor->shapeOverlaps(edges))
+                result.push_back(actor);
+        });
+
+        std::sort(result.begin(), result.end(), isAbove);
+
+        return result;
+    }
+
+    bool Layer::isHidden(const Actor& actor) const noexcept
+    {
+        // the world hidden flag is only updated when the layer is drawn
+        for (const ActorContainer* container = &actor; container && container != this;)
+        {
+            const auto current = static_cast<const Actor*>(container);
+            if (current->isHidden()) return true;
+            container = current->parent;
+        }
+
+        return false;
+    }
+
+    bool Layer::isAbove(const Actor* a, const Actor* b) noexcept
+    {
+        // actors with a lower order are drawn later, so they are on top,
+        // actors with the same order are on top if they are drawn later
+        return a->worldOrder != b->worldOrder ?
+            a->worldOrder < b->worldOrder :
+            a->traversalIndex > b->traversalIndex;
+    }
 }
@@ -7,7 +7,10 @@
 #include <vector>
 #include "Actor.hpp"
 #include "Camera.hpp"
+#include "DrawList.hpp"
+#include "DynamicAabbTree.hpp"
 #include "Light.hpp"
+#include "SpriteBatch.hpp"
 #include "../math/Vector.hpp"
 
 namespace ouzel::scene
@@ -16,6 +19,7 @@ namespace ouzel::scene
 
     class Layer: public ActorContainer
     {
+        friend Actor;
         friend Scene;
         friend Camera;
         friend Light;
@@ -41,6 +45,8 @@ namespace ouzel::scene
         [[nodiscard]] auto getScene() const noexcept { return scene; }
         void removeFromScene();
 
+        [[nodiscard]] auto& getSpriteBatch() noexcept { return spriteBatch; }
+
     protected:
         void addCamera(Camera& camera);
         void removeCamera(Camera& camera);
@@ -57,6 +63,29 @@ namespace ouzel::scene
         std::vector<Light*> lights;
 
         Order order = 0;
+
+        DrawList drawList;
+        SpriteBatch spriteBatch;
+
+    private:
+        void invalidateSpatialProxy(Actor& actor) const;
+        void updateSpatialProxy(Actor& actor, const math::Box<float, 3>& boundingBox) const;
+        void removeActor(Actor& actor);
+        void eraseDirtyActor(Actor& actor) const noexcept;
+        void updateSpatialIndex() const;
+
+        std::vector<std::pair<Actor*, math::Vector<float, 3>>> queryActors(const math::Vector<float, 2>& position) const;
+        std::vector<Actor*> queryActors(const std::vector<math::Vector<float, 2>>& edges) const;
+        bool isHidden(const Actor& actor) const noexcept;
+        static bool isAbove(const Actor* a, const Actor* b) noexcept;
+
+        // world bounding boxes of the actors, updated from the transform-dirty flags
+        // and refreshed before every pick and every draw
+        mutable DynamicAabbTree<Actor*> spatialIndex;
+        mutable std::vector<Actor*> dirtyActors;
+
+        std::vector<Actor*> unculledActors;
+        std::uint32_t traversalCount = 0;
     };
 }
 
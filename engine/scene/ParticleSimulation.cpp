@@ -0,0 +1,434 @@
+// Ouzel by Elviss Strazdins
+
+#include <algorithm>
+#include <cmath>
+#include "ParticleSimulation.hpp"
+#include "../math/Scalar.hpp"
+#include "../math/Simd.hpp"
+
+namespace ouzel::scene
+{
+    namespace
+    {
+        constexpr float updateStep = 1.0F / 60.0F;
+
+        // runs the kernel with SIMD lanes on the bulk of the particles and with scalars on the rest
+        template <class Kernel>
+        void runKernel(std::size_t count, Kernel kernel)
+        {
+            const auto simdEnd = count - count % math::SimdLanes::width;
+            kernel(math::SimdLanes{}, std::size_t{0}, simdEnd);
+            kernel(math::ScalarLanes{}, simdEnd, count);
+        }
+
+        template <class Lanes, class Particles>
+        void integrateGravity(Particles& particles, std::size_t begin, std::size_t end,
+                              const math::Vector<float, 2>& gravity, float positionSign) noexcept
+        {
+            const auto step = Lanes::set(updateStep);
+            const auto zero = Lanes::set(0.0F);
+            const auto gravityX = Lanes::set(gravity.v[0]);
+            const auto gravityY = Lanes::set(gravity.v[1]);
+            const auto positionStep = Lanes::set(updateStep * positionSign);
+
+            for (auto i = begin; i < end; i += Lanes::width)
+            {
+                auto positionX = Lanes::load(&particles.positionX[i]);
+                auto positionY = Lanes::load(&particles.positionY[i]);
+
+                // radial acceleration
+                const auto lengthSquared = Lanes::add(Lanes::mul(positionX, positionX), Lanes::mul(positionY, positionY));
+                const auto inverseLength = Lanes::reciprocalSqrt(lengthSquared);
+                const auto normalize = Lanes::either(Lanes::equal(positionX, zero), Lanes::equal(positionY, zero));
+                const auto nonZero = Lanes::greater(lengthSquared, zero);
+                const auto radialX = Lanes::select(normalize, Lanes::select(nonZero, Lanes::mul(positionX, inverseLength), zero), zero);
+                const auto radialY = Lanes::select(normalize, Lanes::select(nonZero, Lanes::mul(positionY, inverseLength), zero), zero);
+
+                // tangential acceleration
+                const auto radialAcceleration = Lanes::load(&particles.radialAcceleration[i]);
+                const auto tangentialAcceleration = Lanes::load(&particles.tangentialAcceleration[i]);
+                const auto tangentialX = Lanes::sub(zero, Lanes::mul(Lanes::mul(radialY, radialAcceleration), tangentialAcceleration));
+                const auto tangentialY = Lanes::mul(Lanes::mul(radialX, radialAcceleration), tangentialAcceleration);
+
+                // (gravity + radial + tangential) * updateStep
+                auto directionX = Lanes::load(&particles.directionX[i]);
+                auto directionY = Lanes::load(&particles.directionY[i]);
+                directionX = Lanes::add(directionX, Lanes::mul(Lanes::add(Lanes::add(radialX, tangentialX), gravityX), step));
+                directionY = Lanes::add(directionY, Lanes::mul(Lanes::add(Lanes::add(radialY, tangentialY), gravityY), step));
+                Lanes::store(&particles.directionX[i], directionX);
+                Lanes::store(&particles.directionY[i], directionY);
+
+                positionX = Lanes::add(positionX, Lanes::mul(directionX, positionStep));
+                positionY = Lanes::add(positionY, Lanes::mul(directionY, positionStep));
+                Lanes::store(&particles.positionX[i], positionX);
+                Lanes::store(&particles.positionY[i], positionY);
+            }
+        }
+
+        template <class Lanes, class Particles>
+        void integrateRadius(Particles& particles, std::size_t begin, std::size_t end,
+                             float positionSign) noexcept
+        {
+            const auto step = Lanes::set(updateStep);
+            const auto zero = Lanes::set(0.0F);
+            const auto sign = Lanes::set(positionSign);
+
+            for (auto i = begin; i < end; i += Lanes::width)
+            {
+                const auto angle = Lanes::add(Lanes::load(&particles.angle[i]),
+                                              Lanes::mul(Lanes::load(&particles.degreesPerSecond[i]), step));
+                const auto radius = Lanes::add(Lanes::load(&particles.radius[i]),
+                                               Lanes::mul(Lanes::load(&particles.deltaRadius[i]), step));
+                Lanes::store(&particles.angle[i], angle);
+                Lanes::store(&particles.radius[i], radius);
+
+                typename Lanes::Type sine;
+                typename Lanes::Type cosine;
+                Lanes::sinCos(angle, sine, cosine);
+
+                Lanes::store(&particles.positionX[i], Lanes::sub(zero, Lanes::mul(cosine, radius)));
+                Lanes::store(&particles.positionY[i], Lanes::sub(zero, Lanes::mul(Lanes::mul(sine, radius), sign)));
+            }
+        }
+
+        template <class Lanes, class Particles>
+        void integrateCommon(Particles& particles, std::size_t begin, std::size_t end) noexcept
+        {
+            const auto step = Lanes::set(updateStep);
+            const auto zero = Lanes::set(0.0F);
+
+            const auto advance = [step](std::vector<float>& values, const std::vector<float>& deltas, std::size_t i) noexcept {
+                Lanes::store(&values[i], Lanes::add(Lanes::load(&values[i]), Lanes::mul(Lanes::load(&deltas[i]), step)));
+            };
+
+            for (auto i = begin; i < end; i += Lanes::width)
+            {
+                Lanes::store(&particles.life[i], Lanes::sub(Lanes::load(&particles.life[i]), step));
+
+                advance(particles.colorRed, particles.deltaColorRed, i);
+                advance(particles.colorGreen, particles.deltaColorGreen, i);
+                advance(particles.colorBlue, particles.deltaColorBlue, i);
+                advance(particles.colorAlpha, particles.deltaColorAlpha, i);
+                advance(particles.rotation, particles.deltaRotation, i);
+
+                const auto size = Lanes::add(Lanes::load(&particles.size[i]),
+                                             Lanes::mul(Lanes::load(&particles.deltaSize[i]), step));
+                Lanes::store(&particles.size[i], Lanes::max(zero, size));
+            }
+        }
+
+        // merges the transformed particle positions into the minimum and the maximum
+        template <class Lanes, class Particles>
+        void mergeBounds(const Particles& particles, std::size_t begin, std::size_t end,
+                         const math::Matrix<float, 4>& transform,
+                         math::Vector<float, 3>& minimum, math::Vector<float, 3>& maximum) noexcept
+        {
+            if (begin == end) return;
+
+            const auto& m = transform.m.v;
+            typename Lanes::Type lower[3];
+            typename Lanes::Type upper[3];
+            for (std::size_t c = 0; c < 3; ++c)
+            {
+                lower[c] = Lanes::set(minimum.v[c]);
+                upper[c] = Lanes::set(maximum.v[c]);
+            }
+
+            for (auto i = begin; i < end; i += Lanes::width)
+            {
+                const auto x = Lanes::load(&particles.positionX[i]);
+                const auto y = Lanes::load(&particles.positionY[i]);
+                const auto w = Lanes::add(Lanes::add(Lanes::mul(Lanes::set(m[3]), x), Lanes::mul(Lanes::set(m[7]), y)), Lanes::set(m[15]));
+
+                for (std::size_t c = 0; c < 3; ++c)
+                {
+                    const auto value = Lanes::div(Lanes::add(Lanes::add(Lanes::mul(Lanes::set(m[c]), x),
+                                                                        Lanes::mul(Lanes::set(m[4 + c]), y)),
+                                                             Lanes::set(m[12 + c])), w);
+                    lower[c] = Lanes::min(lower[c], value);
+                    upper[c] = Lanes::max(upper[c], value);
+                }
+            }
+
+            for (std::size_t c = 0; c < 3; ++c)
+            {
+                minimum.v[c] = Lanes::reduceMin(lower[c]);
+                maximum.v[c] = Lanes::reduceMax(upper[c]);
+            }
+        }
+
+        // writes the corners of the rotated particle quads to the vertices
+        template <class Lanes, class Particles>
+        void buildQuads(const Particles& particles, std::size_t begin, std::size_t end,
+                        const math::Vector<float, 2>& offset, float positionFactor,
+                        std::vector<graphics::Vertex>& vertices) noexcept
+        {
+            const auto offsetX = Lanes::set(offset.v[0]);
+            const auto offsetY = Lanes::set(offset.v[1]);
+            const auto factor = Lanes::set(positionFactor);
+            const auto half = Lanes::set(0.5F);
+            const auto toRadians = Lanes::set(-math::tau<float> / 360.0F);
+
+            float corners[8][Lanes::width];
+
+            for (auto i = begin; i < end; i += Lanes::width)
+            {
+                const auto x = Lanes::add(offsetX, Lanes::mul(Lanes::load(&particles.positionX[i]), factor));
+                const auto y = Lanes::add(offsetY, Lanes::mul(Lanes::load(&particles.positionY[i]), factor));
+                const auto halfSize = Lanes::mul(Lanes::load(&particles.size[i]), half);
+
+                typename Lanes::Type sine;
+                typename Lanes::Type cosine;
+                Lanes::sinCos(Lanes::mul(Lanes::load(&particles.rotation[i]), toRadians), sine, cosine);
+
+                const auto hc = Lanes::mul(halfSize, cosine);
+                const auto hs = Lanes::mul(halfSize, sine);
+
+                Lanes::store(corners[0], Lanes::add(Lanes::sub(x, hc), hs));
+                Lanes::store(corners[1], Lanes::sub(Lanes::sub(y, hs), hc));
+                Lanes::store(corners[2], Lanes::add(Lanes::add(x, hc), hs));
+                Lanes::store(corners[3], Lanes::sub(Lanes::add(y, hs), hc));
+                Lanes::store(corners[4], Lanes::sub(Lanes::sub(x, hc), hs));
+                Lanes::store(corners[5], Lanes::add(Lanes::sub(y, hs), hc));
+                Lanes::store(corners[6], Lanes::sub(Lanes::add(x, hc), hs));
+                Lanes::store(corners[7], Lanes::add(Lanes::add(y, hs), hc));
+
+                for (std::size_t lane = 0; lane < Lanes::width; ++lane)
+                {
+                    const auto index = i + lane;
+                    const math::Color color{
+                        particles.colorRed[index],
+                        particles.colorGreen[index],
+                        particles.colorBlue[index],
+                        particles.colorAlpha[index]
+                    };
+
+                    auto vertex = &vertices[index * 4];
+                    for (std::size_t corner = 0; corner < 4; ++corner)
+                    {
+                        vertex[corner].position = math::Vector<float, 3>{corners[corner * 2][lane], corners[corner * 2 + 1][lane], 0.0F};
+                        vertex[corner].color = color;
+                    }
+                }
+            }
+        }
+    }
+
+    void ParticleSimulation::init(const ParticleSystemData& newParticleSystemData)
+    {
+        particleSystemData = newParticleSystemData;
+
+        const std::size_t maxParticles = particleSystemData.maxParticles;
+
+        vertices.clear();
+        vertices.reserve(maxParticles * 4);
+
+        for (std::size_t i = 0; i < maxParticles; ++i)
+        {
+            vertices.emplace_back(math::Vector<float, 3>{-1.0F, -1.0F, 0.0F}, math::whiteColor,
+                                  math::Vector<float, 2>{0.0F, 1.0F}, math::Vector<float, 3>{0.0F, 0.0F, -1.0F});
+            vertices.emplace_back(math::Vector<float, 3>{1.0F, -1.0F, 0.0F}, math::whiteColor,
+                                  math::Vector<float, 2>{1.0F, 1.0F}, math::Vector<float, 3>{0.0F, 0.0F, -1.0F});
+            vertices.emplace_back(math::Vector<float, 3>{-1.0F, 1.0F, 0.0F}, math::whiteColor,
+                                  math::Vector<float, 2>{0.0F, 0.0F}, math::Vector<float, 3>{0.0F, 0.0F, -1.0F});
+            vertices.emplace_back(math::Vector<float, 3>{1.0F, 1.0F, 0.0F}, math::whiteColor,
+                                  math::Vector<float, 2>{1.0F, 0.0F}, math::Vector<float, 3>{0.0F, 0.0F, -1.0F});
+        }
+
+        particles.resize(maxParticles);
+        particleCount = 0;
+    }
+
+    void ParticleSimulation::reset() noexcept
+    {
+        emitCounter = 0.0F;
+        elapsed = 0.0F;
+        timeSinceUpdate = 0.0F;
+        particleCount = 0;
+        finished = false;
+    }
+
+    ParticleSimulation::Result ParticleSimulation::simulate(const float delta)
+    {
+        timeSinceUpdate += delta;
+
+        bool updated = false;
+
+        while (timeSinceUpdate >= updateStep)
+        {
+            timeSinceUpdate -= updateStep;
+
+            if (running && particleSystemData.emissionRate > 0.0F)
+            {
+                const float rate = 1.0F / particleSystemData.emissionRate;
+
+                if (particleCount < particleSystemData.maxParticles)
+                {
+                    emitCounter += updateStep;
+                    if (emitCounter < 0.0F)
+                        emitCounter = 0.0F;
+                }
+
+                const auto emitCount = static_cast<std::size_t>(std::min(static_cast<float>(particleSystemData.maxParticles - particleCount), emitCounter / rate));
+                emitParticles(emitCount);
+                emitCounter -= rate * emitCount;
+
+                elapsed += updateStep;
+                if (elapsed < 0.0F)
+                    elapsed = 0.0F;
+                if (particleSystemData.duration >= 0.0F && particleSystemData.duration < elapsed)
+                {
+                    finished = true;
+                    running = false;
+                }
+            }
+            else if (!particleCount)
+                return Result::finished;
+
+            const auto positionSign = particleSystemData.yCoordFlipped ? 1.0F : -1.0F;
+
+            if (particleSystemData.emitterType == ParticleSystemData::EmitterType::gravity)
+                runKernel(particleCount, [this, positionSign](auto lanes, std::size_t begin, std::size_t end) noexcept {
+                    integrateGravity<decltype(lanes)>(particles, begin, end, particleSystemData.gravity, positionSign);
+                });
+            else
+                runKernel(particleCount, [this, positionSign](auto lanes, std::size_t begin, std::size_t end) noexcept {
+                    integrateRadius<decltype(lanes)>(particles, begin, end, positionSign);
+                });
+
+            runKernel(particleCount, [this](auto lanes, std::size_t begin, std::size_t end) noexcept {
+                integrateCommon<decltype(lanes)>(particles, begin, end);
+            });
+
+            // replace the dead particles with the last ones
+            for (std::size_t counter = particleCount; counter > 0; --counter)
+            {
+                const std::size_t i = counter - 1;
+                if (particles.life[i] < 0.0F)
+                    particles.copy(--particleCount, i);
+            }
+
+            updated = true;
+        }
+
+        if (!updated) return Result::idle;
+
+        updateBoundingBox();
+        updateParticleMesh();
+
+        return Result::updated;
+    }
+
+    void ParticleSimulation::updateBoundingBox()
+    {
+        math::reset(boundingBox);
+
+        const auto merge = [this](const math::Matrix<float, 4>& transform) {
+            runKernel(particleCount, [this, &transform](auto lanes, std::size_t begin, std::size_t end) noexcept {
+                mergeBounds<decltype(lanes)>(particles, begin, end, transform, boundingBox.min, boundingBox.max);
+            });
+        };
+
+        if (particleSystemData.positionType == ParticleSystemData::PositionType::grouped)
+            merge(math::identityMatrix<float, 4>);
+        else if (hasEmitter)
+            merge(emitter.boundsTransform);
+    }
+
+    void ParticleSimulation::updateParticleMesh()
+    {
+        if (hasEmitter)
+        {
+            runKernel(particleCount, [this](auto lanes, std::size_t begin, std::size_t end) noexcept {
+                buildQuads<decltype(lanes)>(particles, begin, end, emitter.meshOffset, emitter.meshPositionFactor, vertices);
+            });
+        }
+    }
+
+    void ParticleSimulation::emitParticles(const std::size_t count)
+    {
+        const auto remainingCount = (particleCount + count > particleSystemData.maxParticles) ?
+            particleSystemData.maxParticles - particleCount : count;
+
+        if (remainingCount && hasEmitter)
+        {
+            const auto random = [this]() {
+                return std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
+            };
+
+            for (std::size_t i = particleCount; i < particleCount + remainingCount; ++i)
+            {
+                if (particleSystemData.emitterType == ParticleSystemData::EmitterType::gravity)
+                {
+                    particles.life[i] = std::max(particleSystemData.particleLifespan + particleSystemData.particleLifespanVariance * random(), 0.0F);
+
+                    const auto particlePosition = particleSystemData.sourcePosition + emitter.position + math::Vector<float, 2>{
+                        particleSystemData.sourcePositionVariance.v[0] * random(),
+                        particleSystemData.sourcePositionVariance.v[1] * random()
+                    };
+                    particles.positionX[i] = particlePosition.v[0];
+                    particles.positionY[i] = particlePosition.v[1];
+
+                    particles.size[i] = std::max(particleSystemData.startParticleSize + particleSystemData.startParticleSizeVariance * random(), 0.0F);
+
+                    const float finishSize = std::max(particleSystemData.finishParticleSize + particleSystemData.finishParticleSizeVariance * random(), 0.0F);
+                    particles.deltaSize[i] = (finishSize - particles.size[i]) / particles.life[i];
+
+                    particles.colorRed[i] = std::clamp(particleSystemData.startColorRed + particleSystemData.startColorRedVariance * random(), 0.0F, 1.0F);
+                    particles.colorGreen[i] = std::clamp(particleSystemData.startColorGreen + particleSystemData.startColorGreenVariance * random(), 0.0F, 1.0F);
+                    particles.colorBlue[i] = std::clamp(particleSystemData.startColorBlue + particleSystemData.startColorBlueVariance * random(), 0.0F, 1.0F);
+                    particles.colorAlpha[i] = std::clamp(particleSystemData.startColorAlpha + particleSystemData.startColorAlphaVariance * random(), 0.0F, 1.0F);
+
+                    const float finishColorRed = std::clamp(particleSystemData.finishColorRed + particleSystemData.finishColorRedVariance * random(), 0.0F, 1.0F);
+                    const float finishColorGreen = std::clamp(particleSystemData.finishColorGreen + particleSystemData.finishColorGreenVariance * random(), 0.0F, 1.0F);
+                    const float finishColorBlue = std::clamp(particleSystemData.finishColorBlue + particleSystemData.finishColorBlueVariance * random(), 0.0F, 1.0F);
+                    const float finishColorAlpha = std::clamp(particleSystemData.finishColorAlpha + particleSystemData.finishColorAlphaVariance * random(), 0.0F, 1.0F);
+
+                    particles.deltaColorRed[i] = (finishColorRed - particles.colorRed[i]) / particles.life[i];
+                    particles.deltaColorGreen[i] = (finishColorGreen - particles.colorGreen[i]) / particles.life[i];
+                    particles.deltaColorBlue[i] = (finishColorBlue - particles.colorBlue[i]) / particles.life[i];
+                    particles.deltaColorAlpha[i] = (finishColorAlpha - particles.colorAlpha[i]) / particles.life[i];
+
+                    particles.rotation[i] = particleSystemData.startRotation + particleSystemData.startRotationVariance * random();
+
+                    const float finishRotation = particleSystemData.finishRotation + particleSystemData.finishRotationVariance * random();
+                    particles.deltaRotation[i] = (finishRotation - particles.rotation[i]) / particles.life[i];
+
+                    particles.radialAcceleration[i] = particleSystemData.radialAcceleration + particleSystemData.radialAcceleration * random();
+                    particles.tangentialAcceleration[i] = particleSystemData.tangentialAcceleration + particleSystemData.tangentialAcceleration * random();
+
+                    if (particleSystemData.rotationIsDir)
+                    {
+                        const float a = math::degToRad(particleSystemData.angle + particleSystemData.angleVariance * random());
+                        const math::Vector<float, 2> v{std::cos(a), std::sin(a)};
+                        const float s = particleSystemData.speed + particleSystemData.speedVariance * random();
+                        const auto dir = v * s;
+                        particles.directionX[i] = dir.v[0];
+                        particles.directionY[i] = dir.v[1];
+                        particles.rotation[i] = -math::radToDeg(getAngle(dir));
+                    }
+                    else
+                    {
+                        const float a = math::degToRad(particleSystemData.angle + particleSystemData.angleVariance * random());
+                        const math::Vector<float, 2> v{std::cos(a), std::sin(a)};
+                        const float s = particleSystemData.speed + particleSystemData.speedVariance * random();
+                        const auto dir = v * s;
+                        particles.directionX[i] = dir.v[0];
+                        particles.directionY[i] = dir.v[1];
+                    }
+                }
+                else
+                {
+                    particles.radius[i] = particleSystemData.maxRadius + particleSystemData.maxRadiusVariance * random();
+                    particles.angle[i] = math::degToRad(particleSystemData.angle + particleSystemData.angleVariance * random());
+                    particles.degreesPerSecond[i] = math::degToRad(particleSystemData.rotatePerSecond + particleSystemData.rotatePerSecondVariance * random());
+
+                    const float endRadius = particleSystemData.minRadius + particleSystemData.minRadiusVariance * random();
+                    particles.deltaRadius[i] = (endRadius - particles.radius[i]) / particles.life[i];
+                }
+            }
+
+            particleCount += remainingCount;
+        }
+    }
+}
@@ -0,0 +1,281 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_SCENE_PARTICLESIMULATION_HPP
+#define OUZEL_SCENE_PARTICLESIMULATION_HPP
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "../graphics/Texture.hpp"
+#include "../graphics/Vertex.hpp"
+#include "../math/Box.hpp"
+#include "../math/Matrix.hpp"
+#include "../math/Vector.hpp"
+
+namespace ouzel::scene
+{
+    struct ParticleSystemData final
+    {
+        enum class EmitterType
+        {
+            gravity,
+            radius
+        };
+
+        enum class PositionType
+        {
+            free,
+            parent, // relative to parent
+            grouped
+        };
+
+        std::string name;
+
+        std::uint32_t blendFuncSource = 0;
+        std::uint32_t blendFuncDestination = 0;
+
+        EmitterType emitterType = EmitterType::gravity;
+        std::uint32_t maxParticles = 0;
+        float duration = 0.0F;
+        float particleLifespan = 0.0F;
+        float particleLifespanVariance = 0.0F;
+
+        float speed = 0.0F;
+        float speedVariance = 0.0F;
+
+        math::Vector<float, 2> sourcePosition{};
+        math::Vector<float, 2> sourcePositionVariance{};
+
+        PositionType positionType = PositionType::free;
+
+        float startParticleSize = 0.0F;
+        float startParticleSizeVariance = 0.0F;
+
+        float finishParticleSize = 0.0F;
+        float finishParticleSizeVariance = 0.0F;
+
+        float angle = 0.0F;
+        float angleVariance = 0.0F;
+
+        float startRotation = 0.0F;
+        float startRotationVariance = 0.0F;
+
+        float finishRotation = 0.0F;
+        float finishRotationVariance = 0.0F;
+
+        float rotatePerSecond = 0.0F;
+        float rotatePerSecondVariance = 0.0F;
+
+        float minRadius = 0.0F;
+        float minRadiusVariance = 0.0F;
+
+        float maxRadius = 0.0F;
+        float maxRadiusVariance = 0.0F;
+
+        float radialAcceleration = 0.0F;
+        float radialAccelVariance = 0.0F;
+
+        float tangentialAcceleration = 0.0F;
+        float tangentialAccelVariance = 0.0F;
+
+        bool absolutePosition = false;
+        bool yCoordFlipped = false;
+        bool rotationIsDir = false;
+
+        math::Vector<float, 2> gravity{};
+
+        float startColorRed = 0.0F;
+        float startColorGreen = 0.0F;
+        float startColorBlue = 0.0F;
+        float startColorAlpha = 0.0F;
+
+        float startColorRedVariance = 0.0F;
+        float startColorGreenVariance = 0.0F;
+        float startColorBlueVariance = 0.0F;
+        float startColorAlphaVariance = 0.0F;
+
+        float finishColorRed = 0.0F;
+        float finishColorGreen = 0.0F;
+        float finishColorBlue = 0.0F;
+        float finishColorAlpha = 0.0F;
+
+        float finishColorRedVariance = 0.0F;
+        float finishColorGreenVariance = 0.0F;
+        float finishColorBlueVariance = 0.0F;
+        float finishColorAlphaVariance = 0.0F;
+
+        float emissionRate = 0.0F;
+
+        std::shared_ptr<graphics::Texture> texture;
+    };
+
+    // Simulates the particles of a particle system and builds their quads,
+    // it does not touch the engine, so the simulations of several systems can
+    // run on worker threads
+    class ParticleSimulation final
+    {
+    public:
+        enum class Result
+        {
+            idle, // less than one update step has passed
+            updated, // the particles, the vertices and the bounding box were updated
+            finished // the emission has stopped and all the particles are dead
+        };
+
+        // state of the emitting actor, read on the update thread
+        struct Emitter final
+        {
+            math::Vector<float, 2> position{};
+            math::Vector<float, 2> meshOffset{};
+            float meshPositionFactor = 1.0F;
+            math::Matrix<float, 4> boundsTransform = math::identityMatrix<float, 4>;
+        };
+
+        explicit ParticleSimulation(std::mt19937::result_type seed = std::mt19937::default_seed):
+            randomEngine{seed}
+        {
+        }
+
+        void init(const ParticleSystemData& newParticleSystemData);
+
+        [[nodiscard]] auto& getParticleSystemData() const noexcept { return particleSystemData; }
+
+        void setPositionType(const ParticleSystemData::PositionType newPositionType) noexcept
+        {
+            particleSystemData.positionType = newPositionType;
+        }
+
+        // the simulation is deterministic for a given seed regardless of the thread it runs on
+        void setRandomSeed(std::mt19937::result_type seed) { randomEngine.seed(seed); }
+
+        // particles are emitted and their quads are built only while there is an emitter
+        void setEmitter(const Emitter& newEmitter) noexcept
+        {
+            emitter = newEmitter;
+            hasEmitter = true;
+        }
+
+        void removeEmitter() noexcept { hasEmitter = false; }
+
+        void start() noexcept
+        {
+            finished = false;
+            running = true;
+        }
+
+        void stop() noexcept { running = false; }
+        void reset() noexcept;
+
+        [[nodiscard]] auto isRunning() const noexcept { return running; }
+        [[nodiscard]] auto getParticleCount() const noexcept { return particleCount; }
+
+        Result simulate(const float delta);
+
+        [[nodiscard]] auto& getVertices() const noexcept { return vertices; }
+        [[nodiscard]] auto& getBoundingBox() const noexcept { return boundingBox; }
+
+    private:
+        void updateBoundingBox();
+        void updateParticleMesh();
+
+        void emitParticles(const std::size_t count);
+
+        ParticleSystemData particleSystemData;
+
+        // structure of arrays, so that the update kernels can process several particles at once
+        struct Particles final
+        {
+            template <class Function>
+            void forEach(Function function)
+            {
+                function(life);
+                function(positionX);
+                function(positionY);
+                function(colorRed);
+                function(colorGreen);
+                function(colorBlue);
+                function(colorAlpha);
+                function(deltaColorRed);
+                function(deltaColorGreen);
+                function(deltaColorBlue);
+                function(deltaColorAlpha);
+                function(size);
+                function(deltaSize);
+                function(rotation);
+                function(deltaRotation);
+                function(radialAcceleration);
+                function(tangentialAcceleration);
+                function(directionX);
+                function(directionY);
+                function(angle);
+                function(radius);
+                function(degreesPerSecond);
+                function(deltaRadius);
+            }
+
+            void resize(std::size_t count)
+            {
+                forEach([count](auto& values) { values.resize(count); });
+            }
+
+            void copy(std::size_t source, std::size_t destination) noexcept
+            {
+                forEach([source, destination](auto& values) noexcept { values[destination] = values[source]; });
+            }
+
+            std::vector<float> life;
+
+            std::vector<float> positionX;
+            std::vector<float> positionY;
+
+            std::vector<float> colorRed;
+            std::vector<float> colorGreen;
+            std::vector<float> colorBlue;
+            std::vector<float> colorAlpha;
+
+            std::vector<float> deltaColorRed;
+            std::vector<float> deltaColorGreen;
+            std::vector<float> deltaColorBlue;
+            std::vector<float> deltaColorAlpha;
+
+            std::vector<float> size;
+            std::vector<float> deltaSize;
+
+            std::vector<float> rotation;
+            std::vector<float> deltaRotation;
+
+            // gravity emitter
+            std::vector<float> radialAcceleration;
+            std::vector<float> tangentialAcceleration;
+            std::vector<float> directionX;
+            std::vector<float> directionY;
+
+            // radius emitter
+            std::vector<float> angle;
+            std::vector<float> radius;
+            std::vector<float> degreesPerSecond;
+            std::vector<float> deltaRadius;
+        };
+
+        Particles particles;
+        std::vector<graphics::Vertex> vertices;
+        math::Box<float, 3> boundingBox;
+
+        std::size_t particleCount = 0;
+
+        float emitCounter = 0.0F;
+        float elapsed = 0.0F;
+        float timeSinceUpdate = 0.0F;
+        bool running = false;
+        bool finished = false;
+
+        std::mt19937 randomEngine;
+
+        bool hasEmitter = false;
+        Emitter emitter;
+    };
+}
+
+#endif // OUZEL_SCENE_PARTICLESIMULATION_HPP
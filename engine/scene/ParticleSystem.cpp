@@ -10,27 +10,72 @@
 #include "Layer.hpp"
 #include "../assets/Cache.hpp"
 #include "../core/Engine.hpp"
-#include "../math/Scalar.hpp"
 #include "../storage/FileSystem.hpp"
 #include "../utils/Utils.hpp"
 
 namespace ouzel::scene
 {
-    namespace
+    ParticleSystemUpdater::ParticleSystemUpdater()
     {
-        constexpr float updateStep = 1.0F / 60.0F;
+        updateHandler.updateHandler = [this](const UpdateEvent& event) {
+            update(event.delta);
+            return false;
+        };
+    }
+
+    void ParticleSystemUpdater::add(ParticleSystem& particleSystem)
+    {
+        if (particleSystems.empty())
+            engine->getEventDispatcher().addEventHandler(updateHandler);
+
+        particleSystems.push_back(&particleSystem);
+    }
+
+    void ParticleSystemUpdater::remove(const ParticleSystem& particleSystem)
+    {
+        if (const auto i = std::find(particleSystems.begin(), particleSystems.end(), &particleSystem); i != particleSystems.end())
+            particleSystems.erase(i);
+
+        // the particle system can be removed by an event handler while the systems are being finished
+        std::replace(updatedParticleSystems.begin(), updatedParticleSystems.end(),
+                     const_cast<ParticleSystem*>(&particleSystem), static_cast<ParticleSystem*>(nullptr));
+
+        if (particleSystems.empty())
+            updateHandler.remove();
+    }
+
+    void ParticleSystemUpdater::update(float delta)
+    {
+        updatedParticleSystems = particleSystems;
+
+        // the actor transforms are cached lazily, so they are read on the update thread
+        for (const auto particleSystem : updatedParticleSystems)
+            particleSystem->prepareUpdate();
+
+        engine->getWorkerPool().parallelFor(0, updatedParticleSystems.size(), 1,
+                                            [this, delta](std::size_t first, std::size_t last) {
+            for (auto i = first; i < last; ++i)
+                updatedParticleSystems[i]->simulate(delta);
+        });
+
+        for (std::size_t i = 0; i < updatedParticleSystems.size(); ++i)
+            if (const auto particleSystem = updatedParticleSystems[i])
+                particleSystem->finishUpdate();
+
+        updatedParticleSystems.clear();
+    }
+
+    ParticleSystemUpdater& ParticleSystem::getUpdater()
+    {
+        return engine->getSceneManager().getParticleSystemUpdater();
     }
 
     ParticleSystem::ParticleSystem():
         shader{engine->getCache().getShader(shaderTexture)},
-        blendState{engine->getCache().getBlendState(blendAlpha)}
+        blendState{engine->getCache().getBlendState(blendAlpha)},
+        simulation{core::randomEngine()}
     {
         whitePixelTexture = engine->getCache().getTexture(textureWhitePixel);
-
-        updateHandler.updateHandler = [this](const UpdateEvent& event) {
-            update(event.delta);
-            return false;
-        };
     }
 
     ParticleSystem::ParticleSystem(const ParticleSystemData& initParticleSystemData):
@@ -39,6 +84,11 @@ namespace ouzel::scene
         init(initParticleSystemData);
     }
 
+    ParticleSystem::~ParticleSystem()
+    {
+        if (active) getUpdater().remove(*this);
+    }
+
     void ParticleSystem::draw(const math::Matrix<float, 4>& transformMatrix,
                               const float opacity,
                               const math::Matrix<float, 4>& renderViewProjection,
@@ -49,14 +99,16 @@ namespace ouzel::scene
                         renderViewProjection,
                         wireframe);
 
-        if (particleCount)
+        if (const auto particleCount = simulation.getParticleCount())
         {
             if (needsMeshUpdate)
             {
-                updateParticleMesh();
+                const auto& vertices = simulation.getVertices();
+                vertexBuffer->setData(vertices.data(), static_cast<std::uint32_t>(getVectorSize(vertices)));
                 needsMeshUpdate = false;
             }
 
+            const auto& particleSystemData = simulation.getParticleSystemData();
             const math::Matrix<float, 4> transform =
                 (particleSystemData.positionType == ParticleSystemData::PositionType::free ||
                  particleSystemData.positionType == ParticleSystemData::PositionType::parent) ?
@@ -65,202 +117,112 @@ namespace ouzel::scene
                 renderViewProjection * transformMatrix :
                 throw std::runtime_error{"Invalid position type"};
 
-            const auto colorVector = {1.0F, 1.0F, 1.0F, opacity};
-
-            std::vector<std::vector<float>> pixelShaderConstants(1);
-            pixelShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
-
-            std::vector<std::vector<float>> vertexShaderConstants(1);
-            vertexShaderConstants[0] = {std::begin(transform.m.v), std::end(transform.m.v)};
+            const std::array<float, 4> colorVector{1.0F, 1.0F, 1.0F, opacity};
 
             engine->getGraphics().setPipelineState(blendState->getResource(),
                                                    shader->getResource(),
                                                    graphics::CullMode::none,
                                                    wireframe ? graphics::FillMode::wireframe : graphics::FillMode::solid);
-            engine->getGraphics().setShaderConstants(pixelShaderConstants,
-                                                     vertexShaderConstants);
+            engine->getGraphics().setShaderConstants({colorVector}, {transform});
             engine->getGraphics().setTextures({wireframe ? whitePixelTexture->getResource() : texture->getResource()});
             engine->getGraphics().draw(indexBuffer->getResource(),
                                        static_cast<std::uint32_t>(particleCount * 6),
-                                       sizeof(std::uint16_t),
+                                       sizeof(std::uint32_t),
                                        vertexBuffer->getResource(),
                                        graphics::DrawMode::triangleList,
                                        0);
         }
     }
 
-    void ParticleSystem::update(const float delta)
+    void ParticleSystem::prepareUpdate()
     {
-        timeSinceUpdate += delta;
+        if (!actor)
+        {
+            simulation.removeEmitter();
+            return;
+        }
 
-        bool needsBoundingBoxUpdate = false;
+        const auto& particleSystemData = simulation.getParticleSystemData();
 
-        while (timeSinceUpdate >= updateStep)
-        {
-            timeSinceUpdate -= updateStep;
+        ParticleSimulation::Emitter emitter;
+        emitter.position = (particleSystemData.positionType == ParticleSystemData::PositionType::free) ?
+            math::Vector<float, 2>{actor->convertLocalToWorld(math::Vector<float, 3>{})} :
+            (particleSystemData.positionType == ParticleSystemData::PositionType::parent) ?
+            math::Vector<float, 2>{actor->convertLocalToWorld(math::Vector<float, 3>{}) - actor->getPosition()} :
+            (particleSystemData.positionType == ParticleSystemData::PositionType::grouped) ?
+            math::Vector<float, 2>{} :
+            throw std::runtime_error{"Invalid position type"};
 
-            if (running && particleSystemData.emissionRate > 0.0F)
-            {
-                const float rate = 1.0F / particleSystemData.emissionRate;
-
-                if (particleCount < particleSystemData.maxParticles)
-                {
-                    emitCounter += updateStep;
-                    if (emitCounter < 0.0F)
-                        emitCounter = 0.0F;
-                }
-
-                const auto emitCount = static_cast<std::size_t>(std::min(static_cast<float>(particleSystemData.maxParticles - particleCount), emitCounter / rate));
-                emitParticles(emitCount);
-                emitCounter -= rate * emitCount;
-
-                elapsed += updateStep;
-                if (elapsed < 0.0F)
-                    elapsed = 0.0F;
-                if (particleSystemData.duration >= 0.0F && particleSystemData.duration < elapsed)
-                {
-                    finished = true;
-                    stop();
-                }
-            }
-            else if (active && !particleCount)
-            {
-                active = false;
-                updateHandler.remove();
+        // particles are offset by the actor position in the parent mode and drawn at the origin in the grouped mode
+        emitter.meshOffset = (particleSystemData.positionType == ParticleSystemData::PositionType::parent) ?
+            math::Vector<float, 2>{actor->getPosition()} :
+            math::Vector<float, 2>{};
+        emitter.meshPositionFactor = (particleSystemData.positionType == ParticleSystemData::PositionType::grouped) ? 0.0F : 1.0F;
 
-                auto finishEvent = std::make_unique<AnimationEvent>();
-                finishEvent->type = Event::Type::animationFinish;
-                finishEvent->component = this;
-                engine->getEventDispatcher().dispatchEvent(std::move(finishEvent));
+        emitter.boundsTransform = (particleSystemData.positionType == ParticleSystemData::PositionType::grouped) ?
+            math::identityMatrix<float, 4> :
+            actor->getInverseTransform();
 
-                return;
-            }
+        simulation.setEmitter(emitter);
+    }
 
-            if (active)
-            {
-                for (std::size_t counter = particleCount; counter > 0; --counter)
-                {
-                    const std::size_t i = counter - 1;
-                    auto& particle = particles[i];
-
-                    particle.life -= updateStep;
-
-                    if (particle.life >= 0.0F)
-                    {
-                        if (particleSystemData.emitterType == ParticleSystemData::EmitterType::gravity)
-                        {
-                            math::Vector<float, 2> radial{};
-
-                            // radial acceleration
-                            if (particle.position.v[0] == 0.0F || particle.position.v[1] == 0.0F)
-                                radial = normalized(particle.position);
-
-                            math::Vector<float, 2> tangential = radial * particle.radialAcceleration;
-
-                            // tangential acceleration
-                            std::swap(tangential.v[0], tangential.v[1]);
-                            tangential.v[0] *= -particle.tangentialAcceleration;
-                            tangential.v[1] *= particle.tangentialAcceleration;
-
-                            // (gravity + radial + tangential) * updateStep
-                            const math::Vector<float, 2> directionChange{
-                                (radial.v[0] + tangential.v[0] + particleSystemData.gravity.v[0]) * updateStep,
-                                (radial.v[1] + tangential.v[1] + particleSystemData.gravity.v[1]) * updateStep
-                            };
-                            particle.direction += directionChange;
-
-                            const math::Vector<float, 2> positionChange{
-                                particle.direction.v[0] * updateStep * (particleSystemData.yCoordFlipped ? 1.0F : -1.0F),
-                                particle.direction.v[1] * updateStep * (particleSystemData.yCoordFlipped ? 1.0F : -1.0F)
-                            };
-                            particle.position += positionChange;
-                        }
-                        else
-                        {
-                            particle.angle += particle.degreesPerSecond * updateStep;
-                            particle.radius += particle.deltaRadius * updateStep;
-                            particle.position.v[0] = -std::cos(particle.angle) * particle.radius;
-                            particle.position.v[1] = -std::sin(particle.angle) * particle.radius * (particleSystemData.yCoordFlipped ? 1.0F : -1.0F);
-                        }
-
-                        // color r,g,b,a
-                        particle.colorRed += particle.deltaColorRed * updateStep;
-                        particle.colorGreen += particle.deltaColorGreen * updateStep;
-                        particle.colorBlue += particle.deltaColorBlue * updateStep;
-                        particle.colorAlpha += particle.deltaColorAlpha * updateStep;
-
-                        // size
-                        particle.size += (particle.deltaSize * updateStep);
-                        particle.size = std::max(0.0F, particle.size);
-
-                        // angle
-                        particle.rotation += particle.deltaRotation * updateStep;
-                    }
-                    else
-                    {
-                        particle = particles[particleCount - 1];
-                        --particleCount;
-                    }
-                }
+    void ParticleSystem::finishUpdate()
+    {
+        if (!finishPending) return;
 
-                needsMeshUpdate = true;
-                needsBoundingBoxUpdate = true;
-            }
-        }
+        finishPending = false;
+        active = false;
+        getUpdater().remove(*this);
 
-        if (needsBoundingBoxUpdate)
-        {
-            // Update bounding box
-            math::reset(boundingBox);
+        auto finishEvent = std::make_unique<AnimationEvent>();
+        finishEvent->type = Event::Type::animationFinish;
+        finishEvent->component = this;
+        engine->getEventDispatcher().dispatchEvent(std::move(finishEvent));
+    }
 
-            if (particleSystemData.positionType == ParticleSystemData::PositionType::free ||
-                particleSystemData.positionType == ParticleSystemData::PositionType::parent)
-            {
-                if (actor)
-                {
-                    const auto& inverseTransform = actor->getInverseTransform();
-
-                    for (std::size_t i = 0; i < particleCount; ++i)
-                    {
-                        auto position = math::Vector<float, 3>{particles[i].position};
-                        transformPoint(inverseTransform, position);
-                        insertPoint(boundingBox, position);
-                    }
-                }
-            }
-            else if (particleSystemData.positionType == ParticleSystemData::PositionType::grouped)
-                for (std::size_t i = 0; i < particleCount; ++i)
-                    insertPoint(boundingBox, math::Vector<float, 3>{particles[i].position});
+    void ParticleSystem::simulate(const float delta)
+    {
+        switch (simulation.simulate(delta))
+        {
+            case ParticleSimulation::Result::idle:
+                break;
+            case ParticleSimulation::Result::updated:
+                boundingBox = simulation.getBoundingBox();
+                // the vertex buffer is uploaded by draw on the update thread
+                needsMeshUpdate = true;
+                break;
+            case ParticleSimulation::Result::finished:
+                // the finish event is dispatched by finishUpdate on the update thread
+                finishPending = true;
+                break;
         }
     }
 
     void ParticleSystem::init(const ParticleSystemData& newParticleSystemData)
     {
-        particleSystemData = newParticleSystemData;
-
-        texture = particleSystemData.texture;
+        texture = newParticleSystemData.texture;
 
         if (!texture)
             throw std::runtime_error{"Paricle system data has no texture"};
 
+        simulation.init(newParticleSystemData);
         createParticleMesh();
         resume();
     }
 
     void ParticleSystem::resume()
     {
-        if (!running)
+        if (!simulation.isRunning())
         {
-            finished = false;
-            running = true;
+            simulation.start();
 
             if (!active)
             {
                 active = true;
-                engine->getEventDispatcher().addEventHandler(updateHandler);
+                getUpdater().add(*this);
             }
 
-            if (particleCount == 0)
+            if (simulation.getParticleCount() == 0)
             {
                 auto startEvent = std::make_unique<AnimationEvent>();
                 startEvent->type = Event::Type::animationStart;
@@ -272,40 +234,31 @@ namespace ouzel::scene
 
     void ParticleSystem::stop()
     {
-        running = false;
+        simulation.stop();
     }
 
     void ParticleSystem::reset()
     {
-        emitCounter = 0.0F;
-        elapsed = 0.0F;
-        timeSinceUpdate = 0.0F;
-        particleCount = 0;
-        finished = false;
+        simulation.reset();
     }
 
     void ParticleSystem::createParticleMesh()
     {
-        indices.reserve(particleSystemData.maxParticles * 6);
-        vertices.reserve(particleSystemData.maxParticles * 4);
+        const std::size_t maxParticles = simulation.getParticleSystemData().maxParticles;
+
+        // 32-bit indices, because 16-bit ones only address the vertices of 16384 particles
+        indices.clear();
+        indices.reserve(maxParticles * 6);
 
-        for (std::uint16_t i = 0; i < particleSystemData.maxParticles; ++i)
+        for (std::size_t i = 0; i < maxParticles; ++i)
         {
-            indices.push_back(i * 4 + 0);
-            indices.push_back(i * 4 + 1);
-            indices.push_back(i * 4 + 2);
-            indices.push_back(i * 4 + 1);
-            indices.push_back(i * 4 + 3);
-            indices.push_back(i * 4 + 2);
-
-            vertices.emplace_back(math::Vector<float, 3>{-1.0F, -1.0F, 0.0F}, math::whiteColor,
-                                  math::Vector<float, 2>{0.0F, 1.0F}, math::Vector<float, 3>{0.0F, 0.0F, -1.0F});
-            vertices.emplace_back(math::Vector<float, 3>{1.0F, -1.0F, 0.0F}, math::whiteColor,
-                                  math::Vector<float, 2>{1.0F, 1.0F}, math::Vector<float, 3>{0.0F, 0.0F, -1.0F});
-            vertices.emplace_back(math::Vector<float, 3>{-1.0F, 1.0F, 0.0F}, math::whiteColor,
-                                  math::Vector<float, 2>{0.0F, 0.0F}, math::Vector<float, 3>{0.0F, 0.0F, -1.0F});
-            vertices.emplace_back(math::Vector<float, 3>{1.0F, 1.0F, 0.0F}, math::whiteColor,
-                                  math::Vector<float, 2>{1.0F, 0.0F}, math::Vector<float, 3>{0.0F, 0.0F, -1.0F});
+            const auto firstVertex = static_cast<std::uint32_t>(i * 4);
+            indices.push_back(firstVertex + 0);
+            indices.push_back(firstVertex + 1);
+            indices.push_back(firstVertex + 2);
+            indices.push_back(firstVertex + 1);
+            indices.push_back(firstVertex + 3);
+            indices.push_back(firstVertex + 2);
         }
 
         indexBuffer = std::make_unique<graphics::Buffer>(engine->getGraphics(),
@@ -314,155 +267,11 @@ namespace ouzel::scene
                                                          indices.data(),
                                                          static_cast<std::uint32_t>(getVectorSize(indices)));
 
+        const auto& vertices = simulation.getVertices();
         vertexBuffer = std::make_unique<graphics::Buffer>(engine->getGraphics(),
                                                           graphics::BufferType::vertex,
                                                           graphics::Flags::dynamic,
                                                           vertices.data(),
                                                           static_cast<std::uint32_t>(getVectorSize(vertices)));
-
-        particles.resize(particleSystemData.maxParticles);
-    }
-
-    void ParticleSystem::updateParticleMesh()
-    {
-        if (actor)
-        {
-            for (std::size_t counter = particleCount; counter > 0; --counter)
-            {
-                const std::size_t i = counter - 1;
-                const auto& particle = particles[i];
-
-                const math::Vector<float, 2> position = (particleSystemData.positionType == ParticleSystemData::PositionType::free) ?
-                    particle.position :
-                    (particleSystemData.positionType == ParticleSystemData::PositionType::parent) ?
-                    math::Vector<float, 2>{actor->getPosition()} + particle.position :
-                    (particleSystemData.positionType == ParticleSystemData::PositionType::grouped) ?
-                    math::Vector<float, 2>{} :
-                    throw std::runtime_error{"Invalid position type"};
-
-                const float halfSize = particle.size / 2.0F;
-                const math::Vector<float, 2> v1{-halfSize, -halfSize};
-                const math::Vector<float, 2> v2{halfSize, halfSize};
-
-                const float r = -math::degToRad(particle.rotation);
-                const float cr = std::cos(r);
-                const float sr = std::sin(r);
-
-                const math::Vector<float, 2> a{v1.v[0] * cr - v1.v[1] * sr, v1.v[0] * sr + v1.v[1] * cr};
-                const math::Vector<float, 2> b{v2.v[0] * cr - v1.v[1] * sr, v2.v[0] * sr + v1.v[1] * cr};
-                const math::Vector<float, 2> c{v2.v[0] * cr - v2.v[1] * sr, v2.v[0] * sr + v2.v[1] * cr};
-                const math::Vector<float, 2> d{v1.v[0] * cr - v2.v[1] * sr, v1.v[0] * sr + v2.v[1] * cr};
-
-                const math::Color color{
-                    particle.colorRed,
-                    particle.colorGreen,
-                    particle.colorBlue,
-                    particle.colorAlpha
-                };
-
-                vertices[i * 4 + 0].position = math::Vector<float, 3>{a + position};
-                vertices[i * 4 + 0].color = color;
-
-                vertices[i * 4 + 1].position = math::Vector<float, 3>{b + position};
-                vertices[i * 4 + 1].color = color;
-
-                vertices[i * 4 + 2].position = math::Vector<float, 3>{d + position};
-                vertices[i * 4 + 2].color = color;
-
-                vertices[i * 4 + 3].position = math::Vector<float, 3>{c + position};
-                vertices[i * 4 + 3].color = color;
-            }
-
-            vertexBuffer->setData(vertices.data(), static_cast<std::uint32_t>(getVectorSize(vertices)));
-        }
-    }
-
-    void ParticleSystem::emitParticles(const std::size_t count)
-    {
-        const auto remainingCount = (particleCount + count > particleSystemData.maxParticles) ?
-            particleSystemData.maxParticles - particleCount : count;
-
-        if (remainingCount && actor)
-        {
-            const math::Vector<float, 2> position = (particleSystemData.positionType == ParticleSystemData::PositionType::free) ?
-                math::Vector<float, 2>{actor->convertLocalToWorld(math::Vector<float, 3>{})} :
-                (particleSystemData.positionType == ParticleSystemData::PositionType::parent) ?
-                math::Vector<float, 2>{actor->convertLocalToWorld(math::Vector<float, 3>{}) - actor->getPosition()} :
-                (particleSystemData.positionType == ParticleSystemData::PositionType::grouped) ?
-                math::Vector<float, 2>{} :
-                throw std::runtime_error{"Invalid position type"};
-
-            for (std::size_t i = particleCount; i < particleCount + remainingCount; ++i)
-            {
-                auto& particle = particles[i];
-
-                if (particleSystemData.emitterType == ParticleSystemData::EmitterType::gravity)
-                {
-                    particle.life = std::max(particleSystemData.particleLifespan + particleSystemData.particleLifespanVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F);
-
-                    particle.position = particleSystemData.sourcePosition + position + math::Vector<float, 2>{
-                        particleSystemData.sourcePositionVariance.v[0] * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine),
-                        particleSystemData.sourcePositionVariance.v[1] * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine)
-                    };
-
-                    particle.size = std::max(particleSystemData.startParticleSize + particleSystemData.startParticleSizeVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F);
-
-                    const float finishSize = std::max(particleSystemData.finishParticleSize + particleSystemData.finishParticleSizeVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F);
-                    particle.deltaSize = (finishSize - particle.size) / particle.life;
-
-                    particle.colorRed = std::clamp(particleSystemData.startColorRed + particleSystemData.startColorRedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
-                    particle.colorGreen = std::clamp(particleSystemData.startColorGreen + particleSystemData.startColorGreenVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
-                    particle.colorBlue = std::clamp(particleSystemData.startColorBlue + particleSystemData.startColorBlueVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
-                    particle.colorAlpha = std::clamp(particleSystemData.startColorAlpha + particleSystemData.startColorAlphaVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
-
-                    const float finishColorRed = std::clamp(particleSystemData.finishColorRed + particleSystemData.finishColorRedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
-                    const float finishColorGreen = std::clamp(particleSystemData.finishColorGreen + particleSystemData.finishColorGreenVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
-                    const float finishColorBlue = std::clamp(particleSystemData.finishColorBlue + particleSystemData.finishColorBlueVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
-                    const float finishColorAlpha = std::clamp(particleSystemData.finishColorAlpha + particleSystemData.finishColorAlphaVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
-
-                    particle.deltaColorRed = (finishColorRed - particle.colorRed) / particle.life;
-                    particle.deltaColorGreen = (finishColorGreen - particle.colorGreen) / particle.life;
-                    particle.deltaColorBlue = (finishColorBlue - particle.colorBlue) / particle.life;
-                    particle.deltaColorAlpha = (finishColorAlpha - particle.colorAlpha) / particle.life;
-
-                    particle.rotation = particleSystemData.startRotation + particleSystemData.startRotationVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
-
-                    const float finishRotation = particleSystemData.finishRotation + particleSystemData.finishRotationVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
-                    particle.deltaRotation = (finishRotation - particle.rotation) / particle.life;
-
-                    particle.radialAcceleration = particleSystemData.radialAcceleration + particleSystemData.radialAcceleration * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
-                    particle.tangentialAcceleration = particleSystemData.tangentialAcceleration + particleSystemData.tangentialAcceleration * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
-
-                    if (particleSystemData.rotationIsDir)
-                    {
-                        const float a = math::degToRad(particleSystemData.angle + particleSystemData.angleVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine));
-                        const math::Vector<float, 2> v{std::cos(a), std::sin(a)};
-                        const float s = particleSystemData.speed + particleSystemData.speedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
-                        const auto dir = v * s;
-                        particle.direction = dir;
-                        particle.rotation = -math::radToDeg(getAngle(dir));
-                    }
-                    else
-                    {
-                        const float a = math::degToRad(particleSystemData.angle + particleSystemData.angleVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine));
-                        const math::Vector<float, 2> v{std::cos(a), std::sin(a)};
-                        const float s = particleSystemData.speed + particleSystemData.speedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
-                        const auto dir = v * s;
-                        particle.direction = dir;
-                    }
-                }
-                else
-                {
-                    particle.radius = particleSystemData.maxRadius + particleSystemData.maxRadiusVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
-                    particle.angle = math::degToRad(particleSystemData.angle + particleSystemData.angleVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine));
-                    particle.degreesPerSecond = math::degToRad(particleSystemData.rotatePerSecond + particleSystemData.rotatePerSecondVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine));
-
-                    const float endRadius = particleSystemData.minRadius + particleSystemData.minRadiusVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
-                    particle.deltaRadius = (endRadius - particle.radius) / particle.life;
-                }
-            }
-
-            particleCount += remainingCount;
-        }
     }
 }
@@ -88,6 +88,12 @@ namespace ouzel::scene
 
             child->scene = nullptr;
 
+            for (auto i = pointerOverActors.begin(); i != pointerOverActors.end();)
+                if (i->second && i->second->getLayer() == child)
+                    i = pointerOverActors.erase(i);
+                else
+                    ++i;
+
             layers.erase(layerIterator);
 
             result = true;
@@ -109,6 +115,7 @@ namespace ouzel::scene
             for (const auto layer : layers)
                 layer->leave();
 
+        pointerOverActors.clear();
         layers.clear();
         ownedLayers.clear();
     }
@@ -165,6 +172,15 @@ namespace ouzel::scene
         return result;
     }
 
+    void Scene::removePointerActor(const Actor& actor)
+    {
+        for (auto i = pointerOverActors.begin(); i != pointerOverActors.end();)
+            if (i->second == &actor)
+                i = pointerOverActors.erase(i);
+            else
+                ++i;
+    }
+
     void Scene::enter()
     {
         entered = true;
@@ -180,6 +196,8 @@ namespace ouzel::scene
     {
         entered = false;
 
+        pointerOverActors.clear();
+
         eventHandler.remove();
 
         for (const auto layer : layers)
@@ -204,11 +222,8 @@ namespace ouzel::scene
             }
             case Event::Type::mouseMove:
             {
-                const auto previousActor = pickActor(event.position - event.difference);
-                pointerLeaveActor(0, previousActor.first, event.position);
-
                 const auto actor = pickActor(event.position);
-                pointerEnterActor(0, actor.first, event.position);
+                pointerMoveOverActor(0, actor.first, event.position, event.difference);
 
                 if (const auto i = pointerDownOnActors.find(0); i != pointerDownOnActors.end())
                     pointerDragActor(0, i->second.first, event.position, event.difference, i->second.second);
@@ -237,15 +252,13 @@ namespace ouzel::scene
                 {
                     const auto actor = pickActor(event.position);
                     pointerUpOnActor(event.touchId, actor.first, event.position);
+                    pointerOverActors.erase(event.touchId);
                     break;
                 }
                 case Event::Type::touchMove:
                 {
-                    const auto previousActor = pickActor(event.position - event.difference);
-                    pointerLeaveActor(0, previousActor.first, event.position);
-
                     const auto actor = pickActor(event.position);
-                    pointerEnterActor(0, actor.first, event.position);
+                    pointerMoveOverActor(event.touchId, actor.first, event.position, event.difference);
 
                     if (const auto i = pointerDownOnActors.find(event.touchId); i != pointerDownOnActors.end())
                         pointerDragActor(event.touchId, i->second.first, event.position, event.difference, i->second.second);
@@ -255,6 +268,7 @@ namespace ouzel::scene
                 {
                     const auto actor = pickActor(event.position);
                     pointerUpOnActor(event.touchId, actor.first, event.position);
+                    pointerOverActors.erase(event.touchId);
                     break;
                 }
                 default:
@@ -265,6 +279,22 @@ namespace ouzel::scene
         return false;
     }
 
+    void Scene::pointerMoveOverActor(std::uint64_t pointerId, Actor* actor,
+                                     const math::Vector<float, 2>& position,
+                                     const math::Vector<float, 2>& difference)
+    {
+        // the actor under the pointer is remembered from the previous move,
+        // so that the previous position does not have to be picked again
+        auto i = pointerOverActors.find(pointerId);
+        if (i == pointerOverActors.end())
+            i = pointerOverActors.emplace(pointerId, pickActor(position - difference).first).first;
+
+        pointerLeaveActor(pointerId, i->second, position);
+        pointerEnterActor(pointerId, actor, position);
+
+        i->second = actor;
+    }
+
     void Scene::pointerEnterActor(std::uint64_t pointerId, Actor* actor,
                                   const math::Vector<float, 2>& position)
     {
@@ -16,6 +16,7 @@ namespace ouzel::scene
 
     class Scene
     {
+        friend Layer;
         friend SceneManager;
     public:
         Scene();
@@ -53,12 +54,17 @@ namespace ouzel::scene
                                        const bool renderTargets = false) const;
 
     protected:
+        void removePointerActor(const Actor& actor);
+
         virtual void enter();
         virtual void leave();
 
         bool handleMouse(const MouseEvent& event);
         bool handleTouch(const TouchEvent& event);
 
+        void pointerMoveOverActor(std::uint64_t pointerId, Actor* actor,
+                                  const math::Vector<float, 2>& position,
+                                  const math::Vector<float, 2>& difference);
         void pointerEnterActor(std::uint64_t pointerId, Actor* actor,
                                const math::Vector<float, 2>& position);
         void pointerLeaveActor(std::uint64_t pointerId, Actor* actor,
@@ -80,6 +86,7 @@ namespace ouzel::scene
         EventHandler eventHandler;
 
         std::unordered_map<std::uint64_t, std::pair<Actor*, math::Vector<float, 3>>> pointerDownOnActors;
+        std::unordered_map<std::uint64_t, Actor*> pointerOverActors;
 
         bool entered = false;
     };
@@ -5,9 +5,15 @@
 #include "SceneManager.hpp"
 #include "Scene.hpp"
 #include "Actor.hpp"
+#include "ParticleSystem.hpp"
 
 namespace ouzel::scene
 {
+    SceneManager::SceneManager():
+        particleSystemUpdater{std::make_unique<ParticleSystemUpdater>()}
+    {
+    }
+
     SceneManager::~SceneManager()
     {
         for (auto scene : scenes)
@@ -9,11 +9,12 @@
 namespace ouzel::scene
 {
     class Scene;
+    class ParticleSystemUpdater;
 
     class SceneManager final
     {
     public:
-        SceneManager() = default;
+        SceneManager();
         ~SceneManager();
 
         SceneManager(const SceneManager&) = delete;
@@ -38,7 +39,11 @@ namespace ouzel::scene
 
         void calculateProjection();
 
+        auto& getParticleSystemUpdater() noexcept { return *particleSystemUpdater; }
+
     private:
+        // declared first, so that the particle systems of the owned scenes are removed from it before it is destroyed
+        std::unique_ptr<ParticleSystemUpdater> particleSystemUpdater;
         std::vector<Scene*> scenes;
         std::vector<std::unique_ptr<Scene>> ownedScenes;
     };
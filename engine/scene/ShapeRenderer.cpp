@@ -42,22 +42,15 @@ namespace ouzel::scene
         }
 
         const auto modelViewProj = renderViewProjection * transformMatrix;
-        const auto colorVector = {1.0F, 1.0F, 1.0F, opacity};
+        const std::array<float, 4> colorVector{1.0F, 1.0F, 1.0F, opacity};
 
         for (const auto& drawCommand : drawCommands)
         {
-            std::vector<std::vector<float>> fragmentShaderConstants(1);
-            fragmentShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
-
-            std::vector<std::vector<float>> vertexShaderConstants(1);
-            vertexShaderConstants[0] = {std::begin(modelViewProj.m.v), std::end(modelViewProj.m.v)};
-
             engine->getGraphics().setPipelineState(blendState->getResource(),
                                                    shader->getResource(),
                                                    graphics::CullMode::none,
                                                    wireframe ? graphics::FillMode::wireframe : graphics::FillMode::solid);
-            engine->getGraphics().setShaderConstants(fragmentShaderConstants,
-                                                     vertexShaderConstants);
+            engine->getGraphics().setShaderConstants({colorVector}, {modelViewProj});
             engine->getGraphics().draw(indexBuffer.getResource(),
                                        drawCommand.indexCount,
                                        sizeof(std::uint16_t),
@@ -0,0 +1,74 @@
+// Ouzel by Elviss Strazdins
+
+#include <stdexcept>
+#include "SpriteBatch.hpp"
+#include "../core/Engine.hpp"
+#include "../graphics/Graphics.hpp"
+#include "../utils/Utils.hpp"
+
+namespace ouzel::scene
+{
+    void SpriteBatch::begin() noexcept
+    {
+        vertices.clear();
+        indices.clear();
+        bufferIndex = 0;
+    }
+
+    void SpriteBatch::add(const State& newState,
+                          const math::Matrix<float, 4>& transform,
+                          const std::vector<graphics::Vertex>& newVertices,
+                          const std::vector<std::uint16_t>& newIndices)
+    {
+        if (newVertices.size() > maxVertexCount)
+            throw std::runtime_error{"Too many vertices in a sprite"};
+
+        if (state != newState || vertices.size() + newVertices.size() > maxVertexCount)
+        {
+            flush();
+            state = newState;
+        }
+
+        const auto vertexOffset = static_cast<std::uint16_t>(vertices.size());
+        for (const auto index : newIndices)
+            indices.push_back(static_cast<std::uint16_t>(vertexOffset + index));
+
+        for (auto vertex : newVertices)
+        {
+            transformPoint(transform, vertex.position);
+            vertices.push_back(vertex);
+        }
+    }
+
+    void SpriteBatch::flush()
+    {
+        if (indices.empty()) return;
+
+        if (bufferIndex >= buffers.size())
+            buffers.push_back(Buffers{
+                graphics::Buffer{engine->getGraphics(), graphics::BufferType::index, graphics::Flags::dynamic},
+                graphics::Buffer{engine->getGraphics(), graphics::BufferType::vertex, graphics::Flags::dynamic}
+            });
+
+        auto& batchBuffers = buffers[bufferIndex++];
+        batchBuffers.indexBuffer.setData(indices.data(), static_cast<std::uint32_t>(getVectorSize(indices)));
+        batchBuffers.vertexBuffer.setData(vertices.data(), static_cast<std::uint32_t>(getVectorSize(vertices)));
+
+        engine->getGraphics().setPipelineState(state.blendState,
+                                               state.shader,
+                                               state.cullMode,
+                                               state.fillMode);
+        engine->getGraphics().setShaderConstants({state.color}, {state.renderViewProjection});
+        engine->getGraphics().setTextures({state.textures.begin(), state.textures.end()});
+        engine->getGraphics().draw(batchBuffers.indexBuffer.getResource(),
+                                   static_cast<std::uint32_t>(indices.size()),
+                                   sizeof(std::uint16_t),
+                                   batchBuffers.vertexBuffer.getResource(),
+                                   graphics::DrawMode::triangleList,
+                                   0);
+        engine->getGraphics().countBatch();
+
+        vertices.clear();
+        indices.clear();
+    }
+}
@@ -0,0 +1,83 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_SCENE_SPRITEBATCH_HPP
+#define OUZEL_SCENE_SPRITEBATCH_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "../graphics/Buffer.hpp"
+#include "../graphics/Material.hpp"
+#include "../graphics/RasterizerState.hpp"
+#include "../graphics/Vertex.hpp"
+#include "../math/Matrix.hpp"
+
+namespace ouzel::scene
+{
+    // Merges consecutive sprites that share the pipeline state, textures and color
+    // into one dynamic vertex buffer with pre-transformed vertices
+    class SpriteBatch final
+    {
+    public:
+        static constexpr std::size_t maxVertexCount = 65536; // limited by 16-bit indices
+
+        struct State final
+        {
+            [[nodiscard]] bool operator==(const State& other) const noexcept
+            {
+                return blendState == other.blendState &&
+                    shader == other.shader &&
+                    cullMode == other.cullMode &&
+                    fillMode == other.fillMode &&
+                    textures == other.textures &&
+                    color == other.color &&
+                    renderViewProjection == other.renderViewProjection;
+            }
+
+            [[nodiscard]] bool operator!=(const State& other) const noexcept
+            {
+                return !(*this == other);
+            }
+
+            std::size_t blendState = 0;
+            std::size_t shader = 0;
+            graphics::CullMode cullMode = graphics::CullMode::none;
+            graphics::FillMode fillMode = graphics::FillMode::solid;
+            std::array<std::size_t, graphics::Material::textureLayers> textures{};
+            // the color constant of the shader, which custom materials can use in any way
+            std::array<float, 4> color{1.0F, 1.0F, 1.0F, 1.0F};
+            math::Matrix<float, 4> renderViewProjection = math::identityMatrix<float, 4>;
+        };
+
+        // starts a new frame, the buffers of the previous frame are reused
+        void begin() noexcept;
+
+        void add(const State& newState,
+                 const math::Matrix<float, 4>& transform,
+                 const std::vector<graphics::Vertex>& newVertices,
+                 const std::vector<std::uint16_t>& newIndices);
+
+        // issues the pending sprites as one draw call
+        void flush();
+
+        [[nodiscard]] auto isEmpty() const noexcept { return indices.empty(); }
+
+    private:
+        struct Buffers final
+        {
+            graphics::Buffer indexBuffer;
+            graphics::Buffer vertexBuffer;
+        };
+
+        State state;
+        std::vector<graphics::Vertex> vertices;
+        std::vector<std::uint16_t> indices;
+
+        // every batch of a frame gets its own buffers, so that a later batch
+        // does not overwrite the data of an earlier draw call
+        std::vector<Buffers> buffers;
+        std::size_t bufferIndex = 0;
+    };
+}
+
+#endif // OUZEL_SCENE_SPRITEBATCH_HPP
@@ -19,9 +19,9 @@ namespace ouzel::scene
                              const math::Size<float, 2>& sourceSize,
                              const math::Vector<float, 2>& sourceOffset,
                              const math::Vector<float, 2>& pivot):
-        name{frameName}
+        name{frameName},
+        indices{0, 1, 2, 1, 3, 2}
     {
-        const std::vector<std::uint16_t> indices = {0, 1, 2, 1, 3, 2};
         indexCount = static_cast<std::uint32_t>(indices.size());
 
         math::Vector<float, 2> textCoords[4];
@@ -65,7 +65,7 @@ namespace ouzel::scene
             textCoords[3] = math::Vector<float, 2>{rightBottom.v[0], rightBottom.v[1]};
         }
 
-        const std::vector<graphics::Vertex> vertices{
+        vertices = {
             graphics::Vertex{
                 math::Vector<float, 3>{finalOffset.v[0], finalOffset.v[1], 0.0F}, math::whiteColor,
                 textCoords[0], math::Vector<float, 3>{0.0F, 0.0F, -1.0F}
@@ -101,9 +101,11 @@ namespace ouzel::scene
     }
 
     SpriteData::Frame::Frame(const std::string& frameName,
-                             const std::vector<std::uint16_t>& indices,
-                             const std::vector<graphics::Vertex>& vertices):
-        name{frameName}
+                             const std::vector<std::uint16_t>& initIndices,
+                             const std::vector<graphics::Vertex>& initVertices):
+        name{frameName},
+        indices{initIndices},
+        vertices{initVertices}
     {
         indexCount = static_cast<std::uint32_t>(indices.size());
 
@@ -124,13 +126,15 @@ namespace ouzel::scene
     }
 
     SpriteData::Frame::Frame(const std::string& frameName,
-                             const std::vector<std::uint16_t>& indices,
-                             const std::vector<graphics::Vertex>& vertices,
+                             const std::vector<std::uint16_t>& initIndices,
+                             const std::vector<graphics::Vertex>& initVertices,
                              const math::Rect<float>& frameRectangle,
                              const math::Size<float, 2>& sourceSize,
                              const math::Vector<float, 2>& sourceOffset,
                              const math::Vector<float, 2>& pivot):
-        name{frameName}
+        name{frameName},
+        indices{initIndices},
+        vertices{initVertices}
     {
         indexCount = static_cast<std::uint32_t>(indices.size());
 
@@ -354,11 +358,6 @@ namespace ouzel::scene
                               const math::Matrix<float, 4>& renderViewProjection,
                               bool wireframe)
     {
-        Component::draw(transformMatrix,
-                        opacity,
-                        renderViewProjection,
-                        wireframe);
-
         if (currentAnimation != animationQueue.end() &&
             currentAnimation->animation->frameInterval > 0.0F &&
             !currentAnimation->animation->frames.empty() &&
@@ -368,35 +367,49 @@ namespace ouzel::scene
             if (currentFrame >= currentAnimation->animation->frames.size())
                 currentFrame = currentAnimation->animation->frames.size() - 1;
 
-            const auto modelViewProj = renderViewProjection * transformMatrix * offsetMatrix;
-            const auto colorVector = {
+            const auto& frame = currentAnimation->animation->frames[currentFrame];
+
+            const std::array<float, 4> colorVector{
                 material->diffuseColor.normR(),
                 material->diffuseColor.normG(),
                 material->diffuseColor.normB(),
                 material->diffuseColor.normA() * opacity * material->opacity
             };
 
-            std::vector<std::vector<float>> fragmentShaderConstants(1);
-            fragmentShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
-
-            std::vector<std::vector<float>> vertexShaderConstants(1);
-            vertexShaderConstants[0] = {std::begin(modelViewProj.m.v), std::end(modelViewProj.m.v)};
-
-            std::vector<std::size_t> textures;
-            textures.reserve(graphics::Material::textureLayers);
-            for (const std::shared_ptr<graphics::Texture>& texture : material->textures)
-                textures.push_back(texture ? texture->getResource() : 0);
+            SpriteBatch::State state;
+            state.blendState = material->blendState->getResource();
+            state.shader = material->shader->getResource();
+            state.cullMode = material->cullMode;
+            state.fillMode = wireframe ? graphics::FillMode::wireframe : graphics::FillMode::solid;
+            for (std::size_t i = 0; i < graphics::Material::textureLayers; ++i)
+                state.textures[i] = material->textures[i] ? material->textures[i]->getResource() : 0;
+            state.color = colorVector;
+            state.renderViewProjection = renderViewProjection;
+
+            // consecutive sprites are merged by the layer, it flushes the batch
+            // before any other component draws
+            if (layer)
+            {
+                layer->getSpriteBatch().add(state,
+                                            transformMatrix * offsetMatrix,
+                                            frame.getVertices(),
+                                            frame.getIndices());
+                return;
+            }
 
-            engine->getGraphics().setPipelineState(material->blendState->getResource(),
-                                                   material->shader->getResource(),
-                                                   material->cullMode,
-                                                   wireframe ? graphics::FillMode::wireframe : graphics::FillMode::solid);
-            engine->getGraphics().setShaderConstants(fragmentShaderConstants,
-                                                     vertexShaderConstants);
-            engine->getGraphics().setTextures(textures);
+            Component::draw(transformMatrix,
+                            opacity,
+                            renderViewProjection,
+                            wireframe);
 
-            const auto& frame = currentAnimation->animation->frames[currentFrame];
+            const auto modelViewProj = renderViewProjection * transformMatrix * offsetMatrix;
 
+            engine->getGraphics().setPipelineState(state.blendState,
+                                                   state.shader,
+                                                   state.cullMode,
+                                                   state.fillMode);
+            engine->getGraphics().setShaderConstants({colorVector}, {modelViewProj});
+            engine->getGraphics().setTextures({state.textures.begin(), state.textures.end()});
             engine->getGraphics().draw(frame.getIndexBuffer()->getResource(),
                                        frame.getIndexCount(),
                                        sizeof(std::uint16_t),
@@ -55,12 +55,18 @@ namespace ouzel::scene
             auto& getIndexBuffer() const noexcept { return indexBuffer; }
             auto& getVertexBuffer() const noexcept { return vertexBuffer; }
 
+            // CPU copies of the mesh used for batching
+            auto& getIndices() const noexcept { return indices; }
+            auto& getVertices() const noexcept { return vertices; }
+
         private:
             std::string name;
             math::Box<float, 2> boundingBox;
             std::uint32_t indexCount = 0;
             std::shared_ptr<graphics::Buffer> indexBuffer;
             std::shared_ptr<graphics::Buffer> vertexBuffer;
+            std::vector<std::uint16_t> indices;
+            std::vector<graphics::Vertex> vertices;
         };
 
         struct Animation final
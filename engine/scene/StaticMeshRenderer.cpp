@@ -79,19 +79,13 @@ namespace ouzel::scene
                         wireframe);
 
         const auto modelViewProj = renderViewProjection * transformMatrix;
-        const auto colorVector = {
+        const std::array<float, 4> colorVector{
             material->diffuseColor.normR(),
             material->diffuseColor.normG(),
             material->diffuseColor.normB(),
             material->diffuseColor.normA() * opacity * material->opacity
         };
 
-        std::vector<std::vector<float>> fragmentShaderConstants(1);
-        fragmentShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
-
-        std::vector<std::vector<float>> vertexShaderConstants(1);
-        vertexShaderConstants[0] = {std::begin(modelViewProj.m.v), std::end(modelViewProj.m.v)};
-
         std::vector<std::size_t> textures;
         for (const std::shared_ptr<graphics::Texture>& texture : material->textures)
             textures.push_back(texture ? texture->getResource() : 0);
@@ -100,7 +94,7 @@ namespace ouzel::scene
                                                material->shader->getResource(),
                                                material->cullMode,
                                                wireframe ? graphics::FillMode::wireframe : graphics::FillMode::solid);
-        engine->getGraphics().setShaderConstants(fragmentShaderConstants, vertexShaderConstants);
+        engine->getGraphics().setShaderConstants({colorVector}, {modelViewProj});
         engine->getGraphics().setTextures(textures);
         engine->getGraphics().draw(indexBuffer->getResource(),
                                    indexCount,
@@ -9,6 +9,7 @@
 #include <string>
 #include <string_view>
 #include <vector>
+#include "MappedFile.hpp"
 #include "Path.hpp"
 #include "StorageError.hpp"
 #include "../utils/Utils.hpp"
@@ -20,8 +21,9 @@ namespace ouzel::storage
     public:
         Archive() = default;
 
-        explicit Archive(const Path& path):
-            file{path, std::ios::binary}
+        explicit Archive(const Path& initPath):
+            path{initPath},
+            file{initPath, std::ios::binary}
         {
             constexpr std::uint32_t centralDirectory = 0x02014B50U;
             constexpr std::uint32_t headerSignature = 0x04034B50U;
@@ -94,12 +96,22 @@ namespace ouzel::storage
                 throw Error{"File " + std::string{filename} + " does not exist"};
         }
 
+        // the entries are stored uncompressed, so they can be mapped directly from the archive file
+        MappedFile mapFile(std::string_view filename) const
+        {
+            if (const auto i = entries.find(filename); i != entries.end())
+                return MappedFile{path, static_cast<std::size_t>(i->second.offset), i->second.size};
+            else
+                throw Error{"File " + std::string{filename} + " does not exist"};
+        }
+
         bool fileExists(std::string_view filename) const noexcept(false)
         {
             return entries.find(filename) != entries.end();
         }
 
     private:
+        Path path;
         std::ifstream file;
 
         struct Entry final
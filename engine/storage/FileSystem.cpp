@@ -376,6 +376,63 @@ namespace ouzel::storage
         return data;
     }
 
+    MappedFile FileSystem::mapFile(const Path& filename, const bool searchResources)
+    {
+        if (searchResources)
+        {
+            const auto& genericPath = filename.getGeneric();
+
+            for (const auto& archive : archives)
+                if (archive.second.fileExists(genericPath))
+                    return archive.second.mapFile(genericPath);
+        }
+
+#ifdef __ANDROID__
+        if (!filename.isAbsolute())
+        {
+            auto& engineAndroid = static_cast<core::android::Engine&>(engine);
+
+            const std::unique_ptr<AAsset, decltype(&AAsset_close)> asset{
+                AAssetManager_open(engineAndroid.getAssetManager(), filename.getNative().c_str(), AASSET_MODE_STREAMING),
+                AAsset_close
+            };
+
+            if (!asset)
+                throw Error{"Failed to open file " + std::string(filename)};
+
+            // only the assets that are stored uncompressed in the APK have a file descriptor
+            off64_t start;
+            off64_t length;
+            const auto fileDescriptor = AAsset_openFileDescriptor64(asset.get(), &start, &length);
+            if (fileDescriptor < 0)
+                throw Error{"Failed to map file " + std::string(filename) + ", it is compressed"};
+
+            try
+            {
+                MappedFile result{fileDescriptor,
+                                  static_cast<std::size_t>(start + length),
+                                  static_cast<std::size_t>(start),
+                                  static_cast<std::size_t>(length)};
+                close(fileDescriptor);
+                return result;
+            }
+            catch (...)
+            {
+                close(fileDescriptor);
+                throw;
+            }
+        }
+#endif
+
+        const auto path = getPath(filename, searchResources);
+
+        // file does not exist
+        if (path.isEmpty())
+            throw Error{"Failed to find file " + std::string(filename)};
+
+        return MappedFile{path};
+    }
+
     bool FileSystem::resourceFileExists(const Path& filename) const
     {
         if (filename.isAbsolute())
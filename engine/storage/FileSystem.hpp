@@ -30,6 +30,7 @@
 #  include <unistd.h>
 #endif
 #include "Archive.hpp"
+#include "MappedFile.hpp"
 #include "Path.hpp"
 #include "StorageError.hpp"
 
@@ -249,6 +250,9 @@ namespace ouzel::storage
 
         [[nodiscard]] std::vector<std::byte> readFile(const Path& filename, const bool searchResources = true);
 
+        // maps the file instead of reading it, so that only the accessed parts of it are resident in memory
+        [[nodiscard]] MappedFile mapFile(const Path& filename, const bool searchResources = true);
+
         bool resourceFileExists(const Path& filename) const;
 
         [[nodiscard]] Path getPath(const Path& filename, const bool searchResources = true) const
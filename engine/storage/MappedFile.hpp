@@ -0,0 +1,274 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_STORAGE_MAPPEDFILE_HPP
+#define OUZEL_STORAGE_MAPPEDFILE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <system_error>
+#ifdef _WIN32
+#  pragma push_macro("WIN32_LEAN_AND_MEAN")
+#  pragma push_macro("NOMINMAX")
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <Windows.h>
+#  pragma pop_macro("WIN32_LEAN_AND_MEAN")
+#  pragma pop_macro("NOMINMAX")
+#elif defined(__unix__) || defined(__APPLE__)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+#include "Path.hpp"
+#include "StorageError.hpp"
+
+namespace ouzel::storage
+{
+    // Read-only memory mapping of a file or of a part of it, the pages are read
+    // from the file only when they are accessed and can be released after use
+    class MappedFile final
+    {
+    public:
+        static constexpr std::size_t wholeFile = std::numeric_limits<std::size_t>::max();
+
+        MappedFile() noexcept = default;
+
+        explicit MappedFile(const Path& path, std::size_t offset = 0, std::size_t initSize = wholeFile)
+        {
+#ifdef _WIN32
+            const auto file = CreateFileW(path.getNative().c_str(), GENERIC_READ, FILE_SHARE_READ,
+                                          nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                throw std::system_error{static_cast<int>(GetLastError()), std::system_category(), "Failed to open file"};
+
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize))
+            {
+                const auto error = GetLastError();
+                CloseHandle(file);
+                throw std::system_error{static_cast<int>(error), std::system_category(), "Failed to get file size"};
+            }
+
+            setRange(static_cast<std::size_t>(fileSize.QuadPart), offset, initSize);
+            if (size == 0) // empty ranges can not be mapped
+            {
+                CloseHandle(file);
+                return;
+            }
+
+            const auto fileMapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            const auto error = GetLastError();
+            CloseHandle(file); // the mapping keeps the file open
+
+            if (!fileMapping)
+                throw std::system_error{static_cast<int>(error), std::system_category(), "Failed to create file mapping"};
+
+            const auto mapOffset = static_cast<ULONGLONG>(offset - alignment);
+            mapping = MapViewOfFile(fileMapping, FILE_MAP_READ,
+                                    static_cast<DWORD>(mapOffset >> 32),
+                                    static_cast<DWORD>(mapOffset & 0xFFFFFFFFU),
+                                    alignment + size);
+            const auto mapError = GetLastError();
+            CloseHandle(fileMapping); // the view keeps the mapping alive
+
+            if (!mapping)
+                throw std::system_error{static_cast<int>(mapError), std::system_category(), "Failed to map file"};
+#elif defined(__unix__) || defined(__APPLE__)
+            auto fileDescriptor = open(path.getNative().c_str(), O_RDONLY);
+            while (fileDescriptor == -1 && errno == EINTR)
+                fileDescriptor = open(path.getNative().c_str(), O_RDONLY);
+
+            if (fileDescriptor == -1)
+                throw std::system_error{errno, std::system_category(), "Failed to open file"};
+
+            try
+            {
+                struct stat s;
+                if (fstat(fileDescriptor, &s) == -1)
+                    throw std::system_error{errno, std::system_category(), "Failed to get file size"};
+
+                map(fileDescriptor, static_cast<std::size_t>(s.st_size), offset, initSize);
+            }
+            catch (...)
+            {
+                close(fileDescriptor);
+                throw;
+            }
+
+            close(fileDescriptor); // the mapping keeps the file open
+#else
+#  error "Unsupported platform"
+#endif
+        }
+
+#if defined(__unix__) || defined(__APPLE__)
+        // maps a part of an open file, the file descriptor can be closed afterwards
+        MappedFile(int fileDescriptor, std::size_t fileSize, std::size_t offset, std::size_t initSize)
+        {
+            map(fileDescriptor, fileSize, offset, initSize);
+        }
+#endif
+
+        ~MappedFile()
+        {
+            unmap();
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept:
+            mapping{other.mapping},
+            alignment{other.alignment},
+            size{other.size}
+        {
+            other.mapping = nullptr;
+            other.alignment = 0;
+            other.size = 0;
+        }
+
+        MappedFile& operator=(MappedFile&& other) noexcept
+        {
+            if (&other == this) return *this;
+
+            unmap();
+            mapping = other.mapping;
+            alignment = other.alignment;
+            size = other.size;
+            other.mapping = nullptr;
+            other.alignment = 0;
+            other.size = 0;
+
+            return *this;
+        }
+
+        [[nodiscard]] auto data() const noexcept
+        {
+            return mapping ? static_cast<const std::byte*>(mapping) + alignment : nullptr;
+        }
+
+        [[nodiscard]] auto getSize() const noexcept { return size; }
+
+        // hints that the range will be read soon, so that it is paged in ahead of the reads
+        void prefetch(std::size_t offset, std::size_t length) const noexcept
+        {
+            if (offset >= size) return;
+            length = std::min(length, size - offset);
+
+#ifdef _WIN32
+            // PrefetchVirtualMemory is not available on all the supported versions, Windows reads ahead sequential access itself
+            (void)length;
+#elif defined(__unix__) || defined(__APPLE__)
+            const auto begin = pageFloor(alignment + offset);
+            const auto end = alignment + offset + length;
+            madvise(static_cast<std::byte*>(mapping) + begin, end - begin, MADV_WILLNEED);
+#endif
+        }
+
+        // releases the pages that are fully within the range, they are read from the file again if they are accessed
+        void release(std::size_t offset, std::size_t length) const noexcept
+        {
+            if (offset >= size) return;
+            length = std::min(length, size - offset);
+
+            const auto begin = pageCeil(alignment + offset);
+            const auto end = pageFloor(alignment + offset + length);
+            if (begin >= end) return;
+
+#ifdef _WIN32
+            // unlocking pages that are not locked removes them from the working set
+            VirtualUnlock(static_cast<std::byte*>(mapping) + begin, end - begin);
+#elif defined(__unix__) || defined(__APPLE__)
+            madvise(static_cast<std::byte*>(mapping) + begin, end - begin, MADV_DONTNEED);
+#endif
+        }
+
+    private:
+        static std::size_t getPageSize() noexcept
+        {
+#ifdef _WIN32
+            SYSTEM_INFO systemInfo;
+            GetSystemInfo(&systemInfo);
+            return systemInfo.dwPageSize;
+#elif defined(__unix__) || defined(__APPLE__)
+            return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+        }
+
+        // the mapping must start at a multiple of this
+        static std::size_t getAllocationGranularity() noexcept
+        {
+#ifdef _WIN32
+            SYSTEM_INFO systemInfo;
+            GetSystemInfo(&systemInfo);
+            return systemInfo.dwAllocationGranularity;
+#elif defined(__unix__) || defined(__APPLE__)
+            return getPageSize();
+#endif
+        }
+
+        static std::size_t pageFloor(std::size_t offset) noexcept
+        {
+            const auto pageSize = getPageSize();
+            return offset - offset % pageSize;
+        }
+
+        static std::size_t pageCeil(std::size_t offset) noexcept
+        {
+            const auto pageSize = getPageSize();
+            return (offset + pageSize - 1) - (offset + pageSize - 1) % pageSize;
+        }
+
+        void setRange(std::size_t fileSize, std::size_t offset, std::size_t initSize)
+        {
+            if (offset > fileSize)
+                throw Error{"Mapped range is outside of the file"};
+
+            size = (initSize == wholeFile) ? fileSize - offset : initSize;
+            if (size > fileSize - offset)
+                throw Error{"Mapped range is outside of the file"};
+
+            alignment = offset % getAllocationGranularity();
+        }
+
+#if defined(__unix__) || defined(__APPLE__)
+        void map(int fileDescriptor, std::size_t fileSize, std::size_t offset, std::size_t initSize)
+        {
+            setRange(fileSize, offset, initSize);
+            if (size == 0) return; // empty ranges can not be mapped
+
+            const auto result = mmap(nullptr, alignment + size, PROT_READ, MAP_SHARED,
+                                     fileDescriptor, static_cast<off_t>(offset - alignment));
+            if (result == MAP_FAILED)
+                throw std::system_error{errno, std::system_category(), "Failed to map file"};
+
+            mapping = result;
+        }
+#endif
+
+        void unmap() noexcept
+        {
+            if (!mapping) return;
+
+#ifdef _WIN32
+            UnmapViewOfFile(mapping);
+#elif defined(__unix__) || defined(__APPLE__)
+            munmap(mapping, alignment + size);
+#endif
+            mapping = nullptr;
+        }
+
+        void* mapping = nullptr;
+        std::size_t alignment = 0; // distance from the start of the mapping to the mapped range
+        std::size_t size = 0;
+    };
+}
+
+#endif // OUZEL_STORAGE_MAPPEDFILE_HPP
@@ -84,9 +84,9 @@ namespace ouzel::thread
             if (!ReleaseSemaphore(semaphore, static_cast<LONG>(count), nullptr))
                 throw std::system_error{static_cast<int>(GetLastError()), std::system_category(), "Failed to release semaphore"};
 #elif defined(__APPLE__)
+            // the result is non-zero if a thread was woken, the signal itself cannot fail
             while (count-- > 0)
-                if (dispatch_semaphore_signal(semaphore) != 0)
-                    throw std::runtime_error{"Failed to signal semaphore"};
+                dispatch_semaphore_signal(semaphore);
 #else
             while (count-- > 0)
                 if (sem_post(&semaphore) == -1)
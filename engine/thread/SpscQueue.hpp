@@ -0,0 +1,71 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_THREAD_SPSCQUEUE_HPP
+#define OUZEL_THREAD_SPSCQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace ouzel::thread
+{
+    // Bounded wait-free ring buffer for one producer and one consumer thread,
+    // the slots are allocated in the constructor, so push and pop never allocate
+    template <class Type>
+    class SpscQueue final
+    {
+        static_assert(std::is_nothrow_move_assignable_v<Type>);
+    public:
+        explicit SpscQueue(std::size_t initialCapacity)
+        {
+            std::size_t capacity = 1;
+            while (capacity < initialCapacity) capacity <<= 1;
+
+            mask = capacity - 1;
+            slots = std::make_unique<Type[]>(capacity);
+        }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+        SpscQueue(SpscQueue&&) = delete;
+        SpscQueue& operator=(SpscQueue&&) = delete;
+
+        [[nodiscard]] auto getCapacity() const noexcept { return mask + 1; }
+
+        [[nodiscard]] bool isEmpty() const noexcept
+        {
+            return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        }
+
+        // must be called only by the producer thread, returns false if the queue is full
+        bool push(Type&& value) noexcept
+        {
+            const auto t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) > mask) return false;
+
+            slots[t & mask] = std::move(value);
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        // must be called only by the consumer thread, returns false if the queue is empty
+        bool pop(Type& value) noexcept
+        {
+            const auto h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire)) return false;
+
+            value = std::move(slots[h & mask]);
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        alignas(64) std::atomic<std::size_t> head{0};
+        alignas(64) std::atomic<std::size_t> tail{0};
+        std::size_t mask = 0;
+        std::unique_ptr<Type[]> slots;
+    };
+}
+
+#endif // OUZEL_THREAD_SPSCQUEUE_HPP
@@ -0,0 +1,160 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_THREAD_WORKSTEALINGQUEUE_HPP
+#define OUZEL_THREAD_WORKSTEALINGQUEUE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace ouzel::thread
+{
+    // Chase-Lev deque: the owning thread pushes and pops at the bottom,
+    // other threads steal from the top
+    template <class Type>
+    class WorkStealingQueue final
+    {
+        static_assert(std::is_trivially_copyable_v<Type>);
+    public:
+        explicit WorkStealingQueue(std::size_t initialCapacity = 1024)
+        {
+            std::size_t capacity = 1;
+            while (capacity < initialCapacity) capacity <<= 1;
+
+            auto buffer = std::make_unique<Buffer>(capacity);
+            array.store(buffer.get(), std::memory_order_relaxed);
+            buffers.push_back(std::move(buffer));
+        }
+
+        WorkStealingQueue(const WorkStealingQueue&) = delete;
+        WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+        WorkStealingQueue(WorkStealingQueue&&) = delete;
+        WorkStealingQueue& operator=(WorkStealingQueue&&) = delete;
+
+        [[nodiscard]] bool isEmpty() const noexcept
+        {
+            const auto b = bottom.load(std::memory_order_relaxed);
+            const auto t = top.load(std::memory_order_relaxed);
+            return b <= t;
+        }
+
+        [[nodiscard]] std::size_t getSize() const noexcept
+        {
+            const auto b = bottom.load(std::memory_order_relaxed);
+            const auto t = top.load(std::memory_order_relaxed);
+            return b > t ? static_cast<std::size_t>(b - t) : 0;
+        }
+
+        // must be called only by the owner thread
+        void push(Type value)
+        {
+            const auto b = bottom.load(std::memory_order_relaxed);
+            const auto t = top.load(std::memory_order_acquire);
+            auto buffer = array.load(std::memory_order_relaxed);
+
+            if (b - t > static_cast<std::int64_t>(buffer->capacity) - 1)
+                buffer = grow(buffer, t, b);
+
+            buffer->put(b, value);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+
+        // must be called only by the owner thread
+        std::optional<Type> pop() noexcept
+        {
+            const auto b = bottom.load(std::memory_order_relaxed) - 1;
+            const auto buffer = array.load(std::memory_order_relaxed);
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto t = top.load(std::memory_order_relaxed);
+
+            if (t > b)
+            {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+
+            const auto value = buffer->get(b);
+
+            if (t == b) // last element, race against the thieves
+            {
+                const bool won = top.compare_exchange_strong(t, t + 1,
+                                                             std::memory_order_seq_cst,
+                                                             std::memory_order_relaxed);
+                bottom.store(b + 1, std::memory_order_relaxed);
+                if (!won) return std::nullopt;
+            }
+
+            return value;
+        }
+
+        // can be called from any thread
+        std::optional<Type> steal() noexcept
+        {
+            auto t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const auto b = bottom.load(std::memory_order_acquire);
+
+            if (t >= b) return std::nullopt;
+
+            const auto buffer = array.load(std::memory_order_acquire);
+            const auto value = buffer->get(t);
+
+            if (!top.compare_exchange_strong(t, t + 1,
+                                             std::memory_order_seq_cst,
+                                             std::memory_order_relaxed))
+                return std::nullopt;
+
+            return value;
+        }
+
+    private:
+        struct Buffer final
+        {
+            explicit Buffer(std::size_t c):
+                capacity{c},
+                mask{c - 1},
+                data{std::make_unique<std::atomic<Type>[]>(c)}
+            {
+            }
+
+            Type get(std::int64_t index) const noexcept
+            {
+                return data[static_cast<std::size_t>(index) & mask].load(std::memory_order_relaxed);
+            }
+
+            void put(std::int64_t index, Type value) noexcept
+            {
+                data[static_cast<std::size_t>(index) & mask].store(value, std::memory_order_relaxed);
+            }
+
+            std::size_t capacity;
+            std::size_t mask;
+            std::unique_ptr<std::atomic<Type>[]> data;
+        };
+
+        Buffer* grow(const Buffer* buffer, std::int64_t t, std::int64_t b)
+        {
+            auto newBuffer = std::make_unique<Buffer>(buffer->capacity * 2);
+            for (auto i = t; i < b; ++i)
+                newBuffer->put(i, buffer->get(i));
+
+            // old buffers are kept alive until destruction, because thieves may still read from them
+            auto result = newBuffer.get();
+            buffers.push_back(std::move(newBuffer));
+            array.store(result, std::memory_order_release);
+            return result;
+        }
+
+        alignas(64) std::atomic<std::int64_t> top{0};
+        alignas(64) std::atomic<std::int64_t> bottom{0};
+        std::atomic<Buffer*> array{nullptr};
+        std::vector<std::unique_ptr<Buffer>> buffers;
+    };
+}
+
+#endif // OUZEL_THREAD_WORKSTEALINGQUEUE_HPP
@@ -0,0 +1,50 @@
+// Ouzel by Elviss Strazdins
+
+#include "core/Setup.h"
+
+#if OUZEL_COMPILE_ALSA
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "Test.hpp"
+#include "audio/alsa/ALSAAudioDevice.hpp"
+
+namespace
+{
+    using namespace ouzel;
+}
+
+// Plays into the null PCM, which like the hw devices is not started by the commits
+// of the mapped buffer, and reports only the frames that fit in its buffer until it is started
+OUZEL_TEST("AudioDevice.alsaStart")
+{
+    audio::Settings settings;
+    settings.audioDevice = "null";
+
+    std::atomic<std::uint64_t> renderedFrames{0};
+    audio::alsa::AudioDevice device{settings, [&renderedFrames](std::uint32_t frames,
+                                                                std::uint32_t channels,
+                                                                std::uint32_t,
+                                                                std::vector<float>& samples) {
+        samples.assign(static_cast<std::size_t>(frames) * channels, 0.0F);
+        renderedFrames += frames;
+    }};
+
+    // the buffer of the device holds four periods of 1024 frames, so a quarter of a second
+    // can be rendered only after the device has been started
+    const auto expectedFrames = settings.sampleRate / 4;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+
+    device.start();
+    while (renderedFrames <= expectedFrames && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    device.stop();
+
+    test::expect(renderedFrames > expectedFrames, "The device must be started after its buffer is filled");
+    test::expect(device.getXrunCount() == 0, "The device must not underrun");
+}
+
+#endif
@@ -0,0 +1,237 @@
+// Ouzel by Elviss Strazdins
+
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <vector>
+#include "Test.hpp"
+#include "graphics/Commands.hpp"
+
+namespace
+{
+    using namespace ouzel;
+    using graphics::Command;
+    using graphics::ResourceId;
+
+    constexpr std::size_t drawCount = 100000;
+
+    // The heap allocated commands that CommandBuffer stored in a queue
+    // before the linear command buffer, kept as the baseline of the benchmark
+    namespace queued
+    {
+        class Command
+        {
+        public:
+            explicit Command(graphics::Command::Type initType) noexcept: type{initType} {}
+            virtual ~Command() = default;
+
+            const graphics::Command::Type type;
+        };
+
+        class SetPipelineStateCommand final: public Command
+        {
+        public:
+            SetPipelineStateCommand(ResourceId initBlendState, ResourceId initShader) noexcept:
+                Command{graphics::Command::Type::setPipelineState},
+                blendState{initBlendState},
+                shader{initShader}
+            {
+            }
+
+            const ResourceId blendState;
+            const ResourceId shader;
+        };
+
+        class SetShaderConstantsCommand final: public Command
+        {
+        public:
+            SetShaderConstantsCommand(std::vector<std::vector<float>> initFragmentShaderConstants,
+                                      std::vector<std::vector<float>> initVertexShaderConstants):
+                Command{graphics::Command::Type::setShaderConstants},
+                fragmentShaderConstants{initFragmentShaderConstants},
+                vertexShaderConstants{initVertexShaderConstants}
+            {
+            }
+
+            const std::vector<std::vector<float>> fragmentShaderConstants;
+            const std::vector<std::vector<float>> vertexShaderConstants;
+        };
+
+        class SetTexturesCommand final: public Command
+        {
+        public:
+            explicit SetTexturesCommand(const std::vector<ResourceId>& initTextures):
+                Command{graphics::Command::Type::setTextures},
+                textures{initTextures}
+            {
+            }
+
+            const std::vector<ResourceId> textures;
+        };
+
+        class DrawCommand final: public Command
+        {
+        public:
+            DrawCommand(ResourceId initIndexBuffer, std::uint32_t initIndexCount) noexcept:
+                Command{graphics::Command::Type::draw},
+                indexBuffer{initIndexBuffer},
+                indexCount{initIndexCount}
+            {
+            }
+
+            const ResourceId indexBuffer;
+            const std::uint32_t indexCount;
+        };
+    }
+
+    const float color[4] = {1.0F, 0.5F, 0.25F, 1.0F};
+    const math::Matrix<float, 4, 4> transform = math::identityMatrix<float, 4>;
+
+    void encode(graphics::CommandBuffer& commandBuffer)
+    {
+        commandBuffer.clear();
+
+        for (std::size_t i = 0; i < drawCount; ++i)
+        {
+            const ResourceId texture = i % 16;
+
+            commandBuffer.pushCommand<graphics::SetPipelineStateCommand>(1, i % 4,
+                                                                         graphics::CullMode::none,
+                                                                         graphics::FillMode::solid);
+            const auto fragmentShaderConstants = commandBuffer.pushShaderConstants({color});
+            const auto vertexShaderConstants = commandBuffer.pushShaderConstants({transform});
+            commandBuffer.pushCommand<graphics::SetShaderConstantsCommand>(fragmentShaderConstants,
+                                                                           vertexShaderConstants);
+            commandBuffer.pushCommand<graphics::SetTexturesCommand>(commandBuffer.pushData(&texture, 1));
+            commandBuffer.pushCommand<graphics::DrawCommand>(2, 6, 2, 3, graphics::DrawMode::triangleList, 0);
+        }
+    }
+
+    // walks the commands the same way the render devices do and sums up their payload
+    std::size_t decode(const graphics::CommandBuffer& commandBuffer)
+    {
+        std::size_t checksum = 0;
+
+        for (const auto command : commandBuffer)
+        {
+            switch (command->type)
+            {
+                case Command::Type::setPipelineState:
+                {
+                    auto setPipelineStateCommand = static_cast<const graphics::SetPipelineStateCommand*>(command);
+                    checksum += setPipelineStateCommand->shader;
+                    break;
+                }
+                case Command::Type::setShaderConstants:
+                {
+                    auto setShaderConstantsCommand = static_cast<const graphics::SetShaderConstantsCommand*>(command);
+                    const auto constants = commandBuffer.getShaderConstants(setShaderConstantsCommand->vertexShaderConstants);
+                    checksum += static_cast<std::size_t>(constants[0]);
+                    break;
+                }
+                case Command::Type::setTextures:
+                {
+                    auto setTexturesCommand = static_cast<const graphics::SetTexturesCommand*>(command);
+                    checksum += setTexturesCommand->textures[0];
+                    break;
+                }
+                case Command::Type::draw:
+                {
+                    auto drawCommand = static_cast<const graphics::DrawCommand*>(command);
+                    checksum += drawCommand->indexCount;
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        return checksum;
+    }
+
+    void encode(std::queue<std::unique_ptr<queued::Command>>& commands)
+    {
+        for (std::size_t i = 0; i < drawCount; ++i)
+        {
+            commands.push(std::make_unique<queued::SetPipelineStateCommand>(1, i % 4));
+            commands.push(std::make_unique<queued::SetShaderConstantsCommand>(
+                std::vector<std::vector<float>>{{std::begin(color), std::end(color)}},
+                std::vector<std::vector<float>>{{std::begin(transform.m.v), std::end(transform.m.v)}}));
+            commands.push(std::make_unique<queued::SetTexturesCommand>(std::vector<ResourceId>{i % 16}));
+            commands.push(std::make_unique<queued::DrawCommand>(2, 6));
+        }
+    }
+
+    std::size_t decode(std::queue<std::unique_ptr<queued::Command>>& commands)
+    {
+        std::size_t checksum = 0;
+
+        while (!commands.empty())
+        {
+            const auto command = std::move(commands.front());
+            commands.pop();
+
+            switch (command->type)
+            {
+                case Command::Type::setPipelineState:
+                    checksum += static_cast<const queued::SetPipelineStateCommand*>(command.get())->shader;
+                    break;
+                case Command::Type::setShaderConstants:
+                    checksum += static_cast<std::size_t>(static_cast<const queued::SetShaderConstantsCommand*>(command.get())->vertexShaderConstants[0][0]);
+                    break;
+                case Command::Type::setTextures:
+                    checksum += static_cast<const queued::SetTexturesCommand*>(command.get())->textures[0];
+                    break;
+                case Command::Type::draw:
+                    checksum += static_cast<const queued::DrawCommand*>(command.get())->indexCount;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        return checksum;
+    }
+
+    std::size_t getExpectedChecksum()
+    {
+        std::size_t checksum = 0;
+        for (std::size_t i = 0; i < drawCount; ++i)
+            checksum += i % 4 + 1 + i % 16 + 6;
+        return checksum;
+    }
+}
+
+OUZEL_TEST("CommandBuffer.roundTrip")
+{
+    graphics::CommandBuffer commandBuffer;
+
+    // the second frame reuses the memory of the first one
+    for (int frame = 0; frame < 2; ++frame)
+    {
+        encode(commandBuffer);
+        test::expect(commandBuffer.getCommandCount() == drawCount * 4, "All the commands must be stored");
+        test::expect(decode(commandBuffer) == getExpectedChecksum(), "Commands must be read back unchanged");
+    }
+}
+
+// Encodes and decodes a frame of 100k draw calls, each with a pipeline
+// state, shader constants and texture change
+OUZEL_BENCHMARK("CommandBuffer.benchmark")
+{
+    std::size_t checksum = 0;
+
+    std::queue<std::unique_ptr<queued::Command>> commands;
+    test::report("unique_ptr queue", test::measure(drawCount, [&commands, &checksum]() {
+        encode(commands);
+        checksum += decode(commands);
+    }), "draws");
+
+    graphics::CommandBuffer commandBuffer;
+    test::report("linear command buffer", test::measure(drawCount, [&commandBuffer, &checksum]() {
+        encode(commandBuffer);
+        checksum += decode(commandBuffer);
+    }), "draws");
+
+    test::expect(checksum % getExpectedChecksum() == 0, "Commands must be read back unchanged");
+}
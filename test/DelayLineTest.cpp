@@ -0,0 +1,98 @@
+// Ouzel by Elviss Strazdins
+
+#include <cstddef>
+#include "Test.hpp"
+#include "audio/DelayLine.hpp"
+
+namespace
+{
+    using namespace ouzel;
+
+    // the samples count up from one, so the sample written a given delay before the last one is known
+    void writeRamp(audio::DelayLine& delayLine, std::size_t count)
+    {
+        for (std::size_t i = 1; i <= count; ++i)
+            delayLine.write(static_cast<float>(i));
+    }
+
+    // checks every integer and fractional delay up to the longest one, after count samples were written
+    bool readsRamp(const audio::DelayLine& delayLine, std::size_t count)
+    {
+        const auto maxDelay = static_cast<std::size_t>(delayLine.getMaxDelay());
+        for (std::size_t delay = 0; delay <= maxDelay; ++delay)
+        {
+            const auto expected = static_cast<float>(count - delay);
+            if (delayLine.read(delay) != expected) return false;
+            if (delayLine.read(static_cast<float>(delay)) != expected) return false;
+            if (delayLine.read(static_cast<float>(delay) + 0.25F) != expected - 0.25F) return false;
+        }
+        return true;
+    }
+}
+
+// The buffer is rounded up to a power of two, the longest delay must be readable with the interpolation
+OUZEL_TEST("DelayLine.maxDelay")
+{
+    test::expect(audio::DelayLine{}.getMaxDelay() == 0.0F, "An empty line must not have a delay");
+
+    for (const auto maxDelay : {1.0F, 10.0F, 10.5F, 14.0F, 15.0F})
+    {
+        audio::DelayLine delayLine{maxDelay};
+        test::expect(delayLine.getMaxDelay() >= maxDelay, "The line must hold the requested delay");
+
+        writeRamp(delayLine, 100);
+        test::expect(readsRamp(delayLine, 100), "Every delay up to the longest one must be read");
+    }
+}
+
+// Writes several times the length of the buffer, so that the position wraps around between the reads
+OUZEL_TEST("DelayLine.wrapAround")
+{
+    const auto length = static_cast<std::size_t>(audio::DelayLine{10.0F}.getMaxDelay()) + 2;
+
+    for (auto count = length; count <= length * 3; ++count)
+    {
+        audio::DelayLine delayLine{10.0F};
+        writeRamp(delayLine, count);
+        test::expect(readsRamp(delayLine, count), "The delayed samples must be read across the end of the buffer");
+    }
+}
+
+// The written samples must survive the growth, the new delays read zeros until they are written
+OUZEL_TEST("DelayLine.grow")
+{
+    audio::DelayLine delayLine{10.0F};
+    const auto shortMaxDelay = static_cast<std::size_t>(delayLine.getMaxDelay());
+    constexpr std::size_t written = 37; // not a multiple of the length, so the position is in the middle
+
+    writeRamp(delayLine, written);
+
+    audio::DelayLine longerLine{100.0F};
+    const auto longMaxDelay = longerLine.getMaxDelay();
+    delayLine.grow(longerLine);
+
+    test::expect(delayLine.getMaxDelay() == longMaxDelay, "The line must take the longer buffer");
+    test::expect(longerLine.getMaxDelay() == static_cast<float>(shortMaxDelay),
+                 "The replaced buffer must be left in the longer line");
+
+    for (std::size_t delay = 0; delay <= shortMaxDelay + 1; ++delay)
+        test::expect(delayLine.read(delay) == static_cast<float>(written - delay), "The history must be kept");
+    for (auto delay = shortMaxDelay + 2; delay <= static_cast<std::size_t>(longMaxDelay) + 1; ++delay)
+        test::expect(delayLine.read(delay) == 0.0F, "The delays that were not written must be silent");
+
+    // the history moves on with the new writes
+    writeRamp(delayLine, written * 4);
+    test::expect(readsRamp(delayLine, written * 4), "The grown line must be written and read across its end");
+
+    // a shorter line does not replace the buffer
+    audio::DelayLine shorterLine{10.0F};
+    delayLine.grow(shorterLine);
+    test::expect(delayLine.getMaxDelay() == longMaxDelay, "A shorter line must not replace the buffer");
+
+    // reserving keeps the history the same way
+    audio::DelayLine reservedLine{10.0F};
+    writeRamp(reservedLine, written);
+    reservedLine.reserve(100.0F);
+    for (std::size_t delay = 0; delay <= shortMaxDelay + 1; ++delay)
+        test::expect(reservedLine.read(delay) == static_cast<float>(written - delay), "Reserving must keep the history");
+}
@@ -0,0 +1,101 @@
+// Ouzel by Elviss Strazdins
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "Test.hpp"
+#include "scene/Actor.hpp"
+#include "scene/Component.hpp"
+#include "scene/DrawList.hpp"
+
+namespace
+{
+    using namespace ouzel;
+
+    constexpr std::size_t actorCount = 50000;
+    constexpr std::int32_t orderCount = 100;
+
+    struct QueuedActor final
+    {
+        scene::Actor* actor;
+        std::int32_t order;
+    };
+
+    std::vector<std::int32_t> createOrders()
+    {
+        std::mt19937 randomEngine{1};
+        std::uniform_int_distribution<std::int32_t> distribution{-orderCount / 2, orderCount / 2};
+
+        std::vector<std::int32_t> orders(actorCount);
+        for (auto& order : orders)
+            order = distribution(randomEngine);
+        return orders;
+    }
+
+    // the sorted insertion that Actor::visit did before the draw list
+    void insertSorted(std::vector<QueuedActor>& drawQueue,
+                      std::vector<scene::Actor>& actors,
+                      const std::vector<std::int32_t>& orders)
+    {
+        drawQueue.clear();
+
+        for (std::size_t i = 0; i < actors.size(); ++i)
+        {
+            const QueuedActor queuedActor{&actors[i], orders[i]};
+            const auto upperBound = std::upper_bound(drawQueue.begin(), drawQueue.end(), queuedActor,
+                                                     [](const auto& a, const auto& b) noexcept {
+                                                         return a.order > b.order;
+                                                     });
+
+            drawQueue.insert(upperBound, queuedActor);
+        }
+    }
+
+    void sortDrawList(scene::DrawList& drawList,
+                      std::vector<scene::Actor>& actors,
+                      const std::vector<std::int32_t>& orders)
+    {
+        drawList.clear();
+
+        for (std::size_t i = 0; i < actors.size(); ++i)
+            drawList.add(actors[i], orders[i], static_cast<std::uint32_t>(i));
+
+        drawList.sort();
+    }
+}
+
+OUZEL_TEST("DrawList.order")
+{
+    std::vector<scene::Actor> actors(actorCount);
+    const auto orders = createOrders();
+
+    std::vector<QueuedActor> drawQueue;
+    insertSorted(drawQueue, actors, orders);
+
+    scene::DrawList drawList;
+    sortDrawList(drawList, actors, orders);
+
+    test::expect(drawList.getSize() == drawQueue.size(), "All the actors must be in the draw list");
+    test::expect(std::equal(drawList.begin(), drawList.end(), drawQueue.begin(),
+                            [](const auto& entry, const auto& queuedActor) noexcept {
+                                return entry.actor == queuedActor.actor;
+                            }), "The draw list must keep the order of the sorted insertion");
+}
+
+// Orders a layer of 50k visible actors with 100 distinct orders
+OUZEL_BENCHMARK("DrawList.benchmark")
+{
+    std::vector<scene::Actor> actors(actorCount);
+    const auto orders = createOrders();
+
+    std::vector<QueuedActor> drawQueue;
+    test::report("sorted insertion", test::measure(actorCount, [&drawQueue, &actors, &orders]() {
+        insertSorted(drawQueue, actors, orders);
+    }), "actors");
+
+    scene::DrawList drawList;
+    test::report("radix-sorted draw list", test::measure(actorCount, [&drawList, &actors, &orders]() {
+        sortDrawList(drawList, actors, orders);
+    }), "actors");
+}
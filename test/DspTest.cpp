@@ -0,0 +1,228 @@
+// Ouzel by Elviss Strazdins
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "Test.hpp"
+#include "audio/Dsp.hpp"
+
+namespace
+{
+    using namespace ouzel;
+
+    constexpr std::size_t sampleCount = 512 * 2; // a stereo buffer of the default size
+    constexpr float gain = 0.7071F;
+
+    // the samples exceed the [-1, 1] range, so that the clamping is exercised
+    std::vector<float> createSamples(std::mt19937::result_type seed)
+    {
+        std::mt19937 randomEngine{seed};
+        std::uniform_real_distribution<float> distribution{-1.5F, 1.5F};
+
+        std::vector<float> samples(sampleCount);
+        for (auto& sample : samples)
+            sample = distribution(randomEngine);
+        return samples;
+    }
+
+    // the scalar loops that the kernels replaced, the compilers must not vectorize them, or the benchmark
+    // would compare the kernels with the auto-vectorized loops instead
+#if defined(__clang__)
+#  define OUZEL_SCALAR_FUNCTION
+#  define OUZEL_SCALAR_LOOP _Pragma("clang loop vectorize(disable) interleave(disable)")
+#elif defined(__GNUC__)
+    // the loops would be vectorized in the callers if the functions were inlined
+#  define OUZEL_SCALAR_FUNCTION __attribute__((optimize("no-tree-vectorize"), noinline))
+#  define OUZEL_SCALAR_LOOP
+#elif defined(_MSC_VER)
+#  define OUZEL_SCALAR_FUNCTION
+#  define OUZEL_SCALAR_LOOP __pragma(loop(no_vector))
+#else
+#  define OUZEL_SCALAR_FUNCTION
+#  define OUZEL_SCALAR_LOOP
+#endif
+
+    namespace scalar
+    {
+        OUZEL_SCALAR_FUNCTION void add(float* destination, const float* source, std::size_t count) noexcept
+        {
+            OUZEL_SCALAR_LOOP
+            for (std::size_t i = 0; i < count; ++i)
+                destination[i] += source[i];
+        }
+
+        OUZEL_SCALAR_FUNCTION void addScaled(float* destination, const float* source, float factor, std::size_t count) noexcept
+        {
+            OUZEL_SCALAR_LOOP
+            for (std::size_t i = 0; i < count; ++i)
+                destination[i] += source[i] * factor;
+        }
+
+        OUZEL_SCALAR_FUNCTION void scale(float* destination, const float* source, float factor, std::size_t count) noexcept
+        {
+            OUZEL_SCALAR_LOOP
+            for (std::size_t i = 0; i < count; ++i)
+                destination[i] = source[i] * factor;
+        }
+
+        OUZEL_SCALAR_FUNCTION void addPair(float* destination, const float* a, const float* b, float factor, std::size_t count) noexcept
+        {
+            OUZEL_SCALAR_LOOP
+            for (std::size_t i = 0; i < count; ++i)
+                destination[i] = (a[i] + b[i]) * factor;
+        }
+
+        OUZEL_SCALAR_FUNCTION void clamp(float* destination, const float* source, float min, float max, std::size_t count) noexcept
+        {
+            OUZEL_SCALAR_LOOP
+            for (std::size_t i = 0; i < count; ++i)
+                destination[i] = std::clamp(source[i], min, max);
+        }
+
+        OUZEL_SCALAR_FUNCTION void convertToInt16(std::int16_t* destination, std::size_t stride, const float* source, std::size_t count) noexcept
+        {
+            OUZEL_SCALAR_LOOP
+            for (std::size_t i = 0; i < count; ++i)
+                destination[i * stride] = static_cast<std::int16_t>(std::clamp(source[i], -1.0F, 1.0F) * 32767.0F);
+        }
+
+        OUZEL_SCALAR_FUNCTION float dot(const float* a, const float* b, std::size_t count) noexcept
+        {
+            float result = 0.0F;
+            OUZEL_SCALAR_LOOP
+            for (std::size_t i = 0; i < count; ++i)
+                result += a[i] * b[i];
+            return result;
+        }
+    }
+
+    bool isClose(const std::vector<float>& a, const std::vector<float>& b)
+    {
+        return std::equal(a.begin(), a.end(), b.begin(), [](float x, float y) noexcept {
+            return std::fabs(x - y) <= 1e-6F;
+        });
+    }
+
+    template <class ScalarFunction, class KernelFunction>
+    void benchmark(const std::string& kernel, ScalarFunction scalarFunction, KernelFunction kernelFunction)
+    {
+        test::report(kernel + " scalar", test::measure(sampleCount, scalarFunction), "samples");
+        test::report(kernel + " SIMD", test::measure(sampleCount, kernelFunction), "samples");
+    }
+}
+
+OUZEL_TEST("Dsp.kernels")
+{
+    const auto a = createSamples(1);
+    const auto b = createSamples(2);
+
+    // an odd count, so that the scalar tail of the kernels is used
+    constexpr std::size_t count = sampleCount - 3;
+
+    auto expected = a;
+    auto result = a;
+    scalar::add(expected.data(), b.data(), count);
+    audio::dsp::add(result.data(), b.data(), count);
+    test::expect(isClose(result, expected), "add must match the scalar loop");
+
+    expected = a;
+    result = a;
+    scalar::addScaled(expected.data(), b.data(), gain, count);
+    audio::dsp::addScaled(result.data(), b.data(), gain, count);
+    test::expect(isClose(result, expected), "addScaled must match the scalar loop");
+
+    scalar::scale(expected.data(), a.data(), gain, count);
+    audio::dsp::scale(result.data(), a.data(), gain, count);
+    test::expect(isClose(result, expected), "scale must match the scalar loop");
+
+    scalar::addPair(expected.data(), a.data(), b.data(), gain, count);
+    audio::dsp::addPair(result.data(), a.data(), b.data(), gain, count);
+    test::expect(isClose(result, expected), "addPair must match the scalar loop");
+
+    scalar::clamp(expected.data(), a.data(), -1.0F, 1.0F, count);
+    audio::dsp::clamp(result.data(), a.data(), -1.0F, 1.0F, count);
+    test::expect(isClose(result, expected), "clamp must match the scalar loop");
+
+    std::vector<std::int16_t> expectedInt16(sampleCount * 2);
+    std::vector<std::int16_t> resultInt16(sampleCount * 2);
+    scalar::convertToInt16(expectedInt16.data() + 1, 2, a.data(), count);
+    audio::dsp::convertToInt16(resultInt16.data() + 1, 2, a.data(), count);
+    test::expect(resultInt16 == expectedInt16, "convertToInt16 must match the scalar loop");
+
+    test::expect(std::fabs(audio::dsp::dot(a.data(), b.data(), count) - scalar::dot(a.data(), b.data(), count)) <= 1e-3F,
+                 "dot must match the scalar loop");
+}
+
+OUZEL_TEST("Dsp.distanceAttenuation")
+{
+    test::expect(audio::dsp::getDistanceAttenuation(0.5F, 1.0F, 100.0F, 1.0F) == 1.0F,
+                 "The sounds closer than the minimal distance must not be attenuated");
+    test::expect(std::fabs(audio::dsp::getDistanceAttenuation(2.0F, 1.0F, 100.0F, 1.0F) - 0.5F) <= 1e-6F,
+                 "The attenuation must be inversely proportional to the distance");
+    test::expect(audio::dsp::getDistanceAttenuation(1000.0F, 1.0F, 100.0F, 1.0F) ==
+                 audio::dsp::getDistanceAttenuation(100.0F, 1.0F, 100.0F, 1.0F),
+                 "The attenuation must stop at the maximal distance");
+
+    // a zero minimal distance and a maximal distance below the minimal one
+    const auto atListener = audio::dsp::getDistanceAttenuation(0.0F, 0.0F, 100.0F, 1.0F);
+    const auto atDistance = audio::dsp::getDistanceAttenuation(0.1F, 0.0F, 100.0F, 1.0F);
+    test::expect(atListener == 1.0F, "A zero minimal distance must not attenuate the sound at the listener");
+    test::expect(atDistance > 0.0F && atDistance < 1.0F, "A zero minimal distance must not silence the sound");
+    test::expect(audio::dsp::getDistanceAttenuation(5.0F, 2.0F, 1.0F, 1.0F) == 1.0F,
+                 "A maximal distance below the minimal one must be raised to it");
+}
+
+// Processes a stereo buffer with every kernel and with the scalar loop that it replaced
+OUZEL_BENCHMARK("Dsp.benchmark")
+{
+    const auto a = createSamples(1);
+    const auto b = createSamples(2);
+    auto result = a;
+    std::vector<std::int16_t> resultInt16(sampleCount * 2);
+    volatile float dotResult = 0.0F;
+
+    benchmark("add", [&result, &b]() {
+        scalar::add(result.data(), b.data(), sampleCount);
+    }, [&result, &b]() {
+        audio::dsp::add(result.data(), b.data(), sampleCount);
+    });
+
+    benchmark("addScaled", [&result, &b]() {
+        scalar::addScaled(result.data(), b.data(), gain, sampleCount);
+    }, [&result, &b]() {
+        audio::dsp::addScaled(result.data(), b.data(), gain, sampleCount);
+    });
+
+    benchmark("scale", [&result, &a]() {
+        scalar::scale(result.data(), a.data(), gain, sampleCount);
+    }, [&result, &a]() {
+        audio::dsp::scale(result.data(), a.data(), gain, sampleCount);
+    });
+
+    benchmark("addPair", [&result, &a, &b]() {
+        scalar::addPair(result.data(), a.data(), b.data(), gain, sampleCount);
+    }, [&result, &a, &b]() {
+        audio::dsp::addPair(result.data(), a.data(), b.data(), gain, sampleCount);
+    });
+
+    benchmark("clamp", [&result, &a]() {
+        scalar::clamp(result.data(), a.data(), -1.0F, 1.0F, sampleCount);
+    }, [&result, &a]() {
+        audio::dsp::clamp(result.data(), a.data(), -1.0F, 1.0F, sampleCount);
+    });
+
+    benchmark("convertToInt16", [&resultInt16, &a]() {
+        scalar::convertToInt16(resultInt16.data(), 2, a.data(), sampleCount);
+    }, [&resultInt16, &a]() {
+        audio::dsp::convertToInt16(resultInt16.data(), 2, a.data(), sampleCount);
+    });
+
+    benchmark("dot", [&dotResult, &a, &b]() {
+        dotResult = scalar::dot(a.data(), b.data(), sampleCount);
+    }, [&dotResult, &a, &b]() {
+        dotResult = audio::dsp::dot(a.data(), b.data(), sampleCount);
+    });
+}
@@ -0,0 +1,281 @@
+// Ouzel by Elviss Strazdins
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#  include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#endif
+#include "Test.hpp"
+#include "smbPitchShift.hpp"
+#include "audio/Audio.hpp"
+#include "audio/Effects.hpp"
+#include "audio/Oscillator.hpp"
+#include "audio/PhaseVocoder.hpp"
+#include "audio/Submix.hpp"
+#include "audio/offline/OfflineAudioDevice.hpp"
+#include "math/Constants.hpp"
+
+namespace
+{
+    using namespace ouzel;
+
+    constexpr std::uint32_t renderedLength = 10; // in seconds
+
+    // the share of one core that a single instance of the effect takes to process an oscillator
+    // in real time, the offline mixer measures the time spent in every processor
+    template <class EffectType, class... Args>
+    double measureLoad(std::uint32_t channels, Args... args)
+    {
+        audio::Settings settings;
+        settings.channels = channels;
+        audio::Audio audio{audio::Driver::offline, settings};
+
+        audio::Oscillator oscillator{audio, 440.0F};
+        audio::Submix submix{audio};
+        submix.setOutput(&audio.getMasterMix());
+        EffectType effect{audio, args...};
+        submix.addEffect(&effect);
+
+        const auto streamId = audio.initStream(oscillator.getSourceId());
+        audio.addCommand(std::make_unique<audio::mixer::SetStreamOutputCommand>(streamId, submix.getBusId()));
+        audio.addCommand(std::make_unique<audio::mixer::PlayStreamCommand>(streamId));
+        audio.update();
+
+        auto& device = static_cast<audio::offline::AudioDevice&>(*audio.getDevice());
+        device.render(static_cast<std::uint64_t>(device.getSampleRate()) * renderedLength);
+        device.clearSamples();
+
+        for (const auto& [objectId, processingTime] : audio.getMixer().getProcessingTimes())
+            if (objectId == effect.getProcessorId())
+                return std::chrono::duration<double>{processingTime}.count() / renderedLength;
+
+        return 0.0;
+    }
+
+    void reportLoad(const std::string& benchmark, double load)
+    {
+        test::reportValue(benchmark, load * 100.0, "% of a core per instance");
+    }
+
+    constexpr std::size_t pannedVoiceCount = 200;
+    constexpr std::size_t pannedBuffers = 500;
+
+    constexpr std::uint32_t pitchSampleRate = 44100;
+    constexpr std::uint32_t pitchFrames = 512; // a buffer of the default size
+    constexpr float pitch = 1.5F;
+
+    // a chord of three partials, so that the vocoders have peaks to move
+    std::vector<float> createChord()
+    {
+        std::vector<float> samples(pitchFrames * 64);
+        for (std::size_t i = 0; i < samples.size(); ++i)
+        {
+            const auto time = static_cast<float>(i) / static_cast<float>(pitchSampleRate);
+            samples[i] = (std::sin(2.0F * math::pi<float> * 220.0F * time) +
+                          std::sin(2.0F * math::pi<float> * 277.18F * time) +
+                          std::sin(2.0F * math::pi<float> * 329.63F * time)) / 3.0F;
+        }
+        return samples;
+    }
+
+    // shifts one buffer after the other through the vocoder, wrapping around the input
+    template <class Vocoder>
+    class PitchBenchmark final
+    {
+    public:
+        explicit PitchBenchmark(const std::vector<float>& initInput):
+            input{initInput}, output(pitchFrames)
+        {
+        }
+
+        void operator()() noexcept
+        {
+            vocoder.process(pitch, pitchFrames, pitchSampleRate, &input[offset], output.data());
+            offset = (offset + pitchFrames) % input.size();
+        }
+
+    private:
+        const std::vector<float>& input;
+        std::vector<float> output;
+        std::size_t offset = 0;
+        Vocoder vocoder;
+    };
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    // time stamp counter ticks per processed sample, which run at the nominal frequency of the processor
+    template <class Function>
+    double measureCycles(std::size_t itemCount, Function function)
+    {
+        constexpr std::size_t iterations = 200;
+
+        function(); // warm up the caches
+        const auto start = __rdtsc();
+        for (std::size_t i = 0; i < iterations; ++i)
+            function();
+        return static_cast<double>(__rdtsc() - start) / static_cast<double>(iterations * itemCount);
+    }
+#endif
+
+    // shifts a sine through the vocoder in buffers of the default size and returns the output after the vocoder
+    // has settled, the input amplitude is 0.5
+    std::vector<float> shiftSine(float frequency, float shift)
+    {
+        constexpr std::size_t bufferCount = 128;
+        constexpr std::size_t settledFrames = 8192; // the latency of a frame and the first overlapping frames
+
+        audio::PhaseVocoder vocoder;
+        std::vector<float> output(pitchFrames * bufferCount);
+        std::vector<float> buffer(pitchFrames);
+        for (std::size_t i = 0; i < bufferCount; ++i)
+        {
+            for (std::size_t frame = 0; frame < pitchFrames; ++frame)
+                buffer[frame] = 0.5F * std::sin(2.0F * math::pi<float> * frequency *
+                                                static_cast<float>(i * pitchFrames + frame) /
+                                                static_cast<float>(pitchSampleRate));
+
+            vocoder.process(shift, pitchFrames, pitchSampleRate, buffer.data(), &output[i * pitchFrames]);
+        }
+
+        return std::vector<float>(output.begin() + settledFrames, output.end());
+    }
+
+    float getRms(const std::vector<float>& samples)
+    {
+        double sum = 0.0;
+        for (const auto sample : samples) sum += static_cast<double>(sample) * static_cast<double>(sample);
+        return static_cast<float>(std::sqrt(sum / static_cast<double>(samples.size())));
+    }
+
+    // counts the upward zero crossings, which is exact enough for a single partial
+    float getFrequency(const std::vector<float>& samples)
+    {
+        std::size_t first = 0;
+        std::size_t last = 0;
+        std::size_t crossings = 0;
+        for (std::size_t i = 1; i < samples.size(); ++i)
+            if (samples[i - 1] < 0.0F && samples[i] >= 0.0F)
+            {
+                if (crossings++ == 0) first = i;
+                last = i;
+            }
+
+        return crossings > 1 ?
+            static_cast<float>(crossings - 1) * static_cast<float>(pitchSampleRate) / static_cast<float>(last - first) :
+            0.0F;
+    }
+
+    template <class Vocoder>
+    void benchmarkPitch(const std::string& benchmark, const std::vector<float>& input)
+    {
+        test::report(benchmark, test::measure(pitchFrames, PitchBenchmark<Vocoder>{input}), "samples");
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+        test::reportValue(benchmark, measureCycles(pitchFrames, PitchBenchmark<Vocoder>{input}), "cycles/sample");
+#endif
+    }
+}
+
+// Processes the stereo and the 5.1 output of an oscillator with a reverb of the default size and with a large one
+OUZEL_BENCHMARK("Reverb.benchmark")
+{
+    const auto stereoLoad = measureLoad<audio::Reverb>(2, 0.1F, 0.5F);
+    test::expect(stereoLoad > 0.0, "The reverb must be processed");
+    reportLoad("stereo", stereoLoad);
+
+    reportLoad("5.1", measureLoad<audio::Reverb>(6, 0.1F, 0.5F));
+    reportLoad("stereo, 1 s lines", measureLoad<audio::Reverb>(2, 1.0F, 0.8F));
+}
+
+// A sine keeps its level and frequency at the unity pitch and is moved by the pitch factor otherwise
+OUZEL_TEST("PhaseVocoder.pitch")
+{
+    constexpr float frequency = 441.0F;
+    constexpr float inputRms = 0.5F * 0.70710678F;
+
+    const auto unshifted = shiftSine(frequency, 1.0F);
+    test::expect(std::fabs(getRms(unshifted) - inputRms) < inputRms * 0.05F, "The unity pitch must keep the level");
+    test::expect(std::fabs(getFrequency(unshifted) - frequency) < frequency * 0.01F,
+                 "The unity pitch must keep the frequency");
+
+    for (const auto shift : {0.5F, 0.75F, 1.5F, 2.0F})
+    {
+        const auto shifted = shiftSine(frequency, shift);
+        test::expect(std::fabs(getRms(shifted) - inputRms) < inputRms * 0.1F, "The shifted sine must keep its level");
+        test::expect(std::fabs(getFrequency(shifted) - frequency * shift) < frequency * shift * 0.01F,
+                     "The sine must be shifted by the pitch factor");
+    }
+}
+
+// Moves 200 oscillators, each on its own submix with a panner, on every buffer like the emitters of a scene do
+// and measures the game thread cost of the position updates and the mixer thread cost of the panning per voice
+OUZEL_BENCHMARK("Panner.benchmark")
+{
+    audio::Settings settings;
+    settings.channels = 2;
+    settings.maxVoices = pannedVoiceCount;
+    audio::Audio audio{audio::Driver::offline, settings};
+    audio::Oscillator oscillator{audio, 440.0F};
+
+    std::vector<std::unique_ptr<audio::Submix>> submixes;
+    std::vector<std::unique_ptr<audio::Panner>> panners;
+    for (std::size_t i = 0; i < pannedVoiceCount; ++i)
+    {
+        submixes.push_back(std::make_unique<audio::Submix>(audio));
+        submixes.back()->setOutput(&audio.getMasterMix());
+        panners.push_back(std::make_unique<audio::Panner>(audio));
+        submixes.back()->addEffect(panners.back().get());
+
+        const auto streamId = audio.initStream(oscillator.getSourceId());
+        audio.addCommand(std::make_unique<audio::mixer::SetStreamOutputCommand>(streamId, submixes.back()->getBusId()));
+        audio.addCommand(std::make_unique<audio::mixer::PlayStreamCommand>(streamId));
+    }
+    audio.update();
+
+    auto& device = static_cast<audio::offline::AudioDevice&>(*audio.getDevice());
+    device.render(device.getBufferSize());
+    audio.getMixer().resetProcessingTimes();
+
+    std::chrono::steady_clock::duration updateTime{};
+    for (std::size_t buffer = 0; buffer < pannedBuffers; ++buffer)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < pannedVoiceCount; ++i)
+        {
+            // the voices circle around the listener at different distances
+            const auto angle = 0.01F * static_cast<float>(buffer) + static_cast<float>(i);
+            const auto distance = 1.0F + static_cast<float>(i % 10);
+            panners[i]->setPosition(math::Vector<float, 3>{std::sin(angle) * distance, 0.0F, std::cos(angle) * distance});
+        }
+        audio.update();
+        updateTime += std::chrono::steady_clock::now() - start;
+
+        device.render(device.getBufferSize());
+        device.clearSamples();
+    }
+
+    std::chrono::steady_clock::duration panningTime{};
+    for (const auto& [objectId, processingTime] : audio.getMixer().getProcessingTimes())
+        for (const auto& panner : panners)
+            if (objectId == panner->getProcessorId())
+                panningTime += processingTime;
+
+    test::expect(panningTime.count() > 0, "The panners must be processed");
+
+    constexpr auto pannedVoiceBuffers = static_cast<double>(pannedVoiceCount * pannedBuffers);
+    test::report("position updates", pannedVoiceBuffers / std::chrono::duration<double>{updateTime}.count(), "voices");
+    test::report("panning", pannedVoiceBuffers / std::chrono::duration<double>{panningTime}.count(), "voice buffers");
+}
+
+// Shifts a mono buffer with the phase vocoder of PitchScale and PitchShift and with smbPitchShift that it replaced,
+// both with 1024 sample frames and the oversampling of 4
+OUZEL_BENCHMARK("PitchShift.benchmark")
+{
+    const auto input = createChord();
+
+    benchmarkPitch<smb::PitchShift<1024, 4>>("smbPitchShift", input);
+    benchmarkPitch<audio::PhaseVocoder>("phase vocoder", input);
+}
@@ -0,0 +1,94 @@
+// Ouzel by Elviss Strazdins
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Test.hpp"
+#include "audio/Fft.hpp"
+#include "math/Constants.hpp"
+
+namespace
+{
+    using namespace ouzel;
+
+    // every stage of the transform is used: the radix-2 size, the radix-4 pass alone and the SIMD stages
+    constexpr std::size_t sizes[] = {2, 4, 8, 64, 1024};
+
+    struct Signal final
+    {
+        std::vector<float> real;
+        std::vector<float> imag;
+    };
+
+    Signal createSignal(std::size_t size, std::mt19937::result_type seed)
+    {
+        std::mt19937 randomEngine{seed};
+        std::uniform_real_distribution<float> distribution{-1.0F, 1.0F};
+
+        Signal signal{std::vector<float>(size), std::vector<float>(size)};
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            signal.real[i] = distribution(randomEngine);
+            signal.imag[i] = distribution(randomEngine);
+        }
+        return signal;
+    }
+}
+
+// Compares the forward transform of random complex signals with a direct evaluation of the DFT in double precision
+OUZEL_TEST("Fft.naiveDft")
+{
+    for (const auto size : sizes)
+    {
+        auto signal = createSignal(size, static_cast<std::mt19937::result_type>(size));
+        const auto original = signal;
+
+        const audio::Fft fft{size};
+        fft.forward(signal.real.data(), signal.imag.data());
+
+        double largestError = 0.0;
+        for (std::size_t k = 0; k < size; ++k)
+        {
+            double real = 0.0;
+            double imag = 0.0;
+            for (std::size_t n = 0; n < size; ++n)
+            {
+                const auto angle = -2.0 * math::pi<double> * static_cast<double>((k * n) % size) / static_cast<double>(size);
+                real += static_cast<double>(original.real[n]) * std::cos(angle) -
+                    static_cast<double>(original.imag[n]) * std::sin(angle);
+                imag += static_cast<double>(original.real[n]) * std::sin(angle) +
+                    static_cast<double>(original.imag[n]) * std::cos(angle);
+            }
+
+            largestError = std::max(largestError, std::hypot(static_cast<double>(signal.real[k]) - real,
+                                                             static_cast<double>(signal.imag[k]) - imag));
+        }
+
+        // the rounding error of the float butterflies grows with the number of stages
+        test::expect(largestError < 1e-5 * static_cast<double>(size), "The transform must match the DFT");
+    }
+}
+
+// The inverse of the forward transform divided by the size must give back the signal
+OUZEL_TEST("Fft.roundTrip")
+{
+    for (const auto size : sizes)
+    {
+        auto signal = createSignal(size, static_cast<std::mt19937::result_type>(size + 1));
+        const auto original = signal;
+
+        const audio::Fft fft{size};
+        fft.forward(signal.real.data(), signal.imag.data());
+        fft.inverse(signal.real.data(), signal.imag.data());
+
+        float largestError = 0.0F;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            largestError = std::max(largestError, std::fabs(signal.real[i] / static_cast<float>(size) - original.real[i]));
+            largestError = std::max(largestError, std::fabs(signal.imag[i] / static_cast<float>(size) - original.imag[i]));
+        }
+
+        test::expect(largestError < 1e-5F, "The inverse transform must restore the signal");
+    }
+}
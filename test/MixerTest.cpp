@@ -0,0 +1,252 @@
+// Ouzel by Elviss Strazdins
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <vector>
+#if defined(__linux__)
+#  include <dlfcn.h>
+#  include <pthread.h>
+#endif
+#include "Test.hpp"
+#include "audio/Audio.hpp"
+#include "audio/Effects.hpp"
+#include "audio/Oscillator.hpp"
+#include "audio/PcmClip.hpp"
+#include "audio/Submix.hpp"
+#include "audio/offline/OfflineAudioDevice.hpp"
+
+namespace
+{
+    using namespace ouzel;
+
+    constexpr std::size_t voiceCount = 200;
+    constexpr std::size_t submixCount = 4;
+    constexpr std::uint32_t clipSampleRate = 22050;
+    constexpr std::uint32_t clipLength = 30; // in seconds, longer than the benchmark runs
+
+    // the heap operations and the mutex locks of all the threads are counted while counting is set
+    std::atomic<bool> counting{false};
+    std::atomic<std::size_t> heapOperationCount{0};
+    std::atomic<std::size_t> lockCount{0};
+
+    void countHeapOperation() noexcept
+    {
+        if (counting.load(std::memory_order_relaxed))
+            heapOperationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    audio::Settings createSettings(std::uint32_t maxVoices)
+    {
+        audio::Settings settings;
+        settings.channels = 2;
+        settings.maxVoices = maxVoices;
+        return settings;
+    }
+
+    // stereo noise at half of the mixer sample rate, so that its streams are resampled
+    std::vector<float> createClipSamples()
+    {
+        std::vector<float> samples(static_cast<std::size_t>(clipSampleRate) * clipLength * 2);
+        std::uint32_t seed = 1;
+        for (auto& sample : samples)
+        {
+            seed = seed * 1664525U + 1013904223U;
+            sample = static_cast<float>(seed >> 8) / 8388608.0F - 1.0F;
+        }
+        return samples;
+    }
+
+    // renders one buffer on the calling thread like the device callback does
+    void renderBuffer(audio::Audio& audio)
+    {
+        auto& device = static_cast<audio::offline::AudioDevice&>(*audio.getDevice());
+        device.render(device.getBufferSize());
+        device.clearSamples();
+    }
+
+    audio::mixer::Mixer::ObjectId playStream(audio::Audio& audio, const audio::Sound& sound, const audio::Mix& output)
+    {
+        const auto streamId = audio.initStream(sound.getSourceId());
+        audio.addCommand(std::make_unique<audio::mixer::SetStreamOutputCommand>(streamId, output.getBusId()));
+        audio.addCommand(std::make_unique<audio::mixer::SetStreamGainCommand>(streamId, 1.0F / static_cast<float>(voiceCount)));
+        audio.addCommand(std::make_unique<audio::mixer::PlayStreamCommand>(streamId));
+        return streamId;
+    }
+
+    // a scene of 200 voices on four submixes, half of them are mono oscillators that are upmixed
+    // and half are stereo clips that are resampled
+    class Scene final
+    {
+    public:
+        explicit Scene(std::uint32_t maxVoices):
+            audio{audio::Driver::offline, createSettings(maxVoices)},
+            oscillator{audio, 440.0F},
+            clip{audio, 2, clipSampleRate, createClipSamples()}
+        {
+            for (std::size_t i = 0; i < submixCount; ++i)
+            {
+                submixes.push_back(std::make_unique<audio::Submix>(audio));
+                submixes.back()->setOutput(&audio.getMasterMix());
+            }
+
+            for (std::size_t i = 0; i < voiceCount; ++i)
+                playStream(audio,
+                           (i % 2 == 0) ? static_cast<const audio::Sound&>(oscillator) : clip,
+                           *submixes[i % submixCount]);
+
+            audio.update();
+        }
+
+        auto& getAudio() noexcept { return audio; }
+
+    private:
+        audio::Audio audio;
+        audio::Oscillator oscillator;
+        audio::PcmClip clip;
+        std::vector<std::unique_ptr<audio::Submix>> submixes;
+    };
+}
+
+void* operator new(std::size_t size)
+{
+    countHeapOperation();
+    if (const auto pointer = std::malloc(size != 0 ? size : 1)) return pointer;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept
+{
+    if (pointer) countHeapOperation();
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+#if defined(__linux__)
+// std::mutex and the other locks of the standard library lock through this
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+    static const auto next = reinterpret_cast<int (*)(pthread_mutex_t*)>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+
+    if (counting.load(std::memory_order_relaxed))
+        lockCount.fetch_add(1, std::memory_order_relaxed);
+
+    return next(mutex);
+}
+#endif
+
+// Creates and deletes submixes and streams and updates the effects on the game thread between the callbacks
+// and checks that no callback allocates, frees or locks, the locks are counted only on Linux
+OUZEL_TEST("Mixer.realTimePath")
+{
+    constexpr std::size_t callbackCount = 1000;
+    constexpr std::size_t maxStreams = 48;
+
+    audio::Audio audio{audio::Driver::offline, createSettings(audio::Settings{}.maxVoices)};
+    audio::Oscillator oscillator{audio, 440.0F};
+    audio::PcmClip clip{audio, 2, clipSampleRate, createClipSamples()};
+
+    // the submixes are mixed through the effects, whose parameters change on every callback
+    audio::Submix effectMix{audio};
+    effectMix.setOutput(&audio.getMasterMix());
+    audio::Delay delay{audio, 0.01F};
+    effectMix.addEffect(&delay);
+    audio::Reverb reverb{audio, 0.05F};
+    effectMix.addEffect(&reverb);
+    audio::Panner panner{audio};
+    panner.setDopplerFactor(1.0F);
+    effectMix.addEffect(&panner);
+    audio::PitchShift pitchShift{audio};
+    effectMix.addEffect(&pitchShift);
+    audio::LowPass lowPass{audio, 1000.0F};
+    effectMix.addEffect(&lowPass);
+
+    std::deque<std::unique_ptr<audio::Submix>> submixes;
+    std::deque<audio::mixer::Mixer::ObjectId> streamIds;
+
+    renderBuffer(audio); // the memory sink of the device is allocated on the first buffer
+
+    for (std::size_t callback = 0; callback < callbackCount; ++callback)
+    {
+        if (callback % 100 == 0)
+        {
+            // the streams of the deleted submix are no longer mixed, but keep playing
+            if (submixes.size() == submixCount) submixes.pop_front();
+
+            submixes.push_back(std::make_unique<audio::Submix>(audio));
+            submixes.back()->setOutput(&effectMix);
+        }
+
+        // the delay lines grow
+        delay.setDelay(0.01F * static_cast<float>(callback % 50 + 1));
+        reverb.setDelay(0.05F + 0.001F * static_cast<float>(callback));
+        reverb.setPreDelay(0.0001F * static_cast<float>(callback));
+        panner.setPosition(math::Vector<float, 3>{0.1F * static_cast<float>(callback), 0.0F, 1.0F});
+        pitchShift.setShift(1.0F + 0.001F * static_cast<float>(callback));
+        lowPass.setFrequency(1000.0F + 10.0F * static_cast<float>(callback));
+
+        for (std::size_t i = 0; i < 4; ++i)
+            streamIds.push_back(playStream(audio,
+                                           (i % 2 == 0) ? static_cast<const audio::Sound&>(oscillator) : clip,
+                                           *submixes[(callback + i) % submixes.size()]));
+
+        while (streamIds.size() > maxStreams)
+        {
+            audio.deleteObject(streamIds.front());
+            streamIds.pop_front();
+        }
+
+        audio.update();
+
+        heapOperationCount = 0;
+        lockCount = 0;
+        counting = true;
+        renderBuffer(audio);
+        counting = false;
+
+        test::expect(heapOperationCount == 0, "The callback must not allocate or free memory");
+        test::expect(lockCount == 0, "The callback must not lock a mutex");
+    }
+}
+
+// Renders the 200 voice scene with all the voices audible and with the voice limit of the default settings
+OUZEL_BENCHMARK("Mixer.benchmark")
+{
+    const auto bufferSize = audio::Settings{}.bufferSize;
+
+    Scene scene{voiceCount};
+    test::report("200 voices", test::measure(bufferSize, [&scene]() {
+        renderBuffer(scene.getAudio());
+    }), "frames");
+
+    Scene limitedScene{audio::Settings{}.maxVoices};
+    test::report("200 voices, 64 rendered", test::measure(bufferSize, [&limitedScene]() {
+        renderBuffer(limitedScene.getAudio());
+    }), "frames");
+}
+
+// The performance gate of the benchmark job of the CI, fails if the 200 voice scene renders less than twice as fast as real time
+OUZEL_BENCHMARK("Mixer.realTimeFactor")
+{
+    constexpr double minRealTimeFactor = 2.0;
+
+    Scene scene{voiceCount};
+    auto& device = static_cast<audio::offline::AudioDevice&>(*scene.getAudio().getDevice());
+    device.render(device.getSampleRate() * 2);
+    device.clearSamples();
+
+    const auto renderedDuration = static_cast<double>(device.getRenderedFrames()) / device.getSampleRate();
+    const std::chrono::duration<double> renderTime = device.getRenderTime();
+    const auto realTimeFactor = renderedDuration / renderTime.count();
+    std::cout << "  real-time factor: " << realTimeFactor << '\n';
+
+    test::expect(realTimeFactor >= minRealTimeFactor, "The 200 voice scene must render at least twice as fast as real time");
+}
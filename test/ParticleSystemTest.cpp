@@ -0,0 +1,133 @@
+// Ouzel by Elviss Strazdins
+
+#include <vector>
+#include "Test.hpp"
+#include "core/WorkerPool.hpp"
+#include "scene/ParticleSimulation.hpp"
+
+namespace
+{
+    using namespace ouzel;
+
+    constexpr std::size_t systemCount = 200;
+    constexpr float frameTime = 1.0F / 60.0F;
+
+    scene::ParticleSystemData createParticleSystemData()
+    {
+        scene::ParticleSystemData particleSystemData;
+        particleSystemData.emitterType = scene::ParticleSystemData::EmitterType::gravity;
+        particleSystemData.maxParticles = 1000;
+        particleSystemData.duration = -1.0F;
+        particleSystemData.particleLifespan = 2.0F;
+        particleSystemData.particleLifespanVariance = 0.5F;
+        particleSystemData.speed = 100.0F;
+        particleSystemData.speedVariance = 20.0F;
+        particleSystemData.sourcePositionVariance = math::Vector<float, 2>{10.0F, 10.0F};
+        particleSystemData.startParticleSize = 8.0F;
+        particleSystemData.finishParticleSize = 2.0F;
+        particleSystemData.angleVariance = 180.0F;
+        particleSystemData.radialAcceleration = 10.0F;
+        particleSystemData.tangentialAcceleration = 5.0F;
+        particleSystemData.gravity = math::Vector<float, 2>{0.0F, -50.0F};
+        particleSystemData.startColorRed = particleSystemData.startColorGreen = 1.0F;
+        particleSystemData.startColorBlue = particleSystemData.startColorAlpha = 1.0F;
+        particleSystemData.finishColorAlpha = 0.0F;
+        particleSystemData.emissionRate = 500.0F;
+        return particleSystemData;
+    }
+
+    std::vector<scene::ParticleSimulation> createSimulations()
+    {
+        const auto particleSystemData = createParticleSystemData();
+
+        std::vector<scene::ParticleSimulation> simulations(systemCount);
+        for (std::size_t i = 0; i < systemCount; ++i)
+        {
+            auto& simulation = simulations[i];
+            simulation.init(particleSystemData);
+            simulation.setRandomSeed(static_cast<std::mt19937::result_type>(i));
+
+            scene::ParticleSimulation::Emitter emitter;
+            emitter.position = math::Vector<float, 2>{static_cast<float>(i), 0.0F};
+            simulation.setEmitter(emitter);
+            simulation.start();
+        }
+
+        return simulations;
+    }
+
+    void simulateSerially(std::vector<scene::ParticleSimulation>& simulations)
+    {
+        for (auto& simulation : simulations)
+            simulation.simulate(frameTime);
+    }
+
+    // the same split that ParticleSystem's updater uses
+    void simulateInParallel(core::WorkerPool& workerPool, std::vector<scene::ParticleSimulation>& simulations)
+    {
+        workerPool.parallelFor(0, simulations.size(), 1, [&simulations](std::size_t first, std::size_t last) {
+            for (auto i = first; i < last; ++i)
+                simulations[i].simulate(frameTime);
+        });
+    }
+
+    std::size_t getParticleCount(const std::vector<scene::ParticleSimulation>& simulations)
+    {
+        std::size_t particleCount = 0;
+        for (const auto& simulation : simulations)
+            particleCount += simulation.getParticleCount();
+        return particleCount;
+    }
+}
+
+OUZEL_TEST("ParticleSystem.deterministic")
+{
+    core::WorkerPool workerPool;
+
+    auto serialSimulations = createSimulations();
+    auto parallelSimulations = createSimulations();
+
+    for (std::size_t frame = 0; frame < 60; ++frame)
+    {
+        simulateSerially(serialSimulations);
+        simulateInParallel(workerPool, parallelSimulations);
+    }
+
+    for (std::size_t i = 0; i < systemCount; ++i)
+    {
+        const auto& serialSimulation = serialSimulations[i];
+        const auto& parallelSimulation = parallelSimulations[i];
+
+        test::expect(serialSimulation.getParticleCount() > 0, "Particles must be emitted");
+        test::expect(serialSimulation.getParticleCount() == parallelSimulation.getParticleCount(),
+                     "The particle count must not depend on the thread");
+
+        const auto& serialVertices = serialSimulation.getVertices();
+        const auto& parallelVertices = parallelSimulation.getVertices();
+        for (std::size_t v = 0; v < serialSimulation.getParticleCount() * 4; ++v)
+            test::expect(serialVertices[v].position == parallelVertices[v].position,
+                         "The particles must not depend on the thread");
+    }
+}
+
+// Updates a scene of 200 emitters, serially and on the worker pool
+OUZEL_BENCHMARK("ParticleSystem.benchmark")
+{
+    core::WorkerPool workerPool;
+
+    auto simulations = createSimulations();
+
+    // run until the emission and the deaths are balanced
+    for (std::size_t frame = 0; frame < 180; ++frame)
+        simulateInParallel(workerPool, simulations);
+
+    const auto particleCount = getParticleCount(simulations);
+
+    test::report("serial", test::measure(particleCount, [&simulations]() {
+        simulateSerially(simulations);
+    }), "particles");
+
+    test::report("worker pool", test::measure(particleCount, [&workerPool, &simulations]() {
+        simulateInParallel(workerPool, simulations);
+    }), "particles");
+}
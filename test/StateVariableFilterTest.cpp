@@ -0,0 +1,125 @@
+// Ouzel by Elviss Strazdins
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "Test.hpp"
+#include "audio/StateVariableFilter.hpp"
+#include "math/Constants.hpp"
+
+namespace
+{
+    using namespace ouzel;
+
+    constexpr std::uint32_t sampleRate = 48000;
+    constexpr std::uint32_t bufferSize = 512;
+    constexpr float cutoff = 1000.0F;
+
+    // the ratio of the output and the input amplitude of a sine, measured after the filter has settled
+    float measureGain(audio::StateVariableFilter& filter, float frequency)
+    {
+        filter.reserve(bufferSize, 1);
+        filter.reset();
+
+        constexpr std::uint32_t settleBuffers = 40;
+        constexpr std::uint32_t measuredBuffers = 20;
+
+        std::vector<float> samples(bufferSize);
+        std::uint64_t frame = 0;
+        float peak = 0.0F;
+        for (std::uint32_t buffer = 0; buffer < settleBuffers + measuredBuffers; ++buffer)
+        {
+            for (auto& sample : samples)
+                sample = std::sin(2.0F * math::pi<float> * frequency *
+                                  static_cast<float>(frame++) / static_cast<float>(sampleRate));
+
+            filter.process(bufferSize, 1, sampleRate, samples);
+
+            if (buffer >= settleBuffers)
+                for (const auto sample : samples)
+                    peak = std::max(peak, std::fabs(sample));
+        }
+
+        return peak;
+    }
+
+    bool isClose(float gain, float expected)
+    {
+        return std::fabs(gain - expected) <= expected * 0.05F;
+    }
+}
+
+// Passes a sine an octave and more below and above the cutoff through every type of the filter
+OUZEL_TEST("StateVariableFilter.response")
+{
+    using Type = audio::StateVariableFilter::Type;
+
+    constexpr float low = cutoff / 20.0F;
+    constexpr float high = cutoff * 20.0F;
+    constexpr float cut = 0.25F; // -12 dB
+    constexpr float stopBand = 0.01F; // -40 dB
+
+    audio::StateVariableFilter lowPass{Type::lowPass, cutoff, 0.70710678F, 0.0F};
+    test::expect(isClose(measureGain(lowPass, low), 1.0F), "The low-pass must pass the low frequencies");
+    test::expect(measureGain(lowPass, high) < stopBand, "The low-pass must attenuate the high frequencies");
+
+    audio::StateVariableFilter highPass{Type::highPass, cutoff, 0.70710678F, 0.0F};
+    test::expect(isClose(measureGain(highPass, high), 1.0F), "The high-pass must pass the high frequencies");
+    test::expect(measureGain(highPass, low) < stopBand, "The high-pass must attenuate the low frequencies");
+
+    audio::StateVariableFilter bandPass{Type::bandPass, cutoff, 0.70710678F, 0.0F};
+    test::expect(isClose(measureGain(bandPass, cutoff), 1.0F), "The band-pass must pass the center frequency");
+    test::expect(measureGain(bandPass, low) < 0.1F, "The band-pass must attenuate the low frequencies");
+    test::expect(measureGain(bandPass, high) < 0.1F, "The band-pass must attenuate the high frequencies");
+
+    audio::StateVariableFilter lowShelf{Type::lowShelf, cutoff, 0.70710678F, -12.0F};
+    test::expect(isClose(measureGain(lowShelf, high), 1.0F), "The low shelf must pass the high frequencies");
+    test::expect(isClose(measureGain(lowShelf, low), cut), "The low shelf must cut the low frequencies by its gain");
+
+    audio::StateVariableFilter highShelf{Type::highShelf, cutoff, 0.70710678F, -12.0F};
+    test::expect(isClose(measureGain(highShelf, low), 1.0F), "The high shelf must pass the low frequencies");
+    test::expect(isClose(measureGain(highShelf, high), cut), "The high shelf must cut the high frequencies by its gain");
+
+    audio::StateVariableFilter peak{Type::peak, cutoff, 0.70710678F, -12.0F};
+    test::expect(isClose(measureGain(peak, low), 1.0F), "The peak filter must pass the low frequencies");
+    test::expect(isClose(measureGain(peak, high), 1.0F), "The peak filter must pass the high frequencies");
+    test::expect(isClose(measureGain(peak, cutoff), cut), "The peak filter must cut the center frequency by its gain");
+}
+
+// Jumps the cutoff of a low-pass between 200 Hz and 8 kHz on every buffer, the ramped coefficients
+// must not move the output faster than a sine of the input frequency can
+OUZEL_TEST("StateVariableFilter.sweep")
+{
+    constexpr float frequency = 440.0F;
+    constexpr std::uint32_t buffers = 100;
+
+    audio::StateVariableFilter filter{audio::StateVariableFilter::Type::lowPass, 200.0F, 0.70710678F, 0.0F};
+    filter.reserve(bufferSize, 1);
+
+    // the largest step between two samples of a unit sine
+    const auto maxStep = 2.0F * math::pi<float> * frequency / static_cast<float>(sampleRate);
+
+    std::vector<float> samples(bufferSize);
+    std::uint64_t frame = 0;
+    float previous = 0.0F;
+    float largestStep = 0.0F;
+    for (std::uint32_t buffer = 0; buffer < buffers; ++buffer)
+    {
+        filter.setFrequency(buffer % 2 == 0 ? 8000.0F : 200.0F);
+
+        for (auto& sample : samples)
+            sample = std::sin(2.0F * math::pi<float> * frequency *
+                              static_cast<float>(frame++) / static_cast<float>(sampleRate));
+
+        filter.process(bufferSize, 1, sampleRate, samples);
+
+        for (const auto sample : samples)
+        {
+            largestStep = std::max(largestStep, std::fabs(sample - previous));
+            previous = sample;
+        }
+    }
+
+    test::expect(largestStep <= maxStep * 1.5F, "Changing the cutoff must not click");
+}
@@ -0,0 +1,99 @@
+// Ouzel by Elviss Strazdins
+
+#ifndef OUZEL_TEST_TEST_HPP
+#define OUZEL_TEST_TEST_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ouzel::test
+{
+    class TestError final: public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    inline void expect(bool condition, const std::string& message)
+    {
+        if (!condition) throw TestError{message};
+    }
+
+    struct TestCase final
+    {
+        const char* name;
+        void (*function)();
+        bool benchmark; // run only when asked for, because it is slow and depends on the machine
+    };
+
+    inline std::vector<TestCase>& getTestCases()
+    {
+        static std::vector<TestCase> testCases;
+        return testCases;
+    }
+
+    class Registration final
+    {
+    public:
+        Registration(const char* name, void (*function)(), bool benchmark = false)
+        {
+            getTestCases().push_back(TestCase{name, function, benchmark});
+        }
+    };
+
+    // Calls the function repeatedly for at least minDuration and returns the
+    // number of items processed per second, itemCount is the number of items
+    // processed by one call
+    template <class Function>
+    double measure(std::size_t itemCount, Function function,
+                   std::chrono::steady_clock::duration minDuration = std::chrono::milliseconds{200})
+    {
+        function(); // warm up the caches and the allocator
+
+        std::size_t iterations = 0;
+        const auto start = std::chrono::steady_clock::now();
+        auto now = start;
+        do
+        {
+            function();
+            ++iterations;
+            now = std::chrono::steady_clock::now();
+        }
+        while (now - start < minDuration);
+
+        const std::chrono::duration<double> elapsed = now - start;
+        return static_cast<double>(itemCount * iterations) / elapsed.count();
+    }
+
+    // prints a result of a benchmark that is not a rate, e.g. a share of a core or cycles per item
+    inline void reportValue(const std::string& benchmark, double value, const char* unit)
+    {
+        std::cout << "  " << benchmark << ": " << value << ' ' << unit << '\n';
+    }
+
+    inline void report(const std::string& benchmark, double rate, const char* unit)
+    {
+        reportValue(benchmark, rate, (std::string{unit} + "/s").c_str());
+    }
+}
+
+#define OUZEL_TEST_CONCAT_IMPL(a, b) a##b
+#define OUZEL_TEST_CONCAT(a, b) OUZEL_TEST_CONCAT_IMPL(a, b)
+
+// Defines a test function and registers it under the given name
+#define OUZEL_TEST(name) \
+    static void OUZEL_TEST_CONCAT(test, __LINE__)(); \
+    static const ouzel::test::Registration OUZEL_TEST_CONCAT(registration, __LINE__){name, &OUZEL_TEST_CONCAT(test, __LINE__)}; \
+    static void OUZEL_TEST_CONCAT(test, __LINE__)()
+
+// Defines a benchmark or a performance gate, which is run only with the --benchmarks argument
+#define OUZEL_BENCHMARK(name) \
+    static void OUZEL_TEST_CONCAT(test, __LINE__)(); \
+    static const ouzel::test::Registration OUZEL_TEST_CONCAT(registration, __LINE__){name, &OUZEL_TEST_CONCAT(test, __LINE__), true}; \
+    static void OUZEL_TEST_CONCAT(test, __LINE__)()
+
+#endif // OUZEL_TEST_TEST_HPP
@@ -0,0 +1,157 @@
+// Ouzel by Elviss Strazdins
+
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Test.hpp"
+#include "audio/mixer/Bus.hpp"
+#include "audio/mixer/Data.hpp"
+#include "audio/mixer/Stream.hpp"
+#include "audio/mixer/VoiceManager.hpp"
+
+namespace
+{
+    using namespace ouzel;
+
+    constexpr std::uint32_t mixerSampleRate = 48000;
+    constexpr std::uint32_t bufferSize = 512;
+
+    // mono data of ones, so that the output of a stream is its gain
+    class ConstantData final: public audio::mixer::Data
+    {
+    public:
+        ConstantData() noexcept: Data{1, mixerSampleRate} {}
+
+        std::unique_ptr<audio::mixer::Stream> createStream() override;
+    };
+
+    class ConstantStream final: public audio::mixer::Stream
+    {
+    public:
+        explicit ConstantStream(ConstantData& initData) noexcept: Stream{initData} {}
+
+        void reset() override {}
+
+        void generateSamples(std::uint32_t frames, std::vector<float>& samples) override
+        {
+            samples.assign(frames, 1.0F);
+        }
+
+        void skipSamples(std::uint32_t) override {}
+    };
+
+    std::unique_ptr<audio::mixer::Stream> ConstantData::createStream()
+    {
+        return std::make_unique<ConstantStream>(*this);
+    }
+
+    class Voices final
+    {
+    public:
+        Voices(std::size_t count, std::uint32_t maxVoices):
+            voiceManager{maxVoices}
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                buses.push_back(std::make_unique<audio::mixer::Bus>(bufferSize));
+                streams.push_back(data.createStream());
+                streams.back()->setOutput(buses.back().get());
+                streams.back()->play();
+                streamPointers.push_back(streams.back().get());
+            }
+
+            std::vector<std::pair<float, audio::mixer::Stream*>> buffer;
+            buffer.reserve(count);
+            voiceManager.swapBuffer(buffer);
+        }
+
+        auto& getStream(std::size_t index) noexcept { return *streams[index]; }
+
+        void update()
+        {
+            voiceManager.update(streamPointers, math::Vector<float, 3>{});
+        }
+
+        // the output of the stream in the next buffer
+        const std::vector<float>& render(std::size_t index)
+        {
+            audio::mixer::Bus::renderStream(*streams[index], bufferSize, 1, mixerSampleRate);
+            buses[index]->mix(bufferSize, 1, mixerSampleRate, false);
+            return buses[index]->getMixBuffer();
+        }
+
+        std::size_t getRealCount() const noexcept
+        {
+            std::size_t count = 0;
+            for (const auto& stream : streams)
+                if (!stream->isVirtual()) ++count;
+            return count;
+        }
+
+    private:
+        ConstantData data;
+        std::vector<std::unique_ptr<audio::mixer::Bus>> buses;
+        std::vector<std::unique_ptr<audio::mixer::Stream>> streams;
+        std::vector<audio::mixer::Stream*> streamPointers;
+        audio::mixer::VoiceManager voiceManager;
+    };
+}
+
+// Swaps the loudness of the two quietest of three streams by 1 dB on every buffer with a limit of two voices,
+// the streams must not flip between real and virtual, but a clearly louder stream must be promoted
+OUZEL_TEST("VoiceManager.hysteresis")
+{
+    Voices voices{3, 2};
+    auto& first = voices.getStream(1);
+    auto& second = voices.getStream(2);
+
+    std::size_t changeCount = 0;
+    for (std::size_t buffer = 0; buffer < 100; ++buffer)
+    {
+        first.setGain(buffer % 2 == 0 ? 0.5F : 0.56F);
+        second.setGain(buffer % 2 == 0 ? 0.56F : 0.5F);
+
+        const auto wasVirtual = first.isVirtual();
+        voices.update();
+        if (buffer > 0 && first.isVirtual() != wasVirtual) ++changeCount;
+
+        test::expect(voices.getRealCount() <= 2, "The voice limit must be kept");
+    }
+
+    test::expect(changeCount == 0, "The streams around the voice limit must not flip");
+
+    auto& virtualStream = first.isVirtual() ? first : second;
+    auto& realStream = first.isVirtual() ? second : first;
+    virtualStream.setGain(1.0F);
+    realStream.setGain(0.1F);
+    voices.update();
+
+    test::expect(!virtualStream.isVirtual() && realStream.isVirtual(), "A clearly louder stream must be promoted");
+}
+
+// The stream that becomes virtual is faded out over one more buffer and the one that becomes real is faded in
+OUZEL_TEST("VoiceManager.fade")
+{
+    Voices voices{2, 1};
+    auto& demoted = voices.getStream(0);
+    auto& promoted = voices.getStream(1);
+    promoted.setGain(0.1F);
+
+    for (std::size_t buffer = 0; buffer < 10; ++buffer) voices.update();
+    test::expect(promoted.isVirtual(), "The quieter stream must be virtual");
+
+    demoted.setGain(0.1F);
+    promoted.setGain(1.0F);
+    voices.update();
+
+    const auto fadedOut = voices.render(0);
+    test::expect(std::fabs(fadedOut.front() - 0.1F) < 0.01F && std::fabs(fadedOut.back()) < 1e-6F,
+                 "The demoted stream must be faded out");
+    test::expect(voices.render(0).back() == 0.0F, "The demoted stream must not be rendered after the fade");
+
+    const auto fadedIn = voices.render(1);
+    test::expect(fadedIn.front() < 0.01F && std::fabs(fadedIn.back() - 1.0F) < 1e-6F,
+                 "The promoted stream must be faded in");
+    test::expect(voices.render(1).front() == 1.0F, "The promoted stream must be rendered at its gain after the fade");
+}
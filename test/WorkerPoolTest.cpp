@@ -0,0 +1,213 @@
+// Ouzel by Elviss Strazdins
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Test.hpp"
+#include "core/WorkerPool.hpp"
+
+namespace
+{
+    // The single mutex queue that WorkerPool used before the work-stealing
+    // deques, kept as the baseline of the benchmark
+    class MutexQueuePool final
+    {
+    public:
+        explicit MutexQueuePool(std::size_t count)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                workers.emplace_back(&MutexQueuePool::work, this);
+        }
+
+        ~MutexQueuePool()
+        {
+            std::unique_lock lock{taskQueueMutex};
+            running = false;
+            lock.unlock();
+            taskQueueCondition.notify_all();
+
+            for (auto& worker : workers)
+                worker.join();
+        }
+
+        MutexQueuePool(const MutexQueuePool&) = delete;
+        MutexQueuePool& operator=(const MutexQueuePool&) = delete;
+
+        void run(std::vector<std::function<void()>>& tasks)
+        {
+            std::unique_lock lock{taskQueueMutex};
+            remainingCount += tasks.size();
+            for (auto& task : tasks)
+                taskQueue.push(std::move(task));
+            lock.unlock();
+
+            taskQueueCondition.notify_all();
+        }
+
+        void wait()
+        {
+            std::unique_lock lock{taskQueueMutex};
+            finishedCondition.wait(lock, [this]() noexcept { return remainingCount == 0; });
+        }
+
+    private:
+        void work()
+        {
+            for (;;)
+            {
+                std::unique_lock lock{taskQueueMutex};
+                taskQueueCondition.wait(lock, [this]() noexcept { return !running || !taskQueue.empty(); });
+                if (!running) break;
+                auto task = std::move(taskQueue.front());
+                taskQueue.pop();
+                lock.unlock();
+
+                task();
+
+                lock.lock();
+                if (--remainingCount == 0)
+                {
+                    lock.unlock();
+                    finishedCondition.notify_all();
+                }
+            }
+        }
+
+        std::vector<std::thread> workers;
+        bool running = true;
+        std::size_t remainingCount = 0;
+        std::queue<std::function<void()>> taskQueue;
+        std::mutex taskQueueMutex;
+        std::condition_variable taskQueueCondition;
+        std::condition_variable finishedCondition;
+    };
+
+    constexpr std::size_t benchmarkTaskCount = 4096;
+
+    void spin(std::atomic<std::size_t>& counter)
+    {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+OUZEL_TEST("WorkerPool.parallelFor")
+{
+    ouzel::core::WorkerPool workerPool{3};
+
+    std::vector<std::atomic<int>> visits(10007);
+    workerPool.parallelFor(0, visits.size(), 64, [&visits](std::size_t first, std::size_t last) {
+        for (auto i = first; i < last; ++i)
+            visits[i].fetch_add(1, std::memory_order_relaxed);
+    });
+
+    for (const auto& visit : visits)
+        ouzel::test::expect(visit.load() == 1, "Every element must be visited once");
+}
+
+OUZEL_TEST("WorkerPool.parallelForThrowingCaller")
+{
+    ouzel::core::WorkerPool workerPool{3};
+
+    constexpr std::size_t chunkCount = 64;
+    std::atomic<std::size_t> finishedChunkCount{0};
+    bool thrown = false;
+
+    try
+    {
+        workerPool.parallelFor(0, chunkCount, 1, [&finishedChunkCount](std::size_t first, std::size_t) {
+            if (first == 0) throw std::runtime_error{"Caller chunk failed"};
+            std::this_thread::sleep_for(std::chrono::microseconds{100});
+            finishedChunkCount.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+
+    ouzel::test::expect(thrown, "The exception of the calling thread's chunk must propagate");
+    ouzel::test::expect(finishedChunkCount.load() == chunkCount - 1,
+                        "The queued chunks must finish before parallelFor returns");
+}
+
+OUZEL_TEST("WorkerPool.nestedTaskGroup")
+{
+    ouzel::core::WorkerPool workerPool{2};
+
+    std::atomic<std::size_t> counter{0};
+    ouzel::core::TaskGroup taskGroup;
+    for (std::size_t i = 0; i < 16; ++i)
+        taskGroup.add([&workerPool, &counter]() {
+            ouzel::core::TaskGroup nestedTaskGroup;
+            for (std::size_t j = 0; j < 16; ++j)
+                nestedTaskGroup.add([&counter]() { spin(counter); });
+            workerPool.wait(workerPool.run(std::move(nestedTaskGroup)));
+        });
+
+    workerPool.wait(workerPool.run(std::move(taskGroup)));
+    ouzel::test::expect(counter.load() == 16 * 16, "All the nested tasks must run");
+}
+
+OUZEL_TEST("WorkerPool.taskGraph")
+{
+    ouzel::core::WorkerPool workerPool{3};
+
+    std::atomic<int> step{0};
+    bool ordered = true;
+
+    ouzel::core::TaskGraph taskGraph;
+    const auto first = taskGraph.add([&step]() { step = 1; });
+    const auto left = taskGraph.add([&step, &ordered]() { if (step < 1) ordered = false; }, {first});
+    const auto right = taskGraph.add([&step, &ordered]() { if (step < 1) ordered = false; }, {first});
+    taskGraph.add([&step, &ordered]() { if (step != 1) ordered = false; step = 2; }, {left, right});
+
+    workerPool.wait(workerPool.run(std::move(taskGraph)));
+    ouzel::test::expect(ordered && step == 2, "Tasks must run after their dependencies");
+}
+
+// Tasks per second of a fan-out of small tasks, from one worker to one per core
+OUZEL_BENCHMARK("WorkerPool.benchmark")
+{
+    const std::size_t maxWorkerCount = std::max(std::thread::hardware_concurrency(), 2U);
+
+    for (std::size_t workerCount = 1; workerCount <= maxWorkerCount; workerCount *= 2)
+    {
+        std::atomic<std::size_t> counter{0};
+
+        double mutexQueueRate;
+        {
+            MutexQueuePool pool{workerCount};
+            mutexQueueRate = ouzel::test::measure(benchmarkTaskCount, [&pool, &counter]() {
+                std::vector<std::function<void()>> tasks;
+                tasks.reserve(benchmarkTaskCount);
+                for (std::size_t i = 0; i < benchmarkTaskCount; ++i)
+                    tasks.emplace_back([&counter]() { spin(counter); });
+                pool.run(tasks);
+                pool.wait();
+            });
+        }
+
+        double workStealingRate;
+        {
+            ouzel::core::WorkerPool pool{workerCount};
+            workStealingRate = ouzel::test::measure(benchmarkTaskCount, [&pool, &counter]() {
+                ouzel::core::TaskGroup taskGroup;
+                for (std::size_t i = 0; i < benchmarkTaskCount; ++i)
+                    taskGroup.add([&counter]() { spin(counter); });
+                pool.wait(pool.run(std::move(taskGroup)));
+            });
+        }
+
+        const auto workers = std::to_string(workerCount) + " workers";
+        ouzel::test::report("mutex queue, " + workers, mutexQueueRate, "tasks");
+        ouzel::test::report("work stealing, " + workers, workStealingRate, "tasks");
+    }
+}
@@ -1,8 +1,44 @@
 // Ouzel by Elviss Strazdins
 
-#include "cstdlib"
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include "Test.hpp"
 
-int main()
+// Runs all the registered tests or only the ones whose name starts with the filter argument,
+// with --benchmarks runs the benchmarks instead of the tests
+int main(int argc, char* argv[])
 {
-    return EXIT_SUCCESS;
+    const char* filter = "";
+    bool benchmarks = false;
+
+    for (int i = 1; i < argc; ++i)
+        if (std::strcmp(argv[i], "--benchmarks") == 0)
+            benchmarks = true;
+        else
+            filter = argv[i];
+
+    std::size_t failureCount = 0;
+
+    for (const auto& testCase : ouzel::test::getTestCases())
+    {
+        if (testCase.benchmark != benchmarks ||
+            std::strncmp(testCase.name, filter, std::strlen(filter)) != 0)
+            continue;
+
+        std::cout << testCase.name << '\n';
+
+        try
+        {
+            testCase.function();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "  FAILED: " << e.what() << '\n';
+            ++failureCount;
+        }
+    }
+
+    return (failureCount == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
 }